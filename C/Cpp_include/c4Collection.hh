@@ -74,6 +74,14 @@ struct C4Collection
     virtual Retained<C4Document> putDocument(const C4DocPutRequest& rq, size_t* C4NULLABLE outCommonAncestorIndex,
                                              C4Error* outError) = 0;
 
+    /// Performs multiple put requests, in order. Equivalent to calling `putDocument` on each one,
+    /// but faster since the existing documents are read in one query. The result is in the same
+    /// order as the requests; if a put fails, its document is null and `outErrors` has its error.
+    /// (Unlike `putDocument`, this doesn't throw exceptions for individual requests.)
+    virtual std::vector<Retained<C4Document>> putDocuments(const C4DocPutRequest* requests, size_t count,
+                                                           size_t* C4NULLABLE outCommonAncestorIndexes,
+                                                           C4Error* outErrors) = 0;
+
     virtual Retained<C4Document> createDocument(slice docID, slice revBody, C4RevisionFlags revFlags,
                                                 C4Error* outError) = 0;
 
@@ -90,6 +98,11 @@ struct C4Collection
     virtual C4Timestamp nextDocExpiration() const = 0;
     virtual int64_t     purgeExpiredDocs()        = 0;
 
+    // Body Compression:
+
+    /// Compresses newly saved bodies at least `minBodySize` bytes long; 0 turns compression off.
+    virtual void setBodyCompression(size_t minBodySize) = 0;
+
     // Queries & Indexes:
 
     /// Same as the C4Database method, but the query will refer to this collection by default.
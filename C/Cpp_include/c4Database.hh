@@ -67,6 +67,15 @@ struct C4Database
 
     static void shutdownLiteCore();
 
+    /// Sets a process-wide soft limit on the memory all open databases use for caching.
+    /// Past the limit, connections recycle each other's least-recently-used pages rather than
+    /// growing their own caches. 0 (the default) means no limit.
+    static void setCacheBudget(uint64_t bytes);
+
+    /// Sets the longest time background housekeeping spends at once returning a database's free
+    /// space to the filesystem, when it's idle. 0 disables it. The default is 100ms.
+    static void setVacuumBudget(uint32_t milliseconds);
+
     Retained<C4Database> openAgain() const;
 
     virtual void close()                                      = 0;
@@ -74,6 +83,9 @@ struct C4Database
     virtual void rekey(const C4EncryptionKey* C4NULLABLE key) = 0;
     virtual void maintenance(C4MaintenanceType)               = 0;
 
+    /// Sets the size in bytes of this connection's page cache. 0 restores the default (10MB.)
+    virtual void setCacheSize(size_t bytes) = 0;
+
     // Attributes:
 
     slice getName() const noexcept FLPURE { return _name; }
@@ -222,6 +234,9 @@ struct C4Database
     Retained<C4Query> newQuery(C4QueryLanguage language, slice queryExpression,
                                int* C4NULLABLE outErrorPos = nullptr) const;
 
+    /// Statistics of this connection's cache of compiled queries.
+    virtual C4QueryCacheStats getQueryCacheStats() const = 0;
+
     // Replicator:
 
     Retained<C4Replicator> newReplicator(C4Address serverAddress, slice remoteDatabaseName,
@@ -15,6 +15,7 @@
 #include "c4DocEnumeratorTypes.h"
 #include "fleece/InstanceCounted.hh"
 #include <memory>
+#include <span>
 
 C4_ASSUME_NONNULL_BEGIN
 
@@ -64,6 +65,12 @@ struct C4DocEnumerator
     /// Steps to the next document. Returns false when it reaches the end.
     bool next();
 
+    /// Steps past up to `docs.size()` documents, storing lightweight views of them in `docs`,
+    /// and returns the number stored; 0 means it reached the end.
+    /// The views' data is only valid until the enumerator is advanced again or closed.
+    /// Afterwards there is no current document.
+    size_t nextBatch(std::span<C4DocumentView> docs);
+
     /// Tears down the internal state without destructing this object. This is useful to free up
     /// resources if the destructor might not be called immediately (i.e. if it's waiting for a
     /// GC finalizer to run.)
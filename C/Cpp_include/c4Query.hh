@@ -79,7 +79,7 @@ struct C4Query final
       private:
         friend struct C4Query;
         friend class litecore::C4QueryObserverImpl;
-        explicit Enumerator(C4Query*, slice encodedParameters = fleece::nullslice);
+        explicit Enumerator(C4Query*, slice encodedParameters = fleece::nullslice, bool streaming = false);
         explicit Enumerator(Retained<litecore::QueryEnumerator> e);
 
         Retained<litecore::QueryEnumerator> _enum;
@@ -93,8 +93,14 @@ struct C4Query final
     /// ```
     Enumerator run(slice params = fleece::nullslice);
 
+    /// Runs the query, returning an enumerator that reads the rows from the database as it goes,
+    /// instead of collecting them all first. It can only go forward: `rowCount`, `seek` and
+    /// `restart` throw an exception. It keeps a read transaction open until it reaches the end or
+    /// is closed, so it shouldn't be kept around.
+    Enumerator runStreaming(slice params = fleece::nullslice);
+
     /// Creates a C-style enumerator. Prefer \ref run to this.
-    C4QueryEnumerator* createEnumerator(slice params = fleece::nullslice);
+    C4QueryEnumerator* createEnumerator(slice params = fleece::nullslice, bool streaming = false);
 
     // Observer:
 
@@ -133,7 +139,7 @@ struct C4Query final
 
     using ObserverSet = std::set<Retained<litecore::C4QueryObserverImpl>, KeyCmp>;
 
-    Retained<litecore::QueryEnumerator>       _createEnumerator(slice params);
+    Retained<litecore::QueryEnumerator>       _createEnumerator(slice params, bool streaming = false);
     Retained<litecore::C4QueryEnumeratorImpl> wrapEnumerator(litecore::QueryEnumerator* C4NULLABLE);
     void                                      liveQuerierUpdated(litecore::QueryEnumerator* C4NULLABLE, C4Error err);
     void                                      liveQuerierStopped();
@@ -16,7 +16,9 @@
 #include "c4ExceptionUtils.hh"
 
 #include "Actor.hh"
+#include "ActorStats.hh"
 #include "Backtrace.hh"
+#include "Instrumentation.hh"
 #include "KeyStore.hh"
 #include "Logging.hh"
 #include "StringUtil.hh"
@@ -31,6 +33,7 @@
 #include <cctype>
 #include <csignal>
 #include <algorithm>
+#include <map>
 #include <set>
 
 #ifdef _MSC_VER
@@ -159,6 +162,100 @@ void c4_dumpInstances(void) C4API {
 #endif
 }
 
+// LCOV_EXCL_STOP
+
+#pragma mark - ACTOR STATS:
+
+static void writeHistogram(fleece::Encoder& e, const actor::LatencyHistogram::Summary& h) {
+    e.beginDict(7);
+    e.writeKey(FLSTR("count"));
+    e.writeUInt(h.count);
+    e.writeKey(FLSTR("mean"));
+    e.writeDouble(h.mean);
+    e.writeKey(FLSTR("p50"));
+    e.writeUInt(h.p50);
+    e.writeKey(FLSTR("p90"));
+    e.writeUInt(h.p90);
+    e.writeKey(FLSTR("p99"));
+    e.writeUInt(h.p99);
+    e.writeKey(FLSTR("max"));
+    e.writeUInt(h.max);
+    e.writeKey(FLSTR("buckets"));
+    e.beginArray(h.buckets.size());
+    for ( auto& [limit, count] : h.buckets ) {
+        e.beginArray(2);
+        e.writeUInt(limit);
+        e.writeUInt(count);
+        e.endArray();
+    }
+    e.endArray();
+    e.endDict();
+}
+
+C4SliceResult c4_getActorStats(void) C4API {
+    return tryCatch<C4SliceResult>(nullptr, [] {
+        auto snapshots = actor::MailboxStats::snapshotAll();
+        // Actor names aren't unique, so disambiguate duplicates with their serial numbers:
+        map<string, unsigned> nameCounts;
+        for ( auto& s : snapshots ) ++nameCounts[s.name];
+
+        fleece::Encoder e;
+        e.beginDict(snapshots.size());
+        for ( auto& s : snapshots ) {
+            string key = s.name;
+            if ( key.empty() || nameCounts[key] > 1 ) key += stringprintf("#%llu", (unsigned long long)s.serial);
+            e.writeKey(slice(key));
+            e.beginDict(9);
+            e.writeKey(FLSTR("enqueued"));
+            e.writeUInt(s.enqueued);
+            e.writeKey(FLSTR("handled"));
+            e.writeUInt(s.handled);
+            e.writeKey(FLSTR("queueDepth"));
+            e.writeUInt(s.queueDepth);
+            e.writeKey(FLSTR("maxQueueDepth"));
+            e.writeUInt(s.maxQueueDepth);
+            e.writeKey(FLSTR("age"));
+            e.writeDouble(s.age);
+            e.writeKey(FLSTR("busy"));
+            e.writeDouble(s.busy);
+            e.writeKey(FLSTR("waitTime"));
+            writeHistogram(e, s.waitTime);
+            e.writeKey(FLSTR("runTime"));
+            writeHistogram(e, s.runTime);
+            if ( s.batches > 0 ) {
+                e.writeKey(FLSTR("batches"));
+                e.beginDict(4);
+                e.writeKey(FLSTR("count"));
+                e.writeUInt(s.batches);
+                e.writeKey(FLSTR("items"));
+                e.writeUInt(s.batchedItems);
+                e.writeKey(FLSTR("capacity"));
+                e.writeUInt(s.batchCapacity);
+                e.writeKey(FLSTR("latency"));
+                e.writeDouble(s.batchLatency);
+                e.endDict();
+            }
+            e.endDict();
+        }
+        e.endDict();
+        return C4SliceResult(e.finish());
+    });
+}
+
+#pragma mark - SIGNPOST TRACING:
+
+void c4_setSignpostTracing(bool enabled) C4API { Signpost::setTracing(enabled); }
+
+C4SliceResult c4_getSignpostTrace(bool clear) C4API {
+    return tryCatch<C4SliceResult>(nullptr, [clear] {
+        string json = Signpost::traceJSON();
+        if ( clear ) Signpost::clearTrace();
+        return toSliceResult(json);
+    });
+}
+
+// LCOV_EXCL_START
+
 #pragma mark - MISCELLANEOUS:
 
 bool c4_setTempDir(C4String path, C4Error* err) C4API {
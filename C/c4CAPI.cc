@@ -289,6 +289,20 @@ C4Document* c4coll_putDoc(C4Collection* coll, const C4DocPutRequest* rq, size_t*
                                  [&] { return coll->putDocument(*rq, outCommonAncestorIndex, outError).detach(); });
 }
 
+size_t c4coll_putDocs(C4Collection* coll, const C4DocPutRequest requests[], size_t count,
+                      C4Document* C4NULLABLE outDocs[C4NULLABLE], C4Error outErrors[]) noexcept {
+    returnIfCollectionInvalid(coll, outErrors, 0);
+    return tryCatch<size_t>(outErrors, [&] {
+        auto   docs   = coll->putDocuments(requests, count, nullptr, outErrors);
+        size_t nSaved = 0;
+        for ( size_t i = 0; i < count; ++i ) {
+            if ( docs[i] ) ++nSaved;
+            if ( outDocs ) outDocs[i] = docs[i].detach();
+        }
+        return nSaved;
+    });
+}
+
 C4Document* c4coll_createDoc(C4Collection* coll, C4String docID, C4Slice revBody, C4RevisionFlags revFlags,
                              C4Error* C4NULLABLE outError) noexcept {
     returnIfCollectionInvalid(coll, outError, nullptr);
@@ -345,6 +359,11 @@ int64_t c4coll_purgeExpiredDocs(C4Collection* coll, C4Error* C4NULLABLE outError
     return tryCatch<int64_t>(outError, [=] { return coll->purgeExpiredDocs(); });
 }
 
+bool c4coll_setBodyCompression(C4Collection* coll, size_t minBodySize, C4Error* C4NULLABLE outError) noexcept {
+    returnIfCollectionInvalid(coll, outError, false);
+    return tryCatch(outError, [=] { coll->setBodyCompression(minBodySize); });
+}
+
 bool c4coll_createIndex(C4Collection* coll, C4String name, C4String indexSpec, C4QueryLanguage queryLanguage,
                         C4IndexType indexType, const C4IndexOptions* C4NULLABLE indexOptions,
                         C4Error* C4NULLABLE outError) noexcept {
@@ -424,6 +443,14 @@ bool c4db_rekey(C4Database* database, const C4EncryptionKey* newKey, C4Error* ou
     return tryCatch(outError, [=] { return database->rekey(newKey); });
 }
 
+bool c4db_setCacheSize(C4Database* database, size_t bytes, C4Error* outError) noexcept {
+    return tryCatch(outError, [=] { return database->setCacheSize(bytes); });
+}
+
+void c4_setCacheBudget(uint64_t bytes) noexcept { C4Database::setCacheBudget(bytes); }
+
+void c4_setVacuumBudget(uint32_t milliseconds) noexcept { C4Database::setVacuumBudget(milliseconds); }
+
 C4String c4db_getName(C4Database* database) noexcept { return slice(database->getName()); }
 
 C4SliceResult c4db_getPath(C4Database* database) noexcept { return C4SliceResult(database->getPath()); }
@@ -771,6 +798,14 @@ bool c4enum_next(C4DocEnumerator* e, C4Error* outError) noexcept {
     });
 }
 
+size_t c4enum_nextBatch(C4DocEnumerator* e, C4DocumentView outDocs[], size_t maxDocs, C4Error* outError) noexcept {
+    return tryCatch<size_t>(outError, [&] {
+        size_t n = e->nextBatch({outDocs, maxDocs});
+        if ( n == 0 ) clearError(outError);  // end of iteration is not an error
+        return n;
+    });
+}
+
 bool c4enum_getDocumentInfo(C4DocEnumerator* e, C4DocumentInfo* outInfo) noexcept {
     return e->getDocumentInfo(*outInfo);
 }
@@ -883,6 +918,8 @@ C4Query* c4query_new2(C4Database* database, C4QueryLanguage language, C4Slice ex
     });
 }
 
+C4QueryCacheStats c4db_getQueryCacheStats(C4Database* database) noexcept { return database->getQueryCacheStats(); }
+
 unsigned c4query_columnCount(C4Query* query) noexcept { return query->columnCount(); }
 
 FLString c4query_columnTitle(C4Query* query, unsigned column) noexcept { return query->columnTitle(column); }
@@ -895,6 +932,10 @@ C4QueryEnumerator* c4query_run(C4Query* query, C4Slice encodedParameters, C4Erro
     return tryCatch<C4QueryEnumerator*>(outError, [&] { return query->createEnumerator(encodedParameters); });
 }
 
+C4QueryEnumerator* c4query_runStreaming(C4Query* query, C4Slice encodedParameters, C4Error* outError) noexcept {
+    return tryCatch<C4QueryEnumerator*>(outError, [&] { return query->createEnumerator(encodedParameters, true); });
+}
+
 C4StringResult c4query_explain(C4Query* query) noexcept {
     return tryCatch<C4StringResult>(nullptr, [&] { return C4StringResult(query->explain()); });
 }
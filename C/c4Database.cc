@@ -17,6 +17,7 @@
 
 #include "DatabaseImpl.hh"
 #include "DatabaseCookies.hh"
+#include "Housekeeper.hh"
 #include "PrebuiltCopier.hh"
 #include "SQLiteDataFile.hh"
 
@@ -168,6 +169,12 @@ constexpr const char* kInvalidDbNameMsgTemplate =
 
 /*static*/ void C4Database::shutdownLiteCore() { SQLiteDataFile::shutdown(); }
 
+/*static*/ void C4Database::setCacheBudget(uint64_t bytes) { SQLiteDataFile::setCacheBudget(bytes); }
+
+/*static*/ void C4Database::setVacuumBudget(uint32_t milliseconds) {
+    Housekeeper::setVacuumBudget(std::chrono::milliseconds(milliseconds));
+}
+
 Retained<C4Database> C4Database::openAgain() const {
     auto config = _config;
     config.flags |= kC4DB_NoHousekeeping;
@@ -14,6 +14,7 @@
 #include "CollectionImpl.hh"
 #include "Record.hh"
 #include "RecordEnumerator.hh"
+#include "RawRevTree.hh"
 #include "RevID.hh"
 #include "VersionVector.hh"
 #include "Error.hh"
@@ -79,10 +80,56 @@ class C4DocEnumerator::Impl
         return true;
     }
 
+    size_t nextBatch(std::span<C4DocumentView> docs) {
+        _legacyDocs.clear();
+        if ( _rows.size() < docs.size() ) _rows.resize(docs.size());
+        size_t n = RecordEnumerator::nextBatch({_rows.data(), docs.size()});
+        for ( size_t i = 0; i < n; ++i ) {
+            RecordView const& row = _rows[i];
+            C4DocumentView&   doc = docs[i];
+            doc.flags             = (C4DocumentFlags)row.flags | kDocExists;
+            doc.docID             = row.key;
+            doc.revID             = expandRevID(revid(row.version));
+            doc.sequence          = row.sequence;
+            doc.body              = row.body;
+            doc.bodySize          = row.bodySize;
+            doc.metaSize          = row.extraSize;
+            doc.expiration        = row.expiration;
+            if ( row.body && !revid(row.version).isVersion() && RawRevision::isRevTree(row.body) ) {
+                // A doc still in the v2.x format has its entire rev-tree in the body, so the
+                // current revision's body has to be found by instantiating the document:
+                Retained<C4Document> legacyDoc = _collection->getDocument(row.key, true, kDocGetCurrentRev);
+                doc.body                       = legacyDoc ? legacyDoc->getRevisionBody() : nullslice;
+                _legacyDocs.emplace_back(std::move(legacyDoc));
+            }
+        }
+        return n;
+    }
+
   private:
-    litecore::CollectionImpl* _collection;
-    C4EnumeratorOptions const _c4Options;
-    alloc_slice               _docRevID;
+    // Writes a revID in ASCII form into the batch arena.
+    slice expandRevID(revid vers) {
+        if ( !vers ) return nullslice;
+        if ( (_c4Options.flags & kC4IncludeRevHistory) && vers.isVersion() )
+            return copyToArena(vers.asVersionVector().asASCII());
+        size_t        maxSize = vers.isVersion() ? Version::kMaxASCIILength : 12 + 2 * vers.size;
+        void*         buf     = batchArena().alloc(maxSize, 1);
+        slice_ostream out(buf, maxSize);
+        Assert(vers.expandInto(out));
+        return {buf, out.bytesWritten()};
+    }
+
+    slice copyToArena(slice data) {
+        void* copy = batchArena().alloc(data.size, 1);
+        memcpy(copy, data.buf, data.size);
+        return {copy, data.size};
+    }
+
+    litecore::CollectionImpl*         _collection;
+    C4EnumeratorOptions const         _c4Options;
+    alloc_slice                       _docRevID;
+    std::vector<RecordView>           _rows;        // Buffer for RecordEnumerator::nextBatch
+    std::vector<Retained<C4Document>> _legacyDocs;  // Docs instantiated by the current batch
 };
 
 C4DocEnumerator::C4DocEnumerator(C4Collection* collection, const C4EnumeratorOptions& options)
@@ -106,6 +153,13 @@ C4DocumentInfo C4DocEnumerator::documentInfo() const {
 
 Retained<C4Document> C4DocEnumerator::getDocument() const { return _impl ? _impl->getDoc() : nullptr; }
 
+size_t C4DocEnumerator::nextBatch(std::span<C4DocumentView> docs) {
+    if ( !_impl ) return 0;
+    if ( size_t n = _impl->nextBatch(docs); n > 0 ) return n;
+    _impl = nullptr;
+    return 0;
+}
+
 bool C4DocEnumerator::next() {
     if ( _impl && _impl->next() ) return true;
     _impl = nullptr;
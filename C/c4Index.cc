@@ -99,6 +99,10 @@ struct C4IndexImpl final : public C4Index {
             opts.where = (char*)_spec.whereClause.buf;
             hasOptions = true;
         }
+        if ( !_spec.includeClause.empty() ) {
+            opts.include = (char*)_spec.includeClause.buf;
+            hasOptions   = true;
+        }
         return hasOptions;
     }
 
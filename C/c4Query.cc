@@ -80,8 +80,8 @@ void C4Query::setParameters(slice parameters) {
 
 #pragma mark - ENUMERATOR:
 
-Retained<QueryEnumerator> C4Query::_createEnumerator(slice encodedParameters) {
-    Query::Options options(encodedParameters ? encodedParameters : parameters());
+Retained<QueryEnumerator> C4Query::_createEnumerator(slice encodedParameters, bool streaming) {
+    Query::Options options(encodedParameters ? encodedParameters : parameters(), 0_seq, 0, streaming);
     return _query->createEnumerator(&options);
 }
 
@@ -91,13 +91,15 @@ Retained<C4QueryEnumeratorImpl> C4Query::wrapEnumerator(QueryEnumerator* e) {
 
 C4Query::Enumerator C4Query::run(slice params) { return Enumerator(this, params); }
 
-C4QueryEnumerator* C4Query::createEnumerator(slice encodedParameters) {
-    auto e = _createEnumerator(encodedParameters);
+C4Query::Enumerator C4Query::runStreaming(slice params) { return Enumerator(this, params, true); }
+
+C4QueryEnumerator* C4Query::createEnumerator(slice encodedParameters, bool streaming) {
+    auto e = _createEnumerator(encodedParameters, streaming);
     return wrapEnumerator(e).detach();
 }
 
-C4Query::Enumerator::Enumerator(C4Query* query, slice encodedParameters)
-    : _enum(query->_createEnumerator(encodedParameters)), _query(query->_query) {}
+C4Query::Enumerator::Enumerator(C4Query* query, slice encodedParameters, bool streaming)
+    : _enum(query->_createEnumerator(encodedParameters, streaming)), _query(query->_query) {}
 
 C4Query::Enumerator::Enumerator(Retained<litecore::QueryEnumerator> e) : _enum(std::move(e)) {}
 
@@ -289,6 +289,35 @@ CBL_CORE_API int c4_getObjectCount(void) C4API;
     the instrumentation it needs is suppressed for performance purposes.) */
 CBL_CORE_API void c4_dumpInstances(void) C4API;
 
+/** Returns runtime statistics of every live Actor -- the internal objects that run replicator
+    workers, BLIP connections, live queries, etc. -- to help find bottlenecks.
+    The result is a Fleece-encoded dictionary whose keys are actor names (with "#" and a unique
+    serial number appended, if several actors have the same name.) Each value is a dictionary:
+    - `enqueued`, `handled`: the number of events enqueued and handled so far
+    - `queueDepth`, `maxQueueDepth`: the current and maximum number of pending events
+    - `age`, `busy`: seconds since the actor was created, and seconds spent handling events
+    - `waitTime`, `runTime`: histograms of how long events waited in the queue, and how long they
+      took to handle. Each has keys `count`, `mean`, `p50`, `p90`, `p99`, `max` (in microseconds),
+      and `buckets`, an array of `[upper bound, count]` pairs.
+    - `batches`: only present if the actor processes items in batches, such as the replicator's
+      document inserter. It has keys `count` (batches processed), `items` (their total size), and the
+      current batching parameters `capacity` (maximum batch size) and `latency` (seconds to wait
+      for more items.)
+    \note This function is thread-safe. The caller is responsible for releasing the result. */
+CBL_CORE_API C4SliceResult c4_getActorStats(void) C4API;
+
+/** Starts or stops recording a trace of LiteCore's internal events -- transactions, commits,
+    queries, index updates, replication, BLIP messages, etc. -- for profiling.
+    Each thread keeps its most recent events in an in-memory ring buffer. While tracing is off,
+    the instrumentation has negligible overhead. */
+CBL_CORE_API void c4_setSignpostTracing(bool enabled) C4API;
+
+/** Returns the recorded trace in Chrome's trace-event JSON format, which can be opened in
+    Perfetto (ui.perfetto.dev) or chrome://tracing. This can be called while tracing.
+    @param clear  If true, the recorded events are discarded afterwards.
+    \note The caller is responsible for releasing the result. */
+CBL_CORE_API C4SliceResult c4_getSignpostTrace(bool clear) C4API;
+
 
 /** @} */
 
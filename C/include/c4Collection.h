@@ -207,6 +207,22 @@ NODISCARD CBL_CORE_API C4Document* C4NULLABLE c4coll_putDoc(C4Collection* collec
                                                             size_t* C4NULLABLE  outCommonAncestorIndex,
                                                             C4Error* C4NULLABLE outError) C4API;
 
+/** Performs multiple Put operations, in order. This is equivalent to calling \ref c4coll_putDoc
+    on each request, but faster, since the existing documents are read in a single query.
+    Each request succeeds or fails independently.
+    \note The caller must use a lock for Database when this function is called.
+    @param collection  The collection to put the documents in.
+    @param requests  An array of `count` put requests.
+    @param count  The number of requests.
+    @param outDocs  If non-NULL, an array of `count` document pointers that will be filled in with
+                    the resulting documents, or NULL for failed requests. You must call
+                    \ref c4doc_release on each non-NULL document.
+    @param outErrors  An array of `count` errors; the error of each failed request is stored here.
+    @return  The number of requests that succeeded, or 0 on a catastrophic error (in which case
+             `outErrors[0]` holds the error.) */
+CBL_CORE_API size_t c4coll_putDocs(C4Collection* collection, const C4DocPutRequest requests[], size_t count,
+                                   C4Document* C4NULLABLE outDocs[C4NULLABLE], C4Error outErrors[]) C4API;
+
 /** Convenience function to create a new document. This just a wrapper around \ref c4coll_putDoc.
     If the document already exists, it will fail with the error `kC4ErrorConflict`.
     \note The caller must use a lock for Database when this function is called.
@@ -281,6 +297,26 @@ CBL_CORE_API C4Timestamp c4coll_nextDocExpiration(C4Collection*) C4API;
 NODISCARD CBL_CORE_API int64_t c4coll_purgeExpiredDocs(C4Collection*, C4Error* C4NULLABLE) C4API;
 
 
+/** @} */
+/** \name Body Compression
+    @{ */
+
+
+/** Enables or disables compression of document bodies in this collection.
+    Revisions saved from now on will be stored compressed if their bodies are at least
+    `minBodySize` bytes long. The compression dictionary is trained from a sample of the
+    collection's existing documents, so this works best after the collection is populated;
+    calling it again retrains the dictionary. Existing documents are not rewritten.
+    Compression is transparent: compressed bodies are decompressed when read or queried.
+    \warning  Versions of LiteCore without this feature can't read compressed documents.
+    @param collection  The collection.
+    @param minBodySize  The minimum body size to compress, or 0 to disable compression.
+    @param outError  On failure, the error will be stored here.
+    @return  True on success, false on failure. */
+NODISCARD CBL_CORE_API bool c4coll_setBodyCompression(C4Collection* collection, size_t minBodySize,
+                                                      C4Error* C4NULLABLE outError) C4API;
+
+
 /** @} */
 /** @} */  // end Collections group
 
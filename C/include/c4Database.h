@@ -63,6 +63,22 @@ CBL_CORE_API void c4_setExtensionPath(C4String path) C4API;
  */
 CBL_CORE_API bool c4_enableExtension(C4String name, C4String extensionPath, C4Error* outError) C4API;
 
+/** Sets a process-wide soft limit on the memory that all open databases together use for
+    caching. When the limit is exceeded, connections recycle each other's least-recently-used
+    cached pages instead of growing their own caches. A value of 0 (the default) means no limit.
+    \note This function is thread-safe.
+    @param bytes  The budget in bytes, or 0 for no limit. */
+CBL_CORE_API void c4_setCacheBudget(uint64_t bytes) C4API;
+
+/** Sets the longest time that background housekeeping spends at once returning a database's
+    free space (left behind by deleted, purged and expired documents) to the filesystem. This
+    happens whenever a database has been idle for a couple of seconds, and continues in later idle
+    periods if it runs out of time. The default is 100ms; 0 disables it, leaving free space to be
+    reclaimed when the database is closed or compacted.
+    \note This function is thread-safe.
+    @param milliseconds  The budget in milliseconds, or 0 to disable. */
+CBL_CORE_API void c4_setVacuumBudget(uint32_t milliseconds) C4API;
+
 /** @} */
 
 //////// DATABASE API:
@@ -175,6 +191,15 @@ CBL_CORE_API C4ExtraInfo c4db_getExtraInfo(C4Database* database) C4API;
 NODISCARD CBL_CORE_API bool c4db_maintenance(C4Database* database, C4MaintenanceType type,
                                              C4Error* C4NULLABLE outError) C4API;
 
+/** Sets the size of this database connection's in-memory page cache. The default is 10MB.
+        Other connections to the same file, including ones from \ref c4db_openAgain, are unaffected.
+    \note The caller must use a lock for Database when this function is called.
+    @param database  The database connection.
+    @param bytes  The cache size in bytes, or 0 to restore the default.
+    @param outError  On failure, the error will be stored here.
+    @return  True on success, false on failure. */
+NODISCARD CBL_CORE_API bool c4db_setCacheSize(C4Database* database, size_t bytes, C4Error* C4NULLABLE outError) C4API;
+
 
 /** @} */
 /** \name Transactions
@@ -40,6 +40,12 @@ typedef C4_OPTIONS(uint32_t, C4DatabaseFlags){
         kC4DB_DiskSyncFull    = 0x80,    ///< Flush to disk after each transaction
         kC4DB_FakeVectorClock = 0x0100,  ///< Use counters instead of timestamps in version vectors (TESTS ONLY)
         kC4DB_NoHousekeeping  = 0x0200,  ///< Disable normal tasks like expiring docs and compaction
+        kC4DB_MMapReads       = 0x0400,  ///< Use memory-mapped reads, even if the platform default is off
+        kC4DB_NoMMapReads     = 0x0800,  ///< Don't use memory-mapped reads, even if the platform default is on
+        kC4DB_InMemory        = 0x1000,  ///< Keep the data in memory only; it's lost when the last connection
+                                         ///< closes. There's no WAL: connections use rollback-journal locking,
+                                         ///< so a (pooled) reader's transaction blocks commits until it ends,
+                                         ///< and DatabasePool snapshot groups aren't supported.
 };
 
 
@@ -57,6 +57,23 @@ NODISCARD CBL_CORE_API C4DocEnumerator* c4coll_enumerateAllDocs(C4Collection*
         \note The caller must use a lock for DocEnumerator when this function is called. */
 NODISCARD CBL_CORE_API bool c4enum_next(C4DocEnumerator* e, C4Error* C4NULLABLE outError) C4API;
 
+/** Advances the enumerator past up to `maxDocs` documents, storing lightweight views of them in
+        the `outDocs` array. This is much faster than calling \ref c4enum_next and
+        \ref c4enum_getDocument for each document, since it allocates no memory per document;
+        use it for full scans like indexing or exporting.
+        The views' data remains valid until the enumerator is advanced again, closed or freed.
+        The bodies are Fleece data, encoded with the database's shared keys.
+        Afterwards the enumerator has no current document.
+        \note The caller must use a lock for DocEnumerator when this function is called.
+        @param e  The enumerator.
+        @param outDocs  An array of at least `maxDocs` views, which will be filled in.
+        @param maxDocs  The maximum number of documents to return.
+        @param outError  Error will be stored here on failure.
+        @return  The number of documents stored in `outDocs`. Returns 0 at the end, or on error;
+                 look at the C4Error to determine which occurred. */
+NODISCARD CBL_CORE_API size_t c4enum_nextBatch(C4DocEnumerator* e, C4DocumentView outDocs[], size_t maxDocs,
+                                               C4Error* C4NULLABLE outError) C4API;
+
 /** Returns the current document, if any, from an enumerator.
         \note The caller must use a lock for DocEnumerator when this function is called.
         @param e  The enumerator.
@@ -59,6 +59,20 @@ typedef struct C4DocumentInfo {
     C4Timestamp      expiration;  ///< Expiration time, or 0 if none
 } C4DocumentInfo;
 
+/** A lightweight view of a document (actually of its current revision), as returned by
+    \ref c4enum_nextBatch. Its slices point to memory owned by the enumerator, which remains
+    valid only until the enumerator is advanced again or freed. */
+typedef struct C4DocumentView {
+    C4DocumentFlags  flags;       ///< Document flags
+    C4String         docID;       ///< Document ID
+    C4String         revID;       ///< RevID of current revision
+    C4SequenceNumber sequence;    ///< Sequence at which doc was last updated
+    C4Slice          body;        ///< Current revision body (Fleece, 2-byte aligned), or null if not included
+    uint64_t         bodySize;    ///< Size in bytes of current revision body (as Fleece not JSON)
+    uint64_t         metaSize;    ///< Size in bytes of extra metadata
+    C4Timestamp      expiration;  ///< Expiration time, or 0 if none
+} C4DocumentView;
+
 // NOLINTEND(cppcoreguidelines-pro-type-member-init)
 
 /** @} */
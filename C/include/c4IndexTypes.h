@@ -130,6 +130,12 @@ typedef struct C4IndexOptions {
 
     /** The where clause for partial indexes. Currently only Value and FullText indexes support partial index */
     const char* C4NULLABLE where;
+
+    /** Extra expressions whose values a value index stores along with the indexed ones, in the same
+        language as the index expression, e.g. "title, price". A query that uses the index and
+        returns only these values can read them from the index instead of from each document.
+        Only Value indexes support this. */
+    const char* C4NULLABLE include;
 } C4IndexOptions;
 
 /** @} */
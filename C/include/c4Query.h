@@ -38,6 +38,13 @@ NODISCARD CBL_CORE_API C4Query* C4NULLABLE c4query_new2(C4Database* database, C4
                                                         C4String expression, int* C4NULLABLE outErrorPos,
                                                         C4Error* C4NULLABLE error) C4API;
 
+/** Returns statistics of the database connection's cache of compiled queries. Queries are cached
+        by language, default collection and text (ignoring differences in whitespace), and the
+        cache is cleared whenever the database schema changes, as when an index is created or
+        deleted.
+        \note The caller must use a lock for Database when this function is called. */
+CBL_CORE_API C4QueryCacheStats c4db_getQueryCacheStats(C4Database* database) C4API;
+
 /** Returns a string describing the implementation of the compiled query.
         This is intended to be read by a developer for purposes of optimizing the query, especially
         to add database indexes.
@@ -84,6 +91,22 @@ CBL_CORE_API void c4query_setParameters(C4Query* query, C4String encodedParamete
 NODISCARD CBL_CORE_API C4QueryEnumerator* C4NULLABLE c4query_run(C4Query* query, C4String encodedParameters,
                                                                  C4Error* C4NULLABLE outError) C4API;
 
+/** Runs a compiled query, returning an enumerator that reads the rows from the database as it
+        goes, instead of collecting them all before returning. This uses much less memory, and
+        returns the first row sooner, when there are many results.
+        The enumerator can only go forward: \ref c4queryenum_getRowCount, \ref c4queryenum_seek
+        and \ref c4queryenum_refresh fail with kC4ErrorUnsupported. It keeps a read transaction
+        open until it reaches the last row or is closed, so don't keep it around.
+        \note The caller must use a lock for Database when this function is called, and when
+        calling \ref c4queryenum_next on the enumerator.
+        @param query  The compiled query to run.
+        @param encodedParameters  Options parameter values; if this parameter is not NULL,
+                        it overrides the parameters assigned by \ref c4query_setParameters.
+        @param outError  On failure, will be set to the error status.
+        @return  An enumerator for reading the rows, or NULL on error. */
+NODISCARD CBL_CORE_API C4QueryEnumerator* C4NULLABLE c4query_runStreaming(C4Query* query, C4String encodedParameters,
+                                                                          C4Error* C4NULLABLE outError) C4API;
+
 /** Given a C4FullTextMatch from the enumerator, returns the entire text of the property that
         was matched. (The result depends only on the term's `dataSource` and `property` fields,
         so if you get multiple matches of the same property in the same document, you can skip
@@ -45,6 +45,14 @@ typedef struct {
     uint32_t length;      ///< *Byte* range length of the match in the full text
 } C4FullTextMatch;
 
+/** Statistics of a database connection's cache of compiled queries. Creating a query that's in
+    the cache skips parsing it, translating it to SQL and preparing the SQL statement. */
+typedef struct {
+    uint64_t hits;     ///< Number of queries created from the cache
+    uint64_t misses;   ///< Number of queries that had to be compiled
+    uint32_t entries;  ///< Number of queries currently cached
+} C4QueryCacheStats;
+
 // Ignore warning about not initializing members, it must be this way to be C-compatible
 // NOLINTBEGIN(cppcoreguidelines-pro-type-member-init)
 /** A query result enumerator.
@@ -92,3 +92,41 @@ N_WAY_TEST_CASE_METHOD(C4AllDocsPerformanceTest, "AllDocsPerformance", "[Perf][.
     double elapsed = st.elapsedMS();
     C4Log("Enumerating %u docs took %.3f ms (%.3f ms/doc)", i, elapsed, elapsed / i);
 }
+
+N_WAY_TEST_CASE_METHOD(C4AllDocsPerformanceTest, "AllDocsPerformance Batched", "[Perf][.slow][C]") {
+    auto defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+    for ( C4EnumeratorFlags flags : {kC4IncludeNonConflicted, kC4IncludeNonConflicted | kC4IncludeBodies} ) {
+        C4EnumeratorOptions options = {flags};
+        const char*         mode    = (flags & kC4IncludeBodies) ? "with bodies" : "metadata only";
+
+        // One document at a time:
+        fleece::Stopwatch st;
+        C4Error           error;
+        auto              e = c4coll_enumerateAllDocs(defaultColl, &options, ERROR_INFO(error));
+        REQUIRE(e);
+        C4Document* doc;
+        unsigned    i = 0;
+        while ( nullptr != (doc = c4enum_nextDocument(e, ERROR_INFO(error))) ) {
+            i++;
+            c4doc_release(doc);
+        }
+        c4enum_free(e);
+        REQUIRE(i == kNumDocuments);
+        double singleElapsed = st.elapsedMS();
+
+        // In batches:
+        constexpr size_t kBatchSize = 256;
+        C4DocumentView   docs[kBatchSize];
+        st.reset();
+        e = c4coll_enumerateAllDocs(defaultColl, &options, ERROR_INFO(error));
+        REQUIRE(e);
+        i = 0;
+        while ( size_t n = c4enum_nextBatch(e, docs, kBatchSize, ERROR_INFO(error)) ) i += unsigned(n);
+        c4enum_free(e);
+        REQUIRE(i == kNumDocuments);
+        double batchElapsed = st.elapsedMS();
+
+        C4Log("Enumerating %u docs (%s): %.3f ms one at a time, %.3f ms in batches (%.1fx faster)", i, mode,
+              singleElapsed, batchElapsed, singleElapsed / batchElapsed);
+    }
+}
@@ -20,6 +20,7 @@
 #include "c4Index.h"
 #include "c4Query.h"
 #include "c4Collection.h"
+#include "DatabasePool.hh"
 #include "Error.hh"
 #include "FilePath.hh"
 #include "HybridClock.hh"
@@ -241,6 +242,64 @@ N_WAY_TEST_CASE_METHOD(C4DatabaseTest, "Test delete while database open", "[Data
     FLSliceResult_Release(message);
 }
 
+N_WAY_TEST_CASE_METHOD(C4DatabaseTest, "Database In Memory", "[Database][C]") {
+    auto config = *c4db_getConfig2(db);
+    config.flags |= kC4DB_InMemory;
+
+    static constexpr slice kTestBundleName = "cbl_core_test_in_memory";
+    C4Error                error;
+    if ( !c4db_deleteNamed(kTestBundleName, config.parentDirectory, &error) ) REQUIRE(error.code == 0);
+
+    if ( isEncrypted() ) {
+        ExpectingExceptions x;
+        CHECK(c4db_openNamed(kTestBundleName, &config, &error) == nullptr);
+        CHECK(error == C4Error{LiteCoreDomain, kC4ErrorUnsupportedEncryption});
+        return;
+    }
+
+    C4Database* memDB = c4db_openNamed(kTestBundleName, &config, ERROR_INFO());
+    REQUIRE(memDB);
+    createRev(memDB, "doc"_sl, kRevID, kFleeceBody);
+
+    // No database file is written; the bundle directory only exists for blobs:
+    alloc_slice bundlePath = c4db_getPath(memDB);
+    CHECK_FALSE(litecore::FilePath(bundlePath.asString(), "db.sqlite3").exists());
+
+    // Other connections to the same database share its contents:
+    C4Database* otherConnection = c4db_openAgain(memDB, ERROR_INFO());
+    REQUIRE(otherConnection);
+    C4Document* doc = c4coll_getDoc(c4db_getDefaultCollection(otherConnection, nullptr), "doc"_sl, true,
+                                    kDocGetCurrentRev, ERROR_INFO());
+    CHECK(doc);
+    c4doc_release(doc);
+    REQUIRE(c4db_close(otherConnection, WITH_ERROR()));
+    c4db_release(otherConnection);
+
+    // Pooled readers work, but without a WAL there are no snapshots to share:
+    {
+        auto pool = make_retained<litecore::DatabasePool>(kTestBundleName, config);
+        {
+            litecore::BorrowedDatabase reader = pool->borrow();
+            CHECK(c4coll_getDocumentCount(c4db_getDefaultCollection(reader, nullptr)) == 1);
+        }
+        ExpectingExceptions x;
+        try {
+            (void)pool->borrowSnapshotGroup(2);
+            FAIL("borrowSnapshotGroup should have failed");
+        } catch ( const litecore::error& e ) { CHECK(e.code == litecore::error::UnsupportedOperation); }
+        pool->close();
+    }
+
+    // Once the last connection closes, the contents are gone:
+    REQUIRE(c4db_close(memDB, WITH_ERROR()));
+    c4db_release(memDB);
+    memDB = c4db_openNamed(kTestBundleName, &config, ERROR_INFO());
+    REQUIRE(memDB);
+    CHECK(c4coll_getDocumentCount(c4db_getDefaultCollection(memDB, nullptr)) == 0);
+    REQUIRE(c4db_delete(memDB, WITH_ERROR()));
+    c4db_release(memDB);
+}
+
 N_WAY_TEST_CASE_METHOD(C4DatabaseTest, "Database OpenNamed Bad Path", "[Database][C][!throws]") {
     auto badOpen = [&](slice parentDirectory) {
         C4Error           error;
@@ -370,6 +429,53 @@ N_WAY_TEST_CASE_METHOD(C4DatabaseTest, "Database Enumerator", "[Database][Docume
     CHECK(i == 100);
 }
 
+N_WAY_TEST_CASE_METHOD(C4DatabaseTest, "Database Enumerator Batched", "[Database][Document][Enumerator][C]") {
+    setupAllDocs();
+    auto defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+
+    C4EnumeratorOptions options = kC4DefaultEnumeratorOptions;
+    bool                withBodies;
+    SECTION("With bodies") { withBodies = true; }
+    SECTION("Without bodies") {
+        withBodies = false;
+        options.flags &= ~kC4IncludeBodies;
+    }
+
+    C4Error          error;
+    C4DocEnumerator* e = REQUIRED(c4coll_enumerateAllDocs(defaultColl, &options, WITH_ERROR()));
+    C4DocumentView   docs[40];
+    constexpr size_t bufSize = 20;
+    char             docID[bufSize];
+    int              i = 1;
+    while ( size_t n = c4enum_nextBatch(e, docs, 40, &error) ) {
+        CHECK(n == (i < 81 ? 40 : 19));
+        for ( size_t d = 0; d < n; ++d, ++i ) {
+            snprintf(docID, bufSize, "doc-%03d", i);
+            CHECK(docs[d].docID == c4str(docID));
+            CHECK(docs[d].revID == kRevID);
+            CHECK(docs[d].flags == kDocExists);
+            CHECK(docs[d].sequence == (C4SequenceNumber)i);
+            CHECK(docs[d].bodySize == kFleeceBody.size);
+            if ( withBodies ) {
+                // The body is aligned in the enumerator's arena, so it can be parsed without copying:
+                CHECK((size_t(docs[d].body.buf) & 1) == 0);
+                Dict body     = FLValue_AsDict(FLValue_FromData(docs[d].body, kFLTrusted));
+                Dict expected = FLValue_AsDict(FLValue_FromData(kFleeceBody, kFLUntrusted));
+                REQUIRE(body);
+                CHECK(body.isEqual(expected));
+            } else {
+                CHECK(docs[d].body == kC4SliceNull);
+            }
+        }
+    }
+    CHECK(error == C4Error{});
+    CHECK(i == 100);
+
+    // There's no current document after a batch:
+    CHECK(c4enum_getDocument(e, ERROR_INFO()) == nullptr);
+    c4enum_free(e);
+}
+
 N_WAY_TEST_CASE_METHOD(C4DatabaseTest, "Database Enumerator with V3.0 Database",
                        "[Database][Document][Enumerator][C]") {
     closeDB();
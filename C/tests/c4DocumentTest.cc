@@ -588,6 +588,57 @@ N_WAY_TEST_CASE_METHOD(C4Test, "Document create from existing rev", "[Document][
     c4doc_release(doc);
 }
 
+N_WAY_TEST_CASE_METHOD(C4Test, "Document Put Multiple", "[Document][C]") {
+    TransactionHelper t(db);
+    auto              defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+    createRev("existing"_sl, kRevID, kFleeceBody);
+    C4String history[1] = {kRevID};
+
+    C4DocPutRequest rqs[5] = {};
+    for ( auto& rq : rqs ) {
+        rq.body = kFleeceBody;
+        rq.save = true;
+    }
+    // A new doc:
+    rqs[0].docID = "a"_sl;
+    // An update of an existing doc:
+    rqs[1].docID        = "existing"_sl;
+    rqs[1].history      = history;
+    rqs[1].historyCount = 1;
+    // Conflicts with the docs saved by the earlier requests:
+    rqs[2].docID = "existing"_sl;
+    rqs[3].docID = "a"_sl;
+    // A new doc with an existing revision:
+    rqs[4].docID            = "b"_sl;
+    rqs[4].existingRevision = true;
+    rqs[4].history          = history;
+    rqs[4].historyCount     = 1;
+
+    C4Document* docs[5];
+    C4Error     errors[5];
+    CHECK(c4coll_putDocs(defaultColl, rqs, 5, docs, errors) == 3);
+    for ( int i : {0, 1, 4} ) {
+        INFO("Request #" << i);
+        REQUIRE(docs[i]);
+        CHECK(docs[i]->docID == rqs[i].docID);
+        CHECK(errors[i] == kC4NoError);
+    }
+    CHECK(docs[1]->revID != kRevID);
+    CHECK(docs[4]->revID == kRevID);
+    for ( int i : {2, 3} ) {
+        INFO("Request #" << i);
+        CHECK(docs[i] == nullptr);
+        CHECK(errors[i] == C4Error{LiteCoreDomain, kC4ErrorConflict});
+    }
+    for ( auto doc : docs ) c4doc_release(doc);
+
+    CHECK(c4coll_getDocumentCount(defaultColl) == 3);
+    C4Document* existing = c4coll_getDoc(defaultColl, "existing"_sl, true, kDocGetCurrentRev, ERROR_INFO());
+    REQUIRE(existing);
+    CHECK(existing->revID != kRevID);
+    c4doc_release(existing);
+}
+
 N_WAY_TEST_CASE_METHOD(C4Test, "Document Update", "[Document][C]") {
     C4Log("Begin test");
     C4Error     error;
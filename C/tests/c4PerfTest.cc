@@ -15,6 +15,7 @@
 #include "c4Collection.h"
 #include "c4Query.h"
 #include "c4Index.h"
+#include "c4Observer.h"
 #include "c4Replicator.h"
 #include "Base.hh"
 #include "Benchmark.hh"
@@ -23,6 +24,7 @@
 #include "SG.hh"
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <thread>
@@ -32,6 +34,7 @@
 #include <condition_variable>
 #ifndef _MSC_VER
 #    include <unistd.h>
+#    include <sys/resource.h>
 #endif
 
 using namespace fleece;
@@ -345,6 +348,198 @@ N_WAY_TEST_CASE_METHOD(PerfTest, "Import names", "[Perf][C][.slow]") {
     }
 }
 
+// Returns the peak resident set size of this process in KB, or 0 if unknown.
+static long peakRSSKB() {
+#ifndef _MSC_VER
+    struct rusage usage {};
+    if ( getrusage(RUSAGE_SELF, &usage) == 0 ) {
+#    ifdef __APPLE__
+        return usage.ru_maxrss / 1024;  // (macOS reports bytes)
+#    else
+        return usage.ru_maxrss;
+#    endif
+    }
+#endif
+    return 0;
+}
+
+N_WAY_TEST_CASE_METHOD(PerfTest, "Query streaming", "[Perf][C][.slow]") {
+    // Download https://github.com/arangodb/example-datasets/raw/master/RandomUsers/names_300000.json
+    // to C/tests/data/ before running this test.
+    auto numDocs = importJSONLines(sFixturesDir + "names_300000.json", 30.0, false);
+    reopenDB();
+
+    C4Query* query = c4query_new2(db, kC4N1QLQuery,
+                                  "SELECT name, contact.address, likes FROM _ ORDER BY memberSince"_sl, nullptr,
+                                  ERROR_INFO());
+    REQUIRE(query);
+
+    // Streaming goes first, since the peak RSS can only grow; the recorded run then shows how far
+    // above that it has to go.
+    for ( bool streaming : {true, false} ) {
+        const char* modeName  = streaming ? "streaming" : "recorded";
+        long        rssBefore = peakRSSKB();
+        Stopwatch   st;
+        auto        e = streaming ? c4query_runStreaming(query, nullslice, ERROR_INFO())
+                                  : c4query_run(query, nullslice, ERROR_INFO());
+        REQUIRE(e);
+        REQUIRE(c4queryenum_next(e, ERROR_INFO()));
+        double   firstRowTime = st.elapsedMS();
+        unsigned n            = 1;
+        while ( c4queryenum_next(e, ERROR_INFO()) ) ++n;
+        st.stop();
+        c4queryenum_release(e);
+        CHECK(n == numDocs);
+
+        fprintf(stderr, "******** %s: first row in %.3fms; peak RSS grew by %ld KB\n", modeName, firstRowTime,
+                peakRSSKB() - rssBefore);
+        st.printReport((string("Query all rows ") + modeName).c_str(), n, "row");
+        string sf_title = string("query_first_row_usec_") + modeName;
+        writeShowFastToFile(sf_title, generateShowfast(round(firstRowTime * 1000.0), sf_title));
+    }
+    c4query_release(query);
+}
+
+// Returns the CPU time (user + system) used so far by all threads of this process, in seconds,
+// or 0 if unknown.
+static double processCPUTime() {
+#ifndef _MSC_VER
+    struct rusage usage {};
+    if ( getrusage(RUSAGE_SELF, &usage) == 0 ) {
+        return double(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+               + double(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+    }
+#endif
+    return 0;
+}
+
+N_WAY_TEST_CASE_METHOD(PerfTest, "Live queries under write load", "[Perf][C][.slow]") {
+    // Many live queries, each matching a small part of the collection, while small transactions
+    // keep changing a few random docs. Queries whose results depend only on single docs are
+    // updated by re-evaluating just the changed docs; a LIMIT forces them to re-run in full.
+    constexpr unsigned kNumDocs = 50000, kNumGroups = 100, kNumQueries = 20, kNumCommits = 500, kDocsPerCommit = 5;
+    auto               defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+
+    auto docIDFor = [](unsigned docNo) {
+        char docID[20];
+        snprintf(docID, sizeof(docID), "doc-%06u", docNo);
+        return string(docID);
+    };
+    auto bodyFor = [&](unsigned docNo, unsigned value) {
+        char json[100];
+        snprintf(json, sizeof(json), R"({"grp":%u,"value":%u})", docNo % kNumGroups, value);
+        return alloc_slice(c4db_encodeJSON(db, slice(json), ERROR_INFO()));
+    };
+
+    {
+        TransactionHelper t(db);
+        for ( unsigned docNo = 0; docNo < kNumDocs; ++docNo ) {
+            C4Document* doc = c4coll_createDoc(defaultColl, slice(docIDFor(docNo)), bodyFor(docNo, 0), 0, ERROR_INFO());
+            REQUIRE(doc);
+            c4doc_release(doc);
+        }
+    }
+
+    auto callback = [](C4QueryObserver*, C4Query*, void* context) { ++*(atomic<unsigned>*)context; };
+
+    for ( bool incremental : {true, false} ) {
+        const char*                      modeName = incremental ? "incremental" : "full";
+        atomic<unsigned>                 callbacks{0};
+        vector<c4::ref<C4Query>>         queries;
+        vector<c4::ref<C4QueryObserver>> observers;
+        for ( unsigned q = 0; q < kNumQueries; ++q ) {
+            string n1ql = "SELECT META().id, value FROM _ WHERE grp = " + to_string(q);
+            if ( !incremental ) n1ql += " LIMIT 1000000";
+            queries.emplace_back(c4query_new2(db, kC4N1QLQuery, slice(n1ql), nullptr, ERROR_INFO()));
+            REQUIRE(queries.back());
+            observers.emplace_back(c4queryobs_create(queries.back(), callback, &callbacks));
+            c4queryobs_setEnabled(observers.back(), true);
+        }
+        REQUIRE_BEFORE(30s, callbacks >= kNumQueries);
+
+        double    cpuBefore = processCPUTime();
+        Stopwatch st;
+        for ( unsigned i = 0; i < kNumCommits; ++i ) {
+            TransactionHelper t(db);
+            for ( unsigned j = 0; j < kDocsPerCommit; ++j ) {
+                unsigned    docNo = litecore::RandomNumber() % kNumDocs;
+                C4Document* doc   = c4coll_getDoc(defaultColl, slice(docIDFor(docNo)), true, kDocGetCurrentRev,
+                                                  ERROR_INFO());
+                REQUIRE(doc);
+                C4Document* updated = c4doc_update(doc, bodyFor(docNo, i + 1), 0, ERROR_INFO());
+                REQUIRE(updated);
+                c4doc_release(updated);
+                c4doc_release(doc);
+            }
+        }
+        // Give the live queries time to catch up with the last commits:
+        this_thread::sleep_for(2s);
+        st.stop();
+        double cpuTime = processCPUTime() - cpuBefore;
+
+        fprintf(stderr, "******** %s: %u commits with %u live queries took %.3f sec CPU, %u callbacks\n", modeName,
+                kNumCommits, kNumQueries, cpuTime, callbacks.load());
+        st.printReport((string("Live queries ") + modeName).c_str(), kNumCommits, "commit");
+        string sf_title = string("live_query_cpu_msec_") + modeName;
+        writeShowFastToFile(sf_title, generateShowfast(round(cpuTime * 1000.0), sf_title));
+        observers.clear();
+    }
+}
+
+N_WAY_TEST_CASE_METHOD(PerfTest, "Query compilation", "[Perf][C][.slow]") {
+    // Apps create the same few queries over and over; those come from the query cache. Giving every
+    // query a different literal defeats the cache, for comparison.
+    constexpr unsigned kNumQueries = 10000;
+    for ( bool cached : {true, false} ) {
+        const char*       modeName = cached ? "cached" : "uncached";
+        C4QueryCacheStats before   = c4db_getQueryCacheStats(db);
+        Stopwatch         st;
+        for ( unsigned i = 0; i < kNumQueries; ++i ) {
+            string n1ql = "SELECT META().id, name.first, name.last FROM _ WHERE contact.address.state = 'CA' "
+                          "AND gender = $gender ORDER BY name.last LIMIT "
+                          + to_string(cached ? 100 : i);
+            C4Query* query = c4query_new2(db, kC4N1QLQuery, slice(n1ql), nullptr, ERROR_INFO());
+            REQUIRE(query);
+            c4query_release(query);
+        }
+        st.stop();
+        C4QueryCacheStats after = c4db_getQueryCacheStats(db);
+        fprintf(stderr, "******** %s: %llu hits, %llu misses\n", modeName,
+                (unsigned long long)(after.hits - before.hits), (unsigned long long)(after.misses - before.misses));
+        st.printReport((string("Compiling query ") + modeName).c_str(), kNumQueries, "query");
+        string sf_title = string("query_compile_usec_") + modeName;
+        writeShowFastToFile(sf_title, generateShowfast(round(st.elapsedMS() * 1000.0 / kNumQueries), sf_title));
+    }
+}
+
+N_WAY_TEST_CASE_METHOD(PerfTest, "Multi-column query", "[Perf][C][.slow]") {
+    // Download https://github.com/arangodb/example-datasets/raw/master/RandomUsers/names_300000.json
+    // to C/tests/data/ before running this test.
+    //
+    // Every row reads six properties of its doc.
+    auto numDocs = importJSONLines(sFixturesDir + "names_300000.json", 30.0, false);
+    REQUIRE(numDocs > 0);
+    reopenDB();
+
+    C4Query* query = c4query_new2(db, kC4N1QLQuery,
+                                  "SELECT name.first, name.last, gender, birthday, contact.address.city FROM _ "
+                                  "WHERE contact.address.state != 'WA' ORDER BY memberSince"_sl,
+                                  nullptr, ERROR_INFO());
+    REQUIRE(query);
+    Stopwatch st;
+    auto      e = c4query_run(query, nullslice, ERROR_INFO());
+    REQUIRE(e);
+    unsigned n = 0;
+    while ( c4queryenum_next(e, ERROR_INFO()) ) ++n;
+    st.stop();
+    c4queryenum_release(e);
+    c4query_release(query);
+    CHECK(n > 0);
+
+    st.printReport("Multi-column query", n, "row");
+    writeShowFastToFile("query_multi_column", generateShowfast(round(double(n) / st.elapsed()), "query_multi_column"));
+}
+
 N_WAY_TEST_CASE_METHOD(PerfTest, "Import geoblocks", "[Perf][C][.slow]") {
     // Download https://github.com/arangodb/example-datasets/raw/master/IPRanges/geoblocks.json
     // to C/tests/data/ before running this test.
@@ -357,6 +552,211 @@ N_WAY_TEST_CASE_METHOD(PerfTest, "Import geoblocks", "[Perf][C][.slow]") {
     readRandomDocs(numDocs, 100000, "geoblocks_import_json");
 }
 
+N_WAY_TEST_CASE_METHOD(PerfTest, "Memory-mapped reads", "[Perf][C][.slow]") {
+    // Create a database much bigger than SQLite's page cache:
+    constexpr size_t kNumDocs = 200000;
+    createPaddedNumberedDocs(kNumDocs);
+
+    for ( C4DatabaseFlags mode : {kC4DB_NoMMapReads, kC4DB_MMapReads} ) {
+        const char* modeName = (mode == kC4DB_MMapReads) ? "mmap" : "no_mmap";
+        std::cerr << "******** With " << modeName << ":\n";
+        reopenDBNewFlags(~(kC4DB_MMapReads | kC4DB_NoMMapReads), mode);
+
+        readRandomDocs(kNumDocs, 100000, (string("read_random_docs_") + modeName).c_str());
+
+        Stopwatch st;
+        auto      n = queryWhere(R"(["=", [".state"], "WA"])");
+        st.stop();
+        st.printReport("SQL query of state", n, "doc");
+        CHECK(n == kNumDocs / 10);
+        string sf_title = string("sql_query_state_") + modeName;
+        writeShowFastToFile(sf_title, generateShowfast(round(double(n) / st.elapsed()), sf_title));
+    }
+}
+
+N_WAY_TEST_CASE_METHOD(PerfTest, "Body compression", "[Perf][C][.slow]") {
+    auto numDocs     = importJSONLines(sFixturesDir + "names_300000.json", 15.0, true);
+    auto defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+
+    // Compacts the database and reports its size, then the speed of reads and of a query:
+    auto measure = [&](const char* modeName) {
+        std::cerr << "******** With " << modeName << ":\n";
+        REQUIRE(c4db_maintenance(db, kC4Compact, WITH_ERROR()));
+        reopenDB();
+        defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+        litecore::FilePath path(alloc_slice(c4db_getPath(db)).asString(), "db.sqlite3");
+        fprintf(stderr, "******** DB size is %" PRIi64 "\n", path.dataSize());
+
+        readRandomDocs(numDocs, 100000, (string("names_read_random_docs_") + modeName).c_str());
+
+        Stopwatch st;
+        auto      n = queryWhere(R"(["=", [".contact.address.state"], "WA"])");
+        st.stop();
+        st.printReport("SQL query of state", n, "doc");
+        string sf_title = string("names_sql_query_state_") + modeName;
+        writeShowFastToFile(sf_title, generateShowfast(round(double(n) / st.elapsed()), sf_title));
+
+        // Reading several properties of each row; a compressed body is decompressed once per row:
+        C4Query* query = c4query_new2(db, kC4N1QLQuery,
+                                      "SELECT name.first, name.last, gender, contact.address.city FROM _ "
+                                      "WHERE contact.address.state != 'WA' ORDER BY memberSince"_sl,
+                                      nullptr, ERROR_INFO());
+        REQUIRE(query);
+        st.reset();
+        auto e = c4query_run(query, nullslice, ERROR_INFO());
+        REQUIRE(e);
+        unsigned rows = 0;
+        while ( c4queryenum_next(e, ERROR_INFO()) ) ++rows;
+        st.stop();
+        c4queryenum_release(e);
+        c4query_release(query);
+        CHECK(rows > 0);
+        st.printReport("Multi-column query", rows, "row");
+        sf_title = string("names_query_multi_column_") + modeName;
+        writeShowFastToFile(sf_title, generateShowfast(round(double(rows) / st.elapsed()), sf_title));
+        return n;
+    };
+
+    auto uncompressedResults = measure("uncompressed");
+
+    // Enable compression, then rewrite every doc so it's stored compressed:
+    REQUIRE(c4coll_setBodyCompression(defaultColl, 100, WITH_ERROR()));
+    {
+        TransactionHelper t(db);
+        for ( unsigned i = 1; i <= numDocs; ++i ) {
+            char docID[20];
+            snprintf(docID, sizeof(docID), "%07u", i);
+            C4Error     error;
+            C4Document* doc = c4coll_getDoc(defaultColl, c4str(docID), true, kDocGetCurrentRev, ERROR_INFO(error));
+            REQUIRE(doc);
+            C4Document* newDoc = c4doc_update(doc, c4doc_getRevisionBody(doc), 0, ERROR_INFO(error));
+            REQUIRE(newDoc);
+            c4doc_release(newDoc);
+            c4doc_release(doc);
+        }
+    }
+
+    CHECK(measure("compressed") == uncompressedResults);
+}
+
+N_WAY_TEST_CASE_METHOD(PerfTest, "Commit latency", "[Perf][C][.slow]") {
+    // Lots of small write transactions, as the replicator makes. With kC4DB_NoHousekeeping, SQLite
+    // checkpoints the WAL inside whichever commit crosses its threshold; otherwise the Housekeeper
+    // does it in the background, so there should be no slow outliers.
+    constexpr size_t kNumCommits = 5000, kDocsPerCommit = 20;
+    const string     json = R"({"padding":")" + string(1000, '*') + R"("})";
+    alloc_slice      body = c4db_encodeJSON(db, slice(json), ERROR_INFO());
+    REQUIRE(body);
+
+    for ( C4DatabaseFlags mode : {kC4DB_NoHousekeeping, C4DatabaseFlags(0)} ) {
+        const char* modeName = mode ? "auto_checkpoint" : "background_checkpoint";
+        reopenDBNewFlags(~kC4DB_NoHousekeeping, mode);
+        auto defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+
+        vector<double> commitTimes;
+        commitTimes.reserve(kNumCommits);
+        for ( size_t i = 0; i < kNumCommits; ++i ) {
+            REQUIRE(c4db_beginTransaction(db, WITH_ERROR()));
+            for ( size_t j = 0; j < kDocsPerCommit; ++j ) {
+                char docID[40];
+                snprintf(docID, sizeof(docID), "%s-%05zu-%02zu", modeName, i, j);
+                C4DocPutRequest rq = {};
+                rq.docID           = slice(docID);
+                rq.body            = body;
+                rq.save            = true;
+                C4Document* doc    = c4coll_putDoc(defaultColl, &rq, nullptr, ERROR_INFO());
+                REQUIRE(doc);
+                c4doc_release(doc);
+            }
+            Stopwatch st;
+            REQUIRE(c4db_endTransaction(db, true, WITH_ERROR()));
+            commitTimes.push_back(st.elapsed() * 1000.0);
+        }
+
+        std::sort(commitTimes.begin(), commitTimes.end());
+        double p50 = commitTimes[kNumCommits / 2], p99 = commitTimes[kNumCommits * 99 / 100];
+        fprintf(stderr, "******** %s: commit p50 %.3fms, p99 %.3fms, max %.3fms\n", modeName, p50, p99,
+                commitTimes.back());
+        string sf_title = string("commit_p99_usec_") + modeName;
+        writeShowFastToFile(sf_title, generateShowfast(round(p99 * 1000.0), sf_title));
+    }
+}
+
+N_WAY_TEST_CASE_METHOD(PerfTest, "CRUD in memory", "[Perf][C][.slow]") {
+    // Small transactions creating, reading, updating and purging docs. With kC4DB_InMemory there's no
+    // file I/O or fsync, so this shows the overhead of the storage layer itself.
+    if ( isEncrypted() ) return;  // in-memory databases can't be encrypted
+    constexpr unsigned kNumDocs = 20000, kDocsPerCommit = 10;
+    const string       json = R"({"padding":")" + string(200, '*') + R"("})";
+    alloc_slice        body = c4db_encodeJSON(db, slice(json), ERROR_INFO());
+    REQUIRE(body);
+
+    for ( C4DatabaseFlags mode : {C4DatabaseFlags(0), kC4DB_InMemory} ) {
+        const char* modeName = mode ? "in_memory" : "on_disk";
+        reopenDBNewFlags(~kC4DB_InMemory, mode);
+        auto defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+        char docID[20];
+
+        Stopwatch st;
+        for ( unsigned i = 0; i < kNumDocs; i += kDocsPerCommit ) {
+            TransactionHelper t(db);
+            for ( unsigned j = i; j < i + kDocsPerCommit; ++j ) {
+                snprintf(docID, sizeof(docID), "%07u", j);
+                C4DocPutRequest rq = {};
+                rq.docID           = slice(docID);
+                rq.body            = body;
+                rq.save            = true;
+                C4Document* doc    = c4coll_putDoc(defaultColl, &rq, nullptr, ERROR_INFO());
+                REQUIRE(doc);
+                c4doc_release(doc);
+            }
+        }
+        st.stop();
+        st.printReport((string("Create docs ") + modeName).c_str(), kNumDocs, "doc");
+        string sf_title = string("crud_create_docs_") + modeName;
+        writeShowFastToFile(sf_title, generateShowfast(round(double(kNumDocs) / st.elapsed()), sf_title));
+
+        st.reset();
+        for ( unsigned i = 0; i < kNumDocs; ++i ) {
+            snprintf(docID, sizeof(docID), "%07u", i);
+            C4Document* doc = c4coll_getDoc(defaultColl, c4str(docID), true, kDocGetCurrentRev, ERROR_INFO());
+            REQUIRE(doc);
+            c4doc_release(doc);
+        }
+        st.stop();
+        st.printReport((string("Read docs ") + modeName).c_str(), kNumDocs, "doc");
+
+        st.reset();
+        for ( unsigned i = 0; i < kNumDocs; i += kDocsPerCommit ) {
+            TransactionHelper t(db);
+            for ( unsigned j = i; j < i + kDocsPerCommit; ++j ) {
+                snprintf(docID, sizeof(docID), "%07u", j);
+                C4Document* doc = c4coll_getDoc(defaultColl, c4str(docID), true, kDocGetCurrentRev, ERROR_INFO());
+                REQUIRE(doc);
+                C4Document* newDoc = c4doc_update(doc, body, 0, ERROR_INFO());
+                REQUIRE(newDoc);
+                c4doc_release(newDoc);
+                c4doc_release(doc);
+            }
+        }
+        st.stop();
+        st.printReport((string("Update docs ") + modeName).c_str(), kNumDocs, "doc");
+
+        st.reset();
+        for ( unsigned i = 0; i < kNumDocs; i += kDocsPerCommit ) {
+            TransactionHelper t(db);
+            for ( unsigned j = i; j < i + kDocsPerCommit; ++j ) {
+                snprintf(docID, sizeof(docID), "%07u", j);
+                REQUIRE(c4coll_purgeDoc(defaultColl, c4str(docID), WITH_ERROR()));
+            }
+        }
+        st.stop();
+        st.printReport((string("Purge docs ") + modeName).c_str(), kNumDocs, "doc");
+        CHECK(c4coll_getDocumentCount(defaultColl) == 0);
+    }
+    reopenDBNewFlags(~kC4DB_InMemory, 0);
+}
+
 N_WAY_TEST_CASE_METHOD(PerfTest, "Import Wikipedia", "[Perf][C][.slow]") {
     // Download https://github.com/diegoceccarelli/json-wikipedia/blob/master/src/test/resources/misc/en-wikipedia-articles-1000-1.json.gz
     // and unzip to C/tests/data/ before running this test.
@@ -368,6 +768,50 @@ N_WAY_TEST_CASE_METHOD(PerfTest, "Import Wikipedia", "[Perf][C][.slow]") {
     readRandomDocs(numDocs, 100000);
 }
 
+N_WAY_TEST_CASE_METHOD(PerfTest, "Covering index", "[Perf][C][.slow]") {
+    // Download https://github.com/diegoceccarelli/json-wikipedia/blob/master/src/test/resources/misc/en-wikipedia-articles-1000-1.json.gz
+    // and unzip to C/tests/data/ before running this test.
+    //
+    // A list of a few small properties of large docs. With a plain index on `type` every row reads
+    // and decodes a doc body; a covering index stores the listed properties, so no body is read.
+    constexpr unsigned kNumRuns = 20;
+    auto               numDocs  = importJSONLines(sFixturesDir + "en-wikipedia-articles-1000-1.json", 15.0, false);
+    REQUIRE(numDocs > 0);
+    auto defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+
+    for ( bool covering : {false, true} ) {
+        const char*    modeName = covering ? "covering" : "plain";
+        C4IndexOptions options{};
+        if ( covering ) options.include = "title, wid, timestamp";
+        REQUIRE(c4coll_createIndex(defaultColl, C4STR("byType"), C4STR("type"), kC4N1QLQuery, kC4ValueIndex,
+                                   &options, ERROR_INFO()));
+        reopenDB();
+
+        C4Query* query = c4query_new2(db, kC4N1QLQuery,
+                                      "SELECT title, wid, timestamp FROM _ WHERE type = 'ARTICLE' ORDER BY title"_sl,
+                                      nullptr, ERROR_INFO());
+        REQUIRE(query);
+        alloc_slice explanation = c4query_explain(query);
+        fprintf(stderr, "******** %s: %.*s\n", modeName, FMTSLICE(explanation));
+
+        unsigned  n = 0;
+        Stopwatch st;
+        for ( unsigned run = 0; run < kNumRuns; ++run ) {
+            auto e = c4query_run(query, nullslice, ERROR_INFO());
+            REQUIRE(e);
+            while ( c4queryenum_next(e, ERROR_INFO()) ) ++n;
+            c4queryenum_release(e);
+        }
+        st.stop();
+        c4query_release(query);
+        CHECK(n > 0);
+
+        st.printReport((string("Wikipedia list query, ") + modeName + " index").c_str(), n, "row");
+        string sf_title = string("query_list_") + modeName + "_index";
+        writeShowFastToFile(sf_title, generateShowfast(round(double(n) / st.elapsed()), sf_title));
+    }
+}
+
 #ifdef LITECORE_PERF_TESTING_MODE
 // This test will be automated soon, and switched to [Perf]
 N_WAY_TEST_CASE_METHOD(PerfTest, "Push and pull names data", "[PerfManual][C][.slow]") {
@@ -372,6 +372,68 @@ static bool lookForIndex(C4Database* db, slice name) {
     return found;
 }
 
+N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query covering value index", "[Query][C]") {
+    C4Error err;
+    auto    defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+    bool    useJSON     = GENERATE(false, true);
+
+    const char* n1ql = "SELECT META().id, name.first, gender FROM _ WHERE contact.address.state = 'CA' "
+                       "ORDER BY META().id";
+    compileSelect(n1ql, kC4N1QLQuery);
+    auto expected = run2(nullptr, 3);
+    REQUIRE(expected.size() == 8);
+
+    // The index stores the doc ID, first name and gender along with the state, so the query can
+    // be answered from the index alone:
+    C4IndexOptions options{};
+    if ( useJSON ) {
+        options.include = R"([["._id"], [".name.first"], [".gender"]])";
+        REQUIRE(c4coll_createIndex(defaultColl, C4STR("byState"), C4STR(R"([[".contact.address.state"]])"),
+                                   kC4JSONQuery, kC4ValueIndex, &options, WITH_ERROR(&err)));
+    } else {
+        options.include = "META().id, name.first, gender";
+        REQUIRE(c4coll_createIndex(defaultColl, C4STR("byState"), C4STR("contact.address.state"), kC4N1QLQuery,
+                                   kC4ValueIndex, &options, WITH_ERROR(&err)));
+    }
+    compileSelect(n1ql, kC4N1QLQuery);
+    checkExplanation(true);
+    alloc_slice explanation = c4query_explain(query);
+    CHECK(explanation.find("COVERING INDEX byState"_sl));
+    CHECK(run2(nullptr, 3) == expected);
+
+    {
+        // Check we can get the include clause back via c4index_getOptions
+        auto           index = REQUIRED(c4coll_getIndex(defaultColl, C4STR("byState"), nullptr));
+        C4IndexOptions outOptions;
+        REQUIRE(c4index_getOptions(index, &outOptions));
+        CHECK(string(outOptions.include) == options.include);
+        c4index_release(index);
+    }
+
+    // An update is visible through the index:
+    {
+        TransactionHelper t(db);
+        c4::ref           doc = c4coll_getDoc(defaultColl, "0000001"_sl, true, kDocGetCurrentRev, ERROR_INFO());
+        REQUIRE(doc);
+        doc = c4doc_update(doc, json2fleece("{name:{first:'Zed'},gender:'male',contact:{address:{state:'CA'}}}"), 0,
+                           ERROR_INFO());
+        REQUIRE(doc);
+    }
+    compileSelect(n1ql, kC4N1QLQuery);
+    auto results = run2(nullptr, 3);
+    REQUIRE(!results.empty());
+    CHECK(results[0] == "0000001, Zed, male");
+
+    // Only value indexes can include expressions:
+    {
+        ExpectingExceptions x;
+        options.include = useJSON ? R"([[".gender"]])" : "gender";
+        CHECK(!c4coll_createIndex(defaultColl, C4STR("byStreet"), C4STR("contact.address.street"), kC4N1QLQuery,
+                                  kC4FullTextIndex, &options, &err));
+        CHECK(err.code == kC4ErrorInvalidParameter);
+    }
+}
+
 N_WAY_TEST_CASE_METHOD(C4QueryTest, "Reindex", "[Query][C]") {
     C4Error err;
     auto    defaultColl = getCollection(db, kC4DefaultCollectionSpec);
@@ -487,6 +549,64 @@ N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query dict literal", "[Query][C]") {
     CHECK(results[0] == "{d:1234.5,f:false,i:12345,id:\"0000001\",n:null,s:\"howdy\",t:true}");
 }
 
+N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query cache", "[Query][C]") {
+    C4QueryCacheStats stats0 = c4db_getQueryCacheStats(db);
+
+    compileSelect("SELECT META().id FROM _ WHERE contact.address.state = 'CA'", kC4N1QLQuery);
+    auto expected = run();
+    CHECK(expected.size() == 8);
+    C4QueryCacheStats stats = c4db_getQueryCacheStats(db);
+    CHECK(stats.misses == stats0.misses + 1);
+    CHECK(stats.hits == stats0.hits);
+
+    // Whitespace outside of quotes doesn't matter:
+    compileSelect("  SELECT META().id\n  FROM _\n  WHERE contact.address.state = 'CA'  ", kC4N1QLQuery);
+    CHECK(run() == expected);
+    stats = c4db_getQueryCacheStats(db);
+    CHECK(stats.misses == stats0.misses + 1);
+    CHECK(stats.hits == stats0.hits + 1);
+    CHECK(c4query_columnCount(query) == 1);
+    CHECK(c4query_columnTitle(query, 0) == "id"_sl);
+
+    // ...but inside quotes it does:
+    compileSelect("SELECT META().id FROM _ WHERE contact.address.state = 'CA '", kC4N1QLQuery);
+    CHECK(run().empty());
+    stats = c4db_getQueryCacheStats(db);
+    CHECK(stats.misses == stats0.misses + 2);
+
+    // N1QL has no backslash escapes, so `'\'` is a complete literal and the next one is quoted too:
+    compileSelect(R"(SELECT '\' AS a, 'x  y' AS b FROM _ WHERE META().id = '0000001')", kC4N1QLQuery);
+    CHECK(run2(nullptr, 2) == vector<string>{"\\, x  y"});
+    compileSelect(R"(SELECT '\' AS a, 'x y' AS b FROM _ WHERE META().id = '0000001')", kC4N1QLQuery);
+    CHECK(run2(nullptr, 2) == vector<string>{"\\, x y"});
+    stats = c4db_getQueryCacheStats(db);
+    CHECK(stats.misses == stats0.misses + 4);
+
+    // A query that failed to compile isn't cached. Once the index it needs exists, it compiles:
+    const char* ftsQuery = "SELECT META().id FROM _ WHERE MATCH(byStreet, 'Hwy')";
+    {
+        ExpectingExceptions x;
+        C4Error             error;
+        CHECK(c4query_new2(db, kC4N1QLQuery, c4str(ftsQuery), nullptr, &error) == nullptr);
+        CHECK(error == C4Error{LiteCoreDomain, kC4ErrorNoSuchIndex});
+    }
+    auto defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+    REQUIRE(c4coll_createIndex(defaultColl, C4STR("byStreet"), C4STR("contact.address.street"), kC4N1QLQuery,
+                               kC4FullTextIndex, nullptr, WITH_ERROR()));
+    // Changing the schema empties the cache:
+    compileSelect(ftsQuery, kC4N1QLQuery);
+    CHECK(run().size() == 5);
+    stats = c4db_getQueryCacheStats(db);
+    CHECK(stats.entries == 1);
+
+    // Deleting the index does too, so the query can't be compiled from a stale translation:
+    REQUIRE(c4coll_deleteIndex(defaultColl, C4STR("byStreet"), WITH_ERROR()));
+    {
+        ExpectingExceptions x;
+        CHECK(c4query_new2(db, kC4N1QLQuery, c4str(ftsQuery), nullptr, nullptr) == nullptr);
+    }
+}
+
 #pragma mark - FTS:
 
 N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query FTS", "[Query][C][FTS]") {
@@ -807,6 +927,63 @@ N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query WHAT", "[Query][C]") {
     c4queryenum_release(e);
 }
 
+N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query streaming", "[Query][C]") {
+    compileSelect(json5("{WHAT: ['.name.first', '.XX', '.name.last'], \
+                         WHERE: ['=', ['.contact.address.state'], ['$STATE']],\
+                      ORDER_BY: [['.name.first']]}"));
+    const char* bindings = R"({"STATE": "CA"})";
+
+    auto collect = [&](C4QueryEnumerator* e) {
+        vector<string> rows;
+        C4Error        error;
+        while ( c4queryenum_next(e, ERROR_INFO(error)) ) {
+            CHECK(e->missingColumns == 0x2);
+            rows.push_back(Array::iterator(e->columns)[0].asstring() + " "
+                           + Array::iterator(e->columns)[2].asstring());
+        }
+        CHECK(error.code == 0);
+        return rows;
+    };
+
+    C4Error error;
+    auto    recorded = c4query_run(query, c4str(bindings), ERROR_INFO(error));
+    REQUIRE(recorded);
+    vector<string> expected = collect(recorded);
+    CHECK(expected.size() == 8);
+    c4queryenum_release(recorded);
+
+    // Two streaming enumerators of the same query, interleaved, each get all the rows:
+    auto e1 = c4query_runStreaming(query, c4str(bindings), ERROR_INFO(error));
+    REQUIRE(e1);
+    REQUIRE(c4queryenum_next(e1, ERROR_INFO(error)));
+    auto e2 = c4query_runStreaming(query, c4str(bindings), ERROR_INFO(error));
+    REQUIRE(e2);
+    CHECK(collect(e2) == expected);
+    vector<string> rows = collect(e1);
+    rows.insert(rows.begin(), expected[0]);
+    CHECK(rows == expected);
+
+    // A streaming enumerator can't count, seek or refresh:
+    {
+        ExpectingExceptions x;
+        CHECK(c4queryenum_getRowCount(e1, &error) == -1);
+        CHECK(error == C4Error{LiteCoreDomain, kC4ErrorUnsupported});
+        CHECK(!c4queryenum_seek(e1, 0, &error));
+        CHECK(error == C4Error{LiteCoreDomain, kC4ErrorUnsupported});
+        CHECK(c4queryenum_refresh(e1, &error) == nullptr);
+        CHECK(error == C4Error{LiteCoreDomain, kC4ErrorUnsupported});
+    }
+    c4queryenum_release(e1);
+    c4queryenum_release(e2);
+
+    // Closing a streaming enumerator before the end:
+    e1 = c4query_runStreaming(query, c4str(bindings), ERROR_INFO(error));
+    REQUIRE(e1);
+    REQUIRE(c4queryenum_next(e1, ERROR_INFO(error)));
+    c4queryenum_close(e1);
+    c4queryenum_release(e1);
+}
+
 N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query WHAT returning object", "[Query][C]") {
     vector<string> expectedFirst = {"Cleveland", "Georgetta", "Margaretta"};
     vector<string> expectedLast  = {"Bejcek", "Kolding", "Ogwynn"};
@@ -1289,6 +1466,74 @@ N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query refresh", "[Query][C][!throws]") {
     c4queryenum_release(refreshed);
 }
 
+N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query compressed bodies", "[Query][C]") {
+    compileSelect("SELECT META().id FROM _", kC4N1QLQuery);
+    vector<string> docIDs = run();
+    REQUIRE(docIDs.size() == 100);
+
+    // Each row reads several properties of its doc, and a self-join reads two docs per row:
+    const struct {
+        const char* sql;
+        unsigned    columns;
+    } queries[] = {
+            {"SELECT META().id, name.first, contact.address.city, gender FROM _ WHERE contact.address.state = 'CA'"
+             " ORDER BY name.last",
+             4},
+            {"SELECT META(a).id, META(b).id FROM _ AS a JOIN _ AS b"
+             " ON a.contact.address.state = b.contact.address.state AND a.gender = b.gender"
+             " WHERE META(a).id < META(b).id ORDER BY META(a).id, META(b).id",
+             2},
+    };
+    vector<vector<string>> expected;
+    for ( auto& q : queries ) {
+        compileSelect(q.sql, kC4N1QLQuery);
+        expected.push_back(run2(nullptr, q.columns));
+        CHECK(!expected.back().empty());
+    }
+
+    // Rewrite every doc so its body is stored compressed:
+    auto defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+    REQUIRE(c4coll_setBodyCompression(defaultColl, 100, WITH_ERROR()));
+    {
+        TransactionHelper t(db);
+        for ( const string& docID : docIDs ) {
+            c4::ref doc = c4coll_getDoc(defaultColl, slice(docID), true, kDocGetCurrentRev, ERROR_INFO());
+            REQUIRE(doc);
+            c4::ref newDoc = c4doc_update(doc, c4doc_getRevisionBody(doc), 0, ERROR_INFO());
+            REQUIRE(newDoc);
+        }
+    }
+
+    for ( size_t i = 0; i < std::size(queries); ++i ) {
+        INFO("Query: " << queries[i].sql);
+        compileSelect(queries[i].sql, kC4N1QLQuery);
+        CHECK(run2(nullptr, queries[i].columns) == expected[i]);
+    }
+}
+
+N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query refresh read-only", "[Query][C]") {
+    // A read-only connection can't create the by-sequence index that incremental updates use,
+    // so refreshing has to fall back to re-running the query:
+    c4::ref<C4Database> writer = c4db_openAgain(db, ERROR_INFO());
+    REQUIRE(writer);
+    reopenDBReadOnly();
+    compile(json5("['=', ['.', 'contact', 'address', 'state'], 'CA']"));
+
+    C4Error error;
+    auto    e = c4query_run(query, kC4SliceNull, ERROR_INFO(error));
+    REQUIRE(e);
+    int64_t count = c4queryenum_getRowCount(e, ERROR_INFO(error));
+    CHECK(count == 8);
+
+    createFleeceRev(writer, "added_later"_sl, kRevID, R"({"contact":{"address":{"state":"CA"}}})"_sl);
+
+    auto refreshed = c4queryenum_refresh(e, ERROR_INFO(error));
+    REQUIRE(refreshed);
+    CHECK(c4queryenum_getRowCount(refreshed, ERROR_INFO(error)) == count + 1);
+    c4queryenum_release(refreshed);
+    c4queryenum_release(e);
+}
+
 N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query observer", "[Query][C][!throws]") {
     compile(json5("['=', ['.', 'contact', 'address', 'state'], 'CA']"));
     C4Error error;
@@ -1510,6 +1755,102 @@ N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query observer after delete and purge", "
     }
 }
 
+N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query observer incremental updates", "[Query][C][!throws]") {
+    // This query's results can be updated by re-evaluating only the changed docs:
+    compileSelect("SELECT META().id FROM _ WHERE contact.address.state='CA'", kC4N1QLQuery);
+
+    QueryState state;
+    state.query = query;
+    state.obs   = c4queryobs_create(query, QueryState::callback, &state);
+    CHECK(state.obs);
+    c4queryobs_setEnabled(state.obs, true);
+
+    C4Log("---- Waiting for query observer...");
+    REQUIRE_BEFORE(2000ms, state.count > 0);
+    CHECK(state.count == 1);
+    vector<string> expected = state.queryResult();
+    CHECK(expected.size() == 8);
+
+    auto defaultColl = getCollection(db, kC4DefaultCollectionSpec);
+    auto setState    = [&](slice docID, const char* newState) {
+        TransactionHelper t(db);
+        c4::ref           doc = c4coll_getDoc(defaultColl, docID, true, kDocGetCurrentRev, ERROR_INFO());
+        REQUIRE(doc);
+        string json = "{contact:{address:{state:'"s + newState + "'}},updated:true}";
+        doc         = c4doc_update(doc, json2fleece(json.c_str()), 0, ERROR_INFO());
+        REQUIRE(doc);
+    };
+
+    auto checkResult = [&] {
+        vector<string> result = state.queryResult();
+        // Rows of changed docs may not be in the same order as a full run would return them:
+        std::ranges::sort(result);
+        std::ranges::sort(expected);
+        CHECK(result == expected);
+    };
+
+    C4Log("---- Adding a doc that doesn't match");
+    state.count = 0;
+    addPersonInState("incr1", "AL");
+    this_thread::sleep_for(1000ms);
+    CHECK(state.count == 0);
+
+    // Count the Query log's messages saying that results were updated incrementally:
+    static atomic<int> sIncrementalUpdates;
+    sIncrementalUpdates = 0;
+    C4LogLevel          queryLevel = c4log_getLevel(kC4QueryLog);
+    C4DomainLevel       observedLevel{kC4QueryLog, kC4LogVerbose};
+    C4LogObserverConfig logConfig{kC4LogNone, &observedLevel, 1,
+                                  [](const C4LogEntry* entry, void*) {
+                                      if ( slice(entry->message).find("Updated results incrementally"_sl) )
+                                          ++sIncrementalUpdates;
+                                  },
+                                  nullptr};
+    C4LogObserver*      logObserver = c4log_newObserver(logConfig, ERROR_INFO());
+    REQUIRE(logObserver);
+    c4log_setLevel(kC4QueryLog, kC4LogVerbose);
+
+    C4Log("---- Adding a doc that matches");
+    addPersonInState("incr2", "CA");
+    REQUIRE_BEFORE(2000ms, state.count > 0);
+    CHECK(state.count == 1);
+    expected.emplace_back("incr2");
+    checkResult();
+
+    C4Log("---- Changing a doc so it no longer matches");
+    state.count = 0;
+    setState(expected[0], "NY");
+    REQUIRE_BEFORE(2000ms, state.count > 0);
+    CHECK(state.count == 1);
+    expected.erase(expected.begin());
+    checkResult();
+    // Both changes were applied to the previous results, not by re-running the query:
+    CHECK(sIncrementalUpdates >= 2);
+    c4log_setLevel(kC4QueryLog, queryLevel);
+    c4log_removeObserver(logObserver);
+    c4logobserver_release(logObserver);
+
+    C4Log("---- Deleting a doc that matches");
+    state.count = 0;
+    {
+        TransactionHelper   t(db);
+        c4::ref<C4Document> doc = c4coll_getDoc(defaultColl, "incr2"_sl, true, kDocGetMetadata, ERROR_INFO());
+        REQUIRE(doc);
+        c4::ref<C4Document> updated = c4doc_update(doc, kC4SliceNull, kRevDeleted, ERROR_INFO());
+        REQUIRE(updated);
+    }
+    REQUIRE_BEFORE(2000ms, state.count > 0);
+    CHECK(state.count == 1);
+    expected.erase(std::ranges::find(expected, "incr2"));
+    checkResult();
+
+    C4Log("---- Changing a matching doc without changing the results");
+    state.count = 0;
+    setState(expected[0], "CA");
+    this_thread::sleep_for(1000ms);
+    CHECK(state.count == 0);
+}
+
 N_WAY_TEST_CASE_METHOD(C4QueryTest, "C4Query observe deleted after delete and purge", "[Query][C][!throws]") {
     compileSelect("SELECT META().id FROM _ WHERE contact.address.state='CA' OR META().deleted", kC4N1QLQuery);
 
@@ -490,6 +490,44 @@ void C4Test::createNumberedDocs(unsigned numberOfDocs) const {
     }
 }
 
+void C4Test::createPaddedNumberedDocs(size_t numberOfDocs, size_t paddingSize) const {
+    constexpr size_t            kBatchSize = 1000;
+    TransactionHelper           t(db);
+    C4Collection*               coll = c4db_getDefaultCollection(db, ERROR_INFO());
+    fleece::Encoder             enc(c4db_createFleeceEncoder(db));
+    const string                padding(paddingSize, '*');
+    vector<string>              docIDs;
+    vector<fleece::alloc_slice> bodies;
+    for ( size_t i = 1; i <= numberOfDocs; ++i ) {
+        char docID[20];
+        snprintf(docID, sizeof(docID), "%07zu", i);
+        docIDs.emplace_back(docID);
+        enc.beginDict();
+        enc.writeKey("n");
+        enc.writeUInt(i);
+        enc.writeKey("state");
+        enc.writeString((i % 10 == 0) ? "WA" : "CA");
+        enc.writeKey("padding");
+        enc.writeString(padding);
+        enc.endDict();
+        bodies.push_back(enc.finish());
+        enc.reset();
+
+        if ( docIDs.size() == kBatchSize || i == numberOfDocs ) {
+            vector<C4DocPutRequest> requests(docIDs.size());
+            for ( size_t j = 0; j < docIDs.size(); ++j ) {
+                requests[j].docID = slice(docIDs[j]);
+                requests[j].body  = bodies[j];
+                requests[j].save  = true;
+            }
+            vector<C4Error> errors(requests.size());
+            Require(c4coll_putDocs(coll, requests.data(), requests.size(), nullptr, errors.data()) == requests.size());
+            docIDs.clear();
+            bodies.clear();
+        }
+    }
+}
+
 string C4Test::listSharedKeys(const string& delimiter) const {
     stringstream result;
     auto         sk = c4db_getFLSharedKeys(db);
@@ -672,6 +710,28 @@ unsigned C4Test::importJSONLines(const string& path, C4Collection* collection, d
     bool     completed;
     {
         TransactionHelper t(database);
+
+        // Documents are saved in batches of 1000:
+        vector<string>              docIDs;
+        vector<fleece::alloc_slice> bodies;
+
+        auto saveDocs = [&] {
+            vector<C4DocPutRequest> requests(docIDs.size());
+            for ( size_t i = 0; i < docIDs.size(); ++i ) {
+                requests[i].docID       = slice(docIDs[i]);
+                requests[i].allocedBody = {(void*)bodies[i].buf, bodies[i].size};
+                requests[i].save        = true;
+            }
+            vector<C4Error> errors(requests.size());
+            size_t          n = c4coll_putDocs(collection, requests.data(), requests.size(), nullptr, errors.data());
+            for ( C4Error& error : errors ) {
+                if ( error.code ) C4Warn("Failed to save doc: %s", error.description().c_str());
+            }
+            Require(n == requests.size());
+            docIDs.clear();
+            bodies.clear();
+        };
+
         completed = readFileByLines(
                 path,
                 [&](FLSlice line) {
@@ -682,24 +742,22 @@ unsigned C4Test::importJSONLines(const string& path, C4Collection* collection, d
                     char             docID[bufSize];
                     snprintf(docID, bufSize, "%s%07u", idPrefix.c_str(), unsigned(docCount + 1));
 
-                    // Save document:
-                    C4DocPutRequest rq = {};
-                    rq.docID           = c4str(docID);
-                    rq.allocedBody     = {(void*)body.buf, body.size};
-                    rq.save            = true;
-                    C4Document* doc    = c4coll_putDoc(collection, &rq, nullptr, ERROR_INFO());
-                    Require(doc != nullptr);
-                    c4doc_release(doc);
+                    docIDs.emplace_back(docID);
+                    bodies.push_back(std::move(body));
                     ++numDocs;
                     ++docCount;
-                    if ( numDocs % 1000 == 0 && timeout > 0.0 && st.elapsed() >= timeout ) {
-                        C4Warn("Stopping JSON import after %.3f sec  ", st.elapsed());
-                        return false;
+                    if ( numDocs % 1000 == 0 ) {
+                        saveDocs();
+                        if ( timeout > 0.0 && st.elapsed() >= timeout ) {
+                            C4Warn("Stopping JSON import after %.3f sec  ", st.elapsed());
+                            return false;
+                        }
                     }
                     if ( verbose && numDocs % 100000 == 0 ) C4Log("%u  ", numDocs);
                     return true;
                 },
                 maxLines);
+        saveDocs();
         C4Log("Committing...");
     }
     if ( verbose ) st.printReport("Importing", numDocs, "doc");
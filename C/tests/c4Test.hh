@@ -293,6 +293,11 @@ class C4Test {
 
     void createNumberedDocs(unsigned numberOfDocs) const;
 
+    // Creates docs "0000001", "0000002", ... in the default collection, in batches of 1000, for
+    // tests that need a database much bigger than SQLite's page cache. Each body is
+    // `{"n": <its number>, "state": <"WA" for every 10th doc, else "CA">, "padding": <'*'s>}`.
+    void createPaddedNumberedDocs(size_t numberOfDocs, size_t paddingSize = 500) const;
+
     std::vector<C4BlobKey>        addDocWithAttachments(C4Slice docID, const std::vector<std::string>& attachments,
                                                         const char*               contentType,
                                                         std::vector<std::string>* legacyNames = nullptr,
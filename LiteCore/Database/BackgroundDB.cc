@@ -46,9 +46,11 @@ namespace litecore {
     }
 
     void BackgroundDB::externalTransactionCommitted(const SequenceTracker& sourceTracker) {
-        notifyTransactionObservers();
+        notifyTransactionObservers(&TransactionObserver::transactionCommitted);
     }
 
+    void BackgroundDB::externalCommit() { notifyTransactionObservers(&TransactionObserver::anyTransactionCommitted); }
+
     void BackgroundDB::useInTransaction(slice keyStoreName, TransactionTask task) {
         _dataFile.useLocked([this, keyStoreName, task](DataFile* dataFile) {
             if ( !dataFile ) return;
@@ -77,7 +79,8 @@ namespace litecore {
             t.notifyCommitted(sequenceTracker);
             sequenceTracker.endTransaction(true);
             // Notify my own observers:
-            notifyTransactionObservers();
+            notifyTransactionObservers(&TransactionObserver::transactionCommitted);
+            notifyTransactionObservers(&TransactionObserver::anyTransactionCommitted);
         });
     }
 
@@ -92,9 +95,9 @@ namespace litecore {
         if ( i != _transactionObservers.end() ) _transactionObservers.erase(i);
     }
 
-    void BackgroundDB::notifyTransactionObservers() {
+    void BackgroundDB::notifyTransactionObservers(void (TransactionObserver::*callback)()) {
         LOCK(_transactionObserversMutex);
-        for ( auto obs : _transactionObservers ) obs->transactionCommitted();
+        for ( auto obs : _transactionObservers ) (obs->*callback)();
     }
 
 }  // namespace litecore
@@ -36,10 +36,15 @@ namespace litecore {
         class TransactionObserver {
           public:
             virtual ~TransactionObserver() = default;
-            /// This method is called on some random thread, and while a BackgroundDB lock is held.
+            /// These methods are called on some random thread, and while a BackgroundDB lock is held.
             /// The implementation must not do anything that might acquire a mutex,
             /// nor call back into BackgroundDB.
-            virtual void transactionCommitted() = 0;
+
+            /// Called after a commit that changed documents in a collection.
+            virtual void transactionCommitted() {}
+
+            /// Called after every commit, including ones that only changed raw or local documents.
+            virtual void anyTransactionCommitted() {}
         };
 
         void addTransactionObserver(TransactionObserver* NONNULL);
@@ -49,7 +54,8 @@ namespace litecore {
         [[nodiscard]] string databaseName() const override;
         alloc_slice          blobAccessor(const fleece::impl::Dict*) const override;
         void                 externalTransactionCommitted(const SequenceTracker& sourceTracker) override;
-        void                 notifyTransactionObservers();
+        void                 externalCommit() override;
+        void                 notifyTransactionObservers(void (TransactionObserver::*callback)());
 
         DatabaseImpl*                     _database;
         access_lock<DataFile*>            _dataFile;
@@ -31,6 +31,7 @@
 #include "Logging.hh"
 #include "StringUtil.hh"
 #include "betterassert.hh"
+#include <unordered_set>
 
 namespace litecore {
 
@@ -54,7 +55,7 @@ namespace litecore {
 
         ~CollectionImpl() override { destructExtraInfo(_extraInfo); }
 
-        enum class HousekeeperTask : short { Expiry, Migrate };
+        enum class HousekeeperTask : short { Expiry, Migrate, Checkpoint, Vacuum };
 
         void close() {
             logVerbose("Closing");
@@ -238,6 +239,73 @@ namespace litecore {
         Retained<C4Document> putDocument(const C4DocPutRequest& rq, size_t* outCommonAncestorIndex,
                                          C4Error* outError) override {
             dbImpl()->mustBeInTransaction();
+            checkPutRequest(rq);
+
+            int                  commonAncestorIndex = 0;
+            Retained<C4Document> doc;
+            if ( rq.save && isNewDocPutRequest(rq) ) {
+                // As an optimization, write the doc assuming there is no prior record in the db:
+                std::tie(doc, commonAncestorIndex) = putNewDoc(rq);
+                // If there's already a record, doc will be null, so we'll continue down regular path.
+            }
+            if ( !doc ) {
+                alloc_slice docID = (rq.docID.buf) ? alloc_slice(rq.docID) : C4Document::createDocID();
+                doc = putIntoDocument(getDocument(docID, false, kDocGetAll), rq, commonAncestorIndex, outError);
+            }
+
+            Assert(commonAncestorIndex >= 0, "Unexpected conflict in c4doc_put");
+            if ( outCommonAncestorIndex ) *outCommonAncestorIndex = commonAncestorIndex;
+            return doc;
+        }
+
+        std::vector<Retained<C4Document>> putDocuments(const C4DocPutRequest* requests, size_t count,
+                                                       size_t* outCommonAncestorIndexes, C4Error* outErrors) override {
+            dbImpl()->mustBeInTransaction();
+
+            // Read the existing records of all the docs with one query. A docID that occurs more
+            // than once is only looked up for its first request; the later ones will have to see
+            // the doc as saved by the earlier one(s), so they go through `putDocument`.
+            std::vector<slice>        docIDs;
+            std::vector<ssize_t>      recordIndexes(count, -1);  // maps request index -> index in docIDs
+            std::unordered_set<slice> seenDocIDs;
+            for ( size_t i = 0; i < count; ++i ) {
+                if ( slice docID = requests[i].docID; docID.buf && seenDocIDs.insert(docID).second ) {
+                    recordIndexes[i] = ssize_t(docIDs.size());
+                    docIDs.push_back(docID);
+                }
+            }
+            std::vector<Record> records = keyStore().getMany(docIDs, kEntireBody);
+
+            std::vector<Retained<C4Document>> docs(count);
+            for ( size_t i = 0; i < count; ++i ) {
+                const C4DocPutRequest& rq                  = requests[i];
+                int                    commonAncestorIndex = 0;
+                outErrors[i]                               = {};
+                try {
+                    if ( recordIndexes[i] < 0 ) {
+                        size_t index;
+                        docs[i]             = putDocument(rq, &index, &outErrors[i]);
+                        commonAncestorIndex = int(index);
+                    } else {
+                        checkPutRequest(rq);
+                        Record& record = records[recordIndexes[i]];
+                        if ( !record.exists() && rq.save && isNewDocPutRequest(rq) )
+                            std::tie(docs[i], commonAncestorIndex) = putNewDoc(rq);
+                        if ( !docs[i] )
+                            docs[i] = putIntoDocument(newDocumentInstance(record), rq, commonAncestorIndex,
+                                                      &outErrors[i]);
+                    }
+                } catch ( ... ) {
+                    outErrors[i] = C4Error::fromCurrentException();
+                    docs[i]      = nullptr;
+                }
+                if ( outCommonAncestorIndexes ) outCommonAncestorIndexes[i] = commonAncestorIndex;
+            }
+            return docs;
+        }
+
+        // Validates a PutRequest's parameters, throwing an exception if they're invalid.
+        static void checkPutRequest(const C4DocPutRequest& rq) {
             if ( rq.docID.buf && !C4Document::isValidDocID(rq.docID) ) error::_throw(error::BadDocID);
             if ( rq.existingRevision || rq.historyCount > 0 ) AssertParam(rq.docID.buf, "Missing docID");
             if ( rq.existingRevision ) {
@@ -248,45 +316,34 @@ namespace litecore {
                             "Can't create a new already-deleted document");
                 AssertParam(rq.remoteDBID == 0, "remoteDBID cannot be used when existingRevision=false");
             }
+        }
 
-            int                  commonAncestorIndex = 0;
-            Retained<C4Document> doc;
-            if ( rq.save && isNewDocPutRequest(rq) ) {
-                // As an optimization, write the doc assuming there is no prior record in the db:
-                std::tie(doc, commonAncestorIndex) = putNewDoc(rq);
-                // If there's already a record, doc will be null, so we'll continue down regular path.
-            }
-            if ( !doc ) {
-                if ( rq.existingRevision ) {
-                    // Insert existing revision:
-                    doc = getDocument(rq.docID, false, kDocGetAll);
-                    C4Error err;
-                    commonAncestorIndex = doc->putExistingRevision(rq, &err);
-                    if ( commonAncestorIndex < 0 ) {
-                        throwIfUnexpected(err, outError);
-                        doc                 = nullptr;
-                        commonAncestorIndex = 0;
-                    }
-                } else {
-                    // Create new revision:
-                    alloc_slice docID = (rq.docID.buf) ? alloc_slice(rq.docID) : C4Document::createDocID();
-
-                    slice parentRevID;
-                    if ( rq.historyCount > 0 ) parentRevID = rq.history[0];
-
-                    doc = getDocument(docID, false, kDocGetAll);
-                    C4Error err;
-                    if ( !doc->checkNewRev(parentRevID, rq.revFlags, rq.allowConflict, &err)
-                         || !doc->putNewRevision(rq, &err) ) {
-                        throwIfUnexpected(err, outError);
-                        doc = nullptr;
-                    }
+        // Adds the PutRequest's revision to `doc`, the document's current state in the database.
+        // Returns `doc`, or null on failure.
+        static Retained<C4Document> putIntoDocument(Retained<C4Document> doc, const C4DocPutRequest& rq,
+                                                    int& commonAncestorIndex, C4Error* outError) {
+            if ( rq.existingRevision ) {
+                // Insert existing revision:
+                C4Error err;
+                commonAncestorIndex = doc->putExistingRevision(rq, &err);
+                if ( commonAncestorIndex < 0 ) {
+                    throwIfUnexpected(err, outError);
+                    doc                 = nullptr;
                     commonAncestorIndex = 0;
                 }
+            } else {
+                // Create new revision:
+                slice parentRevID;
+                if ( rq.historyCount > 0 ) parentRevID = rq.history[0];
+
+                C4Error err;
+                if ( !doc->checkNewRev(parentRevID, rq.revFlags, rq.allowConflict, &err)
+                     || !doc->putNewRevision(rq, &err) ) {
+                    throwIfUnexpected(err, outError);
+                    doc = nullptr;
+                }
+                commonAncestorIndex = 0;
             }
-
-            Assert(commonAncestorIndex >= 0, "Unexpected conflict in c4doc_put");
-            if ( outCommonAncestorIndex ) *outCommonAncestorIndex = commonAncestorIndex;
             return doc;
         }
 
@@ -396,12 +453,20 @@ namespace litecore {
             } else if ( task == HousekeeperTask::Migrate && !_migrateStarted ) {
                 _housekeeper->startMigration();
                 _migrateStarted = true;
+            } else if ( task == HousekeeperTask::Checkpoint && !_checkpointStarted ) {
+                _housekeeper->startCheckpointing();
+                _checkpointStarted = true;
+            } else if ( task == HousekeeperTask::Vacuum && !_vacuumStarted ) {
+                _housekeeper->startVacuuming();
+                _vacuumStarted = true;
             }
         }
 
         bool stopHousekeeping() {
-            _expiryStarted  = false;
-            _migrateStarted = false;
+            _expiryStarted     = false;
+            _migrateStarted    = false;
+            _checkpointStarted = false;
+            _vacuumStarted     = false;
             if ( _housekeeper ) {
                 _housekeeper->stop();
                 _housekeeper = nullptr;
@@ -410,6 +475,14 @@ namespace litecore {
                 return false;
         }
 
+#pragma mark - BODY COMPRESSION:
+
+        void setBodyCompression(size_t minBodySize) override {
+            C4Database::Transaction t(getDatabase());
+            keyStore().setBodyCompression(minBodySize, dbImpl()->transaction());
+            t.commit();
+        }
+
 #pragma mark - INDEXES:
 
         bool createIndex(slice indexName, slice indexSpec, C4QueryLanguage indexLanguage, C4IndexType indexType,
@@ -502,11 +575,15 @@ namespace litecore {
                 if ( indexOptions->where && !IndexSpec::canPartialIndex((IndexSpec::Type)indexType) )
                     error::_throw(error::InvalidParameter, "%s index does support partial index.",
                                   indexTypeNames[indexType]);
+                if ( indexOptions->include && indexType != kC4ValueIndex )
+                    error::_throw(error::InvalidParameter, "%s index does not support included expressions.",
+                                  indexTypeNames[indexType]);
             }
 
-            return keyStore().createIndex({indexName.asString(), (IndexSpec::Type)indexType, indexSpec,
-                                           slice{indexOptions ? indexOptions->where : nullptr},
-                                           (QueryLanguage)indexLanguage, options});
+            IndexSpec spec{indexName.asString(), (IndexSpec::Type)indexType, indexSpec,
+                           slice{indexOptions ? indexOptions->where : nullptr}, (QueryLanguage)indexLanguage, options};
+            if ( indexOptions ) spec.setIncludeClause(slice{indexOptions->include});
+            return keyStore().createIndex(spec);
         }
 
         Retained<C4Index> getIndex(slice name) override { return C4Index::getIndex(this, name); }
@@ -538,6 +615,10 @@ namespace litecore {
                         FLEncoder_WriteKey(enc, "vector_options"_sl);
                         FLEncoder_WriteString(enc, slice(vecOpts->createArgs()));
                     }
+                    if ( !spec.includeClause.empty() ) {
+                        FLEncoder_WriteKey(enc, "include"_sl);
+                        FLEncoder_WriteString(enc, spec.includeClause);
+                    }
                     FLEncoder_EndDict(enc);
                 } else {
                     FLEncoder_WriteString(enc, slice(spec.name));
@@ -577,6 +658,8 @@ namespace litecore {
         Retained<Housekeeper>                    _housekeeper;      // for expiration/cleanup tasks
         bool                                     _expiryStarted{false};
         bool                                     _migrateStarted{false};
+        bool                                     _checkpointStarted{false};
+        bool                                     _vacuumStarted{false};
     };
 
     inline CollectionImpl* asInternal(C4Collection* coll) { return (CollectionImpl*)coll; }
@@ -67,7 +67,7 @@ namespace litecore {
 
     // `path` is path to bundle; return value is path to db file. Updates config.storageEngine. */
     /*static*/ FilePath DatabaseImpl::findOrCreateBundle(const string& path, bool canCreate,
-                                                         C4StorageEngine& storageEngine) {
+                                                         C4StorageEngine& storageEngine, bool inMemory) {
         FilePath bundle(path, "");
         bool     createdDir = (canCreate && bundle.mkdir());
         if ( !createdDir ) bundle.mustExistAsDir();
@@ -78,8 +78,9 @@ namespace litecore {
         // Look for the file corresponding to the requested storage engine (defaulting to SQLite):
 
         FilePath dbPath = bundle["db"].withExtension(factory->filenameExtension());
-        if ( createdDir || factory->fileExists(dbPath) ) {
-            // Db exists in expected format, or else we just created this blank bundle dir, so exit:
+        if ( createdDir || inMemory || factory->fileExists(dbPath) ) {
+            // Db exists in expected format, or else we just created this blank bundle dir, so exit.
+            // (An in-memory db has no file; its bundle only holds its blobs.)
             if ( storageEngine == nullptr ) storageEngine = factory->cname();
             return dbPath;
         }
@@ -126,8 +127,9 @@ namespace litecore {
                 }
         };
 
+        bool     inMemory     = (_config.flags & kC4DB_InMemory) != 0;
         FilePath dataFilePath = findOrCreateBundle(std::string(bundlePath), (_configV1.flags & kC4DB_Create) != 0,
-                                                   _configV1.storageEngine);
+                                                   _configV1.storageEngine, inMemory);
         // Set up DataFile options:
         DataFile::Options options{};
         options.keyStores.sequences = true;
@@ -136,9 +138,14 @@ namespace litecore {
         options.upgradeable         = (_config.flags & kC4DB_NoUpgrade) == 0;
         options.diskSyncFull        = (_config.flags & kC4DB_DiskSyncFull) != 0;
         options.noHousekeeping      = (_config.flags & kC4DB_NoHousekeeping) != 0;
+        options.inMemory            = inMemory;
+        if ( _config.flags & kC4DB_MMapReads ) options.mmapReads = DataFile::MMapMode::On;
+        else if ( _config.flags & kC4DB_NoMMapReads )
+            options.mmapReads = DataFile::MMapMode::Off;
         options.useDocumentKeys     = true;
         options.encryptionAlgorithm = (EncryptionAlgorithm)_config.encryptionKey.algorithm;
         if ( options.encryptionAlgorithm != kNoEncryption ) {
+            if ( inMemory ) error::_throw(error::UnsupportedEncryption, "An in-memory database can't be encrypted");
 #ifdef COUCHBASE_ENTERPRISE
             options.encryptionKey =
                     alloc_slice(_config.encryptionKey.bytes, kEncryptionKeySize[options.encryptionAlgorithm]);
@@ -330,6 +337,13 @@ namespace litecore {
         if ( what == kC4Compact ) garbageCollectBlobs();
     }
 
+    void DatabaseImpl::setCacheSize(size_t bytes) { dataFile()->setCacheSize(bytes); }
+
+    C4QueryCacheStats DatabaseImpl::getQueryCacheStats() const {
+        auto stats = dataFile()->queryCacheStats();
+        return {stats.hits, stats.misses, uint32_t(stats.entries)};
+    }
+
     void DatabaseImpl::garbageCollectBlobs() {
         // Lock the database to avoid any other thread creating a new blob, since if it did
         // I might end up deleting it during the sweep phase (deleteAllExcept).
@@ -366,6 +380,13 @@ namespace litecore {
         }
         for ( auto& coll : collections ) asInternal(coll)->stopHousekeeping();
 
+        // Without the Housekeeper, commits have to checkpoint the WAL again:
+        _backgroundCheckpointing = false;
+        if ( _autoCheckpointDisabled && _dataFile->isOpen() ) {
+            _dataFile->setAutoCheckpoint(true);
+            _autoCheckpointDisabled = false;
+        }
+
         if ( _backgroundDB ) _backgroundDB->close();
     }
 
@@ -387,6 +408,15 @@ namespace litecore {
             asInternal(_defaultCollection)->startHousekeeping(CollectionImpl::HousekeeperTask::Migrate);
         }
 
+        // Checkpoint the WAL in the background, instead of in whichever commit crosses SQLite's
+        // auto-checkpoint threshold. (Auto-checkpoint stays on until the Housekeeper has actually
+        // started; see `setBackgroundCheckpointing`.)
+        asInternal(_defaultCollection)->startHousekeeping(CollectionImpl::HousekeeperTask::Checkpoint);
+
+        // Return free pages to the filesystem a few at a time whenever the database is idle,
+        // instead of all at once when it's closed:
+        asInternal(_defaultCollection)->startHousekeeping(CollectionImpl::HousekeeperTask::Vacuum);
+
         for ( const string& name : _dataFile->allKeyStoreNames() ) {
             if ( CollectionSpec collSpec = keyStoreNameToCollectionSpec(name); collSpec.name ) {
                 if ( _dataFile->getKeyStore(name).nextExpiration() > C4Timestamp::None ) {
@@ -664,6 +694,13 @@ namespace litecore {
         // ++transactionLevel later
         checkOpen();
 
+        // Let the commit checkpoint the WAL itself, unless the Housekeeper is doing it:
+        if ( bool background = _backgroundCheckpointing;
+             _transactionLevel == 0 && background != _autoCheckpointDisabled ) {
+            _dataFile->setAutoCheckpoint(!background);
+            _autoCheckpointDisabled = background;
+        }
+
         if ( ++_transactionLevel == 1 ) {
             _transaction = new ExclusiveTransaction(_dataFile.get());
             forAllOpenCollections([&](C4Collection* coll) { asInternal(coll)->transactionBegan(); });
@@ -21,6 +21,7 @@
 #include "SourceID.hh"
 #include "fleece/function_ref.hh"
 #include "fleece/slice.hh"
+#include <atomic>
 #include <mutex>
 #include <unordered_map>
 
@@ -65,6 +66,11 @@ namespace litecore {
 
         BackgroundDB* backgroundDatabase();
 
+        /// Called by the Housekeeper, on its own thread, when it starts or stops checkpointing the
+        /// WAL after commits. SQLite's auto-checkpoint is turned off while it does, starting with
+        /// the next transaction.
+        void setBackgroundCheckpointing(bool active) noexcept { _backgroundCheckpointing = active; }
+
         fleece::impl::Encoder& sharedEncoder() const;
 
         HybridClock& versionClock() const { return _versionClock; }
@@ -102,6 +108,7 @@ namespace litecore {
 
         void          rekey(const C4EncryptionKey* C4NULLABLE newKey) override;
         void          maintenance(C4MaintenanceType) override;
+        void          setCacheSize(size_t bytes) override;
         void          forEachScope(const ScopeCallback&) const override;
         void          forEachCollection(const CollectionSpecCallback&) const override;
         bool          hasCollection(CollectionSpec) const override;
@@ -125,6 +132,8 @@ namespace litecore {
 
         alloc_slice rawQuery(slice query) override { return dataFile()->rawQuery(query.asString()); }
 
+        C4QueryCacheStats getQueryCacheStats() const override;
+
         void lockClientMutex() noexcept override { _clientMutex.lock(); }
 
         void unlockClientMutex() noexcept override { _clientMutex.unlock(); }
@@ -153,7 +162,8 @@ namespace litecore {
 
         void            open(const FilePath& path);
         void            initCollections();
-        static FilePath findOrCreateBundle(const string& path, bool canCreate, const char* C4NONNULL& outStorageEngine);
+        static FilePath findOrCreateBundle(const string& path, bool canCreate, const char* C4NONNULL& outStorageEngine,
+                                           bool inMemory = false);
         void            _cleanupTransaction(bool committed);
         bool            getUUIDIfExists(slice key, C4UUID&) const;
         C4UUID          generateUUID(slice key, bool overwrite = false);
@@ -192,6 +202,8 @@ namespace litecore {
         std::recursive_mutex                      _clientMutex;           // Mutex for c4db_lock/unlock
         unique_ptr<BackgroundDB>                  _backgroundDB;          // for background operations
         std::once_flag                            _initBDBFlag;
+        std::atomic<bool>                         _backgroundCheckpointing{false};  // Housekeeper checkpoints
+        bool                                      _autoCheckpointDisabled{false};   // Auto-checkpoint is off
         mutable SourceID                          _mySourceID;    // My identifier in version vectors
         mutable HybridClock                       _versionClock;  // Version-vector clock
     };
@@ -19,13 +19,14 @@
 #include "Logging.hh"
 #include "SQLiteKeyStore.hh"
 #include "StringUtil.hh"
+#include <atomic>
 
 namespace litecore {
     using namespace actor;
     using namespace std;
 
     Housekeeper::Housekeeper(C4Collection* coll)
-        : Actor(DBLog, stringprintf("Housekeeper for %s", asInternal(coll)->fullName().c_str()))
+        : Actor(DBLog, stringprintf("Housekeeper for %s", asInternal(coll)->fullName().c_str()), Priority::background)
         , _keyStoreName(asInternal(coll)->keyStore().name())
         , _expiryTimer(std::make_unique<actor::Timer>(std::bind(&Housekeeper::doExpirationAsync, this)))
         , _collection(coll) {}
@@ -40,6 +41,16 @@ namespace litecore {
         enqueue(FUNCTION_TO_QUEUE(Housekeeper::_doMigration));
     }
 
+    void Housekeeper::startCheckpointing() {
+        logInfo("Housekeeper: started checkpointing.");
+        enqueue(FUNCTION_TO_QUEUE(Housekeeper::_startCheckpointing));
+    }
+
+    void Housekeeper::startVacuuming() {
+        logInfo("Housekeeper: started vacuuming.");
+        enqueue(FUNCTION_TO_QUEUE(Housekeeper::_startVacuuming));
+    }
+
     void Housekeeper::stop() {
         enqueue(FUNCTION_TO_QUEUE(Housekeeper::_stop));
         waitTillCaughtUp();
@@ -50,7 +61,14 @@ namespace litecore {
     }
 
     void Housekeeper::_stop() {
-        _expiryTimer = nullptr;
+        if ( _observingCommits ) {
+            _bgdb->removeTransactionObserver(this);
+            _observingCommits = false;
+        }
+        if ( _checkpointTimer ) _database->setBackgroundCheckpointing(false);
+        _checkpointTimer = nullptr;
+        _vacuumTimer     = nullptr;
+        _expiryTimer     = nullptr;
         logVerbose("Housekeeper: stopped.");
     }
 
@@ -192,9 +210,90 @@ namespace litecore {
         logInfo("Migrate deleted docs. Next rowid to start from %" PRId64 " down.", nextMaxRowid);
     }
 
+    // How long after a commit the WAL is checkpointed. During sustained writes, this is also
+    // the interval between checkpoints.
+    static constexpr chrono::milliseconds kCheckpointDelay{250};
+
+    // How long the database has to go without a commit before it's vacuumed. If a vacuum runs out
+    // of budget, it continues after the same interval, if nothing's been committed since.
+    static constexpr chrono::milliseconds kVacuumIdleDelay{2000};
+
+    static atomic<chrono::milliseconds::rep> sVacuumBudgetMS{100};
+
+    chrono::milliseconds Housekeeper::setVacuumBudget(chrono::milliseconds budget) {
+        return chrono::milliseconds(sVacuumBudgetMS.exchange(budget.count()));
+    }
+
+    // Starts observing commits, if not already. Returns false if the background db isn't available.
+    bool Housekeeper::_observeCommits() {
+        if ( !initBackgroundDB() ) return false;
+        if ( !_observingCommits ) {
+            _bgdb->addTransactionObserver(this);
+            _observingCommits = true;
+        }
+        return true;
+    }
+
+    void Housekeeper::_startCheckpointing() {
+        if ( _isStopped() || _checkpointTimer ) return;
+        if ( !_observeCommits() ) return;
+        _checkpointTimer =
+                std::make_unique<actor::Timer>([this] { enqueue(FUNCTION_TO_QUEUE(Housekeeper::_doCheckpoint)); });
+        // Only now that commits will trigger checkpoints can SQLite's auto-checkpoint be turned off:
+        _database->setBackgroundCheckpointing(true);
+    }
+
+    void Housekeeper::_startVacuuming() {
+        if ( _isStopped() || _vacuumTimer ) return;
+        if ( !_observeCommits() ) return;
+        _vacuumTimer = std::make_unique<actor::Timer>([this] { enqueue(FUNCTION_TO_QUEUE(Housekeeper::_doVacuum)); });
+        // There may be free pages left over from before the database was opened:
+        _vacuumTimer->fireAfter(kVacuumIdleDelay);
+    }
+
+    // Called on an arbitrary thread, while BackgroundDB holds a lock. This includes commits that
+    // only changed raw or local docs, since those grow the WAL too.
+    void Housekeeper::anyTransactionCommitted() { enqueue(FUNCTION_TO_QUEUE(Housekeeper::_transactionCommitted)); }
+
+    void Housekeeper::_transactionCommitted() {
+        if ( _isStopped() ) return;
+        if ( _checkpointTimer ) _checkpointTimer->fireEarlierAfter(kCheckpointDelay);
+        // Every commit pushes back the vacuum, so it only runs once the database is idle:
+        if ( _vacuumTimer ) _vacuumTimer->fireAfter(kVacuumIdleDelay);
+    }
+
+    void Housekeeper::_doCheckpoint() {
+        if ( _isStopped() ) return;
+
+        _bgdb->dataFile().useLocked([&](DataFile* df) {
+            if ( !df ) return;
+            try {
+                df->checkpoint();
+            } catch ( const exception& x ) { warn("Housekeeper: checkpoint failed: %s", x.what()); }
+        });
+    }
+
+    void Housekeeper::_doVacuum() {
+        if ( _isStopped() || !_vacuumTimer ) return;
+        chrono::milliseconds budget(sVacuumBudgetMS.load());
+        if ( budget.count() <= 0 ) return;
+
+        bool more = _bgdb->dataFile().useLocked<bool>([&](DataFile* df) {
+            if ( !df ) return false;
+            try {
+                return df->incrementalVacuum(budget);
+            } catch ( const exception& x ) {
+                warn("Housekeeper: incremental vacuum failed: %s", x.what());
+                return false;
+            }
+        });
+        if ( more ) _vacuumTimer->fireAfter(kVacuumIdleDelay);
+    }
+
     bool Housekeeper::initBackgroundDB() {
         if ( !_bgdb && _collection && _collection->isValid() ) {
-            _bgdb       = asInternal(_collection->getDatabase())->backgroundDatabase();
+            _database   = asInternal(_collection->getDatabase());
+            _bgdb       = _database->backgroundDatabase();
             _collection = nullptr;  // No longer needed, release the retain
             logInfo("Housekeeper: opening background database for the Housekeeper...");
         }
@@ -14,14 +14,15 @@
 #include "Base.hh"
 #include "Record.hh"
 #include "Actor.hh"
+#include "BackgroundDB.hh"
 #include "Timer.hh"
 
 struct C4Collection;
 
 namespace litecore {
-    class BackgroundDB;
-
-    class Housekeeper : public actor::Actor {
+    class Housekeeper
+        : public actor::Actor
+        , BackgroundDB::TransactionObserver {
       public:
         /// Creates a Housekeeper for a Collection.
         explicit Housekeeper(C4Collection* NONNULL);
@@ -30,6 +31,14 @@ namespace litecore {
         void startExpiration();
         void startMigration();
 
+        /// Asynchronously starts checkpointing the database's write-ahead log shortly after
+        /// transactions commit, so that commits themselves don't have to.
+        void startCheckpointing();
+
+        /// Asynchronously starts incrementally vacuuming the database whenever no transaction has
+        /// committed for a while, for up to the vacuum budget at a time.
+        void startVacuuming();
+
         /// Synchronously stops the Housekeeper task. After this returns it will do nothing.
         void stop();
 
@@ -41,6 +50,10 @@ namespace litecore {
         // Returns the current batch size.
         static unsigned setMigrateBatchSize(unsigned batchSize);
 
+        /// Sets the longest time a Housekeeper spends vacuuming at once; 0 disables vacuuming.
+        /// This applies to all databases. Returns the previous value.
+        static std::chrono::milliseconds setVacuumBudget(std::chrono::milliseconds);
+
       private:
         bool initBackgroundDB();
 
@@ -55,9 +68,21 @@ namespace litecore {
 
         void _doMigration();
 
+        void anyTransactionCommitted() override;
+        void _transactionCommitted();
+        bool _observeCommits();
+        void _startCheckpointing();
+        void _doCheckpoint();
+        void _startVacuuming();
+        void _doVacuum();
+
         alloc_slice                    _keyStoreName;
         BackgroundDB*                  _bgdb{nullptr};
+        DatabaseImpl*                  _database{nullptr};  // Set along with _bgdb
         std::unique_ptr<actor::Timer>  _expiryTimer;
+        std::unique_ptr<actor::Timer>  _checkpointTimer;
+        std::unique_ptr<actor::Timer>  _vacuumTimer;
+        bool                           _observingCommits{false};
         fleece::Retained<C4Collection> _collection;  // Used for initialization only
     };
 }  // namespace litecore
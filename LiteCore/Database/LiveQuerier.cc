@@ -34,7 +34,7 @@ namespace litecore {
     static constexpr delay_t kLongDelay  = 500ms;
 
     LiveQuerier::LiveQuerier(DatabaseImpl* db, Query* query, bool continuous, Delegate* delegate)
-        : Actor(QueryLog)
+        : Actor(QueryLog, "", Priority::background)
         , _database(db)
         , _backgroundDB(db->backgroundDatabase())
         , _delegate(delegate)
@@ -146,8 +146,10 @@ namespace litecore {
                     _query = df->compileQuery(_expression, _language);
                     if ( _continuous ) _backgroundDB->addTransactionObserver(this);
                 }
-                // Now run the query:
-                newQE = _query->createEnumerator(&options);
+                // Now run the query; if it's continuous, only the docs changed since the last run
+                // need to be re-evaluated:
+                newQE = _continuous ? _query->updateEnumerator(_currentEnumerator, &options)
+                                    : _query->createEnumerator(&options);
             }
             catchError(&error);
 
@@ -40,14 +40,16 @@ namespace litecore {
     IndexSpec::IndexSpec(IndexSpec&& spec)
         : IndexSpec(std::move(spec.name), spec.type, std::move(spec.expression), spec.queryLanguage,
                     std::move(spec.options)) {
-        whereClause = std::move(spec.whereClause);
-        _doc        = spec._doc;
-        spec._doc   = nullptr;
+        whereClause   = std::move(spec.whereClause);
+        includeClause = std::move(spec.includeClause);
+        _doc          = spec._doc;
+        spec._doc     = nullptr;
     }
 
     IndexSpec::~IndexSpec() {
         FLDoc_Release(_doc);
         FLDoc_Release(_unnestDoc);
+        FLDoc_Release(_includeDoc);
     }
 
     void IndexSpec::validateName() const {
@@ -144,6 +146,47 @@ namespace litecore {
         return nullptr;
     }
 
+    FLArray IndexSpec::include() const {
+        if ( includeClause.empty() ) return nullptr;
+        Doc doc(includeDoc());
+        // N1QL parses to a dict with a WHAT list, like the index's expressions; JSON is an array.
+        if ( auto dict = doc.asDict() )
+            return qt::requiredArray(qt::getCaseInsensitive(dict, "WHAT"), "Index INCLUDE term");
+        return qt::requiredArray(doc.root(), "Index INCLUDE term");
+    }
+
+    FLDoc IndexSpec::includeDoc() const {
+        // Precondition: !includeClause.empty()
+        if ( !_includeDoc ) {
+            switch ( queryLanguage ) {
+                case QueryLanguage::kJSON:
+                    try {
+                        _includeDoc = Doc::fromJSON(includeClause).detach();
+                    } catch ( const FleeceException& ) {
+                        error::_throw(error::InvalidQuery, "Invalid JSON in index include clause");
+                    }
+                    if ( !_includeDoc ) error::_throw(error::InvalidQuery, "Invalid JSON in index include clause");
+                    break;
+                case QueryLanguage::kN1QL:
+                    {
+                        // Parses the same way as the index's expressions, as a list of expressions:
+                        int           errPos;
+                        FLMutableDict result = n1ql::parse(includeClause.asString(), &errPos);
+                        if ( !result ) {
+                            string msg = "N1QL syntax error in index include clause \"" + includeClause.asString()
+                                         + "\"";
+                            throw Query::parseError(msg.c_str(), errPos);
+                        }
+                        alloc_slice json{FLValue_ToJSON(FLValue(result))};
+                        FLMutableDict_Release(result);
+                        _includeDoc = Doc::fromJSON(json).detach();
+                        break;
+                    }
+            }
+        }
+        return _includeDoc;
+    }
+
     // Turning unnestPath in C4IndexOptions to an array in JSON expresion.
     // Ex. students[].interests -> [[".students"],[".interests"]]
     FLArray IndexSpec::unnestPaths() const {
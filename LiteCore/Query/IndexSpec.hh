@@ -114,6 +114,16 @@ namespace litecore {
                 whereClause.reset();
         }
 
+        /** The optional INCLUDE clause: extra expressions whose values a value index stores, so that
+            queries reading them can be answered from the index without reading document bodies. */
+        FLArray include() const;
+
+        void setIncludeClause(string_view includeClause_) {
+            if ( !includeClause_.empty() ) includeClause = alloc_slice::nullPaddedString(includeClause_);
+            else
+                includeClause.reset();
+        }
+
         /** The nested unnestPath from arrayOptions, as separated by "[]." is turned to an array. */
         FLArray unnestPaths() const;
 
@@ -121,15 +131,18 @@ namespace litecore {
         Type const        type;           ///< Type of index
         alloc_slice const expression;     ///< The query expression
         alloc_slice       whereClause;    ///< The where clause. If given, expression should be the what clause
+        alloc_slice       includeClause;  ///< Expressions stored in a value index besides the indexed ones
         QueryLanguage     queryLanguage;  ///< Is expression JSON or N1QL?
         Options const     options;        ///< Options for FTS and vector indexes
 
       private:
         FLDoc doc() const;
         FLDoc unnestDoc() const;
+        FLDoc includeDoc() const;
 
-        mutable FLDoc _doc       = nullptr;
-        mutable FLDoc _unnestDoc = nullptr;
+        mutable FLDoc _doc        = nullptr;
+        mutable FLDoc _unnestDoc  = nullptr;
+        mutable FLDoc _includeDoc = nullptr;
     };
 
 }  // namespace litecore
@@ -21,6 +21,7 @@
 #    include "LazyIndex.hh"
 #    include "BothKeyStore.hh"
 #    include "Error.hh"
+#    include "Instrumentation.hh"
 #    include "Query.hh"
 #    include "SequenceSet.hh"
 #    include "SQLiteDataFile.hh"
@@ -208,6 +209,7 @@ namespace litecore {
     }
 
     bool LazyIndexUpdate::finish(ExclusiveTransaction& txn) {
+        Signpost signpost(Signpost::indexUpdate, uintptr_t(this), _count);
         // Finishing an update without either updating or skipping at least one vector is unsupported.
         if ( anyVectorNotModified() ) {
             litecore::error::_throw(litecore::error::UnsupportedOperation,
@@ -68,25 +68,35 @@ namespace litecore {
         struct Options {
             Options() = default;
 
-            Options(const Options& o) : paramBindings(o.paramBindings), afterSequence(o.afterSequence) {}
+            Options(const Options& o)
+                : paramBindings(o.paramBindings), afterSequence(o.afterSequence), streaming(o.streaming) {}
 
             Options& operator=(const Options& o) {
                 const_cast<alloc_slice&>(paramBindings) = o.paramBindings;
                 const_cast<sequence_t&>(afterSequence)  = o.afterSequence;
                 const_cast<uint64_t&>(purgeCount)       = 0;
+                const_cast<bool&>(streaming)            = o.streaming;
                 return *this;
             }
 
             template <class T>
-            explicit Options(T bindings, sequence_t afterSeq = 0_seq, uint64_t withPurgeCount = 0)
-                : paramBindings(std::move(bindings)), afterSequence(afterSeq), purgeCount(withPurgeCount) {}
+            explicit Options(T bindings, sequence_t afterSeq = 0_seq, uint64_t withPurgeCount = 0,
+                             bool streams = false)
+                : paramBindings(std::move(bindings))
+                , afterSequence(afterSeq)
+                , purgeCount(withPurgeCount)
+                , streaming(streams) {}
 
             [[nodiscard]] Options after(sequence_t afterSeq) const {
-                return Options(paramBindings, afterSeq, purgeCount);
+                return Options(paramBindings, afterSeq, purgeCount, streaming);
             }
 
             [[nodiscard]] Options withPurgeCount(uint64_t purgeCnt) const {
-                return Options(paramBindings, afterSequence, purgeCnt);
+                return Options(paramBindings, afterSequence, purgeCnt, streaming);
+            }
+
+            [[nodiscard]] Options asStreaming() const {
+                return Options(paramBindings, afterSequence, purgeCount, true);
             }
 
             [[nodiscard]] bool notOlderThan(sequence_t afterSeq, uint64_t purgeCnt) const {
@@ -96,10 +106,24 @@ namespace litecore {
             alloc_slice const paramBindings;
             sequence_t const  afterSequence{0};
             uint64_t const    purgeCount{0};
+            /// If true, the enumerator reads rows from the database as it goes, instead of
+            /// recording them all up front. It only iterates forward: it doesn't support
+            /// `getRowCount`, `seek`, `refresh`, `clone` or `obsoletedBy`, so it can't be used by
+            /// live queries.
+            bool const streaming{false};
         };
 
         virtual QueryEnumerator* createEnumerator(const Options* = nullptr) = 0;
 
+        /** Like `createEnumerator`, but `previous` (if non-null) is an enumerator of this query's
+            earlier results, which may be updated by re-running the query only on the documents
+            that changed since then. The rows are the same as `createEnumerator`'s, but if the
+            query has no ORDER BY they may be in a different order.
+            The default implementation just calls `createEnumerator`. */
+        virtual QueryEnumerator* updateEnumerator(QueryEnumerator* previous, const Options* options) {
+            return createEnumerator(options);
+        }
+
       protected:
         Query(DataFile&, slice expression, QueryLanguage language);
 
@@ -136,7 +160,7 @@ namespace litecore {
         bool isColumnMissing(unsigned col) const { return (missingColumns() & (1ull << col)) != 0; }
 
         /** Random access to rows. May not be supported by all implementations, but does work with
-            the current SQLite query implementation. */
+            the current SQLite query implementation, unless the enumerator is streaming. */
         virtual int64_t getRowCount() const { return -1; }
 
         virtual void seek(int64_t rowIndex) { error::_throw(error::UnsupportedOperation); }
@@ -0,0 +1,104 @@
+//
+// QueryCache.cc
+//
+// Copyright 2026-Present Couchbase, Inc.
+//
+// Use of this software is governed by the Business Source License included
+// in the file licenses/BSL-Couchbase.txt.  As of the Change Date specified
+// in that file, in accordance with the Business Source License, use of this
+// software will be governed by the Apache License, Version 2.0, included in
+// the file licenses/APL2.txt.
+//
+
+#include "QueryCache.hh"
+#include <cctype>
+
+namespace litecore {
+    using namespace std;
+    using namespace fleece;
+
+    string QueryCache::keyFor(QueryLanguage language, slice text, const string& collectionTable) {
+        string key;
+        key.reserve(collectionTable.size() + text.size + 2);
+        key += char('0' + int(language));
+        key += collectionTable;
+        key += '\0';
+
+        // Collapse whitespace, except inside string literals and quoted identifiers.
+        // JSON strings have backslash escapes; N1QL has none (`'\'` is a complete literal), and a
+        // doubled quote inside a literal just closes and reopens it, which leaves it quoted.
+        const bool backslashEscapes = (language == QueryLanguage::kJSON);
+        char       quote            = 0;
+        bool       escaped          = false;
+        bool       whitespace       = false;
+        for ( char c : string_view(text) ) {
+            if ( quote ) {
+                if ( escaped ) escaped = false;
+                else if ( c == '\\' && backslashEscapes )
+                    escaped = true;
+                else if ( c == quote )
+                    quote = 0;
+            } else if ( isspace((unsigned char)c) ) {
+                whitespace = true;
+                continue;
+            } else if ( c == '"' || c == '\'' || c == '`' ) {
+                quote = c;
+            }
+            if ( whitespace ) {
+                if ( key.back() != '\0' ) key += ' ';
+                whitespace = false;
+            }
+            key += c;
+        }
+        return key;
+    }
+
+    void QueryCache::checkSchemaVersion(int64_t schemaVersion) {
+        if ( schemaVersion != _schemaVersion ) {
+            _lru.clear();
+            _entries.clear();
+            _schemaVersion = schemaVersion;
+        }
+    }
+
+    shared_ptr<const CompiledQuery> QueryCache::get(const string& key, int64_t schemaVersion) {
+        lock_guard<mutex> lock(_mutex);
+        checkSchemaVersion(schemaVersion);
+        auto i = _entries.find(key);
+        if ( i == _entries.end() ) {
+            ++_misses;
+            return nullptr;
+        }
+        ++_hits;
+        _lru.splice(_lru.begin(), _lru, i->second);  // Move it to the front
+        return i->second->second;
+    }
+
+    void QueryCache::put(const string& key, int64_t schemaVersion, shared_ptr<const CompiledQuery> query) {
+        lock_guard<mutex> lock(_mutex);
+        checkSchemaVersion(schemaVersion);
+        if ( auto i = _entries.find(key); i != _entries.end() ) {
+            i->second->second = std::move(query);
+            _lru.splice(_lru.begin(), _lru, i->second);
+            return;
+        }
+        _lru.emplace_front(key, std::move(query));
+        _entries.emplace(key, _lru.begin());
+        if ( _lru.size() > _capacity ) {
+            _entries.erase(_lru.back().first);
+            _lru.pop_back();
+        }
+    }
+
+    void QueryCache::clear() {
+        lock_guard<mutex> lock(_mutex);
+        _lru.clear();
+        _entries.clear();
+    }
+
+    DataFile::QueryCacheStats QueryCache::stats() const {
+        lock_guard<mutex> lock(_mutex);
+        return {_hits, _misses, _lru.size()};
+    }
+
+}  // namespace litecore
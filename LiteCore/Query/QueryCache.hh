@@ -0,0 +1,86 @@
+//
+// QueryCache.hh
+//
+// Copyright 2026-Present Couchbase, Inc.
+//
+// Use of this software is governed by the Business Source License included
+// in the file licenses/BSL-Couchbase.txt.  As of the Change Date specified
+// in that file, in accordance with the Business Source License, use of this
+// software will be governed by the Apache License, Version 2.0, included in
+// the file licenses/APL2.txt.
+//
+
+#pragma once
+#include "DataFile.hh"
+#include "QueryTranslator.hh"
+#include "fleece/slice.hh"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace SQLite {
+    class Statement;
+}
+
+namespace litecore {
+
+    /** Everything a SQLiteQuery gets from parsing and translating its query, plus the prepared
+        statement, so that compiling the same query again can skip all that work. Immutable once
+        created; it's shared by all the SQLiteQuerys compiled from the same query. */
+    struct CompiledQuery {
+        fleece::alloc_slice                json;                     ///< JSON form of the query
+        std::string                        sql;                      ///< SQL translation
+        std::vector<std::string>           collectionTablesUsed;     ///< Tables of the collections read
+        std::set<std::string>              parameters;               ///< Names of the required parameters
+        std::vector<std::string>           ftsTablesUsed;            ///< FTS tables read
+        unsigned                           firstCustomResultColumn;  ///< Column index of 1st column in WHAT
+        std::vector<std::string>           columnTitles;             ///< Titles of the result columns
+        QueryTranslator::IncrementalSQL    incrementalSQL;           ///< SQL for incremental updates, if any
+        std::shared_ptr<SQLite::Statement> statement;                ///< The prepared SQL statement
+    };
+
+    /** A DataFile's LRU cache of CompiledQuerys, keyed by query language, default collection and
+        normalized query text. A translation depends on the database schema -- which indexes and
+        collections exist -- so all the entries are dropped whenever the schema changes.
+        Thread-safe. */
+    class QueryCache {
+      public:
+        static constexpr size_t kDefaultCapacity = 64;
+
+        explicit QueryCache(size_t capacity = kDefaultCapacity) : _capacity(capacity) {}
+
+        /// Returns the cache key of a query: its language, its default collection's table, and its
+        /// text with runs of whitespace outside of quotes collapsed to a single space.
+        static std::string keyFor(QueryLanguage, fleece::slice text, const std::string& collectionTable);
+
+        /// Returns the cached query with this key, or null.
+        /// @param schemaVersion  The database's current schema version. If it's not the one the
+        ///                       entries were cached with, they're all dropped.
+        std::shared_ptr<const CompiledQuery> get(const std::string& key, int64_t schemaVersion);
+
+        /// Adds a query, evicting the least recently used one if the cache is full.
+        void put(const std::string& key, int64_t schemaVersion, std::shared_ptr<const CompiledQuery>);
+
+        /// Removes all the entries.
+        void clear();
+
+        DataFile::QueryCacheStats stats() const;
+
+      private:
+        using Entry = std::pair<std::string, std::shared_ptr<const CompiledQuery>>;
+
+        void checkSchemaVersion(int64_t schemaVersion);
+
+        mutable std::mutex                                          _mutex;
+        size_t const                                                _capacity;
+        std::list<Entry>                                            _lru;                // Most recently used first
+        std::unordered_map<std::string, std::list<Entry>::iterator> _entries;
+        int64_t                                                     _schemaVersion{-1};  // Schema version when cached
+        uint64_t                                                    _hits{0}, _misses{0};
+    };
+
+}  // namespace litecore
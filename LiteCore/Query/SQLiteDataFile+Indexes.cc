@@ -57,7 +57,8 @@ namespace litecore {
               "expression TEXT, "         // Indexed property expression (JSON or N1QL)
               "whereClause TEXT, "        // Property whereClause for partial index (JSON or N1QL)
               "indexTableName TEXT, "     // Index's SQLite name
-              "lastSeq TEXT)");           // indexed sequences, for lazy indexes, else null
+              "lastSeq TEXT, "            // indexed sequences, for lazy indexes, else null
+              "includeClause TEXT)");     // Extra expressions stored in a value index (JSON or N1QL)
         ensureSchemaVersionAtLeast(SchemaVersion::WithIndexTable);
 
         for ( auto& spec : getIndexesOldStyle() ) registerIndex(spec, spec.keyStoreName, spec.indexTableName);
@@ -66,8 +67,8 @@ namespace litecore {
     void SQLiteDataFile::registerIndex(const litecore::IndexSpec& spec, const string& keyStoreName,
                                        const string& indexTableName) {
         SQLite::Statement stmt(*this,
-                               "INSERT INTO indexes (name, type, keyStore, expression, indexTableName, whereClause) "
-                               "VALUES (?, ?, ?, ?, ?, ?)");
+                               "INSERT INTO indexes (name, type, keyStore, expression, indexTableName, whereClause, "
+                               "includeClause) VALUES (?, ?, ?, ?, ?, ?, ?)");
         // CBL-6000 adding prefix to distinguish between JSON and N1QL expression
         string prefixedExpression{spec.queryLanguage == QueryLanguage::kJSON   ? "=j"
                                   : spec.queryLanguage == QueryLanguage::kN1QL ? "=n"
@@ -81,6 +82,8 @@ namespace litecore {
         stmt.bindNoCopy(4, prefixedExpression.c_str(), (int)prefixedExpression.length());
         if ( spec.type != IndexSpec::kValue ) stmt.bindNoCopy(5, indexTableName);
         if ( !spec.whereClause.empty() ) stmt.bindNoCopy(6, (char*)spec.whereClause.buf, (int)spec.whereClause.size);
+        if ( !spec.includeClause.empty() )
+            stmt.bindNoCopy(7, (char*)spec.includeClause.buf, (int)spec.includeClause.size);
 
         LogStatement(stmt);
         stmt.exec();
@@ -210,12 +213,13 @@ namespace litecore {
 
     vector<SQLiteIndexSpec> SQLiteDataFile::getIndexes(const KeyStore* store) const {
         if ( indexTableExists() ) {
-            string sql = "SELECT name, type, expression, keyStore, indexTableName, lastSeq, whereClause "
-                         "FROM indexes ORDER BY name";
+            string sql = "SELECT name, type, expression, keyStore, indexTableName, lastSeq, whereClause, "
+                         "includeClause FROM indexes ORDER BY name";
             if ( _schemaVersion < SchemaVersion::WithIndexesLastSeq ) {
                 // If schema doesn't have the `lastSeq` column, don't query it:
                 replace(sql, "lastSeq", "NULL");
             }
+            if ( _schemaVersion < SchemaVersion::WithIndexesIncludeColumn ) replace(sql, "includeClause", "NULL");
             vector<SQLiteIndexSpec> indexes;
             SQLite::Statement       stmt(*this, sql);
             while ( stmt.executeStep() ) {
@@ -267,12 +271,13 @@ namespace litecore {
     // Gets info of a single index. (Subroutine of create/deleteIndex.)
     optional<SQLiteIndexSpec> SQLiteDataFile::getIndex(slice name) {
         if ( !indexTableExists() ) return nullopt;
-        string sql = "SELECT name, type, expression, keyStore, indexTableName, lastSeq, whereClause "
-                     "FROM indexes WHERE name=?";
+        string sql = "SELECT name, type, expression, keyStore, indexTableName, lastSeq, whereClause, "
+                     "includeClause FROM indexes WHERE name=?";
         if ( _schemaVersion < SchemaVersion::WithIndexesLastSeq ) {
             // If schema doesn't have the `lastSeq` column, don't query it:
             replace(sql, "lastSeq", "NULL");
         }
+        if ( _schemaVersion < SchemaVersion::WithIndexesIncludeColumn ) replace(sql, "includeClause", "NULL");
         SQLite::Statement stmt(*this, sql);
         stmt.bindNoCopy(1, (char*)name.buf, (int)name.size);
         if ( stmt.executeStep() ) return specFromStatement(stmt);
@@ -338,6 +343,7 @@ namespace litecore {
         SQLiteIndexSpec spec{name, type, expression, queryLanguage, options, keyStoreName, indexTableName};
         if ( auto col5 = stmt.getColumn(5); col5.isText() ) spec.indexedSequences = col5.getText();
         if ( auto col6 = stmt.getColumn(6); col6.isText() ) spec.setWhereClause({col6.getText()});
+        if ( auto col7 = stmt.getColumn(7); col7.isText() ) spec.setIncludeClause({col7.getText()});
         return spec;
     }
 
@@ -213,7 +213,9 @@ namespace litecore {
             if ( idxNum == kPathIndex ) {
                 // If fl_each is called with a 2nd (property path) argument, then the first arg is the
                 // doc body, which we need to extract Fleece from:
-                data = valueAsDocBody(argv[0], _scopeDataIsCopied);
+                try {
+                    data = valueAsDocBody(argv[0], _vtab->context, _scopeDataIsCopied);
+                } catch ( const std::exception& ) { return SQLITE_CORRUPT; }
             } else {
                 data               = valueAsSlice(argv[0]);
                 _scopeDataIsCopied = false;
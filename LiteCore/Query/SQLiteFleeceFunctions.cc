@@ -12,6 +12,7 @@
 
 #include "SQLite_Internal.hh"
 #include "SQLiteFleeceUtil.hh"
+#include "BodyCompressor.hh"
 #include "Base64.hh"
 #include "Error.hh"
 #include "Encoder.hh"
@@ -19,7 +20,6 @@
 #include "DeepIterator.hh"
 #include "NumConversion.hh"
 #include "RevID.hh"
-#include <sstream>
 
 using namespace fleece;
 using namespace fleece::impl;
@@ -39,10 +39,12 @@ namespace litecore {
     static void fl_root(sqlite3_context* ctx, [[maybe_unused]] int argc, sqlite3_value** argv) noexcept {
         if ( sqlite3_value_type(argv[0]) == SQLITE_BLOB ) {
             // Pull the Fleece data out of a raw document body:
-            bool  copied{false};
-            slice body = valueAsDocBody(argv[0], copied);
-            setResultBlobFromFleeceData(ctx, body);
-            if ( copied ) ::free((void*)body.buf);
+            try {
+                bool  copied{false};
+                slice body = valueAsDocBody(argv[0], getFuncContext(ctx), copied);
+                setResultBlobFromFleeceData(ctx, body);
+                if ( copied ) ::free((void*)body.buf);
+            } catch ( const std::exception& ) { sqlite3_result_error(ctx, "fl_root: exception!", -1); }
         } else {
             // If arg isn't a blob, check if it's a tagged Fleece pointer:
             const Value* val = asFleeceValue(argv[0]);
@@ -111,8 +113,8 @@ namespace litecore {
         } catch ( const std::exception& ) { sqlite3_result_error(ctx, "fl_nested_value: exception!", -1); }
     }
 
-    // (subroutine of `fl_fts_value`. Writes a Fleece scalar value to a stream in text form.
-    static void handle_fts_value(const Value* data, stringstream& result) {
+    // (subroutine of `fl_fts_value`. Appends a Fleece scalar value to a string in text form.
+    static void handle_fts_value(const Value* data, string& result) {
         if ( _usuallyFalse(!data) ) {
             Warn("Null value received in handle_fts_value");
             return;
@@ -120,17 +122,20 @@ namespace litecore {
 
         switch ( data->type() ) {
             case kBoolean:
-                result << (data->asBool() ? "T" : "F");
+                result += (data->asBool() ? "T" : "F");
                 break;
             case kNumber:
                 {
                     const alloc_slice stringified = data->toString();
-                    result << stringified.asString();
+                    result.append((const char*)stringified.buf, stringified.size);
                     break;
                 }
             case kString:
-                result << data->asString().asString();
-                break;
+                {
+                    slice str = data->asString();
+                    result.append((const char*)str.buf, str.size);
+                    break;
+                }
             default:
                 break;
         }
@@ -145,14 +150,14 @@ namespace litecore {
             QueryFleeceScope scope(ctx, argv);
             if ( scope.root == nullptr ) { return; }
 
-            stringstream result;
+            ScratchString result;
             for ( DeepIterator j(scope.root); j; ++j ) {
-                handle_fts_value(j.value(), result);
-                result << " ";
+                handle_fts_value(j.value(), *result);
+                *result += ' ';
             }
 
-            const string resultStr = result.str();
-            setResultTextFromSlice(ctx, slice(resultStr.substr(0, resultStr.size() - 1)));
+            if ( !result->empty() ) result->pop_back();  // remove the trailing space
+            setResultTextFromSlice(ctx, slice(*result));
         } catch ( const std::exception& ) { sqlite3_result_error(ctx, "fl_fts_value: exception!", -1); }
     }
 
@@ -249,9 +254,9 @@ namespace litecore {
                             sqlite3_result_blob(ctx, encoded.buf, int(encoded.size), SQLITE_STATIC);
                             return;
                         } else if ( subtype == kFleeceIntUnsigned ) {
-                            Encoder enc;
-                            enc.writeUInt(sqlite3_value_int64(arg));
-                            setResultBlobFromFleeceData(ctx, enc.finish());
+                            ScratchEncoder enc;
+                            enc->writeUInt(sqlite3_value_int64(arg));
+                            setResultBlobFromFleeceData(ctx, enc->finish());
                             return;
                         }
                         break;
@@ -277,9 +282,9 @@ namespace litecore {
                                     // A plain blob/data value has to be wrapped in a Fleece container to avoid
                                     // misinterpretation, since SQLiteQueryRunner will assume all blob results
                                     // are Fleece containers.
-                                    Encoder enc;
-                                    enc.writeData(valueAsSlice(arg));
-                                    setResultBlobFromFleeceData(ctx, enc.finish());
+                                    ScratchEncoder enc;
+                                    enc->writeData(valueAsSlice(arg));
+                                    setResultBlobFromFleeceData(ctx, enc->finish());
                                     return;
                                 }
                             default:
@@ -490,13 +495,13 @@ namespace litecore {
     ///
     /// The N1QL `ARRAY()` function. Constructs a Fleece Array out of its arguments.
     static void array_of(sqlite3_context* ctx, int argc, sqlite3_value** argv) noexcept {
-        Encoder enc;
-        enc.beginArray(argc);
+        ScratchEncoder enc;
+        enc->beginArray(argc);
         for ( int i = 0; i < argc; i++ ) {
-            if ( !writeSQLiteValue(ctx, argv[i], nullslice, enc) ) return;
+            if ( !writeSQLiteValue(ctx, argv[i], nullslice, *enc) ) return;
         }
-        enc.endArray();
-        setResultBlobFromFleeceData(ctx, enc.finish());
+        enc->endArray();
+        setResultBlobFromFleeceData(ctx, enc->finish());
     }
 
     /// dict_of(key, value, ...) -> Dict
@@ -507,18 +512,18 @@ namespace litecore {
             sqlite3_result_error(ctx, "object() must have an even arg count", -1);
             return;
         }
-        Encoder enc;
-        enc.beginDictionary(argc / 2);
+        ScratchEncoder enc;
+        enc->beginDictionary(argc / 2);
         for ( int i = 0; i < argc; i += 2 ) {
             slice key = valueAsStringSlice(argv[i]);
             if ( !key ) {
                 sqlite3_result_error(ctx, "invalid key arg to object()", -1);
                 return;
             }
-            if ( !writeSQLiteValue(ctx, argv[i + 1], key, enc) ) return;
+            if ( !writeSQLiteValue(ctx, argv[i + 1], key, *enc) ) return;
         }
-        enc.endDictionary();
-        setResultBlobFromFleeceData(ctx, enc.finish());
+        enc->endDictionary();
+        setResultBlobFromFleeceData(ctx, enc->finish());
     }
 
 #pragma mark - REVISION HISTORY:
@@ -531,16 +536,24 @@ namespace litecore {
     /// so it can read documents as quickly as possible.
     static void fl_callback(sqlite3_context* ctx, [[maybe_unused]] int argc, sqlite3_value** argv) noexcept {
         RecordUpdate rec(valueAsSlice(argv[0]), valueAsSlice(argv[2]));
-        rec.version   = valueAsSlice(argv[1]);
-        rec.extra     = valueAsSlice(argv[3]);
-        rec.sequence  = sequence_t(sqlite3_value_int(argv[4]));
-        rec.flags     = (DocumentFlags)sqlite3_value_int(argv[5]);
-        auto callback = sqlite3_value_pointer(argv[6], kWithDocBodiesCallbackPointerType);
+        rec.version      = valueAsSlice(argv[1]);
+        rec.extra        = valueAsSlice(argv[3]);
+        rec.sequence     = sequence_t(sqlite3_value_int(argv[4]));
+        int64_t rawFlags = sqlite3_value_int64(argv[5]);
+        rec.flags        = (DocumentFlags)rawFlags;
+        auto callback    = sqlite3_value_pointer(argv[6], kWithDocBodiesCallbackPointerType);
         if ( !callback || !rec.key ) {
             sqlite3_result_error(ctx, "Missing or invalid callback", -1);
             return;
         }
         try {
+            alloc_slice decompressedBody;
+            if ( BodyCompressor::isCompressed(rawFlags) ) {
+                auto dictionaries = getFuncContext(ctx).bodyDictionaries;
+                if ( !dictionaries ) error::_throw(error::UnsupportedOperation, "Can't decompress body");
+                decompressedBody = dictionaries->decompress(rec.body);
+                rec.body         = decompressedBody;
+            }
             alloc_slice result = (*(KeyStore::WithDocBodyCallback*)callback)(rec);
             setResultTextFromSlice(ctx, result);
         } catch ( const std::exception& ) { sqlite3_result_error(ctx, "fl_callback: exception!", -1); }
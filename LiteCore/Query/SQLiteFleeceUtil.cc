@@ -14,6 +14,7 @@
 #include "SQLiteFleeceUtil.hh"
 #include "SQLite_Internal.hh"
 #include "RawRevTree.hh"
+#include "BodyCompressor.hh"
 #include "UnicodeCollator.hh"
 #include "Path.hh"
 #include "Error.hh"
@@ -32,14 +33,35 @@ namespace litecore {
 
     const char* const kFleeceValuePointerType = "FleeceValue";
 
-    slice valueAsDocBody(sqlite3_value* arg, bool& outCopied) {
+    // True if a `body` column's data was compressed by a BodyCompressor.
+    static bool isCompressedBody(slice data, const fleeceFuncContext& context) {
+        return _usuallyFalse(BodyCompressor::isCompressed(data)) && context.bodyDictionaries
+               && context.bodyDictionaries->inUse();
+    }
+
+    slice valueAsDocBody(sqlite3_value* arg, const fleeceFuncContext& context, bool& outCopied) {
         outCopied = false;
         auto type = sqlite3_value_type(arg);
         if ( _usuallyFalse(type == SQLITE_NULL) ) return nullslice;  // No 'body' column; may be deleted doc
         DebugAssert(type == SQLITE_BLOB);
         DebugAssert(sqlite3_value_subtype(arg) == 0);
         auto fleece = valueAsSlice(arg);
-        if ( RawRevision::isRevTree(fleece) ) {
+        if ( isCompressedBody(fleece, context) ) {
+            // The body was compressed by a BodyCompressor; decompress it into a new heap block:
+            auto        header     = BodyCompressor::readHeader(fleece);
+            alloc_slice dictionary = header.dictionaryID ? context.bodyDictionaries->get(header.dictionaryID)
+                                                         : nullslice;
+            void* body = ::malloc(header.size);
+            if ( !body ) throw std::bad_alloc();
+            try {
+                BodyCompressor::decompress(header, dictionary, body);
+            } catch ( ... ) {
+                ::free(body);
+                throw;
+            }
+            outCopied = true;
+            return {body, header.size};
+        } else if ( RawRevision::isRevTree(fleece) ) {
             // This is a 2.x-format `body` column containing a revision tree, i.e. the document
             // has not yet been updated to 3.0 format. Extract the current revision's body:
             fleece = RawRevision::getCurrentRevBody(fleece);
@@ -54,10 +76,99 @@ namespace litecore {
         return fleece;
     }
 
-    static SharedKeys* getSharedKeys(sqlite3_context* ctx) {
-        return static_cast<fleeceFuncContext*>(sqlite3_user_data(ctx))->sharedKeys;
+#pragma mark - SCRATCH MEMORY:
+
+    // A scratch string buffer bigger than this is freed between rows.
+    static constexpr size_t kMaxScratchStringCapacity = 64 * 1024;
+
+    thread_local QueryScratch* QueryScratch::sCurrent;
+
+    QueryScratch::QueryScratch() = default;
+
+    QueryScratch::~QueryScratch() { DebugAssert(sCurrent != this); }
+
+    void QueryScratch::reset() noexcept {
+        DebugAssert(!_encoderInUse && !_stringInUse);
+        if ( _usuallyFalse(_string.capacity() > kMaxScratchStringCapacity) ) std::string().swap(_string);
+        for ( auto& body : _docBodies ) body.clear();
+        _nextDocBody = 0;
+    }
+
+    void QueryScratch::DocBody::clear() noexcept {
+        scope.reset();  // must unregister before the data is freed
+        root = nullptr;
+        ::free((void*)data.buf);
+        data       = nullslice;
+        compressed = nullslice;
     }
 
+    const Value* QueryScratch::docRoot(sqlite3_context* ctx, sqlite3_value* arg) {
+        const fleeceFuncContext& context = getFuncContext(ctx);
+        slice                    rawData = valueAsSlice(arg);
+        for ( auto& body : _docBodies ) {
+            if ( body.root && body.sharedKeys == context.sharedKeys && body.compressed == rawData ) return body.root;
+        }
+
+        // Not seen in this row yet, so decompress it into the least recently decoded slot:
+        DocBody& body = _docBodies[_nextDocBody];
+        _nextDocBody  = (_nextDocBody + 1) % kNumDocBodies;
+        body.clear();
+
+        bool copied;
+        body.data = valueAsDocBody(arg, context, copied);
+        DebugAssert(copied);
+        body.compressed = alloc_slice(rawData);
+        body.root       = Value::fromTrustedData(body.data);
+        if ( _usuallyFalse(!body.root) ) {
+            body.clear();
+            Warn("Invalid Fleece data in SQLite table");
+            error::_throw(error::CorruptRevisionData, "QueryScratch getting invalid Fleece data");
+        }
+        body.sharedKeys = context.sharedKeys;
+        body.scope.emplace(body.data, context.sharedKeys);
+        return body.root;
+    }
+
+    ScratchEncoder::ScratchEncoder() {
+        QueryScratch* scratch = QueryScratch::current();
+        if ( scratch && !scratch->_encoderInUse ) {
+            _scratch                = scratch;
+            _scratch->_encoderInUse = true;
+            if ( !_scratch->_encoder ) _scratch->_encoder.emplace();
+            _encoder = &*_scratch->_encoder;
+        } else {
+            _encoder = &_local.emplace();
+        }
+    }
+
+    ScratchEncoder::~ScratchEncoder() {
+        if ( _scratch ) {
+            // (If the encoder was finished, it's already been reset; this is for early returns.)
+            _encoder->reset();
+            _scratch->_encoderInUse = false;
+        }
+    }
+
+    ScratchString::ScratchString() {
+        QueryScratch* scratch = QueryScratch::current();
+        if ( scratch && !scratch->_stringInUse ) {
+            _scratch               = scratch;
+            _scratch->_stringInUse = true;
+            _string                = &_scratch->_string;
+            _string->clear();  // keeps its capacity
+        } else {
+            _string = &_local.emplace();
+        }
+    }
+
+    ScratchString::~ScratchString() {
+        if ( _scratch ) _scratch->_stringInUse = false;
+    }
+
+#pragma mark - FLEECE ARGUMENTS:
+
+    static SharedKeys* getSharedKeys(sqlite3_context* ctx) { return getFuncContext(ctx).sharedKeys; }
+
     QueryFleeceParam::QueryFleeceParam(sqlite3_context* ctx, sqlite3_value* arg, const bool required) noexcept {
         switch ( sqlite3_value_type(arg) ) {
             case SQLITE_BLOB:
@@ -112,29 +223,35 @@ namespace litecore {
         }
     }
 
-    // Clang-Tidy warns that _copied is not initialized by this constructor, we can ignore this because it is
-    // initialized by passing it to 'valueAsDocBody()'
-    // NOLINTBEGIN(cppcoreguidelines-pro-type-member-init)
-    QueryFleeceScope::QueryFleeceScope(sqlite3_context* ctx, sqlite3_value** argv)
-        : Scope(valueAsDocBody(argv[0], _copied), getSharedKeys(ctx)) {
-        if ( _usuallyTrue(data().buf != nullptr) ) {
-            root = Value::fromTrustedData(data());
-            if ( _usuallyFalse(!root) ) {
-                Warn("Invalid Fleece data in SQLite table");
-                error::_throw(error::CorruptRevisionData, "QueryFleeceScope getting invalid Fleece data");
-            }
+    QueryFleeceScope::QueryFleeceScope(sqlite3_context* ctx, sqlite3_value** argv) {
+        QueryScratch*            scratch = QueryScratch::current();
+        const fleeceFuncContext& context = getFuncContext(ctx);
+        if ( scratch && sqlite3_value_type(argv[0]) == SQLITE_BLOB
+             && isCompressedBody(valueAsSlice(argv[0]), context) ) {
+            // Decompressing is costly, so let the query's scratch do it once per row. (Plain Fleece
+            // is used in place; caching it would cost more than it saves.)
+            root = scratch->docRoot(ctx, argv[0]);
         } else {
-            root = Dict::kEmpty;  // No current revision body; may be deleted rev
+            slice data = valueAsDocBody(argv[0], context, _copied);
+            if ( _usuallyTrue(data.buf != nullptr) ) {
+                _scope.emplace(data, getSharedKeys(ctx));
+                root = Value::fromTrustedData(data);
+                if ( _usuallyFalse(!root) ) {
+                    Warn("Invalid Fleece data in SQLite table");
+                    error::_throw(error::CorruptRevisionData, "QueryFleeceScope getting invalid Fleece data");
+                }
+            } else {
+                root = Dict::kEmpty;  // No current revision body; may be deleted rev
+            }
         }
         if ( _usuallyTrue(sqlite3_value_type(argv[1]) != SQLITE_NULL) ) root = evaluatePathFromArg(ctx, argv, 1, root);
     }
 
-    // NOLINTEND(cppcoreguidelines-pro-type-member-init)
-
     QueryFleeceScope::~QueryFleeceScope() {
         if ( _usuallyFalse(_copied) ) {
-            unregister();
-            free((void*)data().buf);
+            const void* buf = _scope->data().buf;
+            _scope.reset();
+            free((void*)buf);
         }
     }
 
@@ -218,9 +335,9 @@ namespace litecore {
 
     bool setResultBlobFromEncodedValue(sqlite3_context* ctx, const fleece::impl::Value* val) noexcept {
         try {
-            Encoder enc;
-            enc.writeValue(val);
-            setResultBlobFromFleeceData(ctx, enc.finish());
+            ScratchEncoder enc;
+            enc->writeValue(val);
+            setResultBlobFromFleeceData(ctx, enc->finish());
             return true;
         } catch ( const bad_alloc& ) { sqlite3_result_error_code(ctx, SQLITE_NOMEM); } catch ( ... ) {
             sqlite3_result_error_code(ctx, SQLITE_ERROR);
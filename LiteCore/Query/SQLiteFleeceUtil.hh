@@ -15,8 +15,12 @@
 #include "DataFile.hh"
 #include "SQLite_Internal.hh"
 #include "Doc.hh"
+#include "Encoder.hh"
 #include <sqlite3.h>
 
+#include <array>
+#include <optional>
+#include <string>
 #include <utility>
 
 namespace litecore {
@@ -38,31 +42,147 @@ namespace litecore {
     // Fleece data.
     // If it detects a v2.x-format `body` it extracts the current revision's Fleece out of the
     // serialized rev-tree. That data might be at an odd address; if so it copies it to a new
-    // heap block and sets `outCopied` to true. As a result, if `outCopied` returns set to true,
+    // heap block and sets `outCopied` to true. A compressed `body` (see BodyCompressor) is
+    // likewise decompressed into a new heap block. As a result, if `outCopied` returns set to true,
     // you MUST call `::free((void*)data.buf` on the result.
-    slice valueAsDocBody(sqlite3_value* arg, bool& outCopied);
+    slice valueAsDocBody(sqlite3_value* arg, const fleeceFuncContext&, bool& outCopied);
 
     inline const fleece::impl::Value* asFleeceValue(sqlite3_value* value) {
         return (const fleece::impl::Value*)sqlite3_value_pointer(value, kFleeceValuePointerType);
     }
 
     // Takes a document body from argv[0] and key-path from argv[1].
-    // Establishes a scope for the Fleece data, and evaluates the path, setting `root`
-    class QueryFleeceScope : public fleece::impl::Scope {
+    // Establishes a scope for the Fleece data, and evaluates the path, setting `root`.
+    // While a query is running, a compressed body is decompressed by the current QueryScratch,
+    // which keeps it for the other function calls on the same row.
+    class QueryFleeceScope {
       public:
         QueryFleeceScope(sqlite3_context* ctx, sqlite3_value** argv);
-        ~QueryFleeceScope() override;
+        ~QueryFleeceScope();
+
+        QueryFleeceScope(const QueryFleeceScope&)            = delete;
+        QueryFleeceScope& operator=(const QueryFleeceScope&) = delete;
 
         const fleece::impl::Value* root;
 
       private:
-        bool _copied;  // Do not initialize it; the base class will do.
+        std::optional<fleece::impl::Scope> _scope;
+        bool                               _copied{false};
     };
 
-    inline DataFile::Delegate* getDBDelegate(sqlite3_context* ctx) {
-        return ((fleeceFuncContext*)sqlite3_user_data(ctx))->delegate;
+    /** Reusable temporaries for SQL functions: a Fleece Encoder and a string buffer, which the
+        functions borrow via `ScratchEncoder` and `ScratchString` instead of constructing their own
+        on every call. A query makes one current on its thread while it steps its statement, and
+        resets it after each row. Functions called outside a query (e.g. while indexing) find no
+        current scratch, and use the heap as before. */
+    class QueryScratch {
+      public:
+        QueryScratch();
+        ~QueryScratch();
+
+        /// The scratch of the query running on the current thread, or nullptr.
+        static QueryScratch* current() noexcept { return sCurrent; }
+
+        /// Makes a QueryScratch current on this thread, for the lifetime of this object.
+        class Use {
+          public:
+            explicit Use(QueryScratch& scratch) noexcept : _prev(sCurrent) { sCurrent = &scratch; }
+
+            ~Use() { sCurrent = _prev; }
+
+            Use(const Use&)            = delete;
+            Use& operator=(const Use&) = delete;
+
+          private:
+            QueryScratch* _prev;
+        };
+
+        /// Call this between rows. It frees memory held by a temporary that grew unusually large,
+        /// and forgets the row's document bodies.
+        void reset() noexcept;
+
+        /// Returns the root of a compressed document body, i.e. a `body` column passed to a function
+        /// like `fl_value`. A row's body is usually passed to several functions, so the bodies
+        /// decompressed since the last `reset` are kept, and the same data passed again reuses its
+        /// root without decompressing it again.
+        const fleece::impl::Value* docRoot(sqlite3_context*, sqlite3_value* body);
+
+      private:
+        friend class ScratchEncoder;
+        friend class ScratchString;
+
+        // A decompressed document body. The compressed data is copied to identify it by, since
+        // SQLite's is only valid during a call; it's much smaller than the Fleece data.
+        struct DocBody {
+            DocBody() = default;
+            ~DocBody() { clear(); }
+
+            void clear() noexcept;
+
+            alloc_slice                        compressed;  // The `body` column's data
+            slice                              data;        // Decompressed Fleece data (malloced)
+            fleece::impl::SharedKeys*          sharedKeys{nullptr};
+            std::optional<fleece::impl::Scope> scope;
+            const fleece::impl::Value*         root{nullptr};
+        };
+
+        static constexpr size_t kNumDocBodies = 4;  // Enough for a few joined collections
+
+        std::optional<fleece::impl::Encoder> _encoder;
+        std::string                          _string;
+        bool                                 _encoderInUse{false}, _stringInUse{false};
+        std::array<DocBody, kNumDocBodies>   _docBodies;
+        unsigned                             _nextDocBody{0};
+
+        static thread_local QueryScratch* sCurrent;
+    };
+
+    /** A Fleece Encoder for a SQL function's result. It borrows the current QueryScratch's encoder
+        if possible, instead of constructing a new one. */
+    class ScratchEncoder {
+      public:
+        ScratchEncoder();
+        ~ScratchEncoder();
+
+        ScratchEncoder(const ScratchEncoder&)            = delete;
+        ScratchEncoder& operator=(const ScratchEncoder&) = delete;
+
+        fleece::impl::Encoder& operator*() noexcept { return *_encoder; }
+
+        fleece::impl::Encoder* operator->() noexcept { return _encoder; }
+
+      private:
+        QueryScratch*                        _scratch{nullptr};
+        std::optional<fleece::impl::Encoder> _local;
+        fleece::impl::Encoder*               _encoder;
+    };
+
+    /** A string buffer for a SQL function's temporary text. It borrows the current QueryScratch's
+        buffer if possible, which keeps its capacity from row to row. */
+    class ScratchString {
+      public:
+        ScratchString();
+        ~ScratchString();
+
+        ScratchString(const ScratchString&)            = delete;
+        ScratchString& operator=(const ScratchString&) = delete;
+
+        std::string& operator*() noexcept { return *_string; }
+
+        std::string* operator->() noexcept { return _string; }
+
+      private:
+        QueryScratch*              _scratch{nullptr};
+        std::optional<std::string> _local;
+        std::string*               _string;
+    };
+
+    inline const fleeceFuncContext& getFuncContext(sqlite3_context* ctx) {
+        return *(fleeceFuncContext*)sqlite3_user_data(ctx);
     }
 
+    inline DataFile::Delegate* getDBDelegate(sqlite3_context* ctx) { return getFuncContext(ctx).delegate; }
+
     // Returns the data of a SQLite blob value as a slice
     inline slice valueAsSlice(sqlite3_value* arg) noexcept {
         const void* blob = sqlite3_value_blob(arg);  // must be called _before_ sqlite3_value_bytes
@@ -16,6 +16,7 @@
 #include "SQLiteCpp/SQLiteCpp.h"
 #include "QueryTranslator.hh"
 #include "Error.hh"
+#include "Instrumentation.hh"
 #include "SecureDigest.hh"
 #include "StringUtil.hh"
 #include "Stopwatch.hh"
@@ -46,13 +47,18 @@ namespace litecore {
         - expression (JSON or N1QL)
         - table name (string)
         - indexed sequence (JSON)  --only for lazy vector indexes
+        - where clause (JSON or N1QL)  --only for partial indexes
+        - include clause (JSON or N1QL)  --only for covering value indexes
      The SQL index always is always named `name`.
      */
 
 
     bool SQLiteKeyStore::createIndex(const IndexSpec& spec) {
         spec.validateName();
+        if ( !spec.includeClause.empty() && spec.type != IndexSpec::kValue )
+            error::_throw(error::InvalidParameter, "Only value indexes can include extra expressions");
 
+        Signpost             signpost(Signpost::indexUpdate, uintptr_t(this), spec.type);
         Stopwatch            st;
         ExclusiveTransaction t(db());
         bool                 created;
@@ -94,7 +100,7 @@ namespace litecore {
         string          name{spec.type == IndexSpec::kArray ? litecore::hexName(sourceTableName) : sourceTableName};
         QueryTranslator qp(db(), "", name);
         qp.writeCreateIndex(spec.name, name, (FLArrayIterator&)expressions, spec.where(),
-                            (spec.type != IndexSpec::kValue));
+                            (spec.type != IndexSpec::kValue), spec.include());
         string sql = qp.SQL();
         return db().createIndex(spec, this, sourceTableName, sql);
     }
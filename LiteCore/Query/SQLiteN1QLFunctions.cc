@@ -555,7 +555,7 @@ namespace litecore {
             sqlite3_result_error(ctx, "concat() requires two or more parameters", -1);
             return;
         }
-        stringstream result;
+        ScratchString result;
         for ( int i = 0; i < argc; ++i ) {
             switch ( auto arg = argv[i]; sqlite3_value_type(arg) ) {
                 case SQLITE_NULL:
@@ -566,29 +566,28 @@ namespace litecore {
                         char   buf[30];
                         double num = sqlite3_value_double(arg);
                         WriteDouble(num, buf, sizeof(buf));
-                        result << buf;
+                        *result += buf;
                         break;
                     }
                 case SQLITE_INTEGER:
                     {
                         auto num = sqlite3_value_int64(arg);
-                        if ( sqlite3_value_subtype(arg) == kFleeceIntBoolean ) result << (num ? "true" : "false");
+                        if ( sqlite3_value_subtype(arg) == kFleeceIntBoolean ) *result += (num ? "true" : "false");
                         else
-                            result << num;
+                            *result += to_string(num);
                         break;
                     }
                 case SQLITE_TEXT:
-                    result.write((const char*)sqlite3_value_text(arg), sqlite3_value_bytes(arg));
+                    result->append((const char*)sqlite3_value_text(arg), sqlite3_value_bytes(arg));
                     break;
                 case SQLITE_BLOB:
                     // A blob is a Fleece array, dict, or null
-                    result << QueryFleeceParam { ctx, arg } -> toJSONString();
+                    *result += QueryFleeceParam { ctx, arg } -> toJSONString();
                     break;
             }
         }
 
-        string str = result.str();
-        sqlite3_result_text(ctx, str.data(), int(str.size()), SQLITE_TRANSIENT);
+        sqlite3_result_text(ctx, result->data(), int(result->size()), SQLITE_TRANSIENT);
     }
 
     // contains(string, substring) returns 1 if `string` contains `substring`, else 0
@@ -1503,11 +1502,11 @@ namespace litecore {
             if ( isMissing(argv[0]) || isNull(argv[0]) || isArray(ctx, argv[0]) ) {
                 sqlite3_result_value(ctx, argv[0]);
             } else {
-                Encoder enc;
-                enc.beginArray();
-                writeSQLiteArg(ctx, argv[0], enc);
-                enc.endArray();
-                setResultBlobFromFleeceData(ctx, enc.finish());
+                ScratchEncoder enc;
+                enc->beginArray();
+                writeSQLiteArg(ctx, argv[0], *enc);
+                enc->endArray();
+                setResultBlobFromFleeceData(ctx, enc->finish());
             }
         } catch ( const std::exception& ) { sqlite3_result_error(ctx, "toarray: exception!", -1); }
     }
@@ -12,13 +12,17 @@
 
 #include "SQLiteKeyStore.hh"
 #include "SQLiteDataFile.hh"
+#include "BothKeyStore.hh"
 #include "SQLite_Internal.hh"
+#include "SQLiteFleeceUtil.hh"
 #include "Defer.hh"
 #include "Logging.hh"
 #include "Query.hh"
+#include "QueryCache.hh"
 #include "QueryTranslator.hh"
 #include "n1ql_parser.hh"
 #include "Error.hh"
+#include "Instrumentation.hh"
 #include "StringUtil.hh"
 #include "Doc.hh"
 #include "Encoder.hh"
@@ -33,6 +37,8 @@
 #include <numeric>  // std::accumulate
 #include <sstream>
 #include <iostream>
+#include <unordered_map>
+#include <unordered_set>
 
 
 extern "C" {
@@ -56,72 +62,63 @@ namespace litecore {
             }
             return false;
         }
+
+        // Reads the full-text match info from the implicit columns of a result row.
+        void readFullTextTerms(const Array* row, unsigned firstCustomResultColumn,
+                               QueryEnumerator::FullTextTerms& terms) {
+            terms.clear();
+            uint64_t dataSource = row->get(kFTSRowidCol)->asInt();
+            if ( kFTSRowidCol < firstCustomResultColumn ) {
+                // The offsets() function returns a string of space-separated numbers in groups of 4.
+                string      offsets = row->get(kFTSOffsetsCol)->asString().asString();
+                const char* termStr = offsets.c_str();
+                while ( *termStr ) {
+                    uint32_t n[4];
+                    for ( unsigned int& i : n ) {
+                        char* next;
+                        i       = (uint32_t)strtol(termStr, &next, 10);
+                        termStr = next;
+                    }
+                    terms.push_back({dataSource, n[0], n[1], n[2], n[3]});
+                    // {rowid, key #, term #, byte offset, byte length}
+                }
+            }
+        }
     }  // namespace
 
     class SQLiteQuery final : public Query {
       public:
         SQLiteQuery(SQLiteDataFile& dataFile, slice queryStr, QueryLanguage language, SQLiteKeyStore* defaultKeyStore)
             : Query(dataFile, queryStr, language) {
-            static constexpr const char* kLanguageName[] = {"JSON", "N1QL"};
-            logInfo("Compiling %s query: %.*s", kLanguageName[(int)language], SPLAT(queryStr));
-
-            switch ( language ) {
-                case QueryLanguage::kJSON:
-                    _json = queryStr;
-                    break;
-                case QueryLanguage::kN1QL:
-                    {
-                        int           errPos;
-                        FLMutableDict result = n1ql::parse(string(queryStr), &errPos);
-                        DEFER { FLMutableDict_Release(result); };
-
-                        if ( !result ) {
-                            throw Query::parseError("N1QL syntax error", errPos);
-                        } else if ( !hasKeyCaseEquivalent((MutableDict*)result, "from") ) {
-                            throw error(error::LiteCore, error::InvalidQuery,
-                                        stringprintf("%s", "N1QL error: missing the FROM clause"));
-                        }
-                        _json = ((MutableDict*)result)->toJSON(true);
-                        logVerbose("N1QL query translated to: %.*s", SPLAT(_json));
-                        break;
-                    }
+            // Parsing and translating a query is expensive, and apps compile the same ones repeatedly:
+            string  cacheKey     = QueryCache::keyFor(language, queryStr, defaultKeyStore->tableName());
+            int64_t schemaCookie = dataFile.schemaCookie();
+            _compiled            = dataFile._queryCache->get(cacheKey, schemaCookie);
+            if ( _compiled ) {
+                logInfo("Compiled from cache: %.*s", SPLAT(queryStr));
+            } else {
+                _compiled = compile(dataFile, queryStr, language, defaultKeyStore);
+                dataFile._queryCache->put(cacheKey, schemaCookie, _compiled);
             }
 
-            QueryTranslator qp(dataFile, defaultKeyStore->collectionName(), defaultKeyStore->tableName());
-            qp.parseJSON(_json);
-            string sql = qp.SQL();
-            logInfo("Compiled as %s", sql.c_str());
-
             // Collect the KeyStores read by this query:
-            for ( const string& table : qp.collectionTablesUsed() )
+            for ( const string& table : _compiled->collectionTablesUsed )
                 _keyStores.push_back(&dataFile.keyStoreFromTable(table));
 
-            // Collect the (required) query parameters:
-            _parameters = qp.parameters();
-            for ( auto p = _parameters.begin(); p != _parameters.end(); ) {
-                if ( hasPrefix(*p, "opt_") ) p = _parameters.erase(p);  // Optional param, don't warn if it's unbound
-                else
-                    ++p;
-            }
-
-            // Collect the FTS tables used:
-            _ftsTables = qp.ftsTablesUsed();
-            for ( auto& ftsTable : _ftsTables ) {
-                if ( !dataFile.tableExists(ftsTable) )
-                    error::_throw(error::NoSuchIndex, "'match' test requires a full-text index");
-            }
-
-            LogTo(SQL, "Compiled {Query#%u}: %s", getObjectRef(), sql.c_str());
-            _statement = dataFile.compile(sql.c_str());
-
-            _1stCustomResultColumn = qp.firstCustomResultColumn();
-            _columnTitles          = qp.columnTitles();
+            _parameters            = _compiled->parameters;
+            _ftsTables             = _compiled->ftsTablesUsed;
+            _statement             = _compiled->statement;
+            _1stCustomResultColumn = _compiled->firstCustomResultColumn;
+            LogTo(SQL, "Compiled {Query#%u}: %s", getObjectRef(), _compiled->sql.c_str());
         }
 
         void close() override {
             logInfo("Closing query (db is closing)");
             _statement.reset();
             _matchedTextStatement.reset();
+            _incrementalStatement.reset();
+            _changedRowsStatement.reset();
+            _changedDocIDsStatement.reset();
             Query::close();
         }
 
@@ -165,7 +162,7 @@ namespace litecore {
             return statement()->getColumnCount() - _1stCustomResultColumn;
         }
 
-        const vector<string>& columnTitles() const noexcept override { return _columnTitles; }
+        const vector<string>& columnTitles() const noexcept override { return _compiled->columnTitles; }
 
         const set<string>& parameterNames() const noexcept override { return _parameters; }
 
@@ -183,17 +180,22 @@ namespace litecore {
                 result << " " << x.getColumn(3).getText() << "\n";
             }
 
-            result << '\n' << _json << '\n';
+            result << '\n' << _compiled->json << '\n';
             return result.str();
         }
 
         QueryEnumerator* createEnumerator(const Options* options) override;
 
+        QueryEnumerator* updateEnumerator(QueryEnumerator* previous, const Options* options) override;
+
         shared_ptr<SQLite::Statement> statement() const {
             if ( !_statement ) error::_throw(error::NotOpen);
             return _statement;
         }
 
+        // True if the results can be updated incrementally, by `updateEnumerator`.
+        bool isIncremental() const { return !_compiled->incrementalSQL.query.empty(); }
+
         set<string>    _parameters;             // Names of the bindable parameters
         vector<string> _ftsTables;              // Names of the FTS tables used
         unsigned       _1stCustomResultColumn;  // Column index of the 1st column declared in JSON
@@ -204,29 +206,123 @@ namespace litecore {
         string loggingClassName() const override { return "Query"; }
 
       private:
-        alloc_slice                   _json;                  // Original JSON form of the query
-        shared_ptr<SQLite::Statement> _statement;             // Compiled SQLite statement
-        unique_ptr<SQLite::Statement> _matchedTextStatement;  // Gets the matched text
-        vector<string>                _columnTitles;          // Titles of columns
-        vector<KeyStore*>             _keyStores;
+        // Parses the query, translates it to SQL, and prepares the statement.
+        shared_ptr<CompiledQuery> compile(SQLiteDataFile& dataFile, slice queryStr, QueryLanguage language,
+                                          SQLiteKeyStore* defaultKeyStore) {
+            static constexpr const char* kLanguageName[] = {"JSON", "N1QL"};
+            logInfo("Compiling %s query: %.*s", kLanguageName[(int)language], SPLAT(queryStr));
+
+            auto compiled = make_shared<CompiledQuery>();
+            switch ( language ) {
+                case QueryLanguage::kJSON:
+                    compiled->json = queryStr;
+                    break;
+                case QueryLanguage::kN1QL:
+                    {
+                        int           errPos;
+                        FLMutableDict result = n1ql::parse(string(queryStr), &errPos);
+                        DEFER { FLMutableDict_Release(result); };
+
+                        if ( !result ) {
+                            throw Query::parseError("N1QL syntax error", errPos);
+                        } else if ( !hasKeyCaseEquivalent((MutableDict*)result, "from") ) {
+                            throw error(error::LiteCore, error::InvalidQuery,
+                                        stringprintf("%s", "N1QL error: missing the FROM clause"));
+                        }
+                        compiled->json = ((MutableDict*)result)->toJSON(true);
+                        logVerbose("N1QL query translated to: %.*s", SPLAT(compiled->json));
+                        break;
+                    }
+            }
+
+            QueryTranslator qp(dataFile, defaultKeyStore->collectionName(), defaultKeyStore->tableName());
+            qp.parseJSON(compiled->json);
+            compiled->sql = qp.SQL();
+            logInfo("Compiled as %s", compiled->sql.c_str());
+
+            compiled->collectionTablesUsed = qp.collectionTablesUsed();
+
+            // Collect the (required) query parameters:
+            auto& parameters = compiled->parameters;
+            parameters       = qp.parameters();
+            for ( auto p = parameters.begin(); p != parameters.end(); ) {
+                if ( hasPrefix(*p, "opt_") ) p = parameters.erase(p);  // Optional param, don't warn if it's unbound
+                else
+                    ++p;
+            }
+
+            // Collect the FTS tables used:
+            compiled->ftsTablesUsed = qp.ftsTablesUsed();
+            for ( auto& ftsTable : compiled->ftsTablesUsed ) {
+                if ( !dataFile.tableExists(ftsTable) )
+                    error::_throw(error::NoSuchIndex, "'match' test requires a full-text index");
+            }
+
+            compiled->statement               = dataFile.compile(compiled->sql.c_str());
+            compiled->firstCustomResultColumn = qp.firstCustomResultColumn();
+            compiled->columnTitles            = qp.columnTitles();
+            compiled->incrementalSQL          = qp.incrementalSQL();
+            return compiled;
+        }
+
+        // Compiles the incremental-update statements, the first time they're needed.
+        // Returns false if incremental updates aren't possible on this connection.
+        bool compileIncrementalStatements() {
+            if ( _incrementalStatement ) return true;
+            if ( _incrementalUnavailable ) return false;
+            (void)statement();  // throws NotOpen if the database has been closed
+            auto&       df  = (SQLiteDataFile&)dataFile();
+            const auto& sql = _compiled->incrementalSQL;
+            // Finding the changed docs is only fast with the by-sequence index, which a read-only
+            // connection can't create if it doesn't exist yet:
+            // Deleted docs are found in the collection's deleted-docs table, so it needs one too:
+            try {
+                df.asSQLiteKeyStore(_keyStores[0])->createSequenceIndex();
+                if ( auto both = dynamic_cast<BothKeyStore*>(_keyStores[0]) )
+                    df.asSQLiteKeyStore(both->deadStore())->createSequenceIndex();
+            } catch ( const SQLite::Exception& x ) {
+                if ( x.getErrorCode() != SQLITE_READONLY ) throw;
+                logInfo("Database is read-only, so results will not be updated incrementally");
+                _incrementalUnavailable = true;
+                return false;
+            }
+            LogTo(SQL, "Compiled {Query#%u} incrementally as: %s", getObjectRef(), sql.changedRows.c_str());
+            _incrementalStatement   = df.compile(sql.query.c_str());
+            _changedRowsStatement   = df.compile(sql.changedRows.c_str());
+            _changedDocIDsStatement = make_unique<SQLite::Statement>(df, sql.changedDocIDs, true);
+            return true;
+        }
+
+        shared_ptr<const CompiledQuery> _compiled;                // Translation, shared with the cache
+        shared_ptr<SQLite::Statement>   _statement;               // Compiled SQLite statement
+        unique_ptr<SQLite::Statement>   _matchedTextStatement;    // Gets the matched text
+        vector<KeyStore*>               _keyStores;
+        shared_ptr<SQLite::Statement>   _incrementalStatement;    // Query with doc IDs prepended
+        shared_ptr<SQLite::Statement>   _changedRowsStatement;    // Same, only on changed docs
+        unique_ptr<SQLite::Statement>   _changedDocIDsStatement;  // Gets IDs of changed docs
+        bool                            _incrementalUnavailable{false};  // Sequence index can't be created
     };
 
 #pragma mark - QUERY ENUMERATOR:
 
     // Query enumerator that reads from prerecorded Fleece data (generated by fastForward(), below)
     // Each array item is a row, which is itself an array of column values.
+    // If `hasDocIDs` is true, each row begins with the ID of the doc it came from; this lets
+    // SQLiteQuery::updateEnumerator update the results incrementally.
     class SQLiteQueryEnumerator final
         : public QueryEnumerator
         , Logging {
       public:
         SQLiteQueryEnumerator(SQLiteQuery* query, const Query::Options* options, sequence_t lastSequence,
-                              uint64_t purgeCount, Doc* recording, unsigned long long rowCount, double elapsedTime)
+                              uint64_t purgeCount, Doc* recording, unsigned long long rowCount, double elapsedTime,
+                              bool hasDocIDs = false)
             : QueryEnumerator(options, lastSequence, purgeCount)
             , Logging(QueryLog)
             , _recording(recording)
             , _iter(_recording->asArray())
-            , _1stCustomResultColumn(query->_1stCustomResultColumn)
-            , _hasFullText(!query->_ftsTables.empty()) {
+            , _1stCustomResultColumn(query->_1stCustomResultColumn + hasDocIDs)
+            , _hasFullText(!query->_ftsTables.empty())
+            , _hasDocIDs(hasDocIDs) {
             logInfo("Created on {Query#%u} with %llu rows (%zu bytes) in %.3fms", unsigned(query->getObjectRef()),
                     rowCount, recording->data().size, elapsedTime * 1000);
         }
@@ -299,7 +395,7 @@ namespace litecore {
             auto                              newOptions  = _options.after(_lastSequence).withPurgeCount(_purgeCount);
             auto                              sqliteQuery = (SQLiteQuery*)query;
             unique_ptr<SQLiteQueryEnumerator> newEnum(
-                    (SQLiteQueryEnumerator*)sqliteQuery->createEnumerator(&newOptions));
+                    (SQLiteQueryEnumerator*)sqliteQuery->updateEnumerator(this, &newOptions));
             if ( obsoletedBy(newEnum.get()) ) {
                 // Results have changed, so return new enumerator:
                 return newEnum.release();
@@ -307,34 +403,27 @@ namespace litecore {
             return nullptr;
         }
 
-        QueryEnumerator* clone() override {
-            auto* clon =
-                    new SQLiteQueryEnumerator(&_options, _lastSequence.load(), _purgeCount.load(), _recording.get());
+        QueryEnumerator* clone() override { return cloneWith(&_options, _lastSequence.load(), _purgeCount.load()); }
+
+        // Returns a copy with the same results, but different options and database state.
+        SQLiteQueryEnumerator* cloneWith(const Query::Options* options, sequence_t lastSequence, uint64_t purgeCount) {
+            auto* clon = new SQLiteQueryEnumerator(options, lastSequence, purgeCount, _recording.get());
             clon->_1stCustomResultColumn = this->_1stCustomResultColumn;
             clon->_hasFullText           = this->_hasFullText;
+            clon->_hasDocIDs             = this->_hasDocIDs;
             return clon;
         }
 
+        bool hasDocIDs() const { return _hasDocIDs; }
+
+        const Array* rows() const { return _recording->asArray(); }
+
+        SharedKeys* sharedKeys() const { return _recording->sharedKeys(); }
+
         bool hasFullText() const override { return _hasFullText; }
 
         const FullTextTerms& fullTextTerms() override {
-            _fullTextTerms.clear();
-            uint64_t dataSource = _iter->asArray()->get(kFTSRowidCol)->asInt();
-            if ( kFTSRowidCol < _1stCustomResultColumn ) {
-                // The offsets() function returns a string of space-separated numbers in groups of 4.
-                string      offsets = _iter->asArray()->get(kFTSOffsetsCol)->asString().asString();
-                const char* termStr = offsets.c_str();
-                while ( *termStr ) {
-                    uint32_t n[4];
-                    for ( unsigned int& i : n ) {
-                        char* next;
-                        i       = (uint32_t)strtol(termStr, &next, 10);
-                        termStr = next;
-                    }
-                    _fullTextTerms.push_back({dataSource, n[0], n[1], n[2], n[3]});
-                    // {rowid, key #, term #, byte offset, byte length}
-                }
-            }
+            readFullTextTerms(_iter->asArray(), _1stCustomResultColumn, _fullTextTerms);
             return _fullTextTerms;
         }
 
@@ -353,21 +442,26 @@ namespace litecore {
         Array::iterator _iter;
         unsigned        _1stCustomResultColumn{0};  // Column index of the 1st column declared in JSON
         bool            _hasFullText{false};
+        bool            _hasDocIDs{false};  // Does each row begin with a doc ID?
         bool            _first{true};
     };
 
     // Reads from 'live' SQLite statement and records the results into a Fleece array,
     // which is then used as the data source of a SQLiteQueryEnum.
+    // (A streaming enumerator instead uses it to encode one row at a time, with its own statement.)
     class SQLiteQueryRunner {
       public:
         SQLiteQueryRunner(SQLiteQuery* query, const Query::Options* options, sequence_t lastSequence,
-                          uint64_t purgeCount)
+                          uint64_t purgeCount, shared_ptr<SQLite::Statement> statement = nullptr,
+                          bool prependsDocID = false)
             : _query(query)
             , _options(options ? *options : Query::Options())
             , _lastSequence(lastSequence)
             , _purgeCount(purgeCount)
-            , _statement(query->statement())
-            , _sk(query->dataFile().documentKeys()) {
+            , _statement(statement ? std::move(statement) : query->statement())
+            , _sk(query->dataFile().documentKeys())
+            , _1stCustomResultColumn(query->_1stCustomResultColumn + prependsDocID)
+            , _prependsDocID(prependsDocID) {
             _statement->clearBindings();
             _unboundParameters = query->_parameters;
             if ( options && options->paramBindings.buf ) bindParameters(options->paramBindings);
@@ -445,7 +539,7 @@ namespace litecore {
                     break;
                 case SQLITE_BLOB:
                     {
-                        if ( i >= _query->_1stCustomResultColumn ) {
+                        if ( i >= _1stCustomResultColumn ) {
                             slice fleeceData{col.getBlob(), (size_t)col.getBytes()};
                             if ( fleeceData.empty() ) {
                                 enc.writeNull();
@@ -468,11 +562,30 @@ namespace litecore {
             return true;
         }
 
+        // Steps the statement to the next row; returns false at the end.
+        bool step() { return _statement->executeStep(); }
+
+        // Encodes the current row as an array of column values, and returns a bit-map of which
+        // of the custom columns are missing/undefined.
+        uint64_t encodeRow(Encoder& enc) {
+            int      nCols          = _statement->getColumnCount();
+            auto     firstCustomCol = _1stCustomResultColumn;
+            uint64_t missingCols    = 0;
+            enc.beginArray(nCols);
+            for ( int i = 0; i < nCols; ++i ) {
+                int64_t offsetColumn = i - firstCustomCol;
+                if ( !encodeColumn(enc, i) && offsetColumn >= 0 && offsetColumn < 64 ) {
+                    missingCols |= (1ULL << offsetColumn);
+                }
+            }
+            enc.endArray();
+            return missingCols;
+        }
+
         // Collects all the (remaining) rows into a Fleece array of arrays,
         // and returns an enumerator impl that will replay them.
         SQLiteQueryEnumerator* fastForward() {
             fleece::Stopwatch st;
-            int               nCols    = _statement->getColumnCount();
             uint64_t          rowCount = 0;
             // Give this encoder its own SharedKeys instead of using the database's DocumentKeys,
             // because the query results might include dicts with new keys that aren't in the
@@ -482,19 +595,15 @@ namespace litecore {
             enc.setSharedKeys(sk);
             enc.beginArray();
 
+            // SQL functions reuse the encoder and buffers in here instead of allocating their own:
+            QueryScratch      scratch;
+            QueryScratch::Use useScratch(scratch);
+
             unicodesn_tokenizerRunningQuery(true);
             try {
-                auto firstCustomCol = _query->_1stCustomResultColumn;
-                while ( _statement->executeStep() ) {
-                    uint64_t missingCols = 0;
-                    enc.beginArray(nCols);
-                    for ( int i = 0; i < nCols; ++i ) {
-                        int64_t offsetColumn = i - firstCustomCol;
-                        if ( !encodeColumn(enc, i) && offsetColumn >= 0 && offsetColumn < 64 ) {
-                            missingCols |= (1ULL << offsetColumn);
-                        }
-                    }
-                    enc.endArray();
+                while ( step() ) {
+                    scratch.reset();
+                    uint64_t missingCols = encodeRow(enc);
                     // Add an integer containing a bit-map of which columns are missing/undefined:
                     enc.writeUInt(missingCols);
                     ++rowCount;
@@ -507,7 +616,75 @@ namespace litecore {
 
             enc.endArray();
             return new SQLiteQueryEnumerator(_query, &_options, _lastSequence, _purgeCount, enc.finishDoc().get(),
-                                             rowCount, st.elapsed());
+                                             rowCount, st.elapsed(), _prependsDocID);
+        }
+
+        // Updates the results of `previous`, whose rows begin with doc IDs, given the IDs of the docs
+        // that changed since then. My statement must be the query's `changedRows` statement, which
+        // returns at most one row per doc. Each changed doc's old row is replaced in place by its
+        // new row, or removed if it has none; rows of newly matching docs are appended. An ordered
+        // query's rows can't be placed that way, so in that case this returns null unless the
+        // results are unchanged.
+        SQLiteQueryEnumerator* update(SQLiteQueryEnumerator* previous, const unordered_set<slice>& changedDocIDs,
+                                      bool ordered) {
+            fleece::Stopwatch st;
+            auto docIDOf = [](const Value* row) { return row->asArray()->get(0)->asString(); };
+
+            _statement->bind(QueryTranslator::kChangedSinceParameter, (long long)previous->lastSequence());
+
+            // Record the changed docs' new rows, using the previous results' SharedKeys so that
+            // all the rows can be copied into the new results as-is:
+            Encoder enc;
+            enc.setSharedKeys(previous->sharedKeys());
+            enc.beginArray();
+            uint64_t newRowCount = 0;
+            {
+                QueryScratch      scratch;
+                QueryScratch::Use useScratch(scratch);
+                unicodesn_tokenizerRunningQuery(true);
+                DEFER { unicodesn_tokenizerRunningQuery(false); };
+                while ( step() ) {
+                    scratch.reset();
+                    uint64_t missingCols = encodeRow(enc);
+                    enc.writeUInt(missingCols);
+                    ++newRowCount;
+                }
+            }
+            enc.endArray();
+            Retained<Doc> newRows = enc.finishDoc();
+
+            bool changed = newRowCount > 0;
+            for ( Array::iterator i(previous->rows()); i && !changed; i += 2 )
+                changed = changedDocIDs.count(docIDOf(i[0u])) > 0;
+            if ( !changed ) return previous->cloneWith(&_options, _lastSequence, _purgeCount);
+            if ( ordered ) return nullptr;
+
+            unordered_map<slice, Array::iterator> newRowsByDocID;
+            for ( Array::iterator i(newRows->asArray()); i; i += 2 ) newRowsByDocID.emplace(docIDOf(i[0u]), i);
+
+            // (The encoder was reset by finishDoc, keeping its SharedKeys.)
+            enc.beginArray();
+            uint64_t rowCount = 0;
+            auto     writeRow = [&](const Array::iterator& i) {
+                enc.writeValue(i[0u]);
+                enc.writeValue(i[1u]);
+                ++rowCount;
+            };
+            for ( Array::iterator i(previous->rows()); i; i += 2 ) {
+                slice docID = docIDOf(i[0u]);
+                if ( !changedDocIDs.count(docID) ) {
+                    writeRow(i);
+                } else if ( auto n = newRowsByDocID.find(docID); n != newRowsByDocID.end() ) {
+                    writeRow(n->second);
+                    newRowsByDocID.erase(n);
+                }
+            }
+            for ( Array::iterator i(newRows->asArray()); i; i += 2 ) {
+                if ( newRowsByDocID.count(docIDOf(i[0u])) ) writeRow(i);
+            }
+            enc.endArray();
+            return new SQLiteQueryEnumerator(_query, &_options, _lastSequence, _purgeCount, enc.finishDoc().get(),
+                                             rowCount, st.elapsed(), true);
         }
 
       private:
@@ -518,6 +695,117 @@ namespace litecore {
         shared_ptr<SQLite::Statement> _statement;
         set<string>                   _unboundParameters;
         SharedKeys*                   _sk;
+        unsigned                      _1stCustomResultColumn;  // Column index of the 1st column declared in JSON
+        bool                          _prependsDocID;          // Does the statement prepend a doc ID column?
+    };
+
+#pragma mark - STREAMING QUERY ENUMERATOR:
+
+    // Query enumerator that steps its SQLite statement as it's iterated, encoding only the current
+    // row, so it doesn't hold the whole result set in memory. The pending statement keeps a read
+    // transaction open until the enumerator reaches the end or is deleted.
+    class SQLiteStreamingQueryEnumerator final
+        : public QueryEnumerator
+        , Logging {
+      public:
+        SQLiteStreamingQueryEnumerator(SQLiteQuery* query, const Query::Options* options, sequence_t lastSequence,
+                                       uint64_t purgeCount, shared_ptr<SQLite::Statement> statement)
+            : QueryEnumerator(options, lastSequence, purgeCount)
+            , Logging(QueryLog)
+            , _query(query)
+            , _runner(make_unique<SQLiteQueryRunner>(query, options, lastSequence, purgeCount, std::move(statement)))
+            , _1stCustomResultColumn(query->_1stCustomResultColumn)
+            , _hasFullText(!query->_ftsTables.empty()) {
+            // As in fastForward(), use separate SharedKeys in case the results contain new keys:
+            _encoder.setSharedKeys(_sharedKeys);
+            // Read the first row now, while the caller's read transaction is open, so the
+            // statement's own read transaction sees the same data as lastSequence and purgeCount:
+            fleece::Stopwatch st;
+            step();
+            logInfo("Created on {Query#%u}, streaming; first row in %.3fms", unsigned(query->getObjectRef()),
+                    st.elapsed() * 1000);
+        }
+
+        ~SQLiteStreamingQueryEnumerator() override { logInfo("Deleted after %llu rows", _rowCount); }
+
+        bool next() override {
+            if ( _first ) _first = false;
+            else if ( _runner )
+                step();
+            if ( !_row ) {
+                logVerbose("END");
+                return false;
+            }
+            if ( willLog(LogLevel::Verbose) ) {
+                alloc_slice json = _row->asArray()->toJSON();
+                logVerbose("--> %.*s", SPLAT(json));
+            }
+            return true;
+        }
+
+        Array::iterator columns() const noexcept override {
+            Array::iterator i(_row->asArray());
+            i += _1stCustomResultColumn;
+            return i;
+        }
+
+        uint64_t missingColumns() const noexcept override { return _missingColumns; }
+
+        bool hasFullText() const override { return _hasFullText; }
+
+        const FullTextTerms& fullTextTerms() override {
+            readFullTextTerms(_row->asArray(), _1stCustomResultColumn, _fullTextTerms);
+            return _fullTextTerms;
+        }
+
+        // A streaming enumerator has no recording to count, compare or replay:
+
+        int64_t getRowCount() const override { unsupported(); }
+
+        bool obsoletedBy(const QueryEnumerator*) override { unsupported(); }
+
+        QueryEnumerator* refresh(Query*) override { unsupported(); }
+
+        QueryEnumerator* clone() override { unsupported(); }
+
+      protected:
+        string loggingClassName() const override { return "QueryEnum"; }
+
+      private:
+        [[noreturn]] static void unsupported() {
+            error::_throw(error::UnsupportedOperation, "Not supported by a streaming query enumerator");
+        }
+
+        // Steps the statement and encodes the new row into `_row`, or sets it to null at the end.
+        void step() {
+            (void)_query->dataFile();  // throws NotOpen if the database has been closed
+            QueryScratch::Use useScratch(_scratch);
+            _scratch.reset();
+            unicodesn_tokenizerRunningQuery(true);
+            DEFER { unicodesn_tokenizerRunningQuery(false); };
+            if ( _runner->step() ) {
+                _missingColumns = _runner->encodeRow(_encoder);
+                _row            = _encoder.finishDoc();
+                ++_rowCount;
+            } else {
+                // Reset the statement right away, ending its read transaction:
+                _row            = nullptr;
+                _missingColumns = 0;
+                _runner.reset();
+            }
+        }
+
+        Retained<SQLiteQuery>         _query;
+        unique_ptr<SQLiteQueryRunner> _runner;  // Owns the statement; null once it's finished
+        Retained<SharedKeys>          _sharedKeys{new SharedKeys};
+        Encoder                       _encoder;
+        QueryScratch                  _scratch;
+        Retained<Doc>                 _row;  // The current row (an array of columns)
+        uint64_t                      _missingColumns{0};
+        unsigned long long            _rowCount{0};
+        unsigned                      _1stCustomResultColumn;  // Column index of the 1st column declared in JSON
+        bool                          _hasFullText;
+        bool                          _first{true};
     };
 
     // The factory method that creates a SQLite Query.
@@ -526,9 +814,12 @@ namespace litecore {
         return new SQLiteQuery(*this, selectorExpression, language, asSQLiteKeyStore(keyStore));
     }
 
+    DataFile::QueryCacheStats SQLiteDataFile::queryCacheStats() const { return _queryCache->stats(); }
+
     // The factory method that creates a SQLite QueryEnumerator, but only if the database has
     // changed since lastSeq.
     QueryEnumerator* SQLiteQuery::createEnumerator(const Options* options) {
+        Signpost signpost(Signpost::queryRun, uintptr_t(this));
         // Start a read-only transaction, to ensure that the result of lastSequence() and purgeCount() will be
         // consistent with the query results.
         ReadOnlyTransaction t(dataFile());
@@ -536,8 +827,61 @@ namespace litecore {
         sequence_t curSeq   = lastSequence();
         uint64_t   purgeCnt = purgeCount();
         if ( options && options->notOlderThan(curSeq, purgeCnt) ) return nullptr;
+        if ( options && options->streaming ) {
+            // A streaming enumerator is stepped long after this returns, so it needs its own
+            // statement rather than sharing mine with other enumerators:
+            shared_ptr<SQLite::Statement> stmt = ((SQLiteDataFile&)dataFile()).compile(statement()->getQuery().c_str());
+            return new SQLiteStreamingQueryEnumerator(this, options, curSeq, purgeCnt, std::move(stmt));
+        }
         SQLiteQueryRunner recorder(this, options, curSeq, purgeCnt);
         return recorder.fastForward();
     }
 
+    // If more docs than this have changed, it's faster to run the whole query again than to update
+    // its results incrementally.
+    static constexpr size_t kMaxIncrementalChanges = 1000;
+
+    // Like createEnumerator, but if possible, computes the new results from the previous ones by
+    // re-running the query only on the docs that changed since then.
+    QueryEnumerator* SQLiteQuery::updateEnumerator(QueryEnumerator* previousE, const Options* options) {
+        auto previous = dynamic_cast<SQLiteQueryEnumerator*>(previousE);
+        if ( !isIncremental() || (options && options->streaming) || (previousE && !previous)
+             || (previous && !previous->hasDocIDs()) )
+            return createEnumerator(options);
+
+        if ( !compileIncrementalStatements() ) return createEnumerator(options);
+
+        Signpost            signpost(Signpost::queryRun, uintptr_t(this));
+        ReadOnlyTransaction t(dataFile());
+
+        sequence_t curSeq   = lastSequence();
+        uint64_t   purgeCnt = purgeCount();
+        if ( options && options->notOlderThan(curSeq, purgeCnt) ) return nullptr;
+
+        // A purge leaves no trace in the sequences, and different parameters mean different results:
+        alloc_slice bindings = options ? options->paramBindings : nullslice;
+        if ( previous && previous->purgeCount() == purgeCnt && previous->lastSequence() <= curSeq
+             && previous->options().paramBindings == bindings ) {
+            // Find the docs that changed since the previous results, including deleted ones:
+            vector<alloc_slice> changedDocIDs;
+            _changedDocIDsStatement->bind(QueryTranslator::kChangedSinceParameter,
+                                          (long long)previous->lastSequence());
+            DEFER { _changedDocIDsStatement->reset(); };
+            while ( changedDocIDs.size() <= kMaxIncrementalChanges && _changedDocIDsStatement->executeStep() )
+                changedDocIDs.emplace_back(getColumnAsSlice(*_changedDocIDsStatement, 0));
+
+            if ( changedDocIDs.size() <= kMaxIncrementalChanges ) {
+                unordered_set<slice> changed(changedDocIDs.begin(), changedDocIDs.end());
+                SQLiteQueryRunner    updater(this, options, curSeq, purgeCnt, _changedRowsStatement, true);
+                if ( auto e = updater.update(previous, changed, _compiled->incrementalSQL.ordered) ) {
+                    logVerbose("Updated results incrementally from %zu changed docs", changed.size());
+                    return e;
+                }
+                logVerbose("Changes affect the order of the results; re-running the whole query");
+            }
+        }
+        SQLiteQueryRunner recorder(this, options, curSeq, purgeCnt, _incrementalStatement, true);
+        return recorder.fastForward();
+    }
+
 }  // namespace litecore
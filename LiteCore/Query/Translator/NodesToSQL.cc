@@ -12,6 +12,7 @@
 
 #include "SQLWriter.hh"
 #include "ExprNodes.hh"
+#include "QueryTranslator.hh"
 #include "IndexedNodes.hh"
 #include "SelectNodes.hh"
 #include "Delimiter.hh"
@@ -380,6 +381,7 @@ namespace litecore::qt {
             delimiter comma(", ");
             // Write extra columns used for FTS
             writeFTSColumns(ctx, comma);
+            if ( ctx.prependDocID ) ctx << comma << sqlIdentifier(from()->alias()) << ".key";
             // ...before the actual columns:
             for ( WhatNode* what : _what ) ctx << comma << what;
         }
@@ -388,7 +390,13 @@ namespace litecore::qt {
         for ( SourceNode* join : _sources )
             if ( join->isJoin() || join->type() == SourceType::unnest ) ctx << ' ' << join;
 
-        if ( _where ) ctx << " WHERE " << _where;
+        if ( ctx.onlyChangedDocs ) {
+            ctx << " WHERE " << sqlIdentifier(from()->alias()) << ".sequence > "
+                << QueryTranslator::kChangedSinceParameter;
+            if ( _where ) ctx << " AND (" << _where << ')';
+        } else if ( _where ) {
+            ctx << " WHERE " << _where;
+        }
 
         if ( !_groupBy.empty() ) {
             ctx << " GROUP BY ";
@@ -83,6 +83,43 @@ namespace litecore {
 
         // Finally, generate the SQL:
         _sql = writeSQL([&](SQLWriter& writer) { query->writeSQL(writer); });
+        if ( isIncremental(query) ) writeIncrementalSQL(query);
+    }
+
+    bool QueryTranslator::isIncremental(SelectNode* query) const {
+        SourceNode* from = query->from();
+        if ( query->sources().size() != 1 || !from->isCollection() || from->usesDeletedDocs()
+             || from->tableName().empty() || query->isAggregate() || query->limit() || query->offset()
+             || query->numPrependedColumns() > 0 || _usesExpiration )
+            return false;
+        // A subquery could make a row depend on other documents:
+        bool hasSubquery = false;
+        query->visitTree([&](Node& node, unsigned /*depth*/) {
+            if ( &node != query && dynamic_cast<SelectNode*>(&node) ) hasSubquery = true;
+        });
+        return !hasSubquery;
+    }
+
+    void QueryTranslator::writeIncrementalSQL(SelectNode* query) {
+        _incrementalSQL.query = writeSQL([&](SQLWriter& writer) {
+            writer.prependDocID = true;
+            query->writeSQL(writer);
+        });
+        _incrementalSQL.changedRows = writeSQL([&](SQLWriter& writer) {
+            writer.prependDocID    = true;
+            writer.onlyChangedDocs = true;
+            query->writeSQL(writer);
+        });
+
+        // Docs that were deleted or purged may be in the deleted-docs table, or gone entirely:
+        string collection = collectionPathForSource(query->from());
+        string condition  = CONCAT(" WHERE sequence > " << kChangedSinceParameter);
+        string sql        = CONCAT("SELECT key FROM " << sqlIdentifier(query->from()->tableName()) << condition);
+        string delTable   = _delegate.collectionTableName(collection, kDeletedDocs);
+        if ( _delegate.tableExists(delTable) )
+            sql += CONCAT(" UNION ALL SELECT key FROM " << sqlIdentifier(delTable) << condition);
+        _incrementalSQL.changedDocIDs = std::move(sql);
+        _incrementalSQL.ordered       = !query->orderBy().empty();
     }
 
     void QueryTranslator::parseJSON(slice json) {
@@ -136,9 +173,7 @@ namespace litecore {
             _hashedTables.emplace(tableName, plainTableName);
             if ( _delegate.tableExists(tableName) ) source->setTableName(ctx.newString(tableName));
         } else {
-            string name(source->collection());
-            if ( name.empty() ) name = _defaultCollectionName;
-            if ( !source->scope().empty() ) name = string(source->scope()) + "." + name;
+            string name = collectionPathForSource(source);
 
             DeletionStatus delStatus = source->usesDeletedDocs() ? kLiveAndDeletedDocs : kLiveDocs;
             //FIXME: Support kDeletedDocs
@@ -178,11 +213,18 @@ namespace litecore {
         return tableName;
     }
 
+    string QueryTranslator::collectionPathForSource(SourceNode* source) const {
+        string name(source->collection());
+        if ( name.empty() ) name = _defaultCollectionName;
+        if ( !source->scope().empty() ) name = string(source->scope()) + "." + name;
+        return name;
+    }
+
 #pragma mark - INDEX CREATION:
 
     void QueryTranslator::writeCreateIndex(const string& indexName, const string& onTableName,
                                            FLArrayIterator& whatExpressions, FLArray whereClause,
-                                           bool isUnnestedTable) {
+                                           bool isUnnestedTable, FLArray includeExpressions) {
         _sql = writeSQL([&](SQLWriter& writer) {
             RootContext ctx = makeRootContext();
 
@@ -192,28 +234,37 @@ namespace litecore {
                 ctx.from = source;
             }
 
+            auto parseItem = [&](Value item) {
+                ExprNode* node;
+                if ( item.asString() ) {
+                    // If an index item is a string, wrap it in an array:
+                    auto a = MutableArray::newArray();
+                    a.append(item);
+                    node = ExprNode::parse(a, ctx);
+                } else {
+                    node = ExprNode::parse(item, ctx);
+                }
+                node->postprocess(ctx);
+                return node;
+            };
+
             writer << "CREATE INDEX " << sqlIdentifier(indexName) << " ON " << sqlIdentifier(onTableName) << " (";
             Array::iterator i(whatExpressions);
             if ( i.count() > 0 ) {
                 delimiter comma(", ");
-                for ( ; i; ++i ) {
-                    ExprNode* node;
-                    if ( Value item = i.value(); item.asString() ) {
-                        // If an index item is a string, wrap it in an array:
-                        auto a = MutableArray::newArray();
-                        a.append(item);
-                        node = ExprNode::parse(a, ctx);
-                    } else {
-                        node = ExprNode::parse(i.value(), ctx);
-                    }
-                    node->postprocess(ctx);
-                    writer << comma << *node;
-                }
+                for ( ; i; ++i ) writer << comma << *parseItem(i.value());
             } else {
                 // No expressions; index the entire body (this is used with unnested/array tables):
                 Assert(isUnnestedTable);
                 writer << kUnnestedValueFnName << "(" << _bodyColumnName << ")";
             }
+            if ( includeExpressions && !isUnnestedTable ) {
+                for ( Array::iterator j(includeExpressions); j; ++j )
+                    writer << ", " << *new (ctx) WhatNode(parseItem(j.value()));
+                // Queries on the default collection also test the `flags` column, to skip deleted docs.
+                // Storing it too lets the index cover those queries.
+                writer << ", flags";
+            }
             writer << ')';
             if ( whereClause && !isUnnestedTable ) {
                 auto where = ExprNode::parse(Array(whereClause), ctx);
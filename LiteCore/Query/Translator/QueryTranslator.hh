@@ -25,6 +25,7 @@ namespace litecore {
         class Node;
         struct ParseContext;
         struct RootContext;
+        class SelectNode;
         class SourceNode;
         class SQLWriter;
     }  // namespace qt
@@ -89,6 +90,25 @@ namespace litecore {
         /// True if this query references the `meta().expiration` property.
         bool usesExpiration() const { return _usesExpiration; }
 
+        /// The SQL parameter giving the sequence after which `IncrementalSQL::changedRows` and
+        /// `IncrementalSQL::changedDocIDs` look for changes.
+        static constexpr const char* kChangedSinceParameter = "$changedSince";
+
+        /// SQL statements for updating a query's results incrementally, by re-evaluating it only
+        /// on the documents that changed since it last ran.
+        struct IncrementalSQL {
+            string query;          ///< The query, with the doc ID prepended as an extra result column
+            string changedRows;    ///< Same, but only for docs changed since `kChangedSinceParameter`
+            string changedDocIDs;  ///< The IDs of all docs, even deleted ones, changed since then
+            bool   ordered{};      ///< True if the query has an ORDER BY clause
+        };
+
+        /// If each result row of the query depends only on one document -- it reads a single
+        /// collection, without joins, UNNEST, subqueries, full-text or vector search, aggregates,
+        /// LIMIT or OFFSET -- these are the statements that update its results incrementally.
+        /// Otherwise they're empty. Available after `parse` or `parseJSON` is called.
+        const IncrementalSQL& incrementalSQL() const { return _incrementalSQL; }
+
         /// Translates an expression (parsed from JSON) to SQL and returns it directly.
         string expressionSQL(FLValue);
 
@@ -99,8 +119,12 @@ namespace litecore {
         void setBodyColumnName(string name) { _bodyColumnName = std::move(name); }
 
         /// Writes a CREATE INDEX statement.
+        /// `includeExpressions` become extra columns after the indexed ones. Each is written the
+        /// way a query writes it as a result column, so SQLite can read a query's results from the
+        /// index instead of evaluating them against the document body.
         void writeCreateIndex(const string& indexName, const string& onTableName, FLArrayIterator& whatExpressions,
-                              FLArray C4NULLABLE whereClause, bool isUnnestedTable);
+                              FLArray C4NULLABLE whereClause, bool isUnnestedTable,
+                              FLArray C4NULLABLE includeExpressions = nullptr);
 
         /// Returns a WHERE clause.
         /// @param  expr  The parsed JSON expression
@@ -126,6 +150,9 @@ namespace litecore {
         QueryTranslator(const QueryTranslator& qp)         = delete;
         QueryTranslator& operator=(const QueryTranslator&) = delete;
         string           tableNameForSource(qt::SourceNode*, qt::ParseContext&);
+        string           collectionPathForSource(qt::SourceNode*) const;
+        bool             isIncremental(qt::SelectNode*) const;
+        void             writeIncrementalSQL(qt::SelectNode*);
         void             assignTableNameToSource(qt::SourceNode*, qt::ParseContext&);
         string           writeSQL(function_ref<void(qt::SQLWriter&)>);
         string           functionCallSQL(slice fnName, FLValue arg, FLValue C4NULLABLE param = nullptr);
@@ -143,6 +170,7 @@ namespace litecore {
         std::vector<string>                _columnTitles;           // Pretty names of result columns
         std::unordered_map<string, string> _hashedTables;    // hexName(tableName) -> tableName. Used for Unnest tables.
         string                             _bodyColumnName;  // Name of the `body` column
+        IncrementalSQL                     _incrementalSQL;  // SQL for incremental updates, if possible
         bool                               _isAggregateQuery{false};  // Is this an aggregate query?
         bool                               _usesExpiration{false};    // Has query accessed _expiration meta-property?
     };
@@ -53,6 +53,14 @@ namespace litecore::qt {
         /// usually when generating SQL for triggers.
         string bodyColumnName = "body";
 
+        /// If true, a SELECT prepends its main source's document ID as an extra result column.
+        /// Used for queries whose results are updated incrementally.
+        bool prependDocID = false;
+
+        /// If true, a SELECT only includes documents whose sequence is greater than the parameter
+        /// `QueryTranslator::kChangedSinceParameter`.
+        bool onlyChangedDocs = false;
+
       private:
         friend class WithPrecedence;
         std::ostream& _out;             // Output stream
@@ -169,9 +169,15 @@ namespace litecore::qt {
         /// The WHERE clause.
         ExprNode* C4NULLABLE where() const { return _where; }
 
+        /// The ORDER BY expressions.
+        List<ExprNode> const& orderBy() const { return _orderBy; }
+
         /// The LIMIT clause.
         ExprNode* C4NULLABLE limit() const { return _limit; }
 
+        /// The OFFSET clause.
+        ExprNode* C4NULLABLE offset() const { return _offset; }
+
         /// True if the query uses aggregate functions, `GROUP BY` or `DISTINCT`.
         /// Set during postprocessing.
         bool isAggregate() const { return _isAggregate; }
@@ -0,0 +1,226 @@
+//
+// BodyCompressor.cc
+//
+// Copyright 2026-Present Couchbase, Inc.
+//
+// Use of this software is governed by the Business Source License included
+// in the file licenses/BSL-Couchbase.txt.  As of the Change Date specified
+// in that file, in accordance with the Business Source License, use of this
+// software will be governed by the Apache License, Version 2.0, included in
+// the file licenses/APL2.txt.
+//
+
+
+// For zlib API documentation, see: https://zlib.net/manual.html
+
+
+#include "BodyCompressor.hh"
+#include "Error.hh"
+#include "slice_stream.hh"
+#include <algorithm>
+#include <cstring>
+#include <optional>
+#include <queue>
+#include <unordered_set>
+
+namespace litecore {
+    using namespace std;
+    using namespace fleece;
+
+    // Raw deflate format (no zlib header or checksum), with the maximum 32KB window.
+    static constexpr int kZlibWindowBits = -15;
+
+    // Max size of a compressed body's header: the magic byte and two varints.
+    static constexpr size_t kMaxHeaderSize = 1 + 5 + 10;
+
+#pragma mark - DICTIONARY TRAINING:
+
+    // This is a simplified version of zstd's "COVER" dictionary builder. It counts how many samples
+    // contain each k-byte substring ("k-mer"), then scores fixed-size segments of the samples by the
+    // counts of the k-mers in them. It takes the best segments greedily, zeroing the counts of the
+    // k-mers in each one it takes, so that later segments don't repeat what's already there.
+
+    static constexpr size_t kKmerSize    = 8;
+    static constexpr size_t kSegmentSize = 64;
+
+    static inline uint64_t kmerAt(const void* p) {
+        uint64_t kmer;
+        memcpy(&kmer, p, kKmerSize);
+        return kmer;
+    }
+
+    alloc_slice BodyCompressor::trainDictionary(const vector<alloc_slice>& samples, size_t maxSize) {
+        unordered_map<uint64_t, uint32_t> counts;
+        for ( auto& sample : samples ) {
+            unordered_set<uint64_t> seen;
+            for ( size_t i = 0; i + kKmerSize <= sample.size; ++i ) {
+                if ( uint64_t kmer = kmerAt(&sample[i]); seen.insert(kmer).second ) ++counts[kmer];
+            }
+        }
+
+        // A segment's score is the total count of its k-mers that occur in more than one sample:
+        auto score = [&](slice segment) {
+            uint64_t total = 0;
+            for ( size_t i = 0; i + kKmerSize <= segment.size; ++i ) {
+                if ( auto c = counts.find(kmerAt(&segment[i])); c != counts.end() && c->second > 1 )
+                    total += c->second;
+            }
+            return total;
+        };
+
+        using Candidate = pair<uint64_t, slice>;  // score, segment
+        auto lessThan   = [](const Candidate& a, const Candidate& b) { return a.first < b.first; };
+        priority_queue<Candidate, vector<Candidate>, decltype(lessThan)> candidates(lessThan);
+        for ( auto& sample : samples ) {
+            for ( size_t pos = 0; pos < sample.size; pos += kSegmentSize ) {
+                slice segment(&sample[pos], min(kSegmentSize, sample.size - pos));
+                if ( uint64_t s = score(segment); s > 0 ) candidates.emplace(s, segment);
+            }
+        }
+
+        vector<slice> chosen;
+        size_t        size = 0;
+        while ( !candidates.empty() && size < maxSize ) {
+            auto [oldScore, segment] = candidates.top();
+            candidates.pop();
+            // Taking other segments may have lowered this one's score; if so, re-queue it:
+            uint64_t newScore = score(segment);
+            if ( newScore == 0 ) continue;
+            if ( newScore < oldScore && !candidates.empty() && newScore < candidates.top().first ) {
+                candidates.emplace(newScore, segment);
+                continue;
+            }
+            segment = slice(segment.buf, min(segment.size, maxSize - size));
+            chosen.push_back(segment);
+            size += segment.size;
+            for ( size_t i = 0; i + kKmerSize <= segment.size; ++i ) {
+                if ( auto c = counts.find(kmerAt(&segment[i])); c != counts.end() ) c->second = 0;
+            }
+        }
+        if ( size == 0 ) return nullslice;
+
+        // Deflate encodes matches near the end of the dictionary most cheaply, so the best segments go last:
+        alloc_slice dictionary(size);
+        auto        dst = (uint8_t*)dictionary.buf + size;
+        for ( slice segment : chosen ) {
+            dst -= segment.size;
+            memcpy(dst, segment.buf, segment.size);
+        }
+        return dictionary;
+    }
+
+#pragma mark - COMPRESSION:
+
+    BodyCompressor::BodyCompressor(size_t minSize, uint32_t dictionaryID, alloc_slice dictionary)
+        : _minSize(minSize), _dictionaryID(dictionaryID), _dictionary(std::move(dictionary)) {
+        if ( ::deflateInit2(&_z, Z_DEFAULT_COMPRESSION, Z_DEFLATED, kZlibWindowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK )
+            error::_throw(error::MemoryError);
+    }
+
+    BodyCompressor::~BodyCompressor() { ::deflateEnd(&_z); }
+
+    alloc_slice BodyCompressor::compress(slice body) {
+        if ( body.size < _minSize ) return nullslice;
+
+        // Resetting the deflate state is much cheaper than creating a new one for every body:
+        ::deflateReset(&_z);
+        if ( _dictionary ) ::deflateSetDictionary(&_z, (const Bytef*)_dictionary.buf, (uInt)_dictionary.size);
+
+        alloc_slice   result(kMaxHeaderSize + ::deflateBound(&_z, (uLong)body.size));
+        slice_ostream out(result);
+        out.writeByte(kMagic);
+        out.writeUVarInt(_dictionaryID);
+        out.writeUVarInt(body.size);
+
+        _z.next_in   = (Bytef*)body.buf;
+        _z.avail_in  = (uInt)body.size;
+        _z.next_out  = (Bytef*)out.next();
+        _z.avail_out = (uInt)out.capacity();
+        if ( int rc = ::deflate(&_z, Z_FINISH); rc != Z_STREAM_END )
+            error::_throw(error::UnexpectedError, "BodyCompressor: zlib deflate error %d", rc);
+
+        size_t size = (uint8_t*)_z.next_out - (uint8_t*)result.buf;
+        if ( size >= body.size ) return nullslice;
+        result.shorten(size);
+        return result;
+    }
+
+#pragma mark - DECOMPRESSION:
+
+    BodyCompressor::Header BodyCompressor::readHeader(slice compressed) {
+        slice_istream      in(compressed);
+        optional<uint64_t> dictionaryID, size;
+        if ( in.readByte() == kMagic ) {
+            dictionaryID = in.readUVarInt();
+            size         = in.readUVarInt();
+        }
+        if ( !dictionaryID || !size || *dictionaryID > UINT32_MAX )
+            error::_throw(error::CorruptRevisionData, "Invalid compressed body");
+        return {uint32_t(*dictionaryID), size_t(*size), in};
+    }
+
+    void BodyCompressor::decompress(const Header& header, slice dictionary, void* output) {
+        // Each thread keeps an inflate state, since creating one for every body is expensive:
+        struct Inflater {
+            Inflater() { ok = (::inflateInit2(&z, kZlibWindowBits) == Z_OK); }
+
+            ~Inflater() {
+                if ( ok ) ::inflateEnd(&z);
+            }
+
+            ::z_stream z{};
+            bool       ok;
+        };
+
+        static thread_local Inflater tInflater;
+        if ( !tInflater.ok ) error::_throw(error::MemoryError);
+
+        ::z_stream& z = tInflater.z;
+        ::inflateReset(&z);
+        if ( dictionary ) ::inflateSetDictionary(&z, (const Bytef*)dictionary.buf, (uInt)dictionary.size);
+        z.next_in   = (Bytef*)header.data.buf;
+        z.avail_in  = (uInt)header.data.size;
+        z.next_out  = (Bytef*)output;
+        z.avail_out = (uInt)header.size;
+        if ( int rc = ::inflate(&z, Z_FINISH); rc != Z_STREAM_END || z.avail_out != 0 )
+            error::_throw(error::CorruptRevisionData, "Invalid compressed body (zlib inflate error %d)", rc);
+    }
+
+    alloc_slice BodyDictionaries::get(uint32_t dictionaryID) {
+        lock_guard<mutex> lock(_mutex);
+        auto              i = _dictionaries.find(dictionaryID);
+        if ( i == _dictionaries.end() ) {
+            alloc_slice dictionary = _loader(dictionaryID);
+            if ( !dictionary )
+                error::_throw(error::CorruptRevisionData, "Unknown body compression dictionary %u", dictionaryID);
+            i = _dictionaries.emplace(dictionaryID, std::move(dictionary)).first;
+        }
+        return i->second;
+    }
+
+    bool BodyDictionaries::inUse() {
+        // Once compression has been enabled it never goes away entirely, so a true result can't go stale:
+        if ( _inUse.load(memory_order_relaxed) ) return true;
+        if ( !_checkInUse() ) return false;
+        _inUse.store(true, memory_order_relaxed);
+        return true;
+    }
+
+    void BodyDictionaries::clear() {
+        lock_guard<mutex> lock(_mutex);
+        _dictionaries.clear();
+    }
+
+    void BodyDictionaries::decompress(const BodyCompressor::Header& header, void* output) {
+        alloc_slice dictionary = header.dictionaryID ? get(header.dictionaryID) : nullslice;
+        BodyCompressor::decompress(header, dictionary, output);
+    }
+
+    alloc_slice BodyDictionaries::decompress(slice compressed) {
+        auto        header = BodyCompressor::readHeader(compressed);
+        alloc_slice body(header.size);
+        decompress(header, (void*)body.buf);
+        return body;
+    }
+
+}  // namespace litecore
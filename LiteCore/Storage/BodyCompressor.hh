@@ -0,0 +1,136 @@
+//
+// BodyCompressor.hh
+//
+// Copyright 2026-Present Couchbase, Inc.
+//
+// Use of this software is governed by the Business Source License included
+// in the file licenses/BSL-Couchbase.txt.  As of the Change Date specified
+// in that file, in accordance with the Business Source License, use of this
+// software will be governed by the Apache License, Version 2.0, included in
+// the file licenses/APL2.txt.
+//
+
+#pragma once
+#include "fleece/slice.hh"
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <zlib.h>
+
+namespace litecore {
+    using fleece::alloc_slice;
+    using fleece::slice;
+
+    /** Compresses record bodies with zlib "deflate", using a preset dictionary trained from a
+        sample of the collection's bodies. Not thread-safe; SQLiteKeyStore only uses it within
+        a transaction.
+
+        A compressed body begins with the byte `kMagic`, then the dictionary ID and the
+        uncompressed size as varints, then the raw deflated data.
+
+        A KeyStore record's body can be arbitrary data (a raw value may well start with 0xFF), so
+        SQLiteKeyStore marks a compressed record by setting `kCompressedFlag` in its `flags`
+        column. SQL functions only see the `body` column, but they only ever read document bodies:
+        Fleece data can't begin with 0xFF (that's a pointer, and pointers only point backwards),
+        nor can a 2.x rev-tree (it begins with a small big-endian size), so once a database has
+        used compression they recognize a compressed body by its first byte. */
+    class BodyCompressor {
+      public:
+        static constexpr uint8_t kMagic = 0xFF;
+
+        /// The bit of a record's `flags` column that's set if its body is compressed.
+        /// (It's above the DocumentFlags and below the subsequence, which starts at bit 16.)
+        static constexpr int64_t kCompressedFlag = 0x8000;
+
+        /// The largest useful dictionary; deflate can't refer back further than this.
+        static constexpr size_t kMaxDictionarySize = 32 * 1024;
+
+        /// True if `body` starts like the output of `compress`. Only meaningful for document bodies.
+        static bool isCompressed(slice body) noexcept { return body.size > 0 && body[0] == kMagic; }
+
+        /// True if a record's raw `flags` column value marks its body as compressed.
+        static bool isCompressed(int64_t rawFlags) noexcept { return (rawFlags & kCompressedFlag) != 0; }
+
+        /// Builds a dictionary out of the substrings most common to the sample bodies.
+        static alloc_slice trainDictionary(const std::vector<alloc_slice>& samples,
+                                           size_t                          maxSize = kMaxDictionarySize);
+
+        /// @param minSize  Bodies smaller than this are left uncompressed.
+        /// @param dictionaryID  The ID under which the dictionary is stored, or 0 if none.
+        /// @param dictionary  The preset dictionary, or null.
+        BodyCompressor(size_t minSize, uint32_t dictionaryID, alloc_slice dictionary);
+        ~BodyCompressor();
+
+        BodyCompressor(const BodyCompressor&)            = delete;
+        BodyCompressor& operator=(const BodyCompressor&) = delete;
+
+        size_t minSize() const { return _minSize; }
+
+        uint32_t dictionaryID() const { return _dictionaryID; }
+
+        /// Returns the compressed form of `body`, or a null slice if it's smaller than `minSize`
+        /// or wouldn't get any smaller.
+        alloc_slice compress(slice body);
+
+        /// The parsed header of a compressed body.
+        struct Header {
+            uint32_t dictionaryID;  ///< ID of the dictionary it was compressed with, or 0
+            size_t   size;          ///< Size of the decompressed body
+            slice    data;          ///< The deflated data following the header
+        };
+
+        /// Parses the header of a compressed body. Throws CorruptRevisionData if it's invalid.
+        static Header readHeader(slice compressed);
+
+        /// Decompresses a body into `output`, which must be `header.size` bytes long.
+        /// Throws CorruptRevisionData if the data is invalid.
+        static void decompress(const Header&, slice dictionary, void* output);
+
+      private:
+        size_t const      _minSize;
+        uint32_t const    _dictionaryID;
+        alloc_slice const _dictionary;
+        ::z_stream        _z{};
+    };
+
+    /** The dictionaries of a database's BodyCompressors, keyed by ID, as needed to decompress
+        its bodies. Dictionaries are loaded on demand and then cached; they never change.
+        Thread-safe, since SQL functions use it too. */
+    class BodyDictionaries {
+      public:
+        /// A function that reads a dictionary from the database; returns null if there's none.
+        using Loader = std::function<alloc_slice(uint32_t dictionaryID)>;
+
+        /// A function that returns true if body compression has ever been enabled in the database.
+        using InUseChecker = std::function<bool()>;
+
+        BodyDictionaries(Loader loader, InUseChecker inUse)
+            : _loader(std::move(loader)), _checkInUse(std::move(inUse)) {}
+
+        /// True if the database may contain compressed bodies. Until it does, SQL functions don't
+        /// treat a body starting with `kMagic` as compressed. Once true, this is remembered.
+        bool inUse();
+
+        /// Returns the dictionary with the given ID. Throws CorruptRevisionData if it's unknown.
+        alloc_slice get(uint32_t dictionaryID);
+
+        /// Decompresses a body produced by a BodyCompressor.
+        alloc_slice decompress(slice compressed);
+
+        /// Decompresses a body, given its header, into `output`, which must be `header.size` bytes long.
+        void decompress(const BodyCompressor::Header& header, void* output);
+
+        /// Forgets the cached dictionaries, so they'll be reloaded when next needed.
+        void clear();
+
+      private:
+        std::mutex                                _mutex;
+        std::unordered_map<uint32_t, alloc_slice> _dictionaries;
+        Loader const                              _loader;
+        InUseChecker const                        _checkInUse;
+        std::atomic<bool>                         _inUse{false};
+    };
+
+}  // namespace litecore
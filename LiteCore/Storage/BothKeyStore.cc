@@ -74,6 +74,28 @@ namespace litecore {
         return seq;
     }
 
+    std::vector<Record> BothKeyStore::getMany(const std::vector<slice>& keys, ContentOption content) const {
+        // First, delegate to the live store:
+        auto records = _liveStore->getMany(keys, content);
+
+        // Retry the keys that weren't found in the dead store:
+        std::vector<slice>  recheckKeys;
+        std::vector<size_t> recheckIndexes;
+        for ( size_t i = 0; i < keys.size(); ++i ) {
+            if ( !records[i].exists() ) {
+                recheckKeys.push_back(keys[i]);
+                recheckIndexes.push_back(i);
+            }
+        }
+        if ( !recheckKeys.empty() ) {
+            auto dead = _deadStore->getMany(recheckKeys, content);
+            for ( size_t i = 0; i < dead.size(); ++i ) {
+                if ( dead[i].exists() ) records[recheckIndexes[i]] = std::move(dead[i]);
+            }
+        }
+        return records;
+    }
+
     std::vector<alloc_slice> BothKeyStore::withDocBodies(const std::vector<slice>& docIDs,
                                                          WithDocBodyCallback       callback) {
         // First, delegate to the live store:
@@ -163,6 +185,8 @@ namespace litecore {
 
         bool read(Record& record) const override { return _current->read(record); }
 
+        bool readView(RecordView& view, Arena<>& arena) const override { return _current->readView(view, arena); }
+
         [[nodiscard]] slice key() const override { return _current->key(); }
 
         [[nodiscard]] sequence_t sequence() const override { return _current->sequence(); }
@@ -195,6 +219,8 @@ namespace litecore {
 
         bool read(Record& record) const override { return _impl->read(record); }
 
+        bool readView(RecordView& view, Arena<>& arena) const override { return _impl->readView(view, arena); }
+
         [[nodiscard]] slice key() const override { return _impl->key(); }
 
         [[nodiscard]] sequence_t sequence() const override { return _impl->sequence(); }
@@ -38,6 +38,8 @@ namespace litecore {
             return _liveStore->read(rec, readBy, content) || _deadStore->read(rec, readBy, content);
         }
 
+        std::vector<Record> getMany(const std::vector<slice>& keys, ContentOption content) const override;
+
         sequence_t set(const RecordUpdate& rec, SetOptions flags, ExclusiveTransaction& transaction) override;
 
         void setKV(slice key, slice version, slice value, ExclusiveTransaction& transaction) override {
@@ -65,6 +67,12 @@ namespace litecore {
             _deadStore->transactionWillEnd(commit);
         }
 
+        // Tombstone bodies are rarely worth compressing; a deleted doc's compressed body is
+        // moved to the dead store as-is.
+        void setBodyCompression(size_t minBodySize, ExclusiveTransaction& t) override {
+            _liveStore->setBodyCompression(minBodySize, t);
+        }
+
         //// EXPIRATION:
 
         bool mayHaveExpiration() override { return _liveStore->mayHaveExpiration() || _deadStore->mayHaveExpiration(); }
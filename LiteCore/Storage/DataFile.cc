@@ -422,6 +422,9 @@ namespace litecore {
         auto elapsed = st.elapsed();
         Signpost::end(Signpost::transaction, uintptr_t(this));
         if ( elapsed >= 0.1 ) _db._logInfo("Committing transaction took %.3f sec", elapsed);
+        _db.forOtherDataFiles([](DataFile* other) {
+            if ( other->delegate() ) other->delegate()->externalCommit();
+        });
     }
 
     void ExclusiveTransaction::abort() {
@@ -20,6 +20,7 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <atomic>  // for std::atomic_uint
+#include <chrono>
 #ifdef check
 #    undef check
 #endif
@@ -65,10 +66,21 @@ namespace litecore {
             // Notifies that another DataFile on the same physical file has committed a transaction
             virtual void externalTransactionCommitted(const SequenceTracker& sourceTracker) {}
 
+            // Notifies that another DataFile on the same physical file has committed any transaction,
+            // including one that changed no collection (only raw or local docs.) Called after the commit.
+            virtual void externalCommit() {}
+
             // Notifies that another DataFile on the same physical file has deleted a collection
             virtual void collectionRemoved(const std::string& keyStoreName){};
         };
 
+        /// Whether to memory-map the database file for reading.
+        enum class MMapMode : uint8_t {
+            PlatformDefault,  ///< Only on platforms where it's known to be safe
+            On,
+            Off,
+        };
+
         struct Options {
             KeyStore::Capabilities keyStores;
             bool                   create : 1;           ///< Should the db be created if it doesn't exist?
@@ -77,9 +89,11 @@ namespace litecore {
             bool                   upgradeable : 1;      ///< DB schema can be upgraded
             bool                   diskSyncFull : 1;     ///< SQLite PRAGMA synchronous
             bool                   noHousekeeping : 1;   ///< Disable automatic maintenance
+            bool                   inMemory : 1;         ///< Keep data in memory, not in the file
             EncryptionAlgorithm    encryptionAlgorithm;  ///< What encryption (if any)
             alloc_slice            encryptionKey;        ///< Encryption key, if encrypting
             DatabaseTag            dbTag;
+            MMapMode               mmapReads;            ///< Memory-mapped reads
             static const Options   defaults;
         };
 
@@ -126,6 +140,26 @@ namespace litecore {
         /** Perform database maintenance of some type. Returns false if not supported. */
         virtual void maintenance(MaintenanceType) = 0;
 
+        /** Sets the size in bytes of this connection's in-memory page cache.
+            0 restores the default size. */
+        virtual void setCacheSize(size_t bytes) = 0;
+
+        /** Enables or disables checkpointing the write-ahead log as part of committing a transaction.
+            If it's disabled, something else (the Housekeeper) must call \ref checkpoint regularly. */
+        virtual void setAutoCheckpoint(bool enabled) = 0;
+
+        /** Copies committed transactions from the write-ahead log into the database, without
+            blocking any reader or writer; if that empties a log that's grown too big, truncates it.
+            Can be called on any instance on the file. */
+        virtual void checkpoint() = 0;
+
+        /** Returns some of the file's free pages (left behind by deletions) to the filesystem, in
+            small steps that each hold the write lock only briefly, until few are left or `budget`
+            has elapsed; then checkpoints, so the file actually shrinks.
+            Returns true if it ran out of time with pages still to free.
+            Can be called on any instance on the file. */
+        virtual bool incrementalVacuum(std::chrono::milliseconds budget) = 0;
+
         virtual void rekey(EncryptionAlgorithm, slice newKey);
 
         Delegate* delegate() const { return _delegate; }
@@ -141,6 +175,16 @@ namespace litecore {
         virtual Retained<Query> compileQuery(slice     expr, QueryLanguage = QueryLanguage::kJSON,
                                              KeyStore* defaultKeyStore = nullptr) = 0;
 
+        /** Statistics of the cache of compiled queries, which saves parsing and translating
+            a query that was compiled before. */
+        struct QueryCacheStats {
+            uint64_t hits;     ///< Number of queries compiled from the cache
+            uint64_t misses;   ///< Number of queries that weren't in the cache
+            size_t   entries;  ///< Number of queries currently in the cache
+        };
+
+        virtual QueryCacheStats queryCacheStats() const = 0;
+
         /** Private API to run a raw (e.g. SQL) query, for diagnostic purposes only */
         virtual fleece::alloc_slice rawQuery(const std::string& query) = 0;
 
@@ -196,6 +240,25 @@ namespace litecore {
 
         void _log(LogLevel level, const char* format, ...) const __printflike(3, 4){LOGBODY_(level)}
 
+        //////// SNAPSHOTS:
+
+        /** An opaque reference to one committed state of the database file. */
+        class Snapshot {
+          public:
+            virtual ~Snapshot() = default;
+        };
+
+        /** Begins a read transaction that sees a single committed state of the file, and stays
+            open until `endSnapshotTransaction`. ReadOnlyTransactions may be nested inside it.
+            If `join` is null, the transaction sees the latest commit, and a Snapshot of that state
+            is returned. Otherwise the transaction sees `join`'s state -- which must have come from
+            another DataFile on the same file, whose transaction is still open -- and returns null.
+            Any number of DataFiles can thus read the same state in parallel. */
+        virtual std::unique_ptr<Snapshot> beginSnapshotTransaction(const Snapshot* join = nullptr) = 0;
+
+        /** Ends a transaction begun by `beginSnapshotTransaction`. */
+        virtual void endSnapshotTransaction() = 0;
+
         //////// SHARED OBJECTS:
 
         Retained<RefCounted> sharedObject(const std::string& key);
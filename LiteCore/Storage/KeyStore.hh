@@ -95,6 +95,11 @@ namespace litecore {
         [[nodiscard]] Record get(slice key, ContentOption = kEntireBody) const;
         [[nodiscard]] Record get(sequence_t, ContentOption = kEntireBody) const;
 
+        /** Reads multiple records by key. The result is in the same order as the keys; if a key
+            doesn't exist, its Record's `exists()` is false. */
+        [[nodiscard]] virtual std::vector<Record> getMany(const std::vector<slice>& keys,
+                                                          ContentOption = kEntireBody) const;
+
         using WithDocBodyCallback = function_ref<alloc_slice(const RecordUpdate&)>;
 
         /** Invokes the callback once for each document found in the database.
@@ -156,6 +161,14 @@ namespace litecore {
 
         virtual void transactionWillEnd(bool commit) {}
 
+        //////// Body compression:
+
+        /** Makes records saved from now on store their bodies compressed, if they're at least
+            `minBodySize` bytes long, using a dictionary trained from a sample of the existing
+            bodies. A `minBodySize` of 0 turns compression off. Existing records aren't rewritten;
+            compressed bodies are decompressed transparently when read, or accessed by queries. */
+        virtual void setBodyCompression(size_t minBodySize, ExclusiveTransaction&) = 0;
+
         //////// Expiration:
 
         /** The current time represented in milliseconds since the unix epoch. */
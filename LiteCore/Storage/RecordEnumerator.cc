@@ -39,6 +39,7 @@ namespace litecore {
     void RecordEnumerator::close() noexcept {
         _record.clear();
         _impl.reset();
+        _arena = Arena<>(kArenaChunkSize);
     }
 
     bool RecordEnumerator::next() {
@@ -58,4 +59,41 @@ namespace litecore {
         }
     }
 
+    size_t RecordEnumerator::nextBatch(std::span<RecordView> rows) {
+        _record.clear();
+        _arena.freeAll();
+        size_t n = 0;
+        while ( _impl && n < rows.size() ) {
+            // At the end, release the impl but not the arena, which holds the rows already read:
+            if ( !_impl->next() || !_impl->readView(rows[n], _arena) ) _impl.reset();
+            else
+                ++n;
+        }
+        LogDebug(QueryLog, "RecordEnumerator %p  --> batch of %zu", this, n);
+        return n;
+    }
+
+    slice RecordEnumerator::Impl::copyToArena(slice data, Arena<>& arena) {
+        if ( !data.buf ) return nullslice;
+        void* copy = arena.alloc(data.size, kViewAlignment);
+        if ( data.size > 0 ) memcpy(copy, data.buf, data.size);
+        return {copy, data.size};
+    }
+
+    bool RecordEnumerator::Impl::readView(RecordView& view, Arena<>& arena) const {
+        Record rec;
+        if ( !read(rec) ) return false;
+        view.key         = copyToArena(rec.key(), arena);
+        view.version     = copyToArena(rec.version(), arena);
+        view.body        = copyToArena(rec.body(), arena);
+        view.extra       = copyToArena(rec.extra(), arena);
+        view.sequence    = rec.sequence();
+        view.subsequence = rec.subsequence();
+        view.flags       = rec.flags();
+        view.bodySize    = rec.bodySize();
+        view.extraSize   = rec.extraSize();
+        view.expiration  = rec.expiration();
+        return true;
+    }
+
 }  // namespace litecore
@@ -19,6 +19,8 @@
 
 #include "SQLiteDataFile.hh"
 #include "SQLiteKeyStore.hh"
+#include "BodyCompressor.hh"
+#include "QueryCache.hh"
 #include "SQLite_Internal.hh"
 #include "SQLiteCpp/SQLiteCpp.h"
 #include "BothKeyStore.hh"
@@ -26,6 +28,7 @@
 #include "UnicodeCollator.hh"
 #include "Error.hh"
 #include "FilePath.hh"
+#include "Instrumentation.hh"
 #include "SharedKeys.hh"
 #include "Stopwatch.hh"
 #include "StringUtil.hh"
@@ -75,25 +78,40 @@ namespace litecore {
     // SQLite page size
     static const int64_t kPageSize = 4096;
 
-    // SQLite cache size (per connection)
+    // Default SQLite cache size (per connection), unless overridden by setCacheSize()
     static const size_t kCacheSize = 10 * MB;
 
     // Maximum size WAL journal will be left at after a commit
     static const int64_t kJournalSize = 5 * MB;
 
+    // SQLite's default `wal_autocheckpoint` threshold, in pages
+    static const int kAutoCheckpointPages = 1000;
+
     static map<string, int> kValidExtensionVersions = {
 #ifdef COUCHBASE_ENTERPRISE
             {"CouchbaseLiteVectorSearch", 2}
 #endif
     };
 
-    // Reference: https://www.sqlite.org/mmap.html
-    static const int kMMapSize = 0;  // Avoid potential file corruption on some OSes.
+    // Memory-mapped reads. Reference: https://www.sqlite.org/mmap.html
+    // They're only on by default where they're known to be safe; some OSes' unified buffer caches
+    // have had bugs that corrupted files. They also need 64-bit address space to be worthwhile.
+#if defined(__linux__) && !defined(__ANDROID__) && UINTPTR_MAX > UINT32_MAX
+    static constexpr bool kMMapByDefault = true;
+#else
+    static constexpr bool kMMapByDefault = false;
+#endif
+    // Maximum number of bytes of the file to map. (SQLite caps this at SQLITE_MAX_MMAP_SIZE.)
+    static const int64_t kMMapSize = 4096 * MB;
 
     // If this fraction of the database is composed of free pages, vacuum it on close
     static const float kVacuumFractionThreshold = 0.25;
     // If the database has many bytes of free space, vacuum it on close
     static const int64_t kVacuumSizeThreshold = 10 * MB;
+    // Number of pages an incremental vacuum frees in each (brief) write transaction
+    static const int64_t kIncrementalVacuumStep = 256;
+    // Number of free pages an incremental vacuum leaves for new data to reuse
+    static const int64_t kIncrementalVacuumSlack = 64;
 
     // Database busy timeout; generally not needed since we have other arbitration that keeps
     // multiple threads from trying to start transactions at once, but another process might
@@ -241,7 +259,10 @@ namespace litecore {
     }
 
     SQLiteDataFile::SQLiteDataFile(const FilePath& path, DataFile::Delegate* delegate, const Options* options)
-        : DataFile(path, delegate, options) {
+        : DataFile(path, delegate, options)
+        , _bodyDictionaries(make_unique<BodyDictionaries>([this](uint32_t id) { return loadBodyDictionary(id); },
+                                                          [this] { return bodyCompressionTablesExist(); }))
+        , _queryCache(make_unique<QueryCache>()) {
         reopen();
     }
 
@@ -325,16 +346,28 @@ namespace litecore {
             }
 
             const Options& options = getOptions();
+            int64_t        mmapSize;
+            switch ( options.mmapReads ) {
+                case MMapMode::On:
+                    mmapSize = kMMapSize;
+                    break;
+                case MMapMode::Off:
+                    mmapSize = 0;
+                    break;
+                default:
+                    mmapSize = defaultMmapSize();
+                    break;
+            }
 
             _exec(stringprintf(
-                    "PRAGMA cache_size=%d; "             // Memory cache
-                    "PRAGMA mmap_size=%d; "              // Memory-mapped reads
+                    "PRAGMA cache_size=%lld; "           // Memory cache
+                    "PRAGMA mmap_size=%lld; "            // Memory-mapped reads
                     "PRAGMA synchronous=%s; "            // Speeds up commits
                     "PRAGMA journal_size_limit=%lld; "   // Limit WAL disk usage
                     "PRAGMA case_sensitive_like=true; "  // Case sensitive LIKE, for N1QL compat
                     "PRAGMA fullfsync=ON",  // Attempt to mitigate damage due to sudden loss of power (iOS / macOS)
-                    -(int)kCacheSize / 1024, kMMapSize, options.diskSyncFull ? "full" : "normal",
-                    (long long)kJournalSize));
+                    -(long long)(_cacheSize ? _cacheSize : kCacheSize) / 1024, (long long)mmapSize,
+                    options.diskSyncFull ? "full" : "normal", (long long)kJournalSize));
 
             (void)upgradeSchema(SchemaVersion::WithPurgeCount, "Adding purgeCnt column", [&] {
                 // Schema upgrade: Add the `purgeCnt` column to the kvmeta table.
@@ -421,6 +454,15 @@ namespace litecore {
                     }
                 }
             });
+
+            (void)upgradeSchema(SchemaVersion::WithIndexesIncludeColumn, "Adding indexes.includeClause column", [&] {
+                string sql;
+                if ( getSchema("indexes", "table", "indexes", sql) ) {
+                    if ( sql.find("includeClause") == string::npos ) {
+                        _exec("ALTER TABLE indexes ADD COLUMN includeClause TEXT");
+                    }
+                }
+            });
         });
 
         // Configure number of extra threads to be used by SQLite:
@@ -429,7 +471,7 @@ namespace litecore {
 
         // Register collators, custom functions, the FTS tokenizer, and the `carray` extension:
         RegisterSQLiteUnicodeCollations(sqlite, _collationContexts);
-        RegisterSQLiteFunctions(sqlite, {delegate(), documentKeys()});
+        RegisterSQLiteFunctions(sqlite, {delegate(), documentKeys(), _bodyDictionaries.get()});
         int rc = register_unicodesn_tokenizer(sqlite);
         if ( rc != SQLITE_OK ) warn("Unable to register FTS tokenizer: SQLite err %d", rc);
         char* errMsg = nullptr;
@@ -490,10 +532,24 @@ namespace litecore {
         _setLastSeqStmt.reset();
         _getPurgeCntStmt.reset();
         _setPurgeCntStmt.reset();
+        _schemaCookieStmt.reset();
+        _dataVersionStmt.reset();
+        _queryCache->clear();
 
         int sqlFlags = options().writeable ? SQLite::OPEN_READWRITE : SQLite::OPEN_READONLY;
         if ( options().create ) sqlFlags |= SQLite::OPEN_CREATE;
-        _sqlDb = make_unique<SQLite::Database>(filePath().path().c_str(), sqlFlags, kBusyTimeoutSecs * 1000);
+        if ( options().inMemory ) {
+            // The "memdb" VFS shares a database among all connections in the process that open the
+            // same name, if it begins with '/'. It's freed when the last connection closes.
+            string name = filePath().canonicalPath();
+            if ( name[0] != '/' ) name = "/" + name;
+            _sqlDb = make_unique<SQLite::Database>(name.c_str(), sqlFlags, kBusyTimeoutSecs * 1000, "memdb");
+            // memdb can't do WAL (so a new database's `journal_mode=WAL` has no effect), and it would
+            // put a rollback journal in a real file, so keep that in memory too:
+            _sqlDb->exec("PRAGMA journal_mode=MEMORY");
+        } else {
+            _sqlDb = make_unique<SQLite::Database>(filePath().path().c_str(), sqlFlags, kBusyTimeoutSecs * 1000);
+        }
     }
 
     void SQLiteDataFile::ensureSchemaVersionAtLeast(SchemaVersion version) {
@@ -512,6 +568,9 @@ namespace litecore {
         _setLastSeqStmt.reset();
         _getPurgeCntStmt.reset();
         _setPurgeCntStmt.reset();
+        _schemaCookieStmt.reset();
+        _dataVersionStmt.reset();
+        _queryCache->clear();  // it holds prepared statements
         if ( _sqlDb ) {
             if ( options().writeable && !options().noHousekeeping ) {
                 withFileLock([this]() {
@@ -689,10 +748,18 @@ namespace litecore {
     }
 
     void SQLiteDataFile::_endTransaction(ExclusiveTransaction* t, bool commit) {
+        Signpost signpost(Signpost::sqliteCommit, uintptr_t(this), commit);
         // Notify key-stores so they can save state:
         forOpenKeyStores([commit](KeyStore& ks) { ks.transactionWillEnd(commit); });
 
         exec(commit ? "COMMIT" : "ROLLBACK");
+        if ( !commit ) {
+            // An aborted transaction may have added a dictionary, whose ID will be reused:
+            _bodyDictionaries->clear();
+            // It may also have changed the schema, and rolling back restores the old schema cookie,
+            // which would make queries cached during the transaction look valid:
+            _queryCache->clear();
+        }
     }
 
     void SQLiteDataFile::beginReadOnlyTransaction() {
@@ -702,6 +769,47 @@ namespace litecore {
 
     void SQLiteDataFile::endReadOnlyTransaction() { _exec("RELEASE SAVEPOINT roTransaction"); }
 
+    // A SQLite WAL snapshot; see https://sqlite.org/c3ref/snapshot_get.html
+    class SQLiteSnapshot final : public DataFile::Snapshot {
+      public:
+        explicit SQLiteSnapshot(sqlite3_snapshot* snapshot) : _snapshot(snapshot) {}
+
+        ~SQLiteSnapshot() override { sqlite3_snapshot_free(_snapshot); }
+
+        sqlite3_snapshot* get() const { return _snapshot; }
+
+      private:
+        sqlite3_snapshot* const _snapshot;
+    };
+
+    unique_ptr<DataFile::Snapshot> SQLiteDataFile::beginSnapshotTransaction(const Snapshot* join) {
+        checkOpen();
+        // A deferred BEGIN doesn't start reading yet, which is what `sqlite3_snapshot_open` requires:
+        _exec("BEGIN");
+        try {
+            sqlite3* sqlite = _sqlDb->getHandle();
+            if ( join ) {
+                auto snapshot = dynamic_cast<const SQLiteSnapshot*>(join);
+                Assert(snapshot, "Snapshot is from a different type of DataFile");
+                if ( int rc = sqlite3_snapshot_open(sqlite, "main", snapshot->get()); rc != SQLITE_OK )
+                    error::_throw(error::SQLite, rc);
+                return nullptr;
+            } else {
+                // Reading anything starts the read transaction; its state is what the snapshot captures:
+                _exec("SELECT count(*) FROM sqlite_master");
+                sqlite3_snapshot* snapshot = nullptr;
+                if ( int rc = sqlite3_snapshot_get(sqlite, "main", &snapshot); rc != SQLITE_OK )
+                    error::_throw(error::SQLite, rc);
+                return make_unique<SQLiteSnapshot>(snapshot);
+            }
+        } catch ( ... ) {
+            _exec("ROLLBACK");
+            throw;
+        }
+    }
+
+    void SQLiteDataFile::endSnapshotTransaction() { _exec("COMMIT"); }
+
     int SQLiteDataFile::_exec(const string& sql) {
         LogTo(SQL, "%s", sql.c_str());
         try {
@@ -809,6 +917,20 @@ namespace litecore {
         _setLastSeqStmt->exec();
     }
 
+    // SQLite increments the schema cookie whenever any connection changes the schema.
+    int64_t SQLiteDataFile::schemaCookie() const {
+        compileCached(_schemaCookieStmt, "PRAGMA schema_version");
+        UsingStatement u(_schemaCookieStmt);
+        return _schemaCookieStmt->executeStep() ? _schemaCookieStmt->getColumn(0).getInt64() : 0;
+    }
+
+    // SQLite changes the data version whenever another connection commits a change.
+    int64_t SQLiteDataFile::dataVersion() const {
+        compileCached(_dataVersionStmt, "PRAGMA data_version");
+        UsingStatement u(_dataVersionStmt);
+        return _dataVersionStmt->executeStep() ? _dataVersionStmt->getColumn(0).getInt64() : 0;
+    }
+
     uint64_t SQLiteDataFile::purgeCount(const std::string& keyStoreName) const {
         uint64_t purgeCnt = 0;
         if ( _schemaVersion >= SchemaVersion::WithPurgeCount ) {
@@ -831,7 +953,82 @@ namespace litecore {
         _setPurgeCntStmt->exec();
     }
 
+#pragma mark - BODY COMPRESSION:
+
+    // Body compression uses two tables, created when it's first enabled. `compression` holds the
+    // settings of each KeyStore that compresses its bodies, and `compressionDicts` holds every
+    // dictionary ever used. Dictionaries are never deleted, since bodies compressed with one may
+    // still exist.
+
+    bool SQLiteDataFile::bodyCompressionTablesExist() const {
+        string sql;
+        return getSchema("compression", "table", "compression", sql);
+    }
+
+    alloc_slice SQLiteDataFile::loadBodyDictionary(uint32_t dictionaryID) const {
+        if ( !bodyCompressionTablesExist() ) return nullslice;
+        SQLite::Statement stmt(*_sqlDb, "SELECT dict FROM compressionDicts WHERE id=?");
+        stmt.bind(1, (long long)dictionaryID);
+        LogStatement(stmt);
+        if ( !stmt.executeStep() ) return nullslice;
+        return alloc_slice(getColumnAsSlice(stmt, 0));
+    }
+
+    unique_ptr<BodyCompressor> SQLiteDataFile::bodyCompressor(const string& keyStoreName) const {
+        if ( !bodyCompressionTablesExist() ) return nullptr;
+        SQLite::Statement stmt(*_sqlDb, "SELECT minSize, dictID FROM compression WHERE keyStore=?");
+        stmt.bind(1, keyStoreName);
+        LogStatement(stmt);
+        if ( !stmt.executeStep() ) return nullptr;
+        auto minSize      = size_t(int64_t(stmt.getColumn(0)));
+        auto dictionaryID = uint32_t(int64_t(stmt.getColumn(1)));
+        return make_unique<BodyCompressor>(minSize, dictionaryID,
+                                           dictionaryID ? _bodyDictionaries->get(dictionaryID) : nullslice);
+    }
+
+    unique_ptr<BodyCompressor> SQLiteDataFile::setBodyCompression(const string& keyStoreName, size_t minSize,
+                                                                  alloc_slice dictionary) {
+        if ( !inTransaction() ) error::_throw(error::NotInTransaction);
+        if ( !bodyCompressionTablesExist() ) {
+            if ( minSize == 0 ) return nullptr;
+            _exec("CREATE TABLE compressionDicts ("
+                  "id INTEGER PRIMARY KEY, "  // Dictionary ID, stored in compressed bodies
+                  "dict BLOB NOT NULL)");     // Dictionary data
+            _exec("CREATE TABLE compression ("
+                  "keyStore TEXT PRIMARY KEY, "               // Name of the KeyStore
+                  "minSize INTEGER NOT NULL, "                // Smallest body to compress
+                  "dictID INTEGER NOT NULL) WITHOUT ROWID");  // Current dictionary, or 0 for none
+        }
+
+        if ( minSize == 0 ) {
+            SQLite::Statement stmt(*_sqlDb, "DELETE FROM compression WHERE keyStore=?");
+            stmt.bind(1, keyStoreName);
+            stmt.exec();
+            return nullptr;
+        }
+
+        // The dictionary's ID is its rowid, which is never reused since dictionaries aren't deleted.
+        uint32_t dictionaryID = 0;
+        if ( dictionary ) {
+            SQLite::Statement stmt(*_sqlDb, "INSERT INTO compressionDicts (dict) VALUES (?)");
+            stmt.bindNoCopy(1, dictionary.buf, (int)dictionary.size);
+            stmt.exec();
+            dictionaryID = uint32_t(_sqlDb->getLastInsertRowid());
+        }
+
+        SQLite::Statement stmt(*_sqlDb, "INSERT OR REPLACE INTO compression (keyStore, minSize, dictID) "
+                                        "VALUES (?, ?, ?)");
+        stmt.bind(1, keyStoreName);
+        stmt.bind(2, (long long)minSize);
+        stmt.bind(3, (long long)dictionaryID);
+        stmt.exec();
+        logInfo("Compressing bodies of '%s' of at least %zu bytes, with a %zu-byte dictionary", keyStoreName.c_str(),
+                minSize, dictionary.size);
+        return make_unique<BodyCompressor>(minSize, dictionaryID, std::move(dictionary));
+    }
+
     uint64_t SQLiteDataFile::fileSize() {
+        if ( options().inMemory ) return intQuery("PRAGMA page_count") * kPageSize;
         // Move all WAL changes into the main database file, so its size is accurate:
         _exec("PRAGMA wal_checkpoint(FULL)");
         return DataFile::fileSize();
@@ -1018,6 +1215,30 @@ namespace litecore {
             warn("auto_vacuum mode did not take effect after running full VACUUM!");
     }
 
+    bool SQLiteDataFile::incrementalVacuum(chrono::milliseconds budget) {
+        checkOpen();
+        int64_t freePages = intQuery("PRAGMA freelist_count");
+        if ( freePages <= kIncrementalVacuumSlack ) return false;
+        // A database that predates CBL-707 needs a full VACUUM first; `_vacuum` does that on close.
+        if ( intQuery("PRAGMA auto_vacuum") != 2 ) return false;
+
+        int64_t           startFreePages = freePages;
+        double            budgetSecs     = chrono::duration<double>(budget).count();
+        fleece::Stopwatch st;
+        do {
+            int64_t pages = std::min(freePages - kIncrementalVacuumSlack, kIncrementalVacuumStep);
+            withFileLock([&] { _exec(stringprintf("PRAGMA incremental_vacuum(%lld)", (long long)pages)); });
+            freePages = intQuery("PRAGMA freelist_count");
+        } while ( freePages > kIncrementalVacuumSlack && st.elapsed() < budgetSecs );
+
+        int64_t freed = startFreePages - freePages;
+        logInfo("Incremental vacuum freed %" PRIi64 " pages (%" PRIi64 "KB) in %.3f sec; %" PRIi64 " still free", freed,
+                freed * kPageSize / 1024, st.elapsed(), freePages);
+        // The file doesn't shrink until the WAL is checkpointed:
+        checkpoint();
+        return freePages > kIncrementalVacuumSlack;
+    }
+
     void SQLiteDataFile::vacuum(bool always) noexcept {
         try {
             _vacuum(always);
@@ -1134,6 +1355,50 @@ namespace litecore {
         return alloc_slice(res);
     }
 
-    int SQLiteDataFile::defaultMmapSize() { return kMMapSize; }
+    int64_t SQLiteDataFile::defaultMmapSize() { return kMMapByDefault ? kMMapSize : 0; }
+
+    void SQLiteDataFile::setCacheSize(size_t bytes) {
+        _cacheSize = bytes;
+        _exec(stringprintf("PRAGMA cache_size=%lld", -(long long)(bytes ? bytes : kCacheSize) / 1024));
+    }
+
+    void SQLiteDataFile::setAutoCheckpoint(bool enabled) {
+        _exec(stringprintf("PRAGMA wal_autocheckpoint=%d", enabled ? kAutoCheckpointPages : 0));
+    }
+
+    void SQLiteDataFile::checkpoint() {
+        checkOpen();
+        if ( options().inMemory ) return;  // There's no WAL
+        sqlite3* db       = _sqlDb->getHandle();
+        int      logPages = 0, copiedPages = 0;
+        int      rc       = sqlite3_wal_checkpoint_v2(db, nullptr, SQLITE_CHECKPOINT_PASSIVE, &logPages, &copiedPages);
+        if ( rc == SQLITE_BUSY ) return;  // Another connection is checkpointing
+        if ( rc != SQLITE_OK ) {
+            warn("PASSIVE checkpoint failed: %s (%d)", sqlite3_errmsg(db), rc);
+            return;
+        }
+        logVerbose("Checkpointed %d of %d WAL pages", copiedPages, logPages);
+
+        if ( logPages * kPageSize > kJournalSize && copiedPages == logPages ) {
+            // The WAL has grown big, and it's all been copied, so truncate it. That needs every
+            // reader to be off the WAL and the writer lock, so don't let the busy handler wait for
+            // them; blocking the writer is exactly the commit stall this is meant to avoid.
+            sqlite3_busy_timeout(db, 0);
+            rc = sqlite3_wal_checkpoint_v2(db, nullptr, SQLITE_CHECKPOINT_TRUNCATE, nullptr, nullptr);
+            sqlite3_busy_timeout(db, kBusyTimeoutSecs * 1000);
+            if ( rc == SQLITE_OK ) logVerbose("Truncated WAL (was %lld bytes)", (long long)logPages * kPageSize);
+            else if ( rc != SQLITE_BUSY )
+                warn("TRUNCATE checkpoint failed: %s (%d)", sqlite3_errmsg(db), rc);
+        }
+    }
+
+    void SQLiteDataFile::setCacheBudget(uint64_t bytes) {
+        // With SQLITE_ENABLE_MEMORY_MANAGEMENT, going over the soft heap limit makes SQLite recycle
+        // the least-recently-used unpinned pages of *all* connections' caches, instead of each
+        // connection growing its own cache up to its `cache_size`.
+        sqlite3_soft_heap_limit64(int64_t(bytes));
+    }
+
+    uint64_t SQLiteDataFile::memoryUsed() { return uint64_t(sqlite3_memory_used()); }
 
 }  // namespace litecore
@@ -30,6 +30,9 @@ namespace SQLite {
 
 namespace litecore {
 
+    class BodyCompressor;
+    class BodyDictionaries;
+    class QueryCache;
     class SQLiteKeyStore;
     struct SQLiteIndexSpec;
 
@@ -74,8 +77,25 @@ namespace litecore {
         fleece::alloc_slice rawQuery(const std::string& query) override;
         alloc_slice         rawScalarQuery(const string& query) override;
 
-        /* Internal-only. The default value used for the SQLite PRAGMA config `mmap_size`. */
-        static int defaultMmapSize();
+        /* Internal-only. The default value used for the SQLite PRAGMA config `mmap_size`,
+           when the Options' `mmapReads` is `PlatformDefault`. */
+        static int64_t defaultMmapSize();
+
+        void setCacheSize(size_t bytes) override;
+        void setAutoCheckpoint(bool enabled) override;
+        void checkpoint() override;
+        bool incrementalVacuum(std::chrono::milliseconds budget) override;
+
+        std::unique_ptr<Snapshot> beginSnapshotTransaction(const Snapshot* join = nullptr) override;
+        void                      endSnapshotTransaction() override;
+
+        /** Sets a process-wide soft limit on SQLite's heap memory, which is mostly page caches.
+            When it's exceeded, connections reuse other connections' cold pages instead of
+            allocating more. 0 means no limit (the default.) */
+        static void setCacheBudget(uint64_t bytes);
+
+        /** The total heap memory currently allocated by SQLite, in all connections. */
+        static uint64_t memoryUsed();
 
         class Factory final : public DataFile::Factory {
           public:
@@ -105,6 +125,7 @@ namespace litecore {
         void inspectIndex(slice name, int64_t& outRowCount, alloc_slice* outRows = nullptr);
 
         Retained<Query> compileQuery(slice expression, QueryLanguage, KeyStore*) override;
+        QueryCacheStats queryCacheStats() const override;
 
         // Deprecated in favor of enableExtension!
         static void setExtensionPath(string);
@@ -146,6 +167,8 @@ namespace litecore {
         int                                exec(const std::string& sql);
         int                                execWithLock(const std::string& sql);
         int64_t                            intQuery(const char* query);
+        int64_t                            schemaCookie() const;
+        int64_t                            dataVersion() const;
         void                               optimizeAndVacuum();
 
         // Indexes:
@@ -159,6 +182,12 @@ namespace litecore {
         void                           setIndexSequences(slice name, slice sequencesJSON);
         void inspectVectorIndex(SQLiteIndexSpec const&, int64_t& outRowCount, alloc_slice* outRows);
 
+        // Body compression:
+        BodyDictionaries&               bodyDictionaries() const { return *_bodyDictionaries; }
+        std::unique_ptr<BodyCompressor> bodyCompressor(const std::string& keyStoreName) const;
+        std::unique_ptr<BodyCompressor> setBodyCompression(const std::string& keyStoreName, size_t minSize,
+                                                           alloc_slice dictionary);
+
       private:
         friend class SQLiteKeyStore;
         friend class SQLiteQuery;
@@ -174,13 +203,14 @@ namespace litecore {
 
             WithNewDocs = 400,  // New document/revision storage (CBL 3.0)
 
-            WithDeletedTable       = 500,  // Added 'deleted' KeyStore for deleted docs (CBL 3.0?)
-            WithIndexesLastSeq     = 501,  // Added 'lastSeq' column to 'indexes' table (CBL 3.2)
-            WithExpirationColumn   = 502,  // Added 'expiration' column to KeyStore
-            WithIndexesWhereColumn = 503,  // Added 'whereClause' column to the "indexes" table
-            MaxReadable            = 599,  // Cannot open versions newer than this
+            WithDeletedTable         = 500,  // Added 'deleted' KeyStore for deleted docs (CBL 3.0?)
+            WithIndexesLastSeq       = 501,  // Added 'lastSeq' column to 'indexes' table (CBL 3.2)
+            WithExpirationColumn     = 502,  // Added 'expiration' column to KeyStore
+            WithIndexesWhereColumn   = 503,  // Added 'whereClause' column to the "indexes" table
+            WithIndexesIncludeColumn = 504,  // Added 'includeClause' column to the "indexes" table
+            MaxReadable              = 599,  // Cannot open versions newer than this
 
-            Current = WithIndexesWhereColumn
+            Current = WithIndexesIncludeColumn
         };
 
         void reopenSQLiteHandle();
@@ -198,14 +228,20 @@ namespace litecore {
         void                         garbageCollectIndexTable(const SQLiteIndexSpec&);
         SQLiteIndexSpec              specFromStatement(SQLite::Statement& stmt) const;
         std::vector<SQLiteIndexSpec> getIndexesOldStyle(const KeyStore* store = nullptr) const;
+        bool                         bodyCompressionTablesExist() const;
+        alloc_slice                  loadBodyDictionary(uint32_t dictionaryID) const;
 
 
         unique_ptr<SQLite::Database>          _sqlDb;  // SQLite database object
         std::unique_ptr<SQLiteKeyStore>       _realDefaultKeyStore;
         mutable unique_ptr<SQLite::Statement> _getLastSeqStmt, _setLastSeqStmt;
         mutable unique_ptr<SQLite::Statement> _getPurgeCntStmt, _setPurgeCntStmt;
+        mutable unique_ptr<SQLite::Statement> _schemaCookieStmt, _dataVersionStmt;
         CollationContextVector                _collationContexts;
         SchemaVersion                         _schemaVersion{SchemaVersion::None};
+        size_t                                _cacheSize{0};      // Page cache size; 0 means default
+        std::unique_ptr<BodyDictionaries>     _bodyDictionaries;  // Dictionaries of compressed bodies
+        std::unique_ptr<QueryCache>           _queryCache;        // Recently compiled queries
     };
 
     struct SQLiteIndexSpec : public IndexSpec {
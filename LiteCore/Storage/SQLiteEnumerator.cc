@@ -13,6 +13,7 @@
 #include "SQLiteKeyStore.hh"
 #include "SQLiteDataFile.hh"
 #include "SQLite_Internal.hh"
+#include "BodyCompressor.hh"
 #include "Logging.hh"
 #include "RecordEnumerator.hh"
 #include "SQLiteCpp/SQLiteCpp.h"
@@ -27,7 +28,8 @@ namespace litecore {
 
     class SQLiteEnumerator final : public RecordEnumerator::Impl {
       public:
-        SQLiteEnumerator(SQLite::Statement* stmt, ContentOption content) : _stmt(stmt), _content(content) {
+        SQLiteEnumerator(const SQLiteKeyStore& store, SQLite::Statement* stmt, ContentOption content)
+            : _store(store), _stmt(stmt), _content(content) {
             LogTo(SQL, "Enumerator: %s", _stmt->getQuery().c_str());
         }
 
@@ -35,7 +37,47 @@ namespace litecore {
 
         bool read(Record& rec) const override {
             rec.setExpiration(expiration_t(int64_t(_stmt->getColumn(RecordColumn::Expiration))));
-            SQLiteKeyStore::setRecordMetaAndBody(rec, *_stmt, _content, true, true);
+            _store.setRecordMetaAndBody(rec, *_stmt, _content, true, true);
+            return true;
+        }
+
+        // Like `SQLiteKeyStore::setRecordMetaAndBody`, but copies the column data into the arena
+        // instead of allocating a heap block for each.
+        bool readView(RecordView& view, Arena<>& arena) const override {
+            view.key      = copyToArena(getColumnAsSlice(*_stmt, RecordColumn::Key), arena);
+            view.version  = copyToArena(getColumnAsSlice(*_stmt, RecordColumn::Version), arena);
+            view.sequence = sequence_t(int64_t(_stmt->getColumn(RecordColumn::Sequence)));
+
+            int64_t rawFlags = _stmt->getColumn(RecordColumn::RawFlags);
+            view.flags       = DocumentFlags(rawFlags & 0xFFFF);
+            view.subsequence = rawFlags >> 16;
+
+            if ( _content == kMetaOnly ) {
+                view.body     = nullslice;
+                view.bodySize = (size_t)int64_t(_stmt->getColumn(RecordColumn::BodyOrSize));
+            } else {
+                slice body = getColumnAsSlice(*_stmt, RecordColumn::BodyOrSize);
+                if ( BodyCompressor::isCompressed(rawFlags) ) {
+                    // Decompress directly into the arena:
+                    auto  header = BodyCompressor::readHeader(body);
+                    void* output = arena.alloc(header.size, kViewAlignment);
+                    _store.db().bodyDictionaries().decompress(header, output);
+                    view.body = {output, header.size};
+                } else {
+                    view.body = copyToArena(body, arena);
+                }
+                view.bodySize = view.body.size;
+            }
+
+            if ( _content >= kEntireBody ) {
+                view.extra     = copyToArena(getColumnAsSlice(*_stmt, RecordColumn::ExtraOrSize), arena);
+                view.extraSize = view.extra.size;
+            } else {
+                view.extra     = nullslice;
+                view.extraSize = (size_t)int64_t(_stmt->getColumn(RecordColumn::ExtraOrSize));
+            }
+
+            view.expiration = expiration_t(int64_t(_stmt->getColumn(RecordColumn::Expiration)));
             return true;
         }
 
@@ -44,6 +86,7 @@ namespace litecore {
         [[nodiscard]] sequence_t sequence() const override { return sequence_t(int64_t(_stmt->getColumn(0))); }
 
       private:
+        const SQLiteKeyStore&         _store;
         unique_ptr<SQLite::Statement> _stmt;
         ContentOption                 _content;
     };
@@ -108,7 +151,7 @@ namespace litecore {
         if ( bySequence ) stmt->bind(1, (long long)options.minSequence);
         else if ( options.startKey )
             stmt->bind(1, (const char*)options.startKey.buf, (int)options.startKey.size);
-        return new SQLiteEnumerator(stmt, options.contentOption);
+        return new SQLiteEnumerator(*this, stmt, options.contentOption);
     }
 
 }  // namespace litecore
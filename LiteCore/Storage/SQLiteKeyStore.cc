@@ -13,6 +13,7 @@
 #include "SQLiteKeyStore.hh"
 #include "SQLiteDataFile.hh"
 #include "SQLite_Internal.hh"
+#include "BodyCompressor.hh"
 #include "Record.hh"
 #include "Error.hh"
 #include "StringUtil.hh"
@@ -65,6 +66,8 @@ namespace litecore {
         reopen();
     }
 
+    SQLiteKeyStore::~SQLiteKeyStore() = default;
+
     void SQLiteKeyStore::createTable() {
         // Here's the table schema. The body comes last because it may be very large, and it's
         // more efficient in SQLite to keep large columns at the end of a row.
@@ -86,6 +89,10 @@ namespace litecore {
     void SQLiteKeyStore::close() {
         // If statements are left open, closing the database will fail with a "db busy" error...
         _stmtCache.clear();
+        for ( auto& stmt : _preparedStmts ) stmt.reset();
+        _bodyCompressor        = nullptr;
+        _bodyCompressorLoaded  = false;
+        _bodyCompressorChecked = false;
         KeyStore::close();
     }
 
@@ -128,6 +135,42 @@ namespace litecore {
         return *i->second;
     }
 
+    SQLite::Statement& SQLiteKeyStore::compileCached(PreparedStmt which) const {
+        // SQL templates of the PreparedStmts, in the same order.
+        // Note: In the SELECT statements the result column order must match RecordColumn.
+        static constexpr const char* kSQL[] = {
+                // ReadByKey + kMetaOnly, kCurrentRevOnly, kEntireBody:
+                "SELECT sequence, flags, null, version, length(body), length(extra) FROM kv_@ WHERE key=?",
+                "SELECT sequence, flags, null, version, body, length(extra) FROM kv_@ WHERE key=?",
+                "SELECT sequence, flags, null, version, body, extra FROM kv_@ WHERE key=?",
+                // ReadBySequence + kMetaOnly, kCurrentRevOnly, kEntireBody:
+                "SELECT null, flags, key, version, length(body), length(extra) FROM kv_@ WHERE sequence=?",
+                "SELECT null, flags, key, version, body, length(extra) FROM kv_@ WHERE sequence=?",
+                "SELECT null, flags, key, version, body, extra FROM kv_@ WHERE sequence=?",
+                // SetKV:
+                "INSERT OR REPLACE INTO kv_@ (key, version, body) VALUES (?, ?, ?)",
+                // Insert, Update:
+                "INSERT OR IGNORE INTO kv_@ (version, body, extra, flags, sequence, key) VALUES (?, ?, ?, ?, ?, ?)",
+                "UPDATE kv_@ SET version=?, body=?, extra=?, flags=?, sequence=?"
+                " WHERE key=? AND sequence=? AND (flags >> 16) = ?",
+                // Delete, DeleteSequence, DeleteSubsequence:
+                "DELETE FROM kv_@ WHERE key=?",
+                "DELETE FROM kv_@ WHERE key=? AND sequence=?",
+                "DELETE FROM kv_@ WHERE key=? AND sequence=? AND (flags >> 16) = ?",
+                // SetDocumentFlag ("flags + 0x10000" increments the subsequence, for MVCC):
+                "UPDATE kv_@ SET flags = ((flags + 0x10000) | ?) WHERE key=? AND sequence=?",
+        };
+        static_assert(std::size(kSQL) == size_t(PreparedStmt::Count));
+
+        auto& stmt = _preparedStmts[size_t(which)];
+        if ( !stmt ) {
+            stmt = db().compile(subst(kSQL[size_t(which)]).c_str());
+        } else {
+            db().checkOpen();
+        }
+        return *stmt;
+    }
+
     uint64_t SQLiteKeyStore::recordCount(bool includeDeleted) const {
         auto&          stmt = compileCached(includeDeleted ? "SELECT count(*) FROM kv_@"
                                                            : "SELECT count(*) FROM kv_@ WHERE (flags & 1) != 1");
@@ -216,11 +259,14 @@ namespace litecore {
             _purgeCountChanged = false;
         }
 
-        _lastSequence    = nullopt;
-        _purgeCountValid = false;
+        _lastSequence          = nullopt;
+        _purgeCountValid       = false;
+        _bodyCompressorChecked = false;
 
         if ( !commit ) {
             if ( _uncommitedTable ) { close(); }
+            // The compression settings may have been changed by the aborted transaction:
+            _bodyCompressorLoaded = false;
         }
 
         _uncommitedTable = false;
@@ -231,8 +277,8 @@ namespace litecore {
     }
 
     // The columns in `stmt` must match RecordColumn.
-    /*static*/ void SQLiteKeyStore::setRecordMetaAndBody(Record& rec, SQLite::Statement& stmt, ContentOption content,
-                                                         bool setKey, bool setSequence) {
+    void SQLiteKeyStore::setRecordMetaAndBody(Record& rec, SQLite::Statement& stmt, ContentOption content, bool setKey,
+                                              bool setSequence) const {
         rec.setExists();
         rec.setContentLoaded(content);
         if ( setKey ) rec.setKey(getColumnAsSlice(stmt, RecordColumn::Key));
@@ -246,9 +292,15 @@ namespace litecore {
 
         rec.setVersion(getColumnAsSlice(stmt, RecordColumn::Version));
 
-        if ( content == kMetaOnly ) rec.setUnloadedBodySize((ssize_t)stmt.getColumn(RecordColumn::BodyOrSize));
-        else
-            rec.setBody(getColumnAsSlice(stmt, RecordColumn::BodyOrSize));
+        // (With kMetaOnly, the size of a compressed body is its compressed size.)
+        if ( content == kMetaOnly ) {
+            rec.setUnloadedBodySize((ssize_t)stmt.getColumn(RecordColumn::BodyOrSize));
+        } else {
+            slice body = getColumnAsSlice(stmt, RecordColumn::BodyOrSize);
+            if ( BodyCompressor::isCompressed(rawFlags) ) rec.setBody(db().bodyDictionaries().decompress(body));
+            else
+                rec.setBody(body);
+        }
 
         if ( content >= kEntireBody ) rec.setExtra(getColumnAsSlice(stmt, RecordColumn::ExtraOrSize));
         else
@@ -281,17 +333,11 @@ namespace litecore {
         //  This statement does nothing if the sequence index has already been created.
         if ( by == ReadBy::Sequence ) const_cast<SQLiteKeyStore*>(this)->createSequenceIndex();
 
-        // Note: In this SELECT statement the result column order must match RecordColumn.
-        string sql;
-        sql.reserve(100);
-        sql = (by == ReadBy::Key) ? "SELECT sequence, flags, null, version" : "SELECT null, flags, key, version";
-        sql += (content >= kCurrentRevOnly) ? ", body" : ", length(body)";
-        sql += (content >= kEntireBody) ? ", extra" : ", length(extra)";
-        sql += " FROM kv_@ WHERE ";
-        sql += (by == ReadBy::Key) ? "key=?" : "sequence=?";
+        auto which = (by == ReadBy::Key) ? PreparedStmt::ReadByKey : PreparedStmt::ReadBySequence;
+        which      = PreparedStmt(int(which) + content);
 
         lock_guard<mutex> lock(_stmtMutex);
-        auto&             stmt = compileCached(sql);
+        auto&             stmt = compileCached(which);
         if ( by == ReadBy::Key ) {
             DebugAssert(rec.key());
             stmt.bindNoCopy(1, (const char*)rec.key().buf, (int)rec.key().size);
@@ -306,6 +352,41 @@ namespace litecore {
         return true;
     }
 
+    vector<Record> SQLiteKeyStore::getMany(const vector<slice>& keys, ContentOption content) const {
+        vector<Record> records;
+        records.reserve(keys.size());
+        if ( keys.empty() ) return records;
+
+        unordered_map<slice, size_t> keyIndices;  // maps key -> index in keys[]
+        keyIndices.reserve(keys.size());
+        for ( slice key : keys ) {
+            keyIndices.insert({key, records.size()});
+            records.emplace_back(key);
+        }
+
+        // Note: In this SELECT statement the result column order must match RecordColumn.
+        string sql = "SELECT sequence, flags, key, version";
+        sql += (content >= kCurrentRevOnly) ? ", body" : ", length(body)";
+        sql += (content >= kEntireBody) ? ", extra" : ", length(extra)";
+        sql += " FROM " + quotedTableName() + " WHERE key IN carray(?1)";
+
+        SQLite::Statement stmt(db(), sql);
+        LogStatement(stmt);
+        stmt.bindArray(1, (const SQLite::Statement::text*)keys.data(), keys.size());
+        while ( stmt.executeStep() ) {
+            Record& rec = records[keyIndices[getColumnAsSlice(stmt, RecordColumn::Key)]];
+            setRecordMetaAndBody(rec, stmt, content, false, true);
+        }
+
+        // If a key appeared more than once, only its first Record was read; copy it to the others:
+        if ( keyIndices.size() < keys.size() ) {
+            for ( size_t i = 0; i < keys.size(); ++i ) {
+                if ( size_t first = keyIndices[keys[i]]; first != i ) records[i] = records[first];
+            }
+        }
+        return records;
+    }
+
     void SQLiteKeyStore::setKV(slice key, slice version, slice value, ExclusiveTransaction& t) {
         DebugAssert(key.size > 0);
         DebugAssert(!_capabilities.sequences);
@@ -314,7 +395,7 @@ namespace litecore {
 
         enum { KeyParam = 1, VersionParam, BodyParam };
 
-        auto&          stmt = compileCached("INSERT OR REPLACE INTO kv_@ (key, version, body) VALUES (?, ?, ?)");
+        auto&          stmt = compileCached(PreparedStmt::SetKV);
         UsingStatement u(stmt);
         stmt.bindNoCopy(KeyParam, (const char*)key.buf, (int)key.size);
         stmt.bindNoCopy(VersionParam, version.buf, (int)version.size);
@@ -340,6 +421,13 @@ namespace litecore {
             OldSubsequenceParam
         };
 
+        // Compress the body, if enabled and worthwhile:
+        slice       body = rec.body;
+        alloc_slice compressedBody;
+        if ( auto compressor = bodyCompressor() ) {
+            if ( (compressedBody = compressor->compress(body)) ) body = compressedBody;
+        }
+
         bool                              tryAgain = false;
         sequence_t                        ret;
         std::tuple<std::string, int, int> lastExcArgs;
@@ -367,13 +455,11 @@ namespace litecore {
             SQLite::Statement* stmt;
             if ( rec.sequence == 0_seq || flags & SetOptions::kInsert ) {
                 // Insert only:
-                stmt   = &compileCached("INSERT OR IGNORE INTO kv_@ (version, body, extra, flags, sequence, key)"
-                                          " VALUES (?, ?, ?, ?, ?, ?)");
+                stmt   = &compileCached(PreparedStmt::Insert);
                 opName = "insert";
             } else {
                 // Replace only:
-                stmt = &compileCached("UPDATE kv_@ SET version=?, body=?, extra=?, flags=?, sequence=?"
-                                      " WHERE key=? AND sequence=? AND (flags >> 16) = ?");
+                stmt = &compileCached(PreparedStmt::Update);
                 stmt->bind(OldSequenceParam, (long long)rec.sequence);
                 stmt->bind(OldSubsequenceParam, (long long)rec.subsequence);
                 opName = "update";
@@ -381,6 +467,7 @@ namespace litecore {
 
             sequence_t seq;
             int64_t    rawFlags = int(rec.flags);
+            if ( compressedBody ) rawFlags |= BodyCompressor::kCompressedFlag;
             if ( flags & kUpdateSequence ) {
                 seq = lastSequence() + 1;
             } else {
@@ -391,7 +478,7 @@ namespace litecore {
             }
 
             stmt->bindNoCopy(VersionParam, rec.version.buf, (int)rec.version.size);
-            stmt->bindNoCopy(BodyParam, rec.body.buf, (int)rec.body.size);
+            stmt->bindNoCopy(BodyParam, body.buf, (int)body.size);
             stmt->bindNoCopy(ExtraParam, rec.extra.buf, (int)rec.extra.size);
             stmt->bind(FlagsParam, (long long)rawFlags);
             stmt->bindNoCopy(KeyParam, (const char*)rec.key.buf, (int)rec.key.size);
@@ -443,15 +530,14 @@ namespace litecore {
         db()._logVerbose("SQLiteKeyStore(%s) del key '%.*s' seq %" PRIu64, _name.c_str(), SPLAT(key), (uint64_t)seq);
         if ( seq != 0_seq ) {
             if ( subseq ) {
-                stmt = &compileCached("DELETE FROM kv_@ WHERE key=? AND sequence=?"
-                                      " AND (flags >> 16) = ?");
+                stmt = &compileCached(PreparedStmt::DeleteSubsequence);
                 stmt->bind(3, (long long)*subseq);
             } else {
-                stmt = &compileCached("DELETE FROM kv_@ WHERE key=? AND sequence=?");
+                stmt = &compileCached(PreparedStmt::DeleteSequence);
             }
             stmt->bind(2, (long long)seq);
         } else {
-            stmt = &compileCached("DELETE FROM kv_@ WHERE key=?");
+            stmt = &compileCached(PreparedStmt::Delete);
         }
         stmt->bindNoCopy(1, (const char*)key.buf, (int)key.size);
         UsingStatement u(*stmt);
@@ -494,7 +580,7 @@ namespace litecore {
 
     bool SQLiteKeyStore::setDocumentFlag(slice key, sequence_t seq, DocumentFlags flags, ExclusiveTransaction&) {
         // "flags + 0x10000" increments the subsequence stored in the upper bits, for MVCC.
-        auto& stmt = compileCached("UPDATE kv_@ SET flags = ((flags + 0x10000) | ?) WHERE key=? AND sequence=?");
+        auto&          stmt = compileCached(PreparedStmt::SetDocumentFlag);
         UsingStatement u(stmt);
         stmt.bind(1, (unsigned)flags);
         stmt.bindNoCopy(2, (const char*)key.buf, (int)key.size);
@@ -548,6 +634,52 @@ namespace litecore {
         return results;
     }
 
+#pragma mark - BODY COMPRESSION:
+
+    // Upper limits on the sample of bodies a compression dictionary is trained from.
+    static constexpr int64_t kMaxDictionarySamples     = 1000;
+    static constexpr size_t  kMaxDictionarySampleBytes = 100 * BodyCompressor::kMaxDictionarySize;
+
+    BodyCompressor* SQLiteKeyStore::bodyCompressor() {
+        if ( !_bodyCompressorChecked ) {
+            // Once per transaction, check whether another connection has committed anything since
+            // the settings were loaded, since it may have changed them:
+            int64_t version = db().dataVersion();
+            if ( version != _bodyCompressorVersion ) _bodyCompressorLoaded = false;
+            _bodyCompressorVersion = version;
+            _bodyCompressorChecked = true;
+        }
+        if ( !_bodyCompressorLoaded ) {
+            _bodyCompressor       = db().bodyCompressor(name());
+            _bodyCompressorLoaded = true;
+        }
+        return _bodyCompressor.get();
+    }
+
+    void SQLiteKeyStore::setBodyCompression(size_t minBodySize, ExclusiveTransaction&) {
+        alloc_slice dictionary;
+        if ( minBodySize > 0 ) {
+            // Train the dictionary from a random sample of the live bodies that would be compressed:
+            vector<alloc_slice> samples;
+            size_t              sampleBytes = 0;
+            SQLite::Statement   stmt(db(), subst("SELECT body, flags FROM kv_@ WHERE (flags & 1) = 0 AND length(body) >= ?"
+                                                 " ORDER BY random() LIMIT ?"));
+            LogStatement(stmt);
+            stmt.bind(1, (long long)minBodySize);
+            stmt.bind(2, (long long)kMaxDictionarySamples);
+            while ( sampleBytes < kMaxDictionarySampleBytes && stmt.executeStep() ) {
+                slice body = getColumnAsSlice(stmt, 0);
+                samples.push_back(BodyCompressor::isCompressed(int64_t(stmt.getColumn(1)))
+                                          ? db().bodyDictionaries().decompress(body)
+                                          : alloc_slice(body));
+                sampleBytes += samples.back().size;
+            }
+            dictionary = BodyCompressor::trainDictionary(samples);
+        }
+        _bodyCompressor       = db().setBodyCompression(name(), minBodySize, dictionary);
+        _bodyCompressorLoaded = true;
+    }
+
 #pragma mark - EXPIRATION:
 
     // Returns true if the KeyStore's table has had the 'expiration' column added to it.
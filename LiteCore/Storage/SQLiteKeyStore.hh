@@ -12,6 +12,7 @@
 
 #pragma once
 #include "KeyStore.hh"
+#include <array>
 #include <atomic>
 #include <memory>
 #include <mutex>
@@ -32,6 +33,7 @@ namespace SQLite {
 
 namespace litecore {
 
+    class BodyCompressor;
     class SQLiteDataFile;
 
     namespace RecordColumn {
@@ -60,6 +62,8 @@ namespace litecore {
 
         bool read(Record& rec, ReadBy, ContentOption) const override;
 
+        std::vector<Record> getMany(const std::vector<slice>& keys, ContentOption) const override;
+
         sequence_t set(const RecordUpdate&, SetOptions, ExclusiveTransaction&) override;
         void       setKV(slice key, slice version, slice value, ExclusiveTransaction&) override;
 
@@ -70,6 +74,8 @@ namespace litecore {
 
         void moveTo(slice key, KeyStore& dst, ExclusiveTransaction&, slice newKey = nullslice) override;
 
+        void setBodyCompression(size_t minBodySize, ExclusiveTransaction&) override;
+
         bool         setExpiration(slice key, expiration_t) override;
         expiration_t getExpiration(slice key) override;
         expiration_t nextExpiration() override;
@@ -100,8 +106,24 @@ namespace litecore {
         bool                    mayHaveExpiration() override;
         RecordEnumerator::Impl* newEnumeratorImpl(RecordEnumerator::Options const&) override;
 
+        /// Statements used on the hottest paths. Each is compiled on first use and kept in
+        /// `_preparedStmts`, so getting it doesn't involve building or hashing any SQL.
+        enum class PreparedStmt : uint8_t {
+            ReadByKey,                       ///< `read` by key; add the ContentOption
+            ReadBySequence = ReadByKey + 3,  ///< `read` by sequence; add the ContentOption
+            SetKV          = ReadBySequence + 3,
+            Insert,             ///< `set` of a new record
+            Update,             ///< `set` of an existing record, with MVCC
+            Delete,             ///< `del` by key
+            DeleteSequence,     ///< `del` by key and sequence
+            DeleteSubsequence,  ///< `del` by key, sequence and subsequence
+            SetDocumentFlag,
+            Count
+        };
+
         std::unique_ptr<SQLite::Statement> compile(const char* sql) const;
         SQLite::Statement&                 compileCached(const std::string& sqlTemplate) const;
+        SQLite::Statement&                 compileCached(PreparedStmt) const;
 
         void transactionWillEnd(bool commit) override;
 
@@ -109,9 +131,9 @@ namespace litecore {
         void reopen() override;
 
         /// Updates a record's flags, version, body, extra from a statement whose column order
-        /// matches the RecordColumn enum.
-        static void setRecordMetaAndBody(Record& rec, SQLite::Statement& stmt, ContentOption, bool setKey,
-                                         bool setSequence);
+        /// matches the RecordColumn enum. Decompresses the body if necessary.
+        void setRecordMetaAndBody(Record& rec, SQLite::Statement& stmt, ContentOption, bool setKey,
+                                  bool setSequence) const;
 
         static slice columnAsSlice(const SQLite::Column&);
 
@@ -121,10 +143,13 @@ namespace litecore {
         friend class LazyIndexUpdate;
 
         SQLiteKeyStore(SQLiteDataFile&, const std::string& name, KeyStore::Capabilities options);
+        ~SQLiteKeyStore() override;
         void createTable();
 
         SQLiteDataFile& db() const { return (SQLiteDataFile&)dataFile(); }
 
+        BodyCompressor* bodyCompressor();
+
         std::string subst(const char* sqlTemplate) const;
         void        setLastSequence(sequence_t seq);
         void        incrementPurgeCount();
@@ -150,10 +175,12 @@ namespace litecore {
 #endif
 
         using StatementCache = std::unordered_map<std::string, std::unique_ptr<SQLite::Statement>>;
+        using PreparedStmts  = std::array<std::unique_ptr<SQLite::Statement>, size_t(PreparedStmt::Count)>;
 
         string                 _tableName, _quotedTableName;
         mutable std::mutex     _stmtMutex;
         mutable StatementCache _stmtCache;
+        mutable PreparedStmts  _preparedStmts;
         bool                   _createdSeqIndex{false}, _createdConflictsIndex{false}, _createdBlobsIndex{false};
         bool                   _lastSequenceChanged{false};
         bool                   _purgeCountChanged{false};
@@ -163,6 +190,10 @@ namespace litecore {
         bool                              _hasExpirationColumn{false};
         bool                              _uncommitedTable{false};
         SQLiteKeyStore*                   _sequencesOwner{nullptr};
+        std::unique_ptr<BodyCompressor>   _bodyCompressor;  // Compresses bodies, if enabled
+        bool                              _bodyCompressorLoaded{false};
+        bool                              _bodyCompressorChecked{false};  // Checked in this transaction
+        int64_t                           _bodyCompressorVersion{0};      // db's dataVersion when checked
     };
 
 }  // namespace litecore
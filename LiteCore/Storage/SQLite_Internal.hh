@@ -29,6 +29,7 @@ namespace fleece::impl {
 }  // namespace fleece::impl
 
 namespace litecore {
+    class BodyDictionaries;
 
     /// Logger for SQL related activity.
     extern LogDomain SQL;
@@ -62,10 +63,12 @@ namespace litecore {
 
     /** What the user_data of a registered SQL function points to. */
     struct fleeceFuncContext {
-        fleeceFuncContext(DataFile::Delegate* d, fleece::impl::SharedKeys* sk) : delegate(d), sharedKeys(sk) {}
+        fleeceFuncContext(DataFile::Delegate* d, fleece::impl::SharedKeys* sk, BodyDictionaries* bd = nullptr)
+            : delegate(d), sharedKeys(sk), bodyDictionaries(bd) {}
 
         DataFile::Delegate*             delegate;
         fleece::impl::SharedKeys* const sharedKeys;
+        BodyDictionaries* const         bodyDictionaries;  // For decompressing `body` columns
     };
 
     /// Registers all our SQL functions. Called when opening a database.
@@ -33,6 +33,10 @@ namespace litecore::actor {
     class Actor;
     class AsyncContext;
 
+    namespace coro {
+        class AsyncPromiseBase;
+    }
+
 
     //// Some support code for asynchronize(), from http://stackoverflow.com/questions/42124866
     template <class RetVal, class T, class... Args>
@@ -53,9 +57,10 @@ namespace litecore::actor {
 #    define ACTOR_BIND_FN(FN, ARGS)               ^{ FN((ARGS)...); }
 #else
     using Mailbox = ThreadedMailbox;
-#    define ACTOR_BIND_METHOD0(RCVR, METHOD)      std::bind(METHOD, RCVR)
-#    define ACTOR_BIND_METHOD(RCVR, METHOD, ARGS) std::bind(METHOD, RCVR, ARGS...)
-#    define ACTOR_BIND_FN(FN, ARGS)               std::bind(FN, ARGS...)
+#    define ACTOR_BIND_METHOD0(RCVR, METHOD)      ActorMessage::method(RCVR, METHOD)
+#    define ACTOR_BIND_METHOD(RCVR, METHOD, ARGS)                                                                      \
+        ActorMessage::method(RCVR, METHOD, std::forward<decltype(ARGS)>(ARGS)...)
+#    define ACTOR_BIND_FN(FN, ARGS)               ActorMessage::function(FN, std::forward<decltype(ARGS)>(ARGS)...)
 #endif
 
 #define FUNCTION_TO_QUEUE(METHOD) #METHOD, &METHOD
@@ -101,9 +106,23 @@ namespace litecore::actor {
             @param parentMailbox  Used for limiting concurrency on some platforms: if non-null,
                         then only one Actor with the same parentMailbox can execute at once.
                         This helps control the number of threads created by the OS. This is only
-                        implemented on Apple platforms, where it determines the target queue. */
-        explicit Actor(LogDomain& domain, const std::string& name = "", Mailbox* parentMailbox = nullptr)
-            : Logging(domain), _mailbox(this, name, parentMailbox) {}
+                        implemented on Apple platforms, where it determines the target queue.
+            @param priority  How urgently the Actor's events should be handled, relative to other
+                        Actors', when there's more work than threads. */
+        explicit Actor(LogDomain& domain, const std::string& name = "", Mailbox* parentMailbox = nullptr,
+                       Priority priority = Priority::normal)
+            : Logging(domain), _mailbox(this, name, parentMailbox, priority) {}
+
+        /** Constructs an Actor with no parent mailbox and the given priority. (Passing `nullptr`
+            as the parent mailbox would be ambiguous with the Scheduler constructor below.) */
+        Actor(LogDomain& domain, const std::string& name, Priority priority)
+            : Actor(domain, name, (Mailbox*)nullptr, priority) {}
+
+#ifndef ACTORS_USE_GCD
+        /** Constructs an Actor that runs on a specific Scheduler instead of the shared one. */
+        Actor(LogDomain& domain, const std::string& name, Scheduler* scheduler, Priority priority = Priority::normal)
+            : Logging(domain), _mailbox(this, name, nullptr, priority, scheduler) {}
+#endif
 
         /** Schedules a call to a method. */
         template <class Rcvr, class... Args>
@@ -149,15 +168,14 @@ namespace litecore::actor {
             return Async<T>(this, bodyFn);
         }
 
-        void wakeAsyncContext(AsyncContext* context) {
-            _mailbox.enqueue(ACTOR_BIND_METHOD0(context, &AsyncContext::next));
-        }
+        void wakeAsyncContext(AsyncContext* context) { context->enqueueNext(this); }
 #endif
 
       private:
         friend class ThreadedMailbox;
         friend class GCDMailbox;
         friend class AsyncContext;
+        friend class coro::AsyncPromiseBase;
 
         template <class ACTOR, class ITEM>
         friend class ActorBatcher;
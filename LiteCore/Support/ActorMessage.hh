@@ -0,0 +1,144 @@
+//
+// ActorMessage.hh
+//
+// Copyright 2026-Present Couchbase, Inc.
+//
+// Use of this software is governed by the Business Source License included
+// in the file licenses/BSL-Couchbase.txt.  As of the Change Date specified
+// in that file, in accordance with the Business Source License, use of this
+// software will be governed by the Apache License, Version 2.0, included in
+// the file licenses/APL2.txt.
+//
+
+#pragma once
+#include "AllocationCounter.hh"
+#include <cstddef>
+#include <new>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace litecore::actor {
+
+    /** A move-only, type-erased `void()` callable, used by ThreadedMailbox to represent a pending
+        call to an Actor method. Unlike `std::function`, a callable of up to `kInlineSize` bytes
+        is stored inline, so a method call with a handful of arguments (including `Retained<>` or
+        `alloc_slice`) needs no heap allocation. Larger callables fall back to the heap. */
+    class ActorMessage {
+      public:
+        static constexpr size_t kInlineSize = 12 * sizeof(void*);
+
+        ActorMessage() noexcept = default;
+
+        template <class F, class = std::enable_if_t<!std::is_same_v<std::decay_t<F>, ActorMessage>>>
+        ActorMessage(F&& fn) {  // NOLINT(google-explicit-constructor)
+            using Fn = std::decay_t<F>;
+            if constexpr ( fitsInline<Fn>() ) {
+                ::new (&_storage) Fn(std::forward<F>(fn));
+                _ops = &InlineOps<Fn>::kOps;
+            } else {
+                AllocationCounter::allocating();
+                *reinterpret_cast<Fn**>(&_storage) = new Fn(std::forward<F>(fn));
+                _ops                               = &HeapOps<Fn>::kOps;
+            }
+        }
+
+        /** Creates a message that calls a method on `rcvr`. The arguments are copied or moved
+            into the message, just as `std::bind` would, and passed to the method as lvalues. */
+        template <class Rcvr, class Method, class... Args>
+        static ActorMessage method(Rcvr* rcvr, Method fn, Args&&... args) {
+            return ActorMessage([rcvr, fn, argTuple = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                std::apply([&](auto&... a) { (rcvr->*fn)(a...); }, argTuple);
+            });
+        }
+
+        /** Creates a message that calls a function or other callable with the given arguments. */
+        template <class Fn, class... Args>
+        static ActorMessage function(Fn fn, Args&&... args) {
+            return ActorMessage(
+                    [fn = std::move(fn), argTuple = std::make_tuple(std::forward<Args>(args)...)]() mutable {
+                        std::apply(fn, argTuple);
+                    });
+        }
+
+        ActorMessage(ActorMessage&& other) noexcept { moveFrom(other); }
+
+        ActorMessage& operator=(ActorMessage&& other) noexcept {
+            if ( this != &other ) {
+                reset();
+                moveFrom(other);
+            }
+            return *this;
+        }
+
+        ActorMessage(const ActorMessage&)            = delete;
+        ActorMessage& operator=(const ActorMessage&) = delete;
+
+        ~ActorMessage() { reset(); }
+
+        explicit operator bool() const noexcept { return _ops != nullptr; }
+
+        /** True if the callable is stored inline, i.e. constructing it didn't allocate. */
+        bool isInline() const noexcept { return _ops && _ops->isInline; }
+
+        void operator()() { _ops->invoke(&_storage); }
+
+        void reset() noexcept {
+            if ( _ops ) {
+                _ops->destroy(&_storage);
+                _ops = nullptr;
+            }
+        }
+
+      private:
+        struct Ops {
+            void (*invoke)(void*);
+            void (*move)(void* dst, void* src) noexcept;
+            void (*destroy)(void*) noexcept;
+            bool isInline;
+        };
+
+        template <class Fn>
+        static constexpr bool fitsInline() {
+            return sizeof(Fn) <= kInlineSize && alignof(Fn) <= alignof(std::max_align_t)
+                   && std::is_nothrow_move_constructible_v<Fn>;
+        }
+
+        template <class Fn>
+        struct InlineOps {
+            static void invoke(void* s) { (*static_cast<Fn*>(s))(); }
+
+            static void move(void* dst, void* src) noexcept {
+                ::new (dst) Fn(std::move(*static_cast<Fn*>(src)));
+                static_cast<Fn*>(src)->~Fn();
+            }
+
+            static void destroy(void* s) noexcept { static_cast<Fn*>(s)->~Fn(); }
+
+            static constexpr Ops kOps{&invoke, &move, &destroy, true};
+        };
+
+        template <class Fn>
+        struct HeapOps {
+            static void invoke(void* s) { (**static_cast<Fn**>(s))(); }
+
+            static void move(void* dst, void* src) noexcept { *static_cast<Fn**>(dst) = *static_cast<Fn**>(src); }
+
+            static void destroy(void* s) noexcept { delete *static_cast<Fn**>(s); }
+
+            static constexpr Ops kOps{&invoke, &move, &destroy, false};
+        };
+
+        void moveFrom(ActorMessage& other) noexcept {
+            if ( other._ops ) {
+                other._ops->move(&_storage, &other._storage);
+                _ops       = other._ops;
+                other._ops = nullptr;
+            }
+        }
+
+        alignas(std::max_align_t) std::byte _storage[kInlineSize];
+        const Ops* _ops{nullptr};
+    };
+
+}  // namespace litecore::actor
@@ -0,0 +1,183 @@
+//
+// ActorStats.cc
+//
+// Copyright 2026-Present Couchbase, Inc.
+//
+// Use of this software is governed by the Business Source License included
+// in the file licenses/BSL-Couchbase.txt.  As of the Change Date specified
+// in that file, in accordance with the Business Source License, use of this
+// software will be governed by the Apache License, Version 2.0, included in
+// the file licenses/APL2.txt.
+//
+
+#include "ActorStats.hh"
+#include "StringUtil.hh"
+#include <algorithm>
+#include <bit>
+#include <map>
+#include <mutex>
+
+using namespace std;
+
+namespace litecore::actor {
+
+    static void atomicMax(atomic<uint64_t>& a, uint64_t value) noexcept {
+        uint64_t cur = a.load(memory_order_relaxed);
+        while ( value > cur && !a.compare_exchange_weak(cur, value, memory_order_relaxed) ) {}
+    }
+
+#pragma mark - HISTOGRAM:
+
+    unsigned LatencyHistogram::bucketFor(uint64_t micros) noexcept {
+        if ( micros < 2 * kSubBuckets ) return unsigned(micros);
+        // The top `kSubBucketBits + 1` bits of the value determine its bucket:
+        auto exp    = unsigned(bit_width(micros)) - 1;
+        auto sub    = unsigned(micros >> (exp - kSubBucketBits)) & (kSubBuckets - 1);
+        auto bucket = (exp - kSubBucketBits + 1) * kSubBuckets + sub;
+        return min(bucket, kNumBuckets - 1);
+    }
+
+    uint64_t LatencyHistogram::bucketStart(unsigned bucket) noexcept {
+        if ( bucket < 2 * kSubBuckets ) return bucket;
+        unsigned exp = bucket / kSubBuckets + kSubBucketBits - 1;
+        unsigned sub = bucket % kSubBuckets;
+        return uint64_t(kSubBuckets + sub) << (exp - kSubBucketBits);
+    }
+
+    void LatencyHistogram::record(uint64_t micros) noexcept {
+        _buckets[bucketFor(micros)].fetch_add(1, memory_order_relaxed);
+        _count.fetch_add(1, memory_order_relaxed);
+        _total.fetch_add(micros, memory_order_relaxed);
+        atomicMax(_max, micros);
+    }
+
+    LatencyHistogram::Summary LatencyHistogram::summary() const {
+        Summary s;
+        s.max = _max.load(memory_order_relaxed);
+        array<uint64_t, kNumBuckets> counts;
+        for ( unsigned b = 0; b < kNumBuckets; ++b ) {
+            counts[b] = _buckets[b].load(memory_order_relaxed);
+            s.count += counts[b];
+        }
+        if ( s.count == 0 ) return s;
+        s.mean = double(_total.load(memory_order_relaxed)) / double(s.count);
+
+        // Percentiles are reported as the upper bound of the bucket they fall in:
+        auto     p50 = (s.count + 1) / 2, p90 = (s.count * 9 + 9) / 10, p99 = (s.count * 99 + 99) / 100;
+        uint64_t seen = 0;
+        for ( unsigned b = 0; b < kNumBuckets; ++b ) {
+            if ( counts[b] == 0 ) continue;
+            uint64_t limit = (b + 1 < kNumBuckets) ? min(bucketStart(b + 1) - 1, s.max) : s.max;
+            if ( seen < p50 && seen + counts[b] >= p50 ) s.p50 = limit;
+            if ( seen < p90 && seen + counts[b] >= p90 ) s.p90 = limit;
+            if ( seen < p99 && seen + counts[b] >= p99 ) s.p99 = limit;
+            seen += counts[b];
+            s.buckets.emplace_back(limit, counts[b]);
+        }
+        return s;
+    }
+
+#pragma mark - MAILBOX STATS:
+
+    namespace {
+        // The registry of live MailboxStats. It's never freed, since mailboxes may be destructed
+        // during or after static destruction.
+        struct Registry {
+            std::mutex                   mut;
+            uint64_t                     lastSerial{0};
+            map<uint64_t, MailboxStats*> mailboxes;
+        };
+
+        Registry& registry() {
+            static auto sRegistry = new Registry;
+            return *sRegistry;
+        }
+
+        uint64_t registerMailbox(MailboxStats* stats) {
+            Registry&  reg = registry();
+            lock_guard lock(reg.mut);
+            uint64_t   serial = ++reg.lastSerial;
+            reg.mailboxes.emplace(serial, stats);
+            return serial;
+        }
+    }  // namespace
+
+    MailboxStats::MailboxStats(string name)
+        : _name(std::move(name)), _serial(registerMailbox(this)), _createdAt(clock::now()) {}
+
+    MailboxStats::~MailboxStats() {
+        Registry&  reg = registry();
+        lock_guard lock(reg.mut);
+        reg.mailboxes.erase(_serial);
+    }
+
+    void MailboxStats::enqueued() noexcept {
+        uint64_t enqueued = _enqueued.fetch_add(1, memory_order_relaxed) + 1;
+        uint64_t handled  = _handled.load(memory_order_relaxed);
+        if ( enqueued > handled ) atomicMax(_maxQueueDepth, enqueued - handled);
+    }
+
+    void MailboxStats::handled(time_point enqueuedAt, time_point startedAt, time_point finishedAt) noexcept {
+        auto runTime = finishedAt - startedAt;
+        _waitTime.record(startedAt - enqueuedAt);
+        _runTime.record(runTime);
+        _busyMicros.fetch_add(uint64_t(chrono::duration_cast<chrono::microseconds>(runTime).count()),
+                              memory_order_relaxed);
+        _handled.fetch_add(1, memory_order_release);
+    }
+
+    void MailboxStats::batched(size_t items, size_t capacity, chrono::nanoseconds latency) noexcept {
+        _batchedItems.fetch_add(items, memory_order_relaxed);
+        _batchCapacity.store(capacity, memory_order_relaxed);
+        _batchLatencyNanos.store(uint64_t(max<int64_t>(latency.count(), 0)), memory_order_relaxed);
+        _batches.fetch_add(1, memory_order_relaxed);
+    }
+
+    MailboxStats::Snapshot MailboxStats::snapshot() const {
+        Snapshot s;
+        s.name          = _name;
+        s.serial        = _serial;
+        s.handled       = _handled.load(memory_order_acquire);  // (read before `_enqueued`)
+        s.enqueued      = _enqueued.load(memory_order_relaxed);
+        s.queueDepth    = (s.enqueued > s.handled) ? s.enqueued - s.handled : 0;
+        s.maxQueueDepth = _maxQueueDepth.load(memory_order_relaxed);
+        s.age           = chrono::duration<double>(clock::now() - _createdAt).count();
+        s.busy          = double(_busyMicros.load(memory_order_relaxed)) / 1e6;
+        s.waitTime      = _waitTime.summary();
+        s.runTime       = _runTime.summary();
+        s.batches       = _batches.load(memory_order_relaxed);
+        s.batchedItems  = _batchedItems.load(memory_order_relaxed);
+        s.batchCapacity = _batchCapacity.load(memory_order_relaxed);
+        s.batchLatency  = double(_batchLatencyNanos.load(memory_order_relaxed)) / 1e9;
+        return s;
+    }
+
+    vector<MailboxStats::Snapshot> MailboxStats::snapshotAll() {
+        Registry&        reg = registry();
+        lock_guard       lock(reg.mut);
+        vector<Snapshot> result;
+        result.reserve(reg.mailboxes.size());
+        for ( auto& [serial, stats] : reg.mailboxes ) result.push_back(stats->snapshot());
+        return result;
+    }
+
+    string MailboxStats::describe() const {
+        Snapshot s    = snapshot();
+        string   desc = stringprintf(
+                "%s handled %llu of %llu events; max queue depth was %llu; "
+                "wait p50/p99/max %llu/%llu/%llu µs; run p50/p99/max %llu/%llu/%llu µs; "
+                "busy %.3f sec (%.1f%%)",
+                s.name.c_str(), (unsigned long long)s.handled, (unsigned long long)s.enqueued,
+                (unsigned long long)s.maxQueueDepth, (unsigned long long)s.waitTime.p50,
+                (unsigned long long)s.waitTime.p99, (unsigned long long)s.waitTime.max,
+                (unsigned long long)s.runTime.p50, (unsigned long long)s.runTime.p99,
+                (unsigned long long)s.runTime.max, s.busy, (s.age > 0 ? s.busy / s.age * 100.0 : 0.0));
+        if ( s.batches > 0 ) {
+            desc += stringprintf("; %llu batches averaging %.1f items, last capacity %llu, latency %.1f ms",
+                                 (unsigned long long)s.batches, double(s.batchedItems) / double(s.batches),
+                                 (unsigned long long)s.batchCapacity, s.batchLatency * 1000.0);
+        }
+        return desc;
+    }
+
+}  // namespace litecore::actor
@@ -0,0 +1,134 @@
+//
+// ActorStats.hh
+//
+// Copyright 2026-Present Couchbase, Inc.
+//
+// Use of this software is governed by the Business Source License included
+// in the file licenses/BSL-Couchbase.txt.  As of the Change Date specified
+// in that file, in accordance with the Business Source License, use of this
+// software will be governed by the Apache License, Version 2.0, included in
+// the file licenses/APL2.txt.
+//
+
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace litecore::actor {
+
+    /** A lock-free histogram of durations in microseconds, in the style of HdrHistogram:
+        each power of two is divided into 4 linear sub-buckets, so a value's bucket is never off by
+        more than 25%, and 128 buckets cover everything up to about two hours.
+        Recording a value takes three relaxed atomic increments (bucket, count and total), plus a
+        compare-and-swap loop to update the maximum (skipped unless the value exceeds it.) */
+    class LatencyHistogram {
+      public:
+        static constexpr unsigned kSubBucketBits = 2;
+        static constexpr unsigned kSubBuckets    = 1u << kSubBucketBits;
+        static constexpr unsigned kNumBuckets    = 32 * kSubBuckets;
+
+        /** A point-in-time summary of a histogram. All times are in microseconds. */
+        struct Summary {
+            uint64_t count{0};
+            double   mean{0};
+            uint64_t p50{0}, p90{0}, p99{0}, max{0};
+            /// Non-empty buckets, as pairs of (upper bound, count):
+            std::vector<std::pair<uint64_t, uint64_t>> buckets;
+        };
+
+        void record(uint64_t micros) noexcept;
+
+        template <class Rep, class Period>
+        void record(std::chrono::duration<Rep, Period> d) noexcept {
+            auto micros = std::chrono::duration_cast<std::chrono::microseconds>(d).count();
+            record(uint64_t(micros > 0 ? micros : 0));
+        }
+
+        uint64_t count() const noexcept { return _count.load(std::memory_order_relaxed); }
+
+        Summary summary() const;
+
+        /** The index of the bucket a value goes in. */
+        static unsigned bucketFor(uint64_t micros) noexcept;
+        /** The smallest value that goes in a bucket. */
+        static uint64_t bucketStart(unsigned bucket) noexcept;
+
+      private:
+        std::array<std::atomic<uint64_t>, kNumBuckets> _buckets{};
+        std::atomic<uint64_t>                          _count{0};
+        std::atomic<uint64_t>                          _total{0};
+        std::atomic<uint64_t>                          _max{0};
+    };
+
+    /** Runtime statistics of an Actor's mailbox: how many events were enqueued and handled, how
+        deep the queue got, how long events waited in the queue and how long the Actor took to
+        handle them. Every mailbox has one, and they're always enabled.
+
+        Each instance registers itself in a process-wide list on construction, so that
+        `snapshotAll` can report on every live mailbox (this is what `c4_getActorStats` uses.) */
+    class MailboxStats {
+      public:
+        using clock      = std::chrono::steady_clock;
+        using time_point = clock::time_point;
+
+        explicit MailboxStats(std::string name);
+        ~MailboxStats();
+
+        MailboxStats(const MailboxStats&)            = delete;
+        MailboxStats& operator=(const MailboxStats&) = delete;
+
+        /** Call this just _before_ adding an event to the queue. (Calling it before, not after,
+            guarantees the handled count never exceeds the enqueued count.) */
+        void enqueued() noexcept;
+
+        /** Call this after handling an event, before removing it from the queue. */
+        void handled(time_point enqueuedAt, time_point startedAt, time_point finishedAt) noexcept;
+
+        /** Call this after the Actor processes a batch of items accumulated by a Batcher,
+            with the batcher's current capacity and latency. */
+        void batched(size_t items, size_t capacity, std::chrono::nanoseconds latency) noexcept;
+
+        /** A point-in-time copy of a mailbox's statistics. */
+        struct Snapshot {
+            std::string               name;
+            uint64_t                  serial{0};    ///< Unique per mailbox, in order of creation
+            uint64_t                  enqueued{0};  ///< Total events enqueued
+            uint64_t                  handled{0};   ///< Total events handled
+            uint64_t                  queueDepth{0}, maxQueueDepth{0};
+            double                    age{0};   ///< Seconds since the mailbox was created
+            double                    busy{0};  ///< Total seconds spent handling events
+            LatencyHistogram::Summary waitTime, runTime;
+            uint64_t                  batches{0}, batchedItems{0};  ///< Batches processed, and their total size
+            uint64_t                  batchCapacity{0};             ///< Most recent Batcher capacity
+            double                    batchLatency{0};              ///< Most recent Batcher latency, in seconds
+        };
+
+        Snapshot snapshot() const;
+
+        /** Returns snapshots of all live mailboxes, in order of creation. */
+        static std::vector<Snapshot> snapshotAll();
+
+        /** A one-line human-readable description, for logging. */
+        std::string describe() const;
+
+      private:
+        std::string const     _name;
+        uint64_t const        _serial;
+        time_point const      _createdAt;
+        std::atomic<uint64_t> _enqueued{0};
+        std::atomic<uint64_t> _handled{0};
+        std::atomic<uint64_t> _maxQueueDepth{0};
+        std::atomic<uint64_t> _busyMicros{0};
+        std::atomic<uint64_t> _batches{0};
+        std::atomic<uint64_t> _batchedItems{0};
+        std::atomic<uint64_t> _batchCapacity{0};
+        std::atomic<uint64_t> _batchLatencyNanos{0};
+        LatencyHistogram      _waitTime;
+        LatencyHistogram      _runTime;
+    };
+
+}  // namespace litecore::actor
@@ -0,0 +1,47 @@
+//
+// AllocationCounter.hh
+//
+// Copyright 2026-Present Couchbase, Inc.
+//
+// Use of this software is governed by the Business Source License included
+// in the file licenses/BSL-Couchbase.txt.  As of the Change Date specified
+// in that file, in accordance with the Business Source License, use of this
+// software will be governed by the Apache License, Version 2.0, included in
+// the file licenses/APL2.txt.
+//
+
+#pragma once
+#include <cstddef>
+
+namespace litecore::actor {
+
+    /** Counts the heap allocations the actor machinery makes on the current thread while it
+        exists: ActorMessage callables too big to store inline, MPSCQueue nodes that weren't in
+        the thread's cache, and coroutine frames that didn't come from a free list.
+        Counters nest; only the innermost one counts. This is for tests and benchmarks, and costs
+        nothing on the paths that don't allocate. */
+    class AllocationCounter {
+      public:
+        AllocationCounter() noexcept : _prev(sCurrent) { sCurrent = this; }
+
+        ~AllocationCounter() { sCurrent = _prev; }
+
+        AllocationCounter(const AllocationCounter&)            = delete;
+        AllocationCounter& operator=(const AllocationCounter&) = delete;
+
+        /// The number of allocations counted so far.
+        size_t count() const noexcept { return _count; }
+
+        /// Call this just before making an allocation that a counter should see.
+        static void allocating() noexcept {
+            if ( sCurrent ) ++sCurrent->_count;
+        }
+
+      private:
+        static inline thread_local AllocationCounter* sCurrent = nullptr;
+
+        AllocationCounter* _prev;
+        size_t             _count{0};
+    };
+
+}  // namespace litecore::actor
@@ -47,7 +47,7 @@ namespace litecore { namespace actor {
 
     void AsyncContext::start() {
         _waitingSelf = this;
-        if ( _actor && _actor != Actor::currentActor() ) _actor->wakeAsyncContext(this);  // Start on my Actor's queue
+        if ( _actor && _actor != Actor::currentActor() ) enqueueNext(_actor);  // Start on my Actor's queue
         else
             next();
     }
@@ -61,12 +61,21 @@ namespace litecore { namespace actor {
         assert(async == _calling);
         if ( _waitingActor ) {
             fleece::Retained<Actor> waitingActor = std::move(_waitingActor);
-            waitingActor->wakeAsyncContext(this);  // queues the next() call on its Mailbox
+            enqueueNext(waitingActor);  // queues the next() call on its Mailbox
         } else {
             next();
         }
     }
 
+    // Schedules a call to `next` on an Actor's queue. (AsyncContext is a friend of Actor.)
+    void AsyncContext::enqueueNext(Actor* actor) {
+#ifdef ACTORS_USE_GCD
+        actor->_mailbox.enqueue("AsyncContext::next", ^{ next(); });
+#else
+        actor->_mailbox.enqueue("AsyncContext::next", ActorMessage::method(this, &AsyncContext::next));
+#endif
+    }
+
     void AsyncContext::_gotResult() {
         _ready        = true;
         auto observer = _observer;
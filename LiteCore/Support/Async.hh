@@ -189,6 +189,7 @@ namespace litecore { namespace actor {
         void start();
         void _wait();
         void _gotResult();
+        void enqueueNext(Actor*);
 
         virtual void next() = 0;
 
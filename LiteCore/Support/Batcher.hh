@@ -13,7 +13,9 @@
 #pragma once
 #include "Logging.hh"
 #include "Timer.hh"
+#include <algorithm>
 #include <atomic>
+#include <chrono>
 #include <climits>
 #include <functional>
 #include <memory>
@@ -25,7 +27,20 @@ namespace litecore::actor {
     using fleece::Retained;
     static constexpr int AnyGen = INT_MAX;
 
-    /** A simple queue that adds objects one at a time and sends them to its target in a batch. */
+    /** Bounds for a Batcher's adaptive mode; see `Batcher::setAdaptive`. */
+    struct BatchTuning {
+        Timer::duration minLatency, maxLatency;    ///< Range of time to wait after the first item
+        size_t          minCapacity, maxCapacity;  ///< Range of batch size that triggers immediate processing
+                                                   ///< (0 if the Batcher has no capacity)
+    };
+
+    /** A simple queue that adds objects one at a time and sends them to its target in a batch.
+
+        By default the latency and capacity are fixed. In adaptive mode they're adjusted after each
+        batch, based on how long it took to process and how fast items are arriving: when items
+        trickle in, batches are processed almost immediately; under load, the batcher waits about
+        as long as processing a batch takes, so that the fixed cost of a batch (like a database
+        commit) is amortized over more items. */
     template <class ITEM>
     class Batcher {
       public:
@@ -38,14 +53,31 @@ namespace litecore::actor {
             , _latency(latency)
             , _capacity(capacity) {}
 
+        /** Enables adaptive mode, within the given bounds. The current latency and capacity are
+            clamped to the bounds, and adjusted from there as batches are processed. */
+        void setAdaptive(const BatchTuning& tuning) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _tuning   = tuning;
+            _adaptive = true;
+            _latency.store(std::clamp(_latency.load(), tuning.minLatency, tuning.maxLatency));
+            _capacity.store(std::clamp(_capacity.load(), tuning.minCapacity, tuning.maxCapacity));
+        }
+
+        /** The current latency: how long to wait after the first item is added to the queue. */
+        Timer::duration latency() const { return _latency.load(std::memory_order_relaxed); }
+
+        /** The current capacity: the queue size that triggers immediate processing. */
+        size_t capacity() const { return _capacity.load(std::memory_order_relaxed); }
+
         /** Adds an item to the queue, and schedules a call to the Actor if necessary.
             Thread-safe. */
         void push(ITEM* item) {
             std::lock_guard<std::mutex> lock(_mutex);
 
+            size_t capacity = _capacity.load(std::memory_order_relaxed);
             if ( !_items ) {
                 _items.reset(new std::vector<Retained<ITEM>>);
-                _items->reserve(_capacity ? _capacity : 200);
+                _items->reserve(capacity ? capacity : 200);
             }
             _items->push_back(item);
             if ( !_scheduled ) {
@@ -53,9 +85,10 @@ namespace litecore::actor {
                 _scheduled = true;
                 _processLater(_generation);
             }
-            if ( _latency > Timer::duration(0) && _capacity > 0 && _items->size() == _capacity ) {
+            if ( latency() > Timer::duration(0) && capacity > 0 && _items->size() >= capacity && !_full ) {
                 // I'm full -- schedule a pop NOW
                 LogVerbose(SyncLog, "Batcher scheduling immediate pop");
+                _full = true;
                 _processNow(_generation);
             }
         }
@@ -68,18 +101,58 @@ namespace litecore::actor {
 
             if ( gen < _generation ) return {};
             _scheduled = false;
+            _full      = false;
             ++_generation;
             return std::move(_items);
         }
 
+        /** Call this after processing a batch returned by `pop`, with the number of items and the
+            time it took. In adaptive mode this updates the latency and capacity.
+            Thread-safe. */
+        void processed(size_t count, Timer::duration cost) {
+            using namespace std::chrono;
+            std::lock_guard<std::mutex> lock(_mutex);
+            auto now = Timer::clock::now();
+            if ( _lastProcessed != Timer::time() ) {
+                // Arrival rate, in items/sec, and cost, in seconds, as moving averages:
+                double interval = duration<double>(now - _lastProcessed).count();
+                _rate           = 0.75 * _rate + 0.25 * (double(count) / std::max(interval, 1e-6));
+                _cost           = 0.75 * _cost + 0.25 * duration<double>(cost).count();
+            } else {
+                _cost = duration<double>(cost).count();
+            }
+            _lastProcessed = now;
+            if ( !_adaptive ) return;
+
+            // If under one item arrives in the time it takes to process a batch, waiting is pointless.
+            // Otherwise wait about as long as processing takes, which keeps the time spent
+            // processing to about half, and make room for everything that arrives meanwhile:
+            auto latency = _tuning.minLatency;
+            if ( _rate * _cost >= 1.0 ) {
+                latency = std::clamp(duration_cast<Timer::duration>(duration<double>(_cost)), _tuning.minLatency,
+                                     _tuning.maxLatency);
+            }
+            double expected = 1.5 * _rate * (duration<double>(latency).count() + _cost);
+            auto   capacity = std::clamp(size_t(std::min(expected, double(_tuning.maxCapacity))), _tuning.minCapacity,
+                                         _tuning.maxCapacity);
+            _latency.store(latency, std::memory_order_relaxed);
+            _capacity.store(capacity, std::memory_order_relaxed);
+        }
+
       private:
         std::function<void(int gen)> _processNow, _processLater;
-        Timer::duration              _latency;
-        size_t                       _capacity;
+        std::atomic<Timer::duration> _latency;
+        std::atomic<size_t>          _capacity;
         std::mutex                   _mutex;
         Items                        _items{};
         int                          _generation{0};
         bool                         _scheduled{false};
+        bool                         _full{false};      // True if an immediate pop has been scheduled
+        bool                         _adaptive{false};  // True in adaptive mode
+        BatchTuning                  _tuning{};         // Bounds for adaptive mode
+        Timer::time                  _lastProcessed{};  // When `processed` was last called
+        double                       _rate{0};          // Average arrival rate (items/sec)
+        double                       _cost{0};          // Average processing time of a batch (sec)
     };
 
     /** A simple queue that adds objects one at a time and sends them to an Actor in a batch. */
@@ -95,13 +168,22 @@ namespace litecore::actor {
                             is added to the queue. */
         ActorBatcher(ACTOR* actor, const char* name, Processor processor, Timer::duration latency = {},
                      size_t capacity = 0)
-            : Batcher<ITEM>(
-                    [actor, this, processor](int gen) { actor->enqueue(_name, processor, gen); },
-                    [actor, this, latency, processor](int gen) { actor->enqueueAfter(latency, _name, processor, gen); },
-                    latency, capacity)
+            : Batcher<ITEM>([actor, this, processor](int gen) { actor->enqueue(_name, processor, gen); },
+                            [actor, this, processor](int gen) {
+                                actor->enqueueAfter(this->latency(), _name, processor, gen);
+                            },
+                            latency, capacity)
+            , _actor(actor)
             , _name(name) {}
 
+        /** Same as `Batcher::processed`, but also records the batch in the Actor's mailbox stats. */
+        void processed(size_t count, Timer::duration cost) {
+            Batcher<ITEM>::processed(count, cost);
+            _actor->_mailbox.stats().batched(count, this->capacity(), this->latency());
+        }
+
       private:
+        ACTOR*      _actor;
         const char* _name;
     };
 
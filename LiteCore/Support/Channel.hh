@@ -22,10 +22,7 @@
 #    define ACTORS_USE_GCD
 #endif
 
-// TODO: Add developer switch / debug mode to enable these options at runtime
-// Set to 1 to have Actor object report performance statistics in their destructors
-#define ACTORS_TRACK_STATS 0
-
+// TODO: Add developer switch / debug mode to enable this option at runtime
 // Set to 1 to have Actor objects track their calls through manifests to provide an
 // async stack trace on exception
 #define ACTORS_USE_MANIFESTS 0
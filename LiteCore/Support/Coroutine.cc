@@ -0,0 +1,179 @@
+//
+// Coroutine.cc
+//
+// Copyright 2026-Present Couchbase, Inc.
+//
+// Use of this software is governed by the Business Source License included
+// in the file licenses/BSL-Couchbase.txt.  As of the Change Date specified
+// in that file, in accordance with the Business Source License, use of this
+// software will be governed by the Apache License, Version 2.0, included in
+// the file licenses/APL2.txt.
+//
+
+#include "Coroutine.hh"
+#include "AllocationCounter.hh"
+#include "Arena.hh"
+#include <mutex>
+#include <new>
+
+using namespace std;
+
+namespace litecore::actor::coro {
+
+#pragma mark - PROMISE:
+
+    bool AsyncPromiseBase::addContinuation(coroutine_handle<> awaiter) noexcept {
+        _continuation      = awaiter;
+        _continuationActor = Actor::currentActor();
+        State state        = kRunning;
+        if ( _state.compare_exchange_strong(state, kAwaited, memory_order_acq_rel) ) return true;
+        // The result became ready in the meantime, so don't suspend:
+        _continuation      = nullptr;
+        _continuationActor = nullptr;
+        return false;
+    }
+
+    coroutine_handle<> AsyncPromiseBase::finish() noexcept {
+        coroutine_handle<> next = noop_coroutine();
+        if ( _state.exchange(kDone, memory_order_acq_rel) == kAwaited ) {
+            // Resume the awaiter on its Actor's queue, or else right here:
+            Retained<Actor> actor = std::move(_continuationActor);
+            if ( actor && actor != Actor::currentActor() ) resumeOn(actor, _continuation);
+            else
+                next = _continuation;
+        }
+        release();  // may destroy this frame, but that's OK since it's suspended
+        return next;
+    }
+
+    void AsyncPromiseBase::resumeOn(Actor* actor, coroutine_handle<> h) {
+#ifdef ACTORS_USE_GCD
+        actor->_mailbox.enqueue("coroutine", ^{ h.resume(); });
+#else
+        actor->_mailbox.enqueue("coroutine", ActorMessage([h] { h.resume(); }));
+#endif
+    }
+
+#pragma mark - FRAME ALLOCATOR:
+
+    namespace {
+        constexpr size_t kNumSizeClasses = FrameAllocator::kMaxSize / FrameAllocator::kGranularity;
+        constexpr size_t kBatchSize      = 32;  // Blocks moved to or from the shared pool at once
+        constexpr size_t kMaxCached      = 4 * kBatchSize;
+        constexpr size_t kArenaChunkSize = 256 * 1024;
+
+        struct FreeBlock {
+            FreeBlock* next;
+        };
+
+        struct FreeList {
+            FreeBlock* first{nullptr};
+            size_t     count{0};
+
+            void push(void* block) noexcept {
+                auto b  = static_cast<FreeBlock*>(block);
+                b->next = first;
+                first   = b;
+                ++count;
+            }
+
+            void* pop() noexcept {
+                FreeBlock* b = first;
+                if ( b ) {
+                    first = b->next;
+                    --count;
+                }
+                return b;
+            }
+
+            // Moves up to `n` blocks to another list.
+            void moveTo(FreeList& other, size_t n) noexcept {
+                for ( ; n > 0 && first; --n ) other.push(pop());
+            }
+        };
+
+        // The shared pool, from which threads get more blocks and to which they return their
+        // surplus. Blocks are never returned to the Arena, so it's never freed.
+        struct SharedPool {
+            std::mutex mut;
+            Arena<>    arena{kArenaChunkSize};
+            FreeList   lists[kNumSizeClasses];
+        };
+
+        SharedPool& sharedPool() {
+            static auto sPool = new SharedPool;
+            return *sPool;
+        }
+
+        struct ThreadCache {
+            FreeList lists[kNumSizeClasses];
+            ~ThreadCache();
+        };
+
+        thread_local ThreadCache tCache;
+        thread_local bool        tCacheDestroyed = false;
+
+        ThreadCache::~ThreadCache() {
+            SharedPool& pool = sharedPool();
+            lock_guard  lock(pool.mut);
+            for ( size_t i = 0; i < kNumSizeClasses; ++i ) lists[i].moveTo(pool.lists[i], SIZE_MAX);
+            tCacheDestroyed = true;
+        }
+
+        constexpr size_t sizeClass(size_t size) { return (size - 1) / FrameAllocator::kGranularity; }
+
+        // Gets a batch of blocks from the shared pool, carving new ones from the arena if needed.
+        void refill(FreeList& list, size_t sizeClass) {
+            size_t      blockSize = (sizeClass + 1) * FrameAllocator::kGranularity;
+            SharedPool& pool      = sharedPool();
+            lock_guard  lock(pool.mut);
+            pool.lists[sizeClass].moveTo(list, kBatchSize);
+            if ( list.count == 0 ) {
+                AllocationCounter::allocating();
+                auto chunk = static_cast<uint8_t*>(pool.arena.alloc(blockSize * kBatchSize, alignof(max_align_t)));
+                for ( size_t i = 0; i < kBatchSize; ++i ) list.push(chunk + i * blockSize);
+            }
+        }
+    }  // namespace
+
+    void* FrameAllocator::alloc(size_t size) {
+        if ( size > kMaxSize ) {
+            AllocationCounter::allocating();
+            return ::operator new(size);
+        }
+        size_t cls = sizeClass(size);
+        if ( _usuallyFalse(tCacheDestroyed) ) {
+            // The thread is exiting and its cache is gone, so go straight to the shared pool:
+            FreeList temp;
+            refill(temp, cls);
+            void*       block = temp.pop();
+            SharedPool& pool  = sharedPool();
+            lock_guard  lock(pool.mut);
+            temp.moveTo(pool.lists[cls], SIZE_MAX);
+            return block;
+        }
+        FreeList& list = tCache.lists[cls];
+        if ( _usuallyFalse(list.count == 0) ) refill(list, cls);
+        return list.pop();
+    }
+
+    void FrameAllocator::free(void* frame, size_t size) noexcept {
+        if ( !frame ) return;
+        if ( size > kMaxSize ) return ::operator delete(frame);
+        size_t cls = sizeClass(size);
+        if ( _usuallyFalse(tCacheDestroyed) ) {
+            SharedPool& pool = sharedPool();
+            lock_guard  lock(pool.mut);
+            pool.lists[cls].push(frame);
+            return;
+        }
+        FreeList& list = tCache.lists[cls];
+        list.push(frame);
+        if ( _usuallyFalse(list.count > kMaxCached) ) {
+            SharedPool& pool = sharedPool();
+            lock_guard  lock(pool.mut);
+            list.moveTo(pool.lists[cls], kBatchSize);
+        }
+    }
+
+}  // namespace litecore::actor::coro
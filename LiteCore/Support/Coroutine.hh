@@ -0,0 +1,264 @@
+//
+// Coroutine.hh
+//
+// Copyright 2026-Present Couchbase, Inc.
+//
+// Use of this software is governed by the Business Source License included
+// in the file licenses/BSL-Couchbase.txt.  As of the Change Date specified
+// in that file, in accordance with the Business Source License, use of this
+// software will be governed by the Apache License, Version 2.0, included in
+// the file licenses/APL2.txt.
+//
+
+#pragma once
+#include "Actor.hh"
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace litecore::actor::coro {
+
+    /*
+     coro::Async<T> is the C++20 coroutine counterpart of Async<T> (see Async.hh.) A function that
+     returns one is a coroutine: it can `co_await` other Async values, and it returns its result
+     with `co_return`:
+
+        coro::Async<int> Puller::countRevs(RevList revs) {
+            auto  found = co_await _revFinder->findRevs(revs);    // may suspend here
+            co_return int(found.size());
+        }
+
+     There are no macros, no restrictions on variable scope, and no callbacks; the code between
+     two `co_await`s reads like ordinary code.
+
+     Calling a coroutine starts it running right away. The Async it returns is a handle to its
+     eventual result: `co_await` it from another coroutine, or check `ready()` and `result()`.
+     It's fine to drop the Async without awaiting it; the coroutine still runs to completion.
+     Only one coroutine may await a given Async.
+
+     THREADING
+
+     If the coroutine is a method of an Actor, its body always runs on that Actor's queue, just
+     like an enqueued method: if it's called from any other thread it starts by enqueueing itself,
+     and whenever it's resumed after awaiting a result that was produced elsewhere, it's enqueued
+     again. So it's effectively single-threaded, like any other Actor code. (The Actor is retained
+     until the coroutine finishes.)
+
+     Any other coroutine resumes on the queue of the Actor it was running on when it suspended,
+     or if it wasn't on an Actor, on whatever thread produced the result it was waiting for.
+
+     MEMORY
+
+     Coroutine frames are allocated by `FrameAllocator`, which keeps per-thread free lists of
+     frames carved out of a shared Arena. Once warmed up, calling a coroutine doesn't use the heap.
+     */
+
+    template <class T>
+    class Async;
+
+    /** Allocator for coroutine frames. Frames up to `kMaxSize` bytes are rounded up to a multiple
+        of `kGranularity`, and recycled through per-thread free lists, which are refilled in
+        batches from a shared pool; the pool carves new blocks out of an Arena. Larger frames
+        come from the heap. */
+    class FrameAllocator {
+      public:
+        static constexpr size_t kGranularity = 64;
+        static constexpr size_t kMaxSize     = 2048;
+
+        static void* alloc(size_t size);
+        static void  free(void* frame, size_t size) noexcept;
+    };
+
+    /** The type-independent part of a coroutine's promise. */
+    class AsyncPromiseBase {
+      public:
+        /// The compiler passes the coroutine's parameters to this constructor; if it's a method,
+        /// the first is the object. If that's an Actor, the coroutine will run on its queue.
+        /// (This isn't a constrained overload, because GCC 12 ignores those for promises.)
+        template <class Self, class... Args>
+        explicit AsyncPromiseBase(Self& self, Args&&...) {
+            if constexpr ( std::is_base_of_v<Actor, Self> ) {
+                _actor = const_cast<Actor*>(static_cast<const Actor*>(&self));
+            }
+        }
+
+        AsyncPromiseBase() = default;
+
+        static void* operator new(size_t size) { return FrameAllocator::alloc(size); }
+
+        static void operator delete(void* frame, size_t size) noexcept { FrameAllocator::free(frame, size); }
+
+        /// Starts the coroutine immediately, unless it has to run on an Actor's queue.
+        struct InitialAwaiter {
+            AsyncPromiseBase* promise;
+
+            bool await_ready() const noexcept {
+                return !promise->_actor || promise->_actor == Actor::currentActor();
+            }
+
+            void await_suspend(std::coroutine_handle<> h) const { resumeOn(promise->_actor, h); }
+
+            void await_resume() const noexcept {}
+        };
+
+        /// Wakes whoever's awaiting the result.
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+
+            template <class P>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) const noexcept {
+                return h.promise().finish();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        InitialAwaiter initial_suspend() noexcept { return {this}; }
+
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void unhandled_exception() noexcept { _exception = std::current_exception(); }
+
+        bool ready() const noexcept { return _state.load(std::memory_order_acquire) == kDone; }
+
+        /// Registers a coroutine to resume when the result is ready.
+        /// Returns false if it's already ready, in which case the caller shouldn't suspend.
+        bool addContinuation(std::coroutine_handle<> awaiter) noexcept;
+
+        /// Releases a reference to the coroutine frame; there's one from the coroutine itself, and
+        /// one from its Async.
+        void release() noexcept {
+            if ( _refs.fetch_sub(1, std::memory_order_acq_rel) == 1 ) _self.destroy();
+        }
+
+      protected:
+        enum State : uint8_t { kRunning, kAwaited, kDone };
+
+        void rethrowIfFailed() const {
+            if ( _exception ) std::rethrow_exception(_exception);
+        }
+
+        /// Marks the result ready, and returns the awaiting coroutine if it should be resumed
+        /// immediately on this thread.
+        std::coroutine_handle<> finish() noexcept;
+
+        /// Schedules a coroutine to resume on an Actor's queue.
+        static void resumeOn(Actor*, std::coroutine_handle<>);
+
+        std::coroutine_handle<> _self;               // My own coroutine
+        Retained<Actor>         _actor;              // Actor whose method I am, if any
+        std::coroutine_handle<> _continuation;       // Coroutine awaiting my result
+        Retained<Actor>         _continuationActor;  // Actor that `_continuation` runs on
+        std::exception_ptr      _exception;          // Exception thrown by the coroutine
+        std::atomic<State>      _state{kRunning};
+        std::atomic<int>        _refs{2};
+    };
+
+    /** The promise type of a coroutine returning `Async<T>`. */
+    template <class T>
+    class AsyncPromise : public AsyncPromiseBase {
+      public:
+        using AsyncPromiseBase::AsyncPromiseBase;
+
+        Async<T> get_return_object() noexcept {
+            _self = std::coroutine_handle<AsyncPromise>::from_promise(*this);
+            return Async<T>(std::coroutine_handle<AsyncPromise>::from_promise(*this));
+        }
+
+        template <class U>
+        void return_value(U&& value) {
+            _result.emplace(std::forward<U>(value));
+        }
+
+        const T& result() const {
+            rethrowIfFailed();
+            return *_result;
+        }
+
+        T extractResult() {
+            rethrowIfFailed();
+            return std::move(*_result);
+        }
+
+      private:
+        std::optional<T> _result;
+    };
+
+    template <>
+    class AsyncPromise<void> : public AsyncPromiseBase {
+      public:
+        using AsyncPromiseBase::AsyncPromiseBase;
+
+        Async<void> get_return_object() noexcept;
+
+        void return_void() noexcept {}
+
+        void result() const { rethrowIfFailed(); }
+
+        void extractResult() { rethrowIfFailed(); }
+    };
+
+    /** The result of a coroutine; see the comment at the top of this file. */
+    template <class T>
+    class Async {
+      public:
+        using promise_type = AsyncPromise<T>;
+        using ResultType   = T;
+
+        Async(Async&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+
+        Async& operator=(Async&& other) noexcept {
+            if ( this != &other ) {
+                if ( _handle ) _handle.promise().release();
+                _handle = std::exchange(other._handle, nullptr);
+            }
+            return *this;
+        }
+
+        ~Async() {
+            if ( _handle ) _handle.promise().release();
+        }
+
+        /// True once the coroutine has returned (or thrown.)
+        bool ready() const noexcept { return _handle.promise().ready(); }
+
+        /// The coroutine's result. Only call this when `ready()` is true.
+        /// If the coroutine threw an exception, this rethrows it.
+        decltype(auto) result() const { return _handle.promise().result(); }
+
+        template <bool Move>
+        struct Awaiter {
+            std::coroutine_handle<promise_type> handle;
+
+            bool await_ready() const noexcept { return handle.promise().ready(); }
+
+            bool await_suspend(std::coroutine_handle<> h) noexcept { return handle.promise().addContinuation(h); }
+
+            decltype(auto) await_resume() const {
+                if constexpr ( Move ) return handle.promise().extractResult();
+                else
+                    return handle.promise().result();
+            }
+        };
+
+        Awaiter<true> operator co_await() && noexcept { return {_handle}; }
+
+        Awaiter<false> operator co_await() const& noexcept { return {_handle}; }
+
+      private:
+        friend class AsyncPromise<T>;
+
+        explicit Async(std::coroutine_handle<promise_type> h) noexcept : _handle(h) {}
+
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    inline Async<void> AsyncPromise<void>::get_return_object() noexcept {
+        _self = std::coroutine_handle<AsyncPromise>::from_promise(*this);
+        return Async<void>(std::coroutine_handle<AsyncPromise>::from_promise(*this));
+    }
+
+}  // namespace litecore::actor::coro
@@ -17,6 +17,7 @@
 #include "Logging.hh"
 #include "c4Collection.hh"
 #include "c4ExceptionUtils.hh"
+#include <algorithm>
 #include <sstream>
 #include <chrono>
 
@@ -28,6 +29,9 @@ namespace litecore {
     /// The default number of read-only C4Databases in a pool.
     static constexpr size_t kDefaultReadOnlyCapacity = 4;
 
+    /// The smallest page cache a pooled C4Database will be given.
+    static constexpr size_t kMinCacheSize = 1024 * 1024;
+
 /// How long a thread will wait wait to borrow a C4Database, before throwing error::Busy.
 /// The exception is intended for detecting & breaking deadlocks, and should never happen in real use.
 /// 10 seconds seemed a reasonable value, but in some cases like replicating huge numbers of
@@ -49,7 +53,8 @@ namespace litecore {
         , _dbConfig(config)
         , _dbDir(_dbConfig.parentDirectory)
         , _readOnly(config.flags | kC4DB_ReadOnly, kDefaultReadOnlyCapacity)
-        , _readWrite(config.flags & ~kC4DB_ReadOnly, (_dbConfig.flags & kC4DB_ReadOnly) ? 0 : 1) {
+        , _readWrite(config.flags & ~kC4DB_ReadOnly, (_dbConfig.flags & kC4DB_ReadOnly) ? 0 : 1)
+        , _cacheBudget(0) {
         _dbConfig.parentDirectory = _dbDir;
     }
 
@@ -57,7 +62,8 @@ namespace litecore {
         logInfo("initial database is %s", nameOf(main).c_str());
         _dbTag              = _c4db_getDatabaseTag(main);
         Cache& cache        = writeable() ? _readWrite : _readOnly;
-        cache.entries[0].db = main;
+        cache.entries[0].db       = main;
+        cache.entries[0].external = true;  // Its cache size belongs to the caller
         cache.created++;
         cache.available++;
     }
@@ -109,6 +115,48 @@ namespace litecore {
                 --_readOnly.created;
             }
         }
+
+        // The remaining ones get a different share of the cache budget:
+        _updateCacheSizes();
+    }
+
+    size_t DatabasePool::cacheBudget() const noexcept {
+        unique_lock lock(_mutex);
+        return _cacheBudget;
+    }
+
+    void DatabasePool::setCacheBudget(size_t bytes) {
+        unique_lock lock(_mutex);
+        _cacheBudget = bytes;
+        _updateCacheSizes();
+    }
+
+    // The page-cache size each db gets: an even share of the budget, or 0 (the default size) if
+    // there's no budget. Must be called under the mutex.
+    size_t DatabasePool::cacheSizePerDB() const noexcept {
+        if ( _cacheBudget == 0 ) return 0;
+        unsigned capacity = _readOnly.capacity + _readWrite.capacity;
+        return std::max(_cacheBudget / capacity, kMinCacheSize);
+    }
+
+    // Sets an entry's db's page-cache size, if it's changed. Must be called under the mutex,
+    // while the db isn't borrowed.
+    void DatabasePool::updateCacheSize(Cache::Entry& entry) noexcept {
+        size_t size = cacheSizePerDB();
+        if ( entry.db && !entry.external && entry.cacheSize != size ) {
+            try {
+                entry.db->setCacheSize(size);
+                entry.cacheSize = size;
+            }
+            catchAndWarn();
+        }
+    }
+
+    void DatabasePool::_updateCacheSizes() noexcept {
+        for ( auto& entry : _readOnly.entries )
+            if ( entry.borrowCount == 0 ) updateCacheSize(entry);
+        for ( auto& entry : _readWrite.entries )
+            if ( entry.borrowCount == 0 ) updateCacheSize(entry);
     }
 
     bool DatabasePool::sameAs(C4Database* db) const noexcept {
@@ -195,7 +243,7 @@ namespace litecore {
             if ( !cache.writeable() && cache.borrowedCount() > 0 ) {
                 // A thread can borrow the same read-only database multiple times:
                 for ( auto& entry : cache.entries ) {
-                    if ( entry.borrower == tid ) {
+                    if ( entry.borrower == tid && !entry.inGroup ) {
                         DebugAssert(entry.borrowCount > 0);
                         return borrow(entry);
                     }
@@ -217,7 +265,10 @@ namespace litecore {
                 for ( auto& entry : cache.entries ) {
                     if ( entry.db == nullptr ) {
                         DebugAssert(entry.borrowCount == 0);
-                        entry.db = newDB(cache);
+                        entry.db        = newDB(cache);
+                        entry.cacheSize = 0;
+                        entry.external  = false;
+                        updateCacheSize(entry);
                         ++cache.created;
                         entry.borrower = tid;
                         return borrow(entry);
@@ -259,6 +310,63 @@ namespace litecore {
 
     BorrowedDatabase DatabasePool::tryBorrowWriteable() { return borrow(_readWrite, false); }
 
+    DatabasePool::SnapshotGroup DatabasePool::borrowSnapshotGroup(unsigned count) {
+        auto   tid   = std::this_thread::get_id();
+        Cache& cache = _readOnly;
+
+        // An in-memory database has no WAL, hence no snapshots; and with its rollback journal, a
+        // read transaction held open by the group would block every commit until it ended.
+        if ( _dbConfig.flags & kC4DB_InMemory )
+            error::_throw(error::UnsupportedOperation, "In-memory databases don't support snapshot groups");
+
+        // (`dbs` is declared before `lock` so that, if opening a db throws, the lock is released
+        // before the dbs already borrowed are returned.)
+        vector<BorrowedDatabase> dbs;
+        unique_lock              lock(_mutex);
+
+        // Wait until all `count` dbs can be borrowed at once. Borrowing them one at a time could
+        // deadlock, if two threads each ended up waiting for the dbs the other one holds.
+        auto timeout = std::chrono::system_clock::now() + kTimeout;
+        while ( true ) {
+            if ( _closed ) error::_throw(error::NotOpen, "DatabasePool is closed");
+            if ( count == 0 || count > cache.capacity )
+                error::_throw(error::InvalidParameter, "Can't borrow %u databases; read-only capacity is %u", count,
+                              cache.capacity);
+            unsigned unopened = cache.capacity - std::min(cache.created, cache.capacity);
+            if ( cache.available + unopened >= count ) break;
+            if ( _cond.wait_until(lock, timeout) == std::cv_status::timeout ) borrowFailed(cache);
+        }
+
+        // Each db is borrowed exclusively; unlike `borrow`, it's not shared with later borrows
+        // on the same thread, since it's in a transaction on an old snapshot.
+        auto borrow = [&](Cache::Entry& entry) {
+            entry.borrower    = tid;
+            entry.borrowCount = 1;
+            entry.inGroup     = true;
+            dbs.push_back(BorrowedDatabase(entry.db, this));
+        };
+        for ( auto& entry : cache.entries ) {
+            if ( dbs.size() < count && entry.db && entry.borrowCount == 0 ) {
+                --cache.available;
+                borrow(entry);
+            }
+        }
+        for ( auto& entry : cache.entries ) {
+            if ( dbs.size() < count && entry.db == nullptr ) {
+                entry.db        = newDB(cache);
+                entry.cacheSize = 0;
+                entry.external  = false;
+                updateCacheSize(entry);
+                ++cache.created;
+                borrow(entry);
+            }
+        }
+        DebugAssert(dbs.size() == count);
+
+        lock.unlock();
+        return SnapshotGroup(std::move(dbs));
+    }
+
     // Called by BorrowedDatabase's destructor and its reset method.
     void DatabasePool::returnDatabase(Ref<C4Database> db) {
         DebugAssert(db);
@@ -276,12 +384,14 @@ namespace litecore {
                 Assert(entry.borrowCount > 1 || !db->isInTransaction(), "Returning db while in transaction");
                 if ( --entry.borrowCount == 0 ) {
                     entry.borrower = {};
+                    entry.inGroup  = false;
                     if ( cache.created > cache.capacity || _closed ) {
                         // Toss out a DB if capacity was lowered after it was checked out, or I'm closed:
                         closeDB(std::move(db));
                         entry.db = nullptr;
                         --cache.created;
                     } else {
+                        updateCacheSize(entry);
                         ++cache.available;
                     }
                 }
@@ -293,6 +403,39 @@ namespace litecore {
         error::_throw(error::AssertionFailed, "DatabasePool::returnDatabase: db does not belong to pool");
     }
 
+#pragma mark - SNAPSHOT GROUP:
+
+    static void endSnapshotTransaction(C4Database* db) noexcept {
+        try {
+            asInternal(db)->dataFile()->endSnapshotTransaction();
+        }
+        catchAndWarn();
+    }
+
+    DatabasePool::SnapshotGroup::SnapshotGroup(vector<BorrowedDatabase> dbs) : _dbs(std::move(dbs)) {
+        // The first db's transaction captures the snapshot; the others then join it:
+        unique_ptr<DataFile::Snapshot> snapshot;
+        size_t                         begun = 0;
+        try {
+            for ( auto& db : _dbs ) {
+                DataFile* dataFile = asInternal(db)->dataFile();
+                if ( !snapshot )
+                    snapshot = dataFile->beginSnapshotTransaction();
+                else
+                    dataFile->beginSnapshotTransaction(snapshot.get());
+                ++begun;
+            }
+        } catch ( ... ) {
+            while ( begun > 0 ) endSnapshotTransaction(_dbs[--begun]);
+            throw;
+        }
+    }
+
+    void DatabasePool::SnapshotGroup::reset() noexcept {
+        for ( auto& db : _dbs ) endSnapshotTransaction(db);
+        _dbs.clear();
+    }
+
 #pragma mark - CACHE:
 
     DatabasePool::Cache::Cache(C4DatabaseFlags flags_, unsigned capacity_)
@@ -20,6 +20,7 @@
 #include <functional>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 C4_ASSUME_NONNULL_BEGIN
 
@@ -64,6 +65,8 @@ namespace litecore {
         /// Constructs a pool that will manage multiple instances of the given database file.
         /// If this database was opened read-only, then no writeable instances will be provided.
         /// @warning  The C4Database is now owned by the pool and shouldn't be used directly.
+        /// @note  The pool never changes this database's page-cache size; a cache budget only
+        ///        applies to the databases the pool opens itself.
         explicit DatabasePool(fleece::Ref<C4Database>&&);
 
         /// Closes all databases, waiting until all borrowed ones have been returned.
@@ -91,6 +94,16 @@ namespace litecore {
         /// Minimum value is 2 (otherwise why are you using a pool at all?)
         void setCapacity(unsigned capacity);
 
+        /// The total size in bytes of the page caches of all the pool's databases, or 0 if unset.
+        size_t cacheBudget() const noexcept;
+
+        /// Sets the total size of the page caches of all the pool's databases. It's divided evenly
+        /// among the pool's capacity, so adding connections doesn't add memory; the OS's file cache
+        /// (or memory-mapping) still shares pages between them.
+        /// Defaults to 0, which leaves each database with its usual cache size.
+        /// Databases currently borrowed are resized when they're returned.
+        void setCacheBudget(size_t bytes);
+
         /// True if this pool manages the same file as this database.
         bool sameAs(C4Database* db) const noexcept;
 
@@ -137,6 +150,20 @@ namespace litecore {
         /// @throws litecore::error `NotOpen` if `close` has been called.
         BorrowedDatabase tryBorrowWriteable();
 
+        class SnapshotGroup;
+
+        /// Borrows `count` different **read-only** databases, each in a read transaction on the same
+        /// snapshot: the latest commit at the time of the call. They don't see any later commits, so
+        /// they can be handed to `count` threads to read the database in parallel -- while another
+        /// thread is writing to it -- and get mutually consistent results.
+        /// When the `SnapshotGroup` goes out of scope, the databases are returned to the pool.
+        /// @note  If fewer than `count` read-only databases are available, waits until they are.
+        /// @throws litecore::error `InvalidParameter` if `count` is 0 or more than the read-only capacity.
+        /// @throws litecore::error `UnsupportedOperation` if the database is in-memory, since it has no WAL.
+        /// @throws litecore::error `NotOpen` if `close` has been called.
+        /// @throws litecore::error `Busy` after waiting ten seconds.
+        SnapshotGroup borrowSnapshotGroup(unsigned count);
+
         class Transaction;
 
         /// Creates a Transaction. Equivalent to `DatabasePool::Transaction(*pool)`.
@@ -160,9 +187,12 @@ namespace litecore {
             Cache(C4DatabaseFlags, unsigned capacity);
 
             struct Entry {
-                fleece::Retained<C4Database> db;               ///< Database (may be nullptr)
-                unsigned                     borrowCount = 0;  ///< Number of borrows
-                std::thread::id              borrower;         ///< Thread that borrowed it, if any
+                fleece::Retained<C4Database> db;                 ///< Database (may be nullptr)
+                unsigned                     borrowCount = 0;    ///< Number of borrows
+                std::thread::id              borrower;           ///< Thread that borrowed it, if any
+                size_t                       cacheSize = 0;      ///< Page cache size last set on db
+                bool                         inGroup   = false;  ///< Borrowed by a SnapshotGroup
+                bool                         external  = false;  ///< The db the pool was created with
             };
 
             C4DatabaseFlags const           flags;          ///< Flags for opening dbs
@@ -182,6 +212,9 @@ namespace litecore {
         [[noreturn]] void borrowFailed(Cache&);
 
         fleece::Ref<C4Database> newDB(Cache&);
+        size_t                  cacheSizePerDB() const noexcept;
+        void                    updateCacheSize(Cache::Entry&) noexcept;
+        void                    _updateCacheSizes() noexcept;
         void                    closeDB(fleece::Ref<C4Database>) noexcept;
         void                    returnDatabase(fleece::Ref<C4Database>);
         void                    _closeUnused(Cache&);
@@ -195,6 +228,7 @@ namespace litecore {
         std::function<void(C4Database*)> _initializer;     // Init fn called on each new database
         Cache                            _readOnly;        // Manages read-only databases
         Cache                            _readWrite;       // Manages writeable databases
+        size_t                           _cacheBudget;     // Total page-cache size of all dbs
         int                              _dbTag  = -1;     // C4DatabaseTag
         bool                             _closed = false;  // Set by `close`
     };
@@ -331,6 +365,31 @@ namespace litecore {
         C4Database* db() const noexcept LIFETIMEBOUND { return get(); }
     };
 
+    /** A group of read-only databases borrowed from a `DatabasePool`, all reading the same snapshot
+        of the database. Created by `DatabasePool::borrowSnapshotGroup`.
+        Each database may be used by a different thread. The group itself belongs to the thread that
+        borrowed it, which must destroy it (returning the databases) after the others are done. */
+    class DatabasePool::SnapshotGroup {
+      public:
+        SnapshotGroup(SnapshotGroup&&) noexcept = default;
+
+        ~SnapshotGroup() { reset(); }
+
+        /// The number of databases in the group.
+        size_t size() const noexcept { return _dbs.size(); }
+
+        C4Database* operator[](size_t i) const noexcept LIFETIMEBOUND { return _dbs[i].get(); }
+
+        /// Ends the databases' transactions and returns them to the pool, leaving me empty.
+        void reset() noexcept;
+
+      private:
+        friend class DatabasePool;
+        explicit SnapshotGroup(std::vector<BorrowedDatabase>);
+
+        std::vector<BorrowedDatabase> _dbs;
+    };
+
     BorrowedDatabase DatabaseOrPool::borrow() const { return _pool ? _pool->borrow() : BorrowedDatabase(_db); }
 
     inline DatabasePool::Transaction DatabasePool::transaction() { return Transaction(*this); }
@@ -22,35 +22,36 @@ using namespace std;
 namespace litecore::actor {
 
 
-#if ACTORS_TRACK_STATS
-#    define beginLatency() fleece::Stopwatch st
-#    define endLatency()   _maxLatency = max(_maxLatency, (double)st.elapsed())
-#    define beginBusy()    _busy.start()
-#    define endBusy()      _maxBusy = max(_maxBusy, _busy.lap())
-#else
-#    define beginLatency() void(0)
-#    define endLatency()   void(0)
-#    define beginBusy()    void(0)
-#    define endBusy()      void(0)
-#endif
-
-
     static char kQueueMailboxSpecificKey;
 
     static const qos_class_t kQOS = QOS_CLASS_UTILITY;
 
+    // The QoS class and relative priority of a mailbox's queue. (`normal` is the former default.)
+    static pair<qos_class_t, int> qosFor(Priority priority) {
+        switch ( priority ) {
+            case Priority::background:
+                return {kQOS, QOS_MIN_RELATIVE_PRIORITY / 2};
+            case Priority::interactive:
+                return {QOS_CLASS_USER_INITIATED, 0};
+            default:
+                return {kQOS, 0};
+        }
+    }
+
 #if ACTORS_USE_MANIFESTS
     thread_local shared_ptr<ChannelManifest> GCDMailbox::sQueueManifest = nullptr;
 #endif
 
-    GCDMailbox::GCDMailbox(Actor* a, const std::string& name, GCDMailbox* parentMailbox) : _actor(a) {
+    GCDMailbox::GCDMailbox(Actor* a, const std::string& name, GCDMailbox* parentMailbox, Priority priority)
+        : _actor(a), _stats(name) {
+        auto [qos, relativePriority] = qosFor(priority);
         dispatch_queue_t targetQueue;
         if ( parentMailbox ) targetQueue = parentMailbox->_queue;
         else
-            targetQueue = dispatch_get_global_queue(kQOS, 0);
+            targetQueue = dispatch_get_global_queue(qos, 0);
         auto                  nameCstr = name.empty() ? nullptr : name.c_str();
         dispatch_queue_attr_t attr     = DISPATCH_QUEUE_SERIAL;
-        attr                           = dispatch_queue_attr_make_with_qos_class(attr, kQOS, 0);
+        attr                           = dispatch_queue_attr_make_with_qos_class(attr, qos, relativePriority);
         attr   = dispatch_queue_attr_make_with_autorelease_frequency(attr, DISPATCH_AUTORELEASE_FREQUENCY_NEVER);
         _queue = dispatch_queue_create_with_target(nameCstr, attr, targetQueue);
         dispatch_queue_set_specific(_queue, &kQueueMailboxSpecificKey, this, nullptr);
@@ -83,9 +84,10 @@ namespace litecore::actor {
     }
 
     void GCDMailbox::enqueue(const char* name, void (^block)()) {
-        beginLatency();
+        _stats.enqueued();
         ++_eventCount;
         retain(_actor);
+        auto enqueuedAt = MailboxStats::clock::now();
 
 #if ACTORS_USE_MANIFESTS
         auto queueManifest = sQueueManifest ? sQueueManifest : make_shared<ChannelManifest>();
@@ -99,10 +101,9 @@ namespace litecore::actor {
           sQueueManifest = queueManifest;
           _localManifest.addExecution(_actor, name);
 #endif
-          endLatency();
-          beginBusy();
+          auto startedAt = MailboxStats::clock::now();
           safelyCall(block);
-          afterEvent();
+          afterEvent(enqueuedAt, startedAt);
 #if ACTORS_USE_MANIFESTS
           sQueueManifest.reset();
 #endif
@@ -111,9 +112,12 @@ namespace litecore::actor {
     }
 
     void GCDMailbox::enqueueAfter(delay_t delay, const char* name, void (^block)()) {
-        beginLatency();
+        _stats.enqueued();
         ++_eventCount;
         retain(_actor);
+        // The event's wait time is measured from when it's due to run:
+        auto enqueuedAt = MailboxStats::clock::now()
+                          + chrono::duration_cast<MailboxStats::clock::duration>(max(delay, delay_t::zero()));
 
 #if ACTORS_USE_MANIFESTS
         auto queueManifest = sQueueManifest ? sQueueManifest : make_shared<ChannelManifest>();
@@ -127,10 +131,9 @@ namespace litecore::actor {
           sQueueManifest = queueManifest;
           _localManifest.addExecution(_actor, name);
 #endif
-          endLatency();
-          beginBusy();
+          auto startedAt = MailboxStats::clock::now();
           safelyCall(block);
-          afterEvent();
+          afterEvent(enqueuedAt, startedAt);
 #if ACTORS_USE_MANIFESTS
           sQueueManifest.reset();
 #endif
@@ -141,27 +144,14 @@ namespace litecore::actor {
             dispatch_async(_queue, wrappedBlock);
     }
 
-    void GCDMailbox::afterEvent() {
+    void GCDMailbox::afterEvent(MailboxStats::time_point enqueuedAt, MailboxStats::time_point startedAt) {
         _actor->afterEvent();
-        endBusy();
-#if ACTORS_TRACK_STATS
-        ++_callCount;
-        if ( _eventCount > _maxEventCount ) { _maxEventCount = _eventCount; }
-#endif
+        _stats.handled(enqueuedAt, startedAt, MailboxStats::clock::now());
         --_eventCount;
         release(_actor);
     }
 
-    void GCDMailbox::logStats() const {
-#if ACTORS_TRACK_STATS
-        printf("%-25s handled %5d events; max queue depth was %3d; max latency was %10s; busy total %10s (%4.1f%%), "
-               "max %10s\n",
-               _actor->actorName().c_str(), _callCount, _maxEventCount,
-               fleece::Stopwatch::formatTime(_maxLatency).c_str(),
-               fleece::Stopwatch::formatTime(_busy.elapsed()).c_str(), (_busy.elapsed() / _createdAt.elapsed()) * 100.0,
-               fleece::Stopwatch::formatTime(_maxBusy).c_str());
-#endif
-    }
+    void GCDMailbox::logStats() const { LogVerbose(ActorLog, "%s", _stats.describe().c_str()); }
 
     void GCDMailbox::runAsyncTask(void (*task)(void*), void* context) {
         static dispatch_queue_t sAsyncTaskQueue;
@@ -25,7 +25,10 @@ namespace litecore::actor {
         Available on Apple platforms, or elsewhere if libdispatch is installed. */
     class GCDMailbox {
       public:
-        explicit GCDMailbox(Actor* a, const std::string& name = "", GCDMailbox* parentMailbox = nullptr);
+        /** Constructs a mailbox. If `parentMailbox` is given, its queue is the target queue;
+            `priority` determines the new queue's QoS class. */
+        explicit GCDMailbox(Actor* a, const std::string& name = "", GCDMailbox* parentMailbox = nullptr,
+                            Priority priority = Priority::normal);
         ~GCDMailbox();
 
         std::string name() const;
@@ -36,6 +39,11 @@ namespace litecore::actor {
         void enqueue(const char* name, void (^block)());
         void enqueueAfter(delay_t delay, const char* name, void (^block)());
 
+        /** Runtime statistics: event counts, queue depth, wait and run times. */
+        const MailboxStats& stats() const { return _stats; }
+
+        MailboxStats& stats() { return _stats; }
+
         void logStats() const;
 
         static Actor* currentActor();
@@ -46,26 +54,18 @@ namespace litecore::actor {
 
       private:
         void runEvent(void (^block)());
-        void afterEvent();
+        void afterEvent(MailboxStats::time_point enqueuedAt, MailboxStats::time_point startedAt);
         void safelyCall(void (^block)()) const;
 
         Actor*               _actor;
         dispatch_queue_t     _queue;
         std::atomic<int32_t> _eventCount{0};
+        MailboxStats         _stats;
 
 #if ACTORS_USE_MANIFESTS
         mutable ChannelManifest                              _localManifest;
         static thread_local std::shared_ptr<ChannelManifest> sQueueManifest;
 #endif
-
-#if ACTORS_TRACK_STATS
-        int32_t           _callCount{0};
-        int32_t           _maxEventCount{0};
-        double            _maxLatency{0};
-        double            _maxBusy{0};
-        fleece::Stopwatch _createdAt{true};
-        fleece::Stopwatch _busy{false};
-#endif
     };
 
 }  // namespace litecore::actor
@@ -11,15 +11,27 @@
 //
 
 #include "Instrumentation.hh"
+#include "StringUtil.hh"
+#include "ThreadUtil.hh"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #ifdef __APPLE__
 #    include <sys/kdebug_signpost.h>
 #    include <os/signpost.h>
 #endif
 
+using namespace std;
+
 namespace litecore {
 
-#if defined(__APPLE__) && LITECORE_SIGNPOSTS
+    atomic<bool> Signpost::sTracing{false};
+
+#ifdef __APPLE__
 
     static os_log_t LiteCore = os_log_create("com.couchbase.litecore", "signposts");
 
@@ -33,15 +45,254 @@ namespace litecore {
 
     void Signpost::mark(Type t, uintptr_t param, uintptr_t param2) {
         os_signpost_event_emit(LiteCore, t, "LiteCore", "%lu %lu %d %d", param, param2, 0, (t % 5));
+        if ( _usuallyFalse(tracing()) ) record(kMark, t, param, param2);
     }
 
     void Signpost::begin(Type t, uintptr_t param, uintptr_t param2) {
         os_signpost_interval_begin(LiteCore, t, "LiteCore", "%lu %lu %d %d", param, param2, 0, (t % 5));
+        if ( _usuallyFalse(tracing()) ) record(kBegin, t, param, param2);
     }
 
     void Signpost::end(Type t, uintptr_t param, uintptr_t param2) {
         os_signpost_interval_end(LiteCore, t, "LiteCore", "%lu %lu %d %d", param, param2, 0, (t % 5));
+        if ( _usuallyFalse(tracing()) ) record(kEnd, t, param, param2);
     }
 #endif
 
+    const char* Signpost::name(Type t) {
+        static constexpr const char* kNames[kNumTypes] = {
+                "?",
+                "transaction",
+                "replicatorConnect",
+                "replicatorDisconnect",
+                "replication",
+                "changesBackPressure",
+                "revsBackPressure",
+                "handlingChanges",
+                "handlingRev",
+                "blipReceived",
+                "blipSent",
+                "sqliteCommit",
+                "queryRun",
+                "indexUpdate",
+                "fleeceReencode",
+        };
+        return (t > 0 && t < kNumTypes) ? kNames[t] : kNames[0];
+    }
+
+#pragma mark - TRACE BUFFERS:
+
+    namespace {
+        using clock = chrono::steady_clock;
+
+        // A recorded signpost. The fields are atomic only so that a reader can copy them while the
+        // owning thread may be overwriting them; the reader detects and discards overwritten events.
+        struct TraceEvent {
+            atomic<int64_t>  time;  // nanoseconds since the clock's epoch
+            atomic<uint64_t> param, param2;
+            atomic<uint32_t> typeAndPhase;
+        };
+
+        // A single-producer ring buffer owned by one thread. `_head` counts all events ever
+        // written; event number `i` is stored in slot `i % kTraceBufferSize`.
+        class TraceBuffer {
+          public:
+            static constexpr size_t kSize = Signpost::kTraceBufferSize;
+            static_assert((kSize & (kSize - 1)) == 0, "kTraceBufferSize must be a power of 2");
+
+            // A thread that has written into this buffer, starting at event number `firstEvent`.
+            struct Owner {
+                uint64_t firstEvent;
+                unsigned tid;         // Small integer identifying the thread in the trace
+                string   threadName;  // Name of the thread, if any
+            };
+
+            // The threads that have used this buffer, oldest first. (Guarded by the registry's mutex.)
+            vector<Owner> owners;
+            atomic<bool>  inUse{false};  // False after the owning thread exits; then it can be reused
+
+            // Assigns the buffer to the current thread. (Called with the registry's mutex locked.)
+            void claim(unsigned tid, string threadName) {
+                uint64_t head = _head.load(memory_order_relaxed);
+                // Forget owners whose events have all been overwritten:
+                while ( owners.size() > 1 && owners[1].firstEvent + kSize <= head ) owners.erase(owners.begin());
+                owners.push_back({head, tid, std::move(threadName)});
+                inUse = true;
+            }
+
+            // Called only by the owning thread.
+            void add(uint32_t typeAndPhase, uint64_t param, uint64_t param2) noexcept {
+                uint64_t i = _head.load(memory_order_relaxed);
+                auto&    e = _events[i & (kSize - 1)];
+                // Keep these stores from moving above the previous event's `_head` store:
+                atomic_thread_fence(memory_order_release);
+                e.time.store(clock::now().time_since_epoch().count(), memory_order_relaxed);
+                e.param.store(param, memory_order_relaxed);
+                e.param2.store(param2, memory_order_relaxed);
+                e.typeAndPhase.store(typeAndPhase, memory_order_relaxed);
+                _head.store(i + 1, memory_order_release);
+            }
+
+            struct Event {
+                int64_t  time;
+                uint64_t param, param2;
+                uint32_t typeAndPhase;
+            };
+
+            // Copies the events out, and sets `firstEvent` to the number of the first one.
+            // Safe to call on any thread, even while events are being added, as long as the
+            // registry's mutex is locked (so `inUse` can't change.)
+            vector<Event> copy(uint64_t& firstEvent) const {
+                bool idle = !inUse.load(memory_order_acquire);
+                uint64_t end   = _head.load(memory_order_acquire);
+                uint64_t start = min(_start.load(memory_order_relaxed), end);
+                start          = max(start, end > kSize ? end - kSize : 0);
+
+                vector<Event> result;
+                result.reserve(end - start);
+                for ( uint64_t i = start; i < end; ++i ) {
+                    auto& e = _events[i & (kSize - 1)];
+                    result.push_back({e.time.load(memory_order_relaxed), e.param.load(memory_order_relaxed),
+                                      e.param2.load(memory_order_relaxed), e.typeAndPhase.load(memory_order_relaxed)});
+                }
+                // Any event the writer may have overwritten (or be overwriting) while we copied is
+                // garbage; drop those from the front:
+                atomic_thread_fence(memory_order_acquire);
+                uint64_t newHead = _head.load(memory_order_relaxed) + (idle ? 0 : 1);
+                if ( newHead > start + kSize ) {
+                    auto stale = min<uint64_t>(newHead - kSize - start, result.size());
+                    result.erase(result.begin(), result.begin() + ptrdiff_t(stale));
+                    start += stale;
+                }
+                firstEvent = start;
+                return result;
+            }
+
+            // Makes existing events invisible to `copy`.
+            void clear() noexcept { _start.store(_head.load(memory_order_acquire), memory_order_relaxed); }
+
+          private:
+            array<TraceEvent, kSize> _events;
+            atomic<uint64_t>         _head{0};
+            atomic<uint64_t>         _start{0};
+        };
+
+        // All trace buffers ever created. It's never freed, since threads may record signposts
+        // during or after static destruction.
+        struct TraceRegistry {
+            std::mutex                      mut;
+            vector<unique_ptr<TraceBuffer>> buffers;
+            unsigned                        lastTid{0};
+        };
+
+        TraceRegistry& registry() {
+            static auto sRegistry = new TraceRegistry;
+            return *sRegistry;
+        }
+
+        // Gets a buffer for the current thread, reusing one left behind by an exited thread if
+        // possible. (The exited thread's events stay in the trace until they're overwritten.)
+        TraceBuffer* claimBuffer() {
+            string         threadName = GetThreadName();
+            TraceRegistry& reg        = registry();
+            lock_guard     lock(reg.mut);
+            TraceBuffer*   buffer     = nullptr;
+            for ( auto& buf : reg.buffers ) {
+                if ( !buf->inUse.load(memory_order_relaxed) ) {
+                    buffer = buf.get();
+                    break;
+                }
+            }
+            if ( !buffer ) buffer = reg.buffers.emplace_back(make_unique<TraceBuffer>()).get();
+            buffer->claim(++reg.lastTid, std::move(threadName));
+            return buffer;
+        }
+
+        // Owns the current thread's claim on its buffer, and releases it when the thread exits.
+        struct ThreadTrace {
+            TraceBuffer* buffer = nullptr;
+            bool         exited = false;  // Set when the thread exits; after that, nothing's recorded
+
+            ~ThreadTrace() {
+                if ( buffer ) {
+                    lock_guard lock(registry().mut);
+                    buffer->inUse = false;
+                    buffer        = nullptr;
+                }
+                exited = true;
+            }
+        };
+
+        thread_local ThreadTrace tTrace;
+    }  // namespace
+
+    void Signpost::record(Phase phase, Type type, uintptr_t param, uintptr_t param2) noexcept {
+        TraceBuffer* buffer = tTrace.buffer;
+        if ( _usuallyFalse(!buffer) ) {
+            if ( tTrace.exited ) return;
+            try {
+                buffer = tTrace.buffer = claimBuffer();
+            } catch ( ... ) { return; }
+        }
+        buffer->add(uint32_t(type) << 8 | phase, param, param2);
+    }
+
+    void Signpost::setTracing(bool enabled) { sTracing.store(enabled, memory_order_relaxed); }
+
+    void Signpost::clearTrace() {
+        TraceRegistry& reg = registry();
+        lock_guard     lock(reg.mut);
+        for ( auto& buf : reg.buffers ) buf->clear();
+    }
+
+#pragma mark - EXPORT:
+
+    string Signpost::traceJSON() {
+        TraceRegistry& reg = registry();
+        lock_guard     lock(reg.mut);
+        string         json   = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool           first  = true;
+        auto           append = [&](const string& event) {
+            if ( !first ) json += ",\n";
+            first = false;
+            json += event;
+        };
+        for ( auto& buf : reg.buffers ) {
+            uint64_t eventNo;
+            auto     events = buf->copy(eventNo);
+            auto     owner  = buf->owners.begin();
+            bool     named  = false;
+            for ( auto& e : events ) {
+                while ( owner + 1 != buf->owners.end() && (owner + 1)->firstEvent <= eventNo ) {
+                    ++owner;
+                    named = false;
+                }
+                ++eventNo;
+                if ( !named && !owner->threadName.empty() ) {
+                    // (Thread names are set by LiteCore itself, so they don't need escaping.)
+                    append(stringprintf("{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%u,"
+                                        "\"args\":{\"name\":\"%s\"}}",
+                                        owner->tid, owner->threadName.c_str()));
+                }
+                named = true;
+
+                auto        type  = Type(e.typeAndPhase >> 8);
+                auto        phase = Phase(e.typeAndPhase & 0xFF);
+                double      ts    = double(e.time) / 1000.0;  // nanoseconds -> microseconds
+                const char* ph    = (phase == kBegin) ? "b" : (phase == kEnd) ? "e" : "i";
+                string      event = stringprintf("{\"ph\":\"%s\",\"cat\":\"LiteCore\",\"name\":\"%s\",\"pid\":1,"
+                                                 "\"tid\":%u,\"ts\":%.3f,",
+                                                 ph, name(type), owner->tid, ts);
+                if ( phase == kMark ) event += "\"s\":\"t\",";
+                else
+                    event += stringprintf("\"id\":\"%s:%llx\",", name(type), (unsigned long long)e.param);
+                event += stringprintf("\"args\":{\"param\":%llu,\"param2\":%llu}}", (unsigned long long)e.param,
+                                      (unsigned long long)e.param2);
+                append(event);
+            }
+        }
+        json += "]}";
+        return json;
+    }
+
 }  // namespace litecore
@@ -0,0 +1,150 @@
+//
+// MPSCQueue.hh
+//
+// Copyright 2026-Present Couchbase, Inc.
+//
+// Use of this software is governed by the Business Source License included
+// in the file licenses/BSL-Couchbase.txt.  As of the Change Date specified
+// in that file, in accordance with the Business Source License, use of this
+// software will be governed by the Apache License, Version 2.0, included in
+// the file licenses/APL2.txt.
+//
+
+#pragma once
+#include "AllocationCounter.hh"
+#include "Error.hh"
+#include <atomic>
+#include <thread>
+#include <utility>
+
+namespace litecore::actor {
+
+    /** A lock-free multiple-producer, single-consumer FIFO queue.
+        Any thread may call `push`, but only one thread at a time may call `front` and `pop`.
+        (ThreadedMailbox ensures this, since the Scheduler only runs a mailbox on one thread at once.)
+
+        This is Dmitry Vyukov's intrusive MPSC node queue: a push is one atomic exchange plus a
+        store, and never blocks. Nodes are recycled through a small per-thread free list, so in
+        the steady state a push doesn't allocate memory either.
+
+        The item count is kept separately from the linked list; it's what determines whether the
+        queue was empty before a push or is empty after a pop. A producer can be preempted between
+        incrementing the count and linking its node, so `front` may briefly have to spin. */
+    template <class T>
+    class MPSCQueue {
+      public:
+        MPSCQueue() : _head(&_stub), _tail(&_stub) {}
+
+        ~MPSCQueue() {
+            while ( _count > 0 ) pop();
+            if ( _tail != &_stub ) delete _tail;
+        }
+
+        MPSCQueue(const MPSCQueue&)            = delete;
+        MPSCQueue& operator=(const MPSCQueue&) = delete;
+
+        /** Adds a value to the end of the queue. Can be called on any thread.
+            @return  True if the queue was empty before the push. */
+        template <class U>
+        bool push(U&& value) {
+            Node* node  = allocNode();
+            node->value = std::forward<U>(value);
+            // Claim the count before linking the node, so a consumer that sees a nonzero count
+            // knows that a node is (or is about to be) available:
+            bool  wasEmpty = (_count.fetch_add(1, std::memory_order_acq_rel) == 0);
+            Node* prev     = _head.exchange(node, std::memory_order_acq_rel);
+            prev->next.store(node, std::memory_order_release);
+            return wasEmpty;
+        }
+
+        /** Returns the front item of the queue without popping it. The queue MUST be non-empty.
+            Only the consumer thread may call this. */
+        T& front() {
+            DebugAssert(_count > 0);
+            Node* next = _tail->next.load(std::memory_order_acquire);
+            while ( !next ) {
+                // A producer has claimed a slot but hasn't linked its node yet:
+                std::this_thread::yield();
+                next = _tail->next.load(std::memory_order_acquire);
+            }
+            return next->value;
+        }
+
+        /** Removes the front item. The queue MUST be non-empty. Only the consumer thread may call this.
+            @return  True if the queue is now empty. */
+        bool pop() {
+            (void)front();  // waits for the node to be linked
+            Node* oldTail = _tail;
+            Node* next    = oldTail->next.load(std::memory_order_acquire);
+            _tail         = next;
+            next->value   = T();  // `next` is the new stub; its value has been consumed
+            if ( oldTail != &_stub ) freeNode(oldTail);
+            else
+                _stub.next.store(nullptr, std::memory_order_relaxed);
+            return _count.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+
+        /** Returns the number of items in the queue. */
+        size_t size() const { return _count.load(std::memory_order_relaxed); }
+
+        bool empty() const { return size() == 0; }
+
+      private:
+        struct Node {
+            std::atomic<Node*> next{nullptr};
+            T                  value{};
+        };
+
+        /** Per-thread cache of free nodes. Nodes are freed by the consumer thread and allocated
+            by producers; since Actors mostly send messages to each other from Scheduler threads,
+            the caches stay roughly balanced. */
+        struct NodeCache {
+            static constexpr size_t kMaxNodes = 256;
+
+            Node*  first{nullptr};
+            size_t count{0};
+
+            ~NodeCache() {
+                while ( first ) {
+                    Node* next = first->next.load(std::memory_order_relaxed);
+                    delete first;
+                    first = next;
+                }
+            }
+        };
+
+        static NodeCache& nodeCache() {
+            thread_local NodeCache sCache;
+            return sCache;
+        }
+
+        static Node* allocNode() {
+            NodeCache& cache = nodeCache();
+            if ( Node* node = cache.first ) {
+                cache.first = node->next.load(std::memory_order_relaxed);
+                --cache.count;
+                node->next.store(nullptr, std::memory_order_relaxed);
+                return node;
+            }
+            AllocationCounter::allocating();
+            return new Node;
+        }
+
+        static void freeNode(Node* node) {
+            NodeCache& cache = nodeCache();
+            if ( cache.count < NodeCache::kMaxNodes ) {
+                node->next.store(cache.first, std::memory_order_relaxed);
+                cache.first = node;
+                ++cache.count;
+            } else {
+                delete node;
+            }
+        }
+
+        Node                _stub;  // Initial dummy node
+        std::atomic<Node*>  _head;  // Most recently pushed node; producers exchange this
+        Node*               _tail;  // Dummy node whose `next` is the front; consumer-only
+        std::atomic<size_t> _count{0};
+    };
+
+}  // namespace litecore::actor
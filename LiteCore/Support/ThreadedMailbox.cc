@@ -21,6 +21,7 @@
 #    include <future>
 #    include <random>
 #    include <map>
+#    include <optional>
 #    include <sstream>
 
 namespace { namespace threadStats {
@@ -41,7 +42,11 @@ namespace { namespace threadStats {
         time_point<system_clock> lastChecked;
         std::mutex               mutex;
 
-        void init(size_t numThreads) { enterTimes.resize(numThreads); }
+        void init(size_t numThreads) {
+            // There may be more than one Scheduler, so only ever grow the table:
+            std::lock_guard lock(mutex);
+            if ( numThreads > enterTimes.size() ) enterTimes.resize(numThreads);
+        }
 
         void enter(size_t taskID, actor::Actor* actor) {
             auto            time = system_clock::now();
@@ -54,37 +59,47 @@ namespace { namespace threadStats {
             enterTimes[taskID - 1] = {{}, nullptr};
         }
 
+        std::atomic<system_clock::rep> lastCheckedTicks{0};
+
         void check() {
-            auto              time = system_clock::now();
-            std::stringstream ss;
-            unsigned          count = 0;
+            auto time = system_clock::now();
+            // This is called on every enqueue, so skip the mutex unless a check is due:
+            if ( time.time_since_epoch().count() - lastCheckedTicks.load(std::memory_order_relaxed)
+                 < duration_cast<system_clock::duration>(checkInterval).count() )
+                return;
+
+            std::optional<std::stringstream> ss;  // Only constructed if there's something to report
+            unsigned                         count = 0;
             {
                 std::lock_guard lock(mutex);
 
                 if ( time - lastChecked < checkInterval ) {
                     return;
-                } else
+                } else {
                     lastChecked = time;
+                    lastCheckedTicks.store(time.time_since_epoch().count(), std::memory_order_relaxed);
+                }
 
                 for ( const auto& enter : enterTimes ) {
                     if ( enter.time.time_since_epoch() == system_clock::duration::zero() ) continue;
                     if ( auto elapsed = time - enter.time; elapsed > warningThreshold ) {
-                        if ( count++ > 0 ) ss << "\n";
+                        if ( !ss ) ss.emplace();
+                        if ( count++ > 0 ) *ss << "\n";
                         std::string objPath;
                         if ( LogObjectRef objRef = enter.actor->getObjectRef(); objRef != LogObjectRef::None ) {
                             objPath = loginternal::sObjectMap.getObjectPath(objRef);
                         }
-                        ss << "  actor=";
-                        if ( objPath.empty() ) ss << enter.actor;
+                        *ss << "  actor=";
+                        if ( objPath.empty() ) *ss << enter.actor;
                         else
-                            ss << objPath;
-                        ss << " timeInThread=" << duration_cast<milliseconds>(elapsed).count() << "ms";
+                            *ss << objPath;
+                        *ss << " timeInThread=" << duration_cast<milliseconds>(elapsed).count() << "ms";
                     }
                 }
             }
             if ( count > 0 ) {
                 LogWarn(ActorLog, "%u out of %zu threads are running for an excessive amount of time:\n%s", count,
-                        enterTimes.size(), ss.str().c_str());
+                        enterTimes.size(), ss->str().c_str());
             }
         }
 }}  // namespace ::threadStats
@@ -93,20 +108,6 @@ using namespace std;
 
 namespace litecore { namespace actor {
 
-#    if ACTORS_TRACK_STATS
-#        define beginLatency() fleece::Stopwatch st
-#        define endLatency()   _maxLatency = max(_maxLatency, (double)st.elapsed())
-#        define beginBusy()    _busy.start()
-#        define endBusy()      _busy.stop()
-#        define SELF           this, st
-#    else
-#        define beginLatency()
-#        define endLatency()
-#        define beginBusy()
-#        define endBusy()
-#        define SELF this
-#    endif
-
 #    pragma mark - SCHEDULER:
 
         struct RunAsyncActor : Actor {
@@ -132,52 +133,184 @@ namespace litecore { namespace actor {
             return sScheduler;
         }
 
+        thread_local Scheduler* Scheduler::sCurrentScheduler;
+        thread_local unsigned   Scheduler::sCurrentTaskID;
+
         void Scheduler::start() {
             if ( !_started.test_and_set() ) {
                 if ( _numThreads == 0 ) {
                     _numThreads = thread::hardware_concurrency();
                     if ( _numThreads == 0 ) _numThreads = 2;
                 }
-                LogTo(ActorLog, "Starting Scheduler<%p> with %u threads", this, _numThreads);
+                LogTo(ActorLog, "Starting Scheduler<%p> with %u threads%s", this, _numThreads,
+                      (_workStealing ? "" : " (no work-stealing)"));
                 threadStats::init(_numThreads);
+                _stopping = false;
+                _workers.clear();
+                for ( unsigned id = 1; id <= _numThreads; id++ ) _workers.emplace_back(make_unique<Worker>());
                 for ( unsigned id = 1; id <= _numThreads; id++ ) _threadPool.emplace_back([this, id] { task(id); });
             }
         }
 
         void Scheduler::stop() {
             LogTo(ActorLog, "Stopping Scheduler<%p>...", this);
-            _queue.close();
+            {
+                lock_guard<mutex> lock(_idleMutex);
+                _stopping = true;
+            }
+            _idleCond.notify_all();
             for ( auto& t : _threadPool ) { t.join(); }
+            _threadPool.clear();
             LogTo(ActorLog, "Scheduler<%p> has stopped", this);
             _started.clear();
         }
 
         void Scheduler::task(unsigned taskID) {
             LogVerbose(ActorLog, "   task %d starting", taskID);
-            constexpr size_t bufSize = 100;
-            char             name[bufSize];
-            snprintf(name, bufSize, "CBL Scheduler#%u", taskID);
-            SetThreadName(name);
+            if ( taskID > 0 ) {
+                constexpr size_t bufSize = 100;
+                char             name[bufSize];
+                snprintf(name, bufSize, "CBL Scheduler#%u", taskID);
+                SetThreadName(name);
+            }
+            sCurrentScheduler = this;
+            sCurrentTaskID    = taskID;
             ThreadedMailbox* mailbox;
-            while ( (mailbox = _queue.pop()) != nullptr ) {
+            unsigned         turn = 0;
+            while ( (mailbox = nextMailbox(taskID, turn++)) != nullptr ) {
                 LogVerbose(ActorLog, "   task %d calling Actor<%p>", taskID, mailbox);
-                threadStats::enter(taskID, mailbox->_actor);
+                if ( taskID > 0 ) threadStats::enter(taskID, mailbox->_actor);
 
                 mailbox->performNextMessage();
 
-                threadStats::exit(taskID);
+                if ( taskID > 0 ) threadStats::exit(taskID);
                 mailbox = nullptr;
             }
+            sCurrentScheduler = nullptr;
             LogTo(ActorLog, "   task %d finished", taskID);
         }
 
-        void Scheduler::schedule(ThreadedMailbox* mbox) { sScheduler->_queue.push(mbox); }
+        // The order in which a thread looks for work at each priority, on a given turn.
+        // (See the Scheduler class comment.)
+        static const array<Priority, kNumPriorities>& priorityOrder(unsigned turn) {
+            static constexpr array<Priority, kNumPriorities> kOrders[3] = {
+                    {{Priority::interactive, Priority::normal, Priority::background}},
+                    {{Priority::normal, Priority::interactive, Priority::background}},
+                    {{Priority::background, Priority::interactive, Priority::normal}},
+            };
+            if ( turn % 16 == 0 ) return kOrders[2];
+            if ( turn % 4 == 0 ) return kOrders[1];
+            return kOrders[0];
+        }
+
+        // Returns the next mailbox for a thread to run, blocking until one is available.
+        // Returns nullptr once the Scheduler is stopping and there's nothing left to run.
+        ThreadedMailbox* Scheduler::nextMailbox(unsigned taskID, unsigned turn) {
+            Worker* worker = (_workStealing && taskID > 0) ? _workers[taskID - 1].get() : nullptr;
+            while ( true ) {
+                for ( Priority p : priorityOrder(turn) ) {
+                    auto priority = unsigned(p);
+                    if ( _queuedByPriority[priority] == 0 ) continue;
+                    ThreadedMailbox* mbox = nullptr;
+                    if ( worker ) {
+                        lock_guard<mutex> lock(worker->mutex);
+                        auto&             queue = worker->queue[priority];
+                        if ( !queue.empty() ) {
+                            mbox = queue.front();
+                            queue.pop_front();
+                        }
+                    }
+                    if ( !mbox ) mbox = popGlobal(priority);
+                    if ( !mbox && _workStealing ) mbox = steal(taskID, priority);
+                    if ( mbox ) {
+                        --_queuedByPriority[priority];
+                        --_queuedCount;
+                        return mbox;
+                    }
+                }
 
+                // Nothing to do; go to sleep until something is scheduled.
+                // (The `_sleepers` / `_queuedCount` handshake with `schedule` prevents lost wakeups.)
+                unique_lock<mutex> lock(_idleMutex);
+                ++_sleepers;
+                _idleCond.wait(lock, [&] { return _queuedCount > 0 || _stopping; });
+                --_sleepers;
+                if ( _queuedCount == 0 && _stopping ) return nullptr;
+            }
+        }
 
-        // Explicitly instantiate the Channel specializations we need; this corresponds to the
-        // "extern template..." declarations at the bottom of Actor.hh
-        template class Channel<ThreadedMailbox*>;
-        template class Channel<std::function<void()>>;
+        ThreadedMailbox* Scheduler::popGlobal(unsigned priority) {
+            lock_guard<mutex> lock(_globalMutex);
+            auto&             queue = _globalQueue[priority];
+            if ( queue.empty() ) return nullptr;
+            ThreadedMailbox* mbox = queue.front();
+            queue.pop_front();
+            return mbox;
+        }
+
+        // Takes the oldest half of another worker's queue of the given priority, keeping one to run
+        // and moving the rest into this thread's own queue.
+        ThreadedMailbox* Scheduler::steal(unsigned taskID, unsigned priority) {
+            auto  n      = unsigned(_workers.size());
+            auto* myself = (taskID > 0) ? _workers[taskID - 1].get() : nullptr;
+            for ( unsigned i = 1; i <= n; ++i ) {
+                Worker* victim = _workers[(taskID - 1 + i) % n].get();
+                if ( victim == myself ) continue;
+                std::deque<ThreadedMailbox*> loot;
+                {
+                    lock_guard<mutex> lock(victim->mutex);
+                    auto&             queue = victim->queue[priority];
+                    size_t            count = (queue.size() + 1) / 2;
+                    if ( count == 0 ) continue;
+                    auto end = queue.begin() + ptrdiff_t(count);
+                    loot.assign(queue.begin(), end);
+                    queue.erase(queue.begin(), end);
+                }
+                ThreadedMailbox* mbox = loot.front();
+                loot.pop_front();
+                if ( !loot.empty() ) {
+                    if ( myself ) {
+                        lock_guard<mutex> lock(myself->mutex);
+                        auto&             queue = myself->queue[priority];
+                        queue.insert(queue.end(), loot.begin(), loot.end());
+                    } else {
+                        lock_guard<mutex> lock(_globalMutex);
+                        auto&             queue = _globalQueue[priority];
+                        queue.insert(queue.end(), loot.begin(), loot.end());
+                    }
+                }
+                return mbox;
+            }
+            return nullptr;
+        }
+
+        Scheduler::Worker* Scheduler::currentWorker() const {
+            if ( _workStealing && sCurrentScheduler == this && sCurrentTaskID > 0 )
+                return _workers[sCurrentTaskID - 1].get();
+            return nullptr;
+        }
+
+        void Scheduler::schedule(ThreadedMailbox* mbox) {
+            auto priority = unsigned(mbox->_priority);
+            if ( Worker* worker = currentWorker() ) {
+                lock_guard<mutex> lock(worker->mutex);
+                worker->queue[priority].push_back(mbox);
+            } else {
+                lock_guard<mutex> lock(_globalMutex);
+                _globalQueue[priority].push_back(mbox);
+            }
+            ++_queuedByPriority[priority];
+            ++_queuedCount;
+            if ( _sleepers > 0 ) {
+                { lock_guard<mutex> lock(_idleMutex); }
+                _idleCond.notify_one();
+            }
+        }
+
+
+        // Explicitly instantiate the MPSCQueue specialization we need; this corresponds to the
+        // "extern template..." declaration at the bottom of ThreadedMailbox.hh
+        template class MPSCQueue<MailboxEvent>;
 
 
 #    pragma mark - MAILBOX:
@@ -188,81 +321,59 @@ namespace litecore { namespace actor {
         thread_local shared_ptr<ChannelManifest> ThreadedMailbox::sThreadManifest;
 #    endif
 
-        ThreadedMailbox::ThreadedMailbox(Actor* a, const std::string& name, ThreadedMailbox* parent)
-            : _actor(a), _name(name) {
-            Scheduler::sharedScheduler()->start();
+        ThreadedMailbox::ThreadedMailbox(Actor* a, const std::string& name, ThreadedMailbox* parent,
+                                         Priority priority, Scheduler* scheduler)
+            : _actor(a)
+            , _name(name)
+            , _scheduler(scheduler ? scheduler : (parent ? parent->_scheduler : Scheduler::sharedScheduler()))
+            , _priority(priority)
+            , _stats(name) {
+            _scheduler->start();
         }
 
-        void ThreadedMailbox::enqueue(const char* name, const std::function<void()>& f) {
-            beginLatency();
+        void ThreadedMailbox::enqueue(const char* name, ActorMessage&& message) {
             retain(_actor);
             threadStats::check();
+            _stats.enqueued();
 
+            MailboxEvent event{std::move(message), name, false, MailboxStats::clock::now()};
 #    if ACTORS_USE_MANIFESTS
-            auto threadManifest = sThreadManifest ? sThreadManifest : make_shared<ChannelManifest>();
-            threadManifest->addEnqueueCall(_actor, name);
+            event.threadManifest = sThreadManifest ? sThreadManifest : make_shared<ChannelManifest>();
+            event.threadManifest->addEnqueueCall(_actor, name);
             _localManifest.addEnqueueCall(_actor, name);
-            const auto wrappedBlock = [f, threadManifest, name, SELF] {
-                threadManifest->addExecution(_actor, name);
-                sThreadManifest = threadManifest;
-                _localManifest.addExecution(_actor, name);
-#    else
-            const auto wrappedBlock = [f, SELF] {
-#    endif
-                endLatency();
-                beginBusy();
-                safelyCall(f);
-                afterEvent();
-
-#    if ACTORS_USE_MANIFESTS
-                sThreadManifest.reset();
 #    endif
-            };
-
-            if ( push(wrappedBlock) ) reschedule();
+            if ( push(std::move(event)) ) reschedule();
         }
 
-        void ThreadedMailbox::enqueueAfter(delay_t delay, const char* name, const std::function<void()>& f) {
-            if ( delay <= delay_t::zero() ) return enqueue(name, f);
+        void ThreadedMailbox::enqueueAfter(delay_t delay, const char* name, ActorMessage&& message) {
+            if ( delay <= delay_t::zero() ) return enqueue(name, std::move(message));
 
-            beginLatency();
             _delayedEventCount++;
             retain(_actor);
             threadStats::check();
+            _stats.enqueued();
 
+            // The Timer's callback owns the event, so it's freed even if the timer never fires.
+            // (A std::function has to be copyable, hence a shared_ptr.)
+            auto event = make_shared<MailboxEvent>(MailboxEvent{std::move(message), name, true});
 #    if ACTORS_USE_MANIFESTS
-            auto threadManifest = sThreadManifest ? sThreadManifest : make_shared<ChannelManifest>();
-            threadManifest->addEnqueueCall(_actor, name, delay.count());
+            event->threadManifest = sThreadManifest ? sThreadManifest : make_shared<ChannelManifest>();
+            event->threadManifest->addEnqueueCall(_actor, name, delay.count());
             _localManifest.addEnqueueCall(_actor, name, delay.count());
-            auto timer = new Timer([f, threadManifest, name, this] {
-                const auto wrappedBlock = [f, threadManifest, name, SELF] {
-                    threadManifest->addExecution(_actor, name);
-                    sThreadManifest = threadManifest;
-                    _localManifest.addExecution(_actor, name);
-#    else
-            auto       timer        = new Timer([f, this] {
-                const auto wrappedBlock = [f, SELF] {
 #    endif
-                    endLatency();
-                    beginBusy();
-                    safelyCall(f);
-                    --_delayedEventCount;
-                    afterEvent();
-#    if ACTORS_USE_MANIFESTS
-                    sThreadManifest.reset();
-#    endif
-                };
-
-                if ( push(wrappedBlock) ) reschedule();
+            auto timer = new Timer([event, this] {
+                event->enqueuedAt = MailboxStats::clock::now();
+                bool wasEmpty     = push(std::move(*event));
+                if ( wasEmpty ) reschedule();
             });
 
             timer->autoDelete();
             timer->fireAfter(chrono::duration_cast<Timer::duration>(delay));
         }
 
-        void ThreadedMailbox::safelyCall(const std::function<void()>& f) const {
+        void ThreadedMailbox::safelyCall(ActorMessage& message) const {
             try {
-                f();
+                message();
             } catch ( std::exception& x ) {
                 _actor->caughtException(x);
 #    if ACTORS_USE_MANIFESTS
@@ -277,43 +388,38 @@ namespace litecore { namespace actor {
             }
         }
 
-        void ThreadedMailbox::afterEvent() {
-            _actor->afterEvent();
-            endBusy();
-
-#    if ACTORS_TRACK_STATS
-            ++_callCount;
-            if ( eventCount() > _maxEventCount ) { _maxEventCount = eventCount(); }
-#    endif
-        }
+        void ThreadedMailbox::afterEvent() { _actor->afterEvent(); }
 
-        void ThreadedMailbox::reschedule() { Scheduler::schedule(this); }
+        void ThreadedMailbox::reschedule() { _scheduler->schedule(this); }
 
         void ThreadedMailbox::performNextMessage() {
             LogVerbose(ActorLog, "%s performNextMessage", _actor->actorName().c_str());
             DebugAssert(++_active == 1);  // Fail-safe check to detect 'impossible' re-entrant call
-            sCurrentActor = _actor;
-            auto& fn      = front();
-            fn();
+            sCurrentActor       = _actor;
+            MailboxEvent& event = front();
+#    if ACTORS_USE_MANIFESTS
+            event.threadManifest->addExecution(_actor, event.name);
+            sThreadManifest = event.threadManifest;
+            _localManifest.addExecution(_actor, event.name);
+#    endif
+            auto startedAt = MailboxStats::clock::now();
+            safelyCall(event.message);
+            if ( event.delayed ) --_delayedEventCount;
+            afterEvent();
+            _stats.handled(event.enqueuedAt, startedAt, MailboxStats::clock::now());
+#    if ACTORS_USE_MANIFESTS
+            sThreadManifest.reset();
+#    endif
             sCurrentActor = nullptr;
 
             DebugAssert(--_active == 0);
 
-            bool empty;
-            popNoWaiting(empty);
+            bool empty = pop();
             release(_actor);  // For enqueue's retain call
             if ( !empty ) reschedule();
         }
 
-        void ThreadedMailbox::logStats() const {
-#    if ACTORS_TRACK_STATS
-            LogTo(ActorLog, "%s handled %d events; max queue depth was %d; max latency was %s; busy %s (%.1f%%)",
-                  _actor->actorName().c_str(), _callCount, _maxEventCount,
-                  fleece::Stopwatch::formatTime(_maxLatency).c_str(),
-                  fleece::Stopwatch::formatTime(_busy.elapsed()).c_str(),
-                  (_busy.elapsed() / _createdAt.elapsed()) * 100.0);
-#    endif
-        }
+        void ThreadedMailbox::logStats() const { LogVerbose(ActorLog, "%s", _stats.describe().c_str()); }
 
         void ThreadedMailbox::runAsyncTask(void (*task)(void*), void* context) {
             static RunAsyncActor* sRunAsyncActor =
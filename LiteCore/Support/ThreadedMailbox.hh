@@ -11,11 +11,18 @@
 //
 
 #pragma once
+#include "ActorMessage.hh"
+#include "ActorStats.hh"
 #include "Channel.hh"
+#include "MPSCQueue.hh"
 #include "fleece/RefCounted.hh"
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <functional>
@@ -33,24 +40,59 @@ namespace litecore::actor {
     /** A delay expressed in floating-point seconds */
     using delay_t = std::chrono::duration<double>;
 
+    /** The scheduling priority of an Actor. When there's more work than threads, mailboxes of
+        higher priority run first, but lower priorities still get a share of the turns, so they're
+        slowed down rather than starved. (With GCD, these map to dispatch QoS classes.) */
+    enum class Priority : uint8_t {
+        background,   ///< Maintenance that can wait, like expiration or live-query updates
+        normal,       ///< The default
+        interactive,  ///< Latency-sensitive work, like networking and replication
+    };
+
+    constexpr unsigned kNumPriorities = unsigned(Priority::interactive) + 1;
+
 
 #ifndef ACTORS_USE_GCD
+    /** An entry in a ThreadedMailbox's queue: the message plus bookkeeping about it. */
+    struct MailboxEvent {
+        ActorMessage             message;
+        const char*              name{nullptr};
+        bool                     delayed{false};  // True if it was scheduled by `enqueueAfter`
+        MailboxStats::time_point enqueuedAt;      // When it was added to the queue
+#    if ACTORS_USE_MANIFESTS
+        std::shared_ptr<ChannelManifest> threadManifest;
+#    endif
+    };
+
     /** Default Actor mailbox implementation that uses a thread pool run by a Scheduler. */
-    class ThreadedMailbox : Channel<std::function<void()>> {
+    class ThreadedMailbox : MPSCQueue<MailboxEvent> {
       public:
-        ThreadedMailbox(Actor*, const std::string& name = "", ThreadedMailbox* parentMailbox = nullptr);
+        /** Constructs a mailbox.
+            @param parentMailbox  Ignored, except that if it's non-null and `scheduler` is null,
+                                  the new mailbox runs on the parent's Scheduler.
+            @param priority  The mailbox's priority in the Scheduler.
+            @param scheduler  The Scheduler to run on; defaults to `Scheduler::sharedScheduler()`. */
+        ThreadedMailbox(Actor*, const std::string& name = "", ThreadedMailbox* parentMailbox = nullptr,
+                        Priority priority = Priority::normal, Scheduler* scheduler = nullptr);
 
         const std::string& name() const { return _name; }
 
+        Priority priority() const { return _priority; }
+
         unsigned eventCount() const { return (unsigned)size() + (unsigned)_delayedEventCount; }
 
-        void enqueue(const char* name, const std::function<void()>&);
-        void enqueueAfter(delay_t delay, const char* name, const std::function<void()>&);
+        void enqueue(const char* name, ActorMessage&&);
+        void enqueueAfter(delay_t delay, const char* name, ActorMessage&&);
 
         static Actor* currentActor() { return sCurrentActor; }
 
         static void runAsyncTask(void (*task)(void*), void* context);
 
+        /** Runtime statistics: event counts, queue depth, wait and run times. */
+        const MailboxStats& stats() const { return _stats; }
+
+        MailboxStats& stats() { return _stats; }
+
         void logStats() const;
 
       private:
@@ -59,24 +101,19 @@ namespace litecore::actor {
         void reschedule();
         void performNextMessage();
         void afterEvent();
-        void safelyCall(const std::function<void()>& f) const;
+        void safelyCall(ActorMessage&) const;
 
         Actor* const      _actor;
         std::string const _name;
+        Scheduler* const  _scheduler;
+        Priority const    _priority;
+        MailboxStats      _stats;
 
-        int _delayedEventCount{0};
+        std::atomic_int _delayedEventCount{0};
 #    if DEBUG
         std::atomic_int _active{0};
 #    endif
 
-#    if ACTORS_TRACK_STATS
-        int32_t           _callCount{0};
-        int32_t           _maxEventCount{0};
-        double            _maxLatency{0};
-        fleece::Stopwatch _createdAt{true};
-        fleece::Stopwatch _busy{false};
-#    endif
-
         static thread_local Actor* sCurrentActor;
 
 #    if ACTORS_USE_MANIFESTS
@@ -86,10 +123,30 @@ namespace litecore::actor {
     };
 
     /** The Scheduler is reponsible for calling ThreadedMailboxes to run their Actor methods.
-        It managers a thread pool on which Mailboxes and Actors will run. */
+        It managers a thread pool on which Mailboxes and Actors will run.
+
+        Each worker thread has its own run queue. A mailbox scheduled from a worker thread (which is
+        the common case: an Actor sending a message to another, or rescheduling itself after handling
+        an event) goes on that thread's queue, so it tends to stay on the same core. Mailboxes
+        scheduled from other threads go on a shared queue. A worker with nothing to do first checks
+        the shared queue, then steals work from other workers' queues.
+
+        A mailbox is never in more than one queue at once, so the guarantee that a mailbox handles
+        only one event at a time is unaffected by which thread runs it.
+
+        Every queue is split by mailbox Priority. A thread looks for work one priority at a time,
+        in an order that depends on its turn number: on most turns it starts with `interactive`,
+        but every 4th turn it starts with `normal` and every 16th with `background`. So when all
+        priorities have work, they get 3/4, 3/16 and 1/16 of the turns; when some don't, the others
+        get their turns. */
     class Scheduler {
       public:
-        Scheduler(unsigned numThreads = 0) : _numThreads(numThreads) {}
+        /** Constructs a Scheduler.
+            @param numThreads  Number of threads in the pool; 0 means the number of CPU cores.
+            @param workStealing  If false, all threads share a single queue, as in the original design.
+                                 This is only useful for benchmarking. */
+        explicit Scheduler(unsigned numThreads = 0, bool workStealing = true)
+            : _numThreads(numThreads), _workStealing(workStealing) {}
 
         /** Returns a per-process shared instance. */
         static Scheduler* sharedScheduler();
@@ -108,20 +165,44 @@ namespace litecore::actor {
         friend class ThreadedMailbox;
 
         /** A request for an Actor's performNextMessage method to be called. */
-        static void schedule(ThreadedMailbox* mbox);
+        void schedule(ThreadedMailbox* mbox);
 
       private:
-        void task(unsigned taskID);
-
-        unsigned                  _numThreads;
-        Channel<ThreadedMailbox*> _queue;
-        std::vector<std::thread>  _threadPool;
-        std::atomic_flag          _started = ATOMIC_FLAG_INIT;
+        /** Mailboxes waiting to run, in a FIFO per priority. */
+        using RunQueue = std::array<std::deque<ThreadedMailbox*>, kNumPriorities>;
+
+        /** A worker thread's local run queue. */
+        struct Worker {
+            std::mutex mutex;
+            RunQueue   queue;
+        };
+
+        void             task(unsigned taskID);
+        ThreadedMailbox* nextMailbox(unsigned taskID, unsigned turn);
+        ThreadedMailbox* popGlobal(unsigned priority);
+        ThreadedMailbox* steal(unsigned taskID, unsigned priority);
+        Worker*          currentWorker() const;
+
+        unsigned                             _numThreads;
+        bool const                           _workStealing;
+        std::vector<std::unique_ptr<Worker>> _workers;
+        std::mutex                           _globalMutex;
+        RunQueue                             _globalQueue;
+        std::atomic<size_t>                  _queuedCount{0};  // Mailboxes in all queues
+        std::atomic<size_t>                  _queuedByPriority[kNumPriorities]{};
+        std::mutex                           _idleMutex;
+        std::condition_variable              _idleCond;
+        std::atomic<unsigned>                _sleepers{0};
+        std::atomic<bool>                    _stopping{false};
+        std::vector<std::thread>             _threadPool;
+        std::atomic_flag                     _started = ATOMIC_FLAG_INIT;
+
+        static thread_local Scheduler* sCurrentScheduler;
+        static thread_local unsigned   sCurrentTaskID;
     };
 
-    // This prevents the compiler from specializing Channel in every compilation unit:
-    extern template class Channel<ThreadedMailbox*>;
-    extern template class Channel<std::function<void()>>;
+    // This prevents the compiler from specializing MPSCQueue in every compilation unit:
+    extern template class MPSCQueue<MailboxEvent>;
 #endif
 
 }  // namespace litecore::actor
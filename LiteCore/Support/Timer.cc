@@ -13,7 +13,8 @@
 #include "Timer.hh"
 #include "Error.hh"
 #include "ThreadUtil.hh"
-#include <vector>
+#include <algorithm>
+#include <bit>
 
 using namespace std;
 
@@ -24,21 +25,18 @@ namespace litecore::actor {
         return *sManager;
     }
 
-    Timer::Manager::Manager() : _thread([this]() { run(); }) {}
+    Timer::Manager::Manager() : _epoch(clock::now()), _thread([this]() { run(); }) {}
 
     // Body of the manager's background thread. Waits for timers and calls their callbacks.
     void Timer::Manager::run() {
         SetThreadName("Timer (CBL)");
         unique_lock<mutex> lock(_mutex);
         while ( true ) {
-            auto earliest = _schedule.begin();
-            if ( earliest == _schedule.end() ) {
-                // Schedule is empty; just wait for a change
-                _condition.wait(lock);
+            if ( !_due ) advanceTo(std::max(_now, ticksAt(clock::now(), false)));
 
-            } else if ( earliest->first <= clock::now() ) {
+            if ( _due ) {
                 // A Timer is ready to fire, so remove it and call the callback:
-                _triggeredTimer             = earliest->second;
+                _triggeredTimer             = _due;
                 _triggeredTimer->_triggered = true;
                 _unschedule(_triggeredTimer);
 
@@ -63,33 +61,152 @@ namespace litecore::actor {
                 lock.lock();
 
             } else {
-                // Wait for the first timer's fireTime, or until the _schedule is updated:
-                auto nextFireTime = earliest->first;
-                _condition.wait_until(lock, nextFireTime);
+                // Wait for the next tick that has anything to do, or until a timer is scheduled
+                // before that tick:
+                _wakeTick = nextEventTick();
+                if ( _wakeTick == kNever ) _condition.wait(lock);
+                else
+                    _condition.wait_until(lock, timeOfTick(_wakeTick));
+                _wakeTick = 0;
             }
         }
     }
 
-    // Removes a Timer from _scheduled. Returns true if the next fire time is affected.
+    Timer::Manager::tick Timer::Manager::ticksAt(time t, bool roundUp) const {
+        if ( t <= _epoch ) return 0;
+        auto elapsed = t - _epoch;
+        auto ms      = chrono::duration_cast<chrono::milliseconds>(elapsed);
+        if ( roundUp && ms < elapsed ) ++ms;  // Never fire early
+        return tick(ms.count());
+    }
+
+    Timer::time Timer::Manager::timeOfTick(tick t) const { return _epoch + chrono::milliseconds(t); }
+
+    // Adds a timer to the wheel level & slot appropriate for its `_expiry`, or to `_due` if that's
+    // already past. Precondition: _mutex must be locked, and timer not in any list.
+    void Timer::Manager::insert(Timer* timer) {
+        if ( timer->_expiry <= _now ) return link(timer, kDueLevel, 0);
+        // Timers further in the future than the wheel covers go in the last slot; they'll be
+        // re-inserted when it cascades.
+        tick delta  = std::min(timer->_expiry - _now, kMaxOffset);
+        tick expiry = _now + delta;
+        for ( unsigned level = 0;; ++level ) {
+            unsigned shift = level * kSlotBits;
+            if ( level == kLevels - 1 || delta < (tick(1) << (shift + kSlotBits)) )
+                return link(timer, uint8_t(level), uint8_t((expiry >> shift) & (kSlots - 1)));
+        }
+    }
+
+    // Appends a timer to a circular list: a wheel slot, or `_due`.
+    void Timer::Manager::link(Timer* timer, uint8_t level, uint8_t slot) {
+        Timer*& head  = (level == kDueLevel) ? _due : _levels[level].slots[slot];
+        timer->_level = level;
+        timer->_slot  = slot;
+        if ( head ) {
+            Timer* tail  = head->_prev;
+            tail->_next  = timer;
+            timer->_prev = tail;
+            timer->_next = head;
+            head->_prev  = timer;
+        } else {
+            timer->_prev = timer->_next = timer;
+            head                        = timer;
+        }
+        if ( level != kDueLevel ) {
+            _levels[level].occupied[slot / 64] |= (uint64_t(1) << (slot % 64));
+            ++_levels[level].count;
+        }
+    }
+
+    // Removes a timer from whichever list it's in.
+    void Timer::Manager::unlink(Timer* timer) {
+        uint8_t level = timer->_level, slot = timer->_slot;
+        Timer*& head  = (level == kDueLevel) ? _due : _levels[level].slots[slot];
+        if ( timer->_next == timer ) {
+            head = nullptr;
+            if ( level != kDueLevel ) _levels[level].occupied[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+        } else {
+            timer->_prev->_next = timer->_next;
+            timer->_next->_prev = timer->_prev;
+            if ( head == timer ) head = timer->_next;
+        }
+        if ( level != kDueLevel ) --_levels[level].count;
+        timer->_prev = timer->_next = nullptr;
+    }
+
+    // Returns the offset from `from` of the next occupied slot at a level (wrapping around), or -1.
+    int Timer::Manager::nextOccupiedSlot(unsigned level, unsigned from) const {
+        auto& occupied = _levels[level].occupied;
+        for ( unsigned offset = 0; offset < kSlots; ) {
+            unsigned slot = (from + offset) & (kSlots - 1);
+            // (Bits below `from` in the first word are skipped by the shift; if the scan wraps
+            // around to that word again, bits at or above `from` are known to be clear.)
+            if ( uint64_t bits = occupied[slot / 64] >> (slot % 64) ) return int(offset + std::countr_zero(bits));
+            offset += 64 - (slot % 64);
+        }
+        return -1;
+    }
+
+    // Returns the next tick after `_now` at which the wheel has work to do: either a level 0 slot
+    // whose timers expire, or a higher-level slot that has to be cascaded. Returns kNever if empty.
+    Timer::Manager::tick Timer::Manager::nextEventTick() const {
+        tick next = kNever;
+        for ( unsigned level = 0; level < kLevels; ++level ) {
+            if ( _levels[level].count == 0 ) continue;
+            unsigned shift = level * kSlotBits;
+            tick     base  = (_now >> shift) + 1;
+            if ( int offset = nextOccupiedSlot(level, unsigned(base & (kSlots - 1))); offset >= 0 )
+                next = std::min(next, (base + tick(offset)) << shift);
+        }
+        return next;
+    }
+
+    // Advances the wheel to tick `target`, cascading higher levels down and moving expired
+    // timers to `_due`. Skips over ticks that have nothing to do.
+    void Timer::Manager::advanceTo(tick target) {
+        while ( true ) {
+            tick next = nextEventTick();
+            if ( next > target ) {
+                _now = target;
+                return;
+            }
+            _now = next;
+            for ( unsigned level = kLevels - 1; level > 0; --level ) {
+                unsigned shift = level * kSlotBits;
+                if ( (next & ((tick(1) << shift) - 1)) == 0 ) {
+                    Timer*& head = _levels[level].slots[(next >> shift) & (kSlots - 1)];
+                    while ( Timer* timer = head ) {
+                        unlink(timer);
+                        insert(timer);
+                    }
+                }
+            }
+            Timer*& head = _levels[0].slots[next & (kSlots - 1)];
+            while ( Timer* timer = head ) {
+                unlink(timer);
+                link(timer, kDueLevel, 0);
+            }
+        }
+    }
+
+    // Removes a Timer from the wheel.
     // Precondition: _mutex must be locked.
-    // Postconditions: timer is not in _scheduled. timer->_state != kScheduled.
-    bool Timer::Manager::_unschedule(Timer* timer) {
-        if ( timer->_state != kScheduled ) return false;
-        bool affectsTiming = (timer->_entry == _schedule.begin());
-        _schedule.erase(timer->_entry);
-        timer->_entry    = _schedule.end();
+    // Postconditions: timer is not in the wheel. timer->_state != kScheduled.
+    void Timer::Manager::_unschedule(Timer* timer) {
+        if ( timer->_state != kScheduled ) return;
+        unlink(timer);
         timer->_state    = kUnscheduled;
         timer->_fireTime = time();
-        return affectsTiming && !_schedule.empty();
     }
 
     // Unschedules a timer, preventing it from firing if it hasn't been triggered yet.
     // (Called by Timer::stop())
     // Precondition: _mutex must NOT be locked.
-    // Postcondition: timer is not in _scheduled. timer->_state != kScheduled.
+    // Postcondition: timer is not in the wheel. timer->_state != kScheduled.
     void Timer::Manager::unschedule(Timer* timer, bool deleting) {
         unique_lock<mutex> lock(_mutex);
-        if ( _unschedule(timer) ) _condition.notify_one();  // wakes up run() so it can recalculate its wait time
+        // (No need to wake run(); at worst it will wake up at the old fire time and find nothing to do.)
+        _unschedule(timer);
 
         if ( deleting ) {
             Assert(!timer->_autoDelete);
@@ -110,17 +227,18 @@ namespace litecore::actor {
     // Schedules or re-schedules a timer. (Called by Timer::fireAt/fireAfter())
     // If `earlier` is true, it will only move the fire time closer, else it returns `false`.
     // Precondition: _mutex must NOT be locked.
-    // Postcondition: timer is in _scheduled. timer->_state == kScheduled.
+    // Postcondition: timer is in the wheel. timer->_state == kScheduled.
     bool Timer::Manager::setFireTime(Timer* timer, clock::time_point when, bool earlier) {
         unique_lock<mutex> lock(_mutex);
         // Don't allow timer's callback to reschedule itself when deletion is pending:
         if ( timer->_state == kDeleted ) return false;
         if ( earlier && timer->scheduled() && when >= timer->_fireTime ) return false;
-        bool notify      = _unschedule(timer);
-        timer->_entry    = _schedule.insert({when, timer});
-        timer->_state    = kScheduled;
+        _unschedule(timer);
         timer->_fireTime = when;
-        if ( timer->_entry == _schedule.begin() || notify )
+        timer->_expiry   = ticksAt(when, true);
+        insert(timer);
+        timer->_state = kScheduled;
+        if ( timer->_expiry < _wakeTick )
             _condition.notify_one();  // wakes up run() so it can recalculate its wait time
         return true;
     }
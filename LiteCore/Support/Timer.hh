@@ -11,10 +11,11 @@
 //
 
 #pragma once
+#include <array>
 #include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <functional>
-#include <map>
 #include <mutex>
 #include <thread>
 #include <condition_variable>
@@ -84,39 +85,74 @@ namespace litecore::actor {
       private:
         enum state : uint8_t {
             kUnscheduled,  // Idle
-            kScheduled,    // In _scheduled queue, waiting to fire
+            kScheduled,    // In the Manager's timing wheel, waiting to fire
             kDeleted,      // Destructor called, waiting for fire to complete
         };
 
-        /** Internal singleton that tracks all scheduled Timers and runs a background thread. */
+        /** Internal singleton that tracks all scheduled Timers and runs a background thread.
+            Scheduled timers are kept in a hierarchical timing wheel with a resolution of 1ms:
+            four levels of 256 slots, each slot being an intrusive linked list of Timers. Level 0
+            holds timers due in the next 256 ticks; each higher level covers a 256x longer span,
+            and its slots are "cascaded" down into lower levels as their time approaches.
+            Scheduling, rescheduling and unscheduling are O(1). */
         class Manager {
           public:
-            using map = std::multimap<time, Timer*>;
+            using tick = uint64_t;  // Milliseconds since the Manager was created
 
             Manager();
             bool setFireTime(Timer*, time, bool ifEarlier = false);
             void unschedule(Timer*, bool deleting = false);
 
           private:
-            bool _unschedule(Timer*);
+            static constexpr unsigned kLevels    = 4;
+            static constexpr unsigned kSlotBits  = 8;
+            static constexpr unsigned kSlots     = 1 << kSlotBits;
+            static constexpr uint8_t  kDueLevel  = kLevels;  // `_level` of a Timer in `_due`
+            static constexpr tick     kNever     = UINT64_MAX;
+            static constexpr tick     kMaxOffset = (tick(1) << (kLevels * kSlotBits)) - 1;
+
+            /** One level of the wheel: its slot lists, plus a bitmap of which are non-empty. */
+            struct Level {
+                std::array<Timer*, kSlots>        slots{};
+                std::array<uint64_t, kSlots / 64> occupied{};
+                size_t                            count{0};
+            };
+
+            tick ticksAt(time t, bool roundUp) const;
+            time timeOfTick(tick) const;
+            void insert(Timer*);
+            void link(Timer*, uint8_t level, uint8_t slot);
+            void unlink(Timer*);
+            int  nextOccupiedSlot(unsigned level, unsigned from) const;
+            tick nextEventTick() const;
+            void advanceTo(tick);
+            void _unschedule(Timer*);
             void run();
 
-            map                     _schedule;   // A priority queue of Timers ordered by time
-            std::mutex              _mutex;      // Thread-safety for _schedule
-            std::condition_variable _condition;  // Used to signal that _schedule has changed
-            std::thread             _thread;     // Bg thread that waits & fires Timers
-            Timer*                  _triggeredTimer{nullptr};
+            time                       _epoch;             // Time of tick 0
+            tick                       _now{0};            // Last tick the wheel was advanced to
+            std::array<Level, kLevels> _levels;            // The timing wheel
+            Timer*                     _due{nullptr};      // Timers whose time has come, in order
+            tick                       _wakeTick{kNever};  // When run() will wake up; 0 if it's awake
+            std::mutex                 _mutex;             // Thread-safety for the wheel
+            std::condition_variable    _condition;         // Used to signal that the wheel has changed
+            std::thread                _thread;            // Bg thread that waits & fires Timers
+            Timer*                     _triggeredTimer{nullptr};
         };
 
         friend class Manager;
         static Manager& manager();
 
-        callback               _callback;             // The function to call when I fire
-        time                   _fireTime;             // Absolute time that I fire
-        std::atomic<state>     _state{kUnscheduled};  // Current state
-        std::atomic<bool>      _triggered{false};     // True while callback is being called
-        bool                   _autoDelete{false};    // If true, delete after firing
-        Manager::map::iterator _entry;                // My map entry in Manager::_schedule
+        callback           _callback;             // The function to call when I fire
+        time               _fireTime;             // Absolute time that I fire
+        std::atomic<state> _state{kUnscheduled};  // Current state
+        std::atomic<bool>  _triggered{false};     // True while callback is being called
+        bool               _autoDelete{false};    // If true, delete after firing
+        Manager::tick      _expiry{0};            // Tick at which I fire
+        Timer*             _prev{nullptr};        // Links in a Manager wheel slot or due list
+        Timer*             _next{nullptr};
+        uint8_t            _level{0};             // Wheel level I'm in, or kDueLevel
+        uint8_t            _slot{0};              // Slot in that level
     };
 
 }  // namespace litecore::actor
@@ -0,0 +1,577 @@
+//
+// ActorTest.cc
+//
+// Copyright 2026-Present Couchbase, Inc.
+//
+// Use of this software is governed by the Business Source License included
+// in the file licenses/BSL-Couchbase.txt.  As of the Change Date specified
+// in that file, in accordance with the Business Source License, use of this
+// software will be governed by the Apache License, Version 2.0, included in
+// the file licenses/APL2.txt.
+//
+
+#include "LiteCoreTest.hh"
+#include "Actor.hh"
+#include "AllocationCounter.hh"
+#include "Async.hh"
+#include "Batcher.hh"
+#include "Coroutine.hh"
+#include "Stopwatch.hh"
+#include "Timer.hh"
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <optional>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace std::chrono_literals;
+using namespace litecore;
+using namespace litecore::actor;
+
+#ifndef ACTORS_USE_GCD
+
+namespace {
+
+    // Passes a countdown around a ring of actors; each hop is one message.
+    class RingActor : public Actor {
+      public:
+        RingActor(Scheduler* scheduler, atomic<int>* ringsRemaining)
+            : Actor(kC4Cpp_DefaultLog, "RingActor", scheduler), _ringsRemaining(ringsRemaining) {}
+
+        void setNext(RingActor* next) { _next = next; }
+
+        void hop(int count) { enqueue(FUNCTION_TO_QUEUE(RingActor::_hop), count); }
+
+        int maxConcurrency() const { return _maxConcurrency; }
+
+      private:
+        void _hop(int count) {
+            int active = ++_active;
+            if ( active > _maxConcurrency ) _maxConcurrency = active;
+            if ( count > 0 ) _next->hop(count - 1);
+            else
+                --*_ringsRemaining;
+            --_active;
+        }
+
+        RingActor*   _next{nullptr};
+        atomic<int>* _ringsRemaining;
+        atomic<int>  _active{0};
+        int          _maxConcurrency{0};
+    };
+
+    // Records the messages it receives from each of several producers.
+    class CounterActor : public Actor {
+      public:
+        explicit CounterActor(int numProducers) : Actor(kC4Cpp_DefaultLog, "CounterActor"), _last(numProducers, -1) {}
+
+        void count(int producer, int n) { enqueue(FUNCTION_TO_QUEUE(CounterActor::_count), producer, n); }
+
+        int  total{0};
+        bool inOrder{true};
+
+      private:
+        void _count(int producer, int n) {
+            if ( n != _last[producer] + 1 ) inOrder = false;
+            _last[producer] = n;
+            ++total;
+        }
+
+        vector<int> _last;
+    };
+
+    // Receives a four-argument message; can also send a batch of them to another SinkActor,
+    // counting the heap allocations made while doing so.
+    class SinkActor : public Actor {
+      public:
+        explicit SinkActor(Scheduler* scheduler) : Actor(kC4Cpp_DefaultLog, "SinkActor", scheduler) {}
+
+        void receive(int i, double d, Retained<SinkActor> sender, alloc_slice data) {
+            enqueue(FUNCTION_TO_QUEUE(SinkActor::_receive), i, d, sender, data);
+        }
+
+        void sendBatch(Retained<SinkActor> target, int count) {
+            enqueue(FUNCTION_TO_QUEUE(SinkActor::_sendBatch), target, count);
+        }
+
+        int    received{0};
+        size_t allocsInLastBatch{0};
+
+      private:
+        void _receive(int i, double d, Retained<SinkActor> sender, alloc_slice data) { ++received; }
+
+        void _sendBatch(Retained<SinkActor> target, int count) {
+            alloc_slice       data("some data");
+            AllocationCounter allocs;
+            for ( int i = 0; i < count; ++i ) target->receive(i, 1.0, this, data);
+            allocsInLastBatch = allocs.count();
+        }
+    };
+
+    // Handles events that take a given time, at a given priority.
+    class BusyActor : public Actor {
+      public:
+        BusyActor(Scheduler* scheduler, const string& name, Priority priority)
+            : Actor(kC4Cpp_DefaultLog, name, scheduler, priority) {}
+
+        void work(chrono::microseconds t) { enqueue(FUNCTION_TO_QUEUE(BusyActor::_work), t); }
+
+        atomic<int> handled{0};
+
+      private:
+        void _work(chrono::microseconds t) {
+            this_thread::sleep_for(t);
+            ++handled;
+        }
+    };
+
+    struct RingBench {
+        static constexpr int kNumRings = 16, kRingSize = 8;
+
+        RingBench(unsigned numThreads, bool workStealing) : scheduler(numThreads, workStealing) {
+            scheduler.start();
+            for ( int r = 0; r < kNumRings; ++r ) {
+                for ( int i = 0; i < kRingSize; ++i )
+                    actors.push_back(make_retained<RingActor>(&scheduler, &ringsRemaining));
+                for ( int i = 0; i < kRingSize; ++i )
+                    actors[r * kRingSize + i]->setNext(actors[r * kRingSize + (i + 1) % kRingSize]);
+            }
+        }
+
+        ~RingBench() { scheduler.stop(); }
+
+        // Runs `hops` messages around each ring; returns the elapsed time in seconds.
+        double run(int hops) {
+            ringsRemaining = kNumRings;
+            fleece::Stopwatch st;
+            for ( int r = 0; r < kNumRings; ++r ) actors[r * kRingSize]->hop(hops);
+            while ( ringsRemaining > 0 ) this_thread::sleep_for(100us);
+            return st.elapsed();
+        }
+
+        Scheduler                   scheduler;
+        atomic<int>                 ringsRemaining{0};
+        vector<Retained<RingActor>> actors;
+    };
+
+}  // namespace
+
+TEST_CASE("Actor Scheduler one event at a time", "[Actor]") {
+    bool      workStealing = GENERATE(false, true);
+    RingBench bench(4, workStealing);
+    bench.run(1000);
+    for ( auto& actor : bench.actors ) CHECK(actor->maxConcurrency() == 1);
+}
+
+TEST_CASE("Actor mailbox multiple producers", "[Actor]") {
+    constexpr int kNumProducers = 8, kNumMessages = 20000;
+    auto          actor = make_retained<CounterActor>(kNumProducers);
+    vector<thread> producers;
+    for ( int p = 0; p < kNumProducers; ++p ) {
+        producers.emplace_back([=] {
+            for ( int n = 0; n < kNumMessages; ++n ) actor->count(p, n);
+        });
+    }
+    for ( auto& t : producers ) t.join();
+    actor->waitTillCaughtUp();
+    CHECK(actor->total == kNumProducers * kNumMessages);
+    CHECK(actor->inOrder);
+}
+
+TEST_CASE("Actor message enqueue doesn't allocate", "[Actor]") {
+    Scheduler scheduler(1);
+    scheduler.start();
+    {
+        auto sender   = make_retained<SinkActor>(&scheduler);
+        auto receiver = make_retained<SinkActor>(&scheduler);
+        // The first batch warms up the mailbox's node cache; the second should reuse it:
+        for ( int round = 0; round < 2; ++round ) {
+            sender->sendBatch(receiver, 100);
+            sender->waitTillCaughtUp();
+            receiver->waitTillCaughtUp();
+        }
+        CHECK(receiver->received == 200);
+        CHECK(sender->allocsInLastBatch == 0);
+    }
+    scheduler.stop();
+}
+
+TEST_CASE("Actor Scheduler priorities", "[Actor]") {
+    // Saturate the Scheduler with background actors, each with 400ms of work queued:
+    constexpr int kNumBackground = 8, kEventsEach = 200;
+    Scheduler     scheduler(4);
+    scheduler.start();
+    {
+        vector<Retained<BusyActor>> background;
+        for ( int i = 0; i < kNumBackground; ++i ) {
+            background.push_back(make_retained<BusyActor>(&scheduler, "PriorityTest-bg", Priority::background));
+            for ( int n = 0; n < kEventsEach; ++n ) background.back()->work(2ms);
+        }
+
+        // An interactive actor (like BLIP) gets its events handled promptly anyway:
+        auto interactive = make_retained<BusyActor>(&scheduler, "PriorityTest-interactive", Priority::interactive);
+        for ( int i = 0; i < 20; ++i ) {
+            this_thread::sleep_for(5ms);
+            interactive->work(0us);
+        }
+        interactive->waitTillCaughtUp();
+
+        optional<MailboxStats::Snapshot> stats;
+        for ( auto& s : MailboxStats::snapshotAll() ) {
+            if ( s.name == "PriorityTest-interactive" ) stats = s;
+        }
+        REQUIRE(stats);
+        Log("Interactive wait time: p50 %llu µs, max %llu µs", (unsigned long long)stats->waitTime.p50,
+            (unsigned long long)stats->waitTime.max);
+        CHECK(stats->waitTime.max < 50'000);
+
+        // ...while the background actors still got work done, and weren't finished yet:
+        int handled = 0;
+        for ( auto& actor : background ) handled += actor->handled;
+        CHECK(handled > 0);
+        CHECK(handled < kNumBackground * kEventsEach);
+
+        for ( auto& actor : background ) actor->waitTillCaughtUp();
+    }
+    scheduler.stop();
+}
+
+TEST_CASE("Actor message dispatch", "[Actor][Perf][.slow]") {
+    // Compares building, moving and calling an ActorMessage with the former std::function + std::bind.
+    struct Target {
+        void handle(int i, double d, Retained<SinkActor> sender, alloc_slice data) { sum += i; }
+
+        int64_t sum = 0;
+    };
+
+    constexpr int kCount = 1'000'000;
+    Target        target;
+    auto          sender = make_retained<SinkActor>(nullptr);
+    alloc_slice   data("some data");
+
+    fleece::Stopwatch st;
+    for ( int i = 0; i < kCount; ++i ) {
+        std::function<void()> fn = std::bind(&Target::handle, &target, i, 1.0, sender, data);
+        std::function<void()> queued(std::move(fn));
+        queued();
+    }
+    st.printReport("std::function + std::bind", kCount, "message");
+
+    st.reset();
+    AllocationCounter allocs;
+    for ( int i = 0; i < kCount; ++i ) {
+        auto         msg = ActorMessage::method(&target, &Target::handle, i, 1.0, sender, data);
+        ActorMessage queued(std::move(msg));
+        queued();
+    }
+    st.printReport("ActorMessage", kCount, "message");
+    Log("    %.2f allocations per message", double(allocs.count()) / kCount);
+    CHECK(allocs.count() == 0);
+}
+
+TEST_CASE("Actor Scheduler throughput", "[Actor][Perf][.slow]") {
+    constexpr int kHops      = 100000;
+    unsigned      maxThreads = max(thread::hardware_concurrency(), 2u);
+    for ( unsigned numThreads = 1; numThreads <= maxThreads; numThreads *= 2 ) {
+        for ( bool workStealing : {false, true} ) {
+            RingBench bench(numThreads, workStealing);
+            double    elapsed  = bench.run(kHops);
+            double    messages = double(RingBench::kNumRings) * (kHops + 1);
+            Log("%u threads, %-14s: %10.0f messages/sec", numThreads, (workStealing ? "work-stealing" : "single queue"),
+                messages / elapsed);
+        }
+    }
+}
+
+#endif
+
+namespace {
+
+    // Sleeps for as long as it's told to.
+    class SleepyActor : public Actor {
+      public:
+        SleepyActor() : Actor(kC4Cpp_DefaultLog, "SleepyActor") {}
+
+        void sleep(chrono::microseconds t) { enqueue(FUNCTION_TO_QUEUE(SleepyActor::_sleep), t); }
+
+      private:
+        void _sleep(chrono::microseconds t) { this_thread::sleep_for(t); }
+    };
+
+    // The same computation written with the old async macros and with coroutines:
+
+    Async<int> oldSquare(int n) {
+        BEGIN_ASYNC_RETURNING(int)
+        return n * n;
+        END_ASYNC()
+    }
+
+    Async<int> oldSumSquares(int n) {
+        int sum = 0, i, square;
+        BEGIN_ASYNC_RETURNING(int)
+        for ( i = 1; i <= n; ++i ) {
+            asyncCall(square, oldSquare(i));
+            sum += square;
+        }
+        return sum;
+        END_ASYNC()
+    }
+
+    coro::Async<int> coSquare(int n) { co_return n * n; }
+
+    coro::Async<int> coSumSquares(int n) {
+        int sum = 0;
+        for ( int i = 1; i <= n; ++i ) sum += co_await coSquare(i);
+        co_return sum;
+    }
+
+    // An Actor with coroutine methods.
+    class CoActor : public Actor {
+      public:
+        CoActor() : Actor(kC4Cpp_DefaultLog, "CoActor") {}
+
+        coro::Async<int> twice(int n) {
+            if ( currentActor() != this ) wrongThread = true;
+            co_return 2 * n;
+        }
+
+        coro::Async<int> twicePlusOne(Retained<CoActor> other, int n) {
+            if ( currentActor() != this ) wrongThread = true;
+            int result = co_await other->twice(n);
+            if ( currentActor() != this ) wrongThread = true;
+            co_return result + 1;
+        }
+
+        coro::Async<void> fail() {
+            throw std::runtime_error("oops");
+            co_return;
+        }
+
+        atomic<bool> wrongThread{false};
+    };
+
+}  // namespace
+
+TEST_CASE("LatencyHistogram", "[Actor]") {
+    using H = LatencyHistogram;
+    for ( unsigned b = 0; b < H::kNumBuckets; ++b ) {
+        CHECK(H::bucketFor(H::bucketStart(b)) == b);
+        if ( b + 1 < H::kNumBuckets ) {
+            // Buckets are contiguous, and no wider than 25% of their start:
+            CHECK(H::bucketFor(H::bucketStart(b + 1) - 1) == b);
+            CHECK(H::bucketStart(b + 1) - H::bucketStart(b) <= max<uint64_t>(1, H::bucketStart(b) / 4));
+        }
+    }
+    CHECK(H::bucketFor(uint64_t(1) << 40) == H::kNumBuckets - 1);
+
+    H histogram;
+    for ( uint64_t us = 1; us <= 1000; ++us ) histogram.record(us);
+    histogram.record(chrono::milliseconds(-5));  // negative durations count as zero
+    auto s = histogram.summary();
+    CHECK(s.count == 1001);
+    CHECK(s.max == 1000);
+    CHECK(s.mean == Approx(500.0));
+    CHECK((s.p50 >= 500 && s.p50 < 625));
+    CHECK((s.p90 >= 900 && s.p90 <= 1000));
+    CHECK((s.p99 >= 990 && s.p99 <= 1000));
+    uint64_t total = 0;
+    for ( auto& [limit, count] : s.buckets ) total += count;
+    CHECK(total == s.count);
+}
+
+TEST_CASE("Actor mailbox stats", "[Actor]") {
+    auto actor = make_retained<SleepyActor>();
+    for ( int i = 0; i < 10; ++i ) actor->sleep(2ms);
+    actor->waitTillCaughtUp();
+
+    optional<MailboxStats::Snapshot> stats;
+    for ( auto& s : MailboxStats::snapshotAll() ) {
+        if ( s.name == "SleepyActor" ) stats = s;
+    }
+    REQUIRE(stats);
+    CHECK(stats->enqueued == 11);  // (waitTillCaughtUp enqueues an event too)
+    CHECK(stats->handled >= 10);   // the last event may still be finishing
+    CHECK(stats->queueDepth == stats->enqueued - stats->handled);
+    CHECK(stats->maxQueueDepth >= 2);
+    CHECK(stats->runTime.count == stats->handled);
+    CHECK(stats->runTime.p50 >= 2000);
+    CHECK(stats->waitTime.max >= 8 * 2000);  // the last sleep waited for the others
+    CHECK(stats->busy >= 0.020);
+
+    // Once the actor is freed, it's no longer listed:
+    auto serial = stats->serial;
+    actor       = nullptr;
+    auto listed = [&] {
+        auto all = MailboxStats::snapshotAll();
+        return any_of(all.begin(), all.end(), [&](auto& s) { return s.serial == serial; });
+    };
+    REQUIRE_BEFORE(1s, !listed());
+}
+
+TEST_CASE("Batcher adaptive", "[Actor]") {
+    struct Item : public RefCounted {};
+
+    constexpr auto   kMinLatency = 2ms, kMaxLatency = 100ms;
+    constexpr size_t kMinCapacity = 20, kMaxCapacity = 1000;
+    int              nowCalls = 0;
+    Batcher<Item>    batcher([&](int) { ++nowCalls; }, [](int) {}, 50ms, 100);
+    batcher.setAdaptive({kMinLatency, kMaxLatency, kMinCapacity, kMaxCapacity});
+    CHECK(batcher.latency() == 50ms);
+    CHECK(batcher.capacity() == 100);
+
+    // Items trickle in, and a batch is cheap, so there's no point waiting:
+    for ( int i = 0; i < 10; ++i ) {
+        this_thread::sleep_for(20ms);
+        batcher.processed(1, 1ms);
+    }
+    CHECK(batcher.latency() == kMinLatency);
+    CHECK(batcher.capacity() == kMinCapacity);
+
+    // Under heavy load, the latency follows the cost of a batch, and batches get as big as allowed:
+    for ( int i = 0; i < 20; ++i ) {
+        this_thread::sleep_for(2ms);
+        batcher.processed(500, 10ms);
+    }
+    CHECK(batcher.latency() >= 9ms);
+    CHECK(batcher.latency() <= 11ms);
+    CHECK(batcher.capacity() == kMaxCapacity);
+
+    // Filling the batch to capacity triggers immediate processing, once:
+    auto item = make_retained<Item>();
+    for ( size_t i = 0; i < kMaxCapacity + 10; ++i ) batcher.push(item);
+    CHECK(nowCalls == 1);
+    auto items = batcher.pop();
+    REQUIRE(items);
+    CHECK(items->size() == kMaxCapacity + 10);
+}
+
+TEST_CASE("Coroutine basics", "[Actor]") {
+    coro::Async<int> result = coSquare(12);
+    REQUIRE(result.ready());
+    CHECK(result.result() == 144);
+
+    result = coSumSquares(10);
+    REQUIRE(result.ready());
+    CHECK(result.result() == 385);
+}
+
+TEST_CASE("Coroutine methods run on their Actor", "[Actor]") {
+    auto actor1 = make_retained<CoActor>(), actor2 = make_retained<CoActor>();
+    auto result = actor1->twicePlusOne(actor2, 20);
+    REQUIRE_BEFORE(2s, result.ready());
+    CHECK(result.result() == 41);
+    CHECK(!actor1->wrongThread);
+    CHECK(!actor2->wrongThread);
+
+    auto failure = actor1->fail();
+    REQUIRE_BEFORE(2s, failure.ready());
+    CHECK_THROWS_AS(failure.result(), std::runtime_error);
+}
+
+#ifndef ACTORS_USE_GCD
+
+TEST_CASE("Coroutine frames don't allocate", "[Actor]") {
+    (void)coSumSquares(100);  // warm up the frame allocator
+    AllocationCounter allocs;
+    auto              result = coSumSquares(100);
+    REQUIRE(result.ready());
+    CHECK(result.result() == 338350);
+    CHECK(allocs.count() == 0);
+}
+
+TEST_CASE("Coroutine await performance", "[Actor][Perf][.slow]") {
+    constexpr int kCalls = 1000, kAwaitsPerCall = 1000, kAwaits = kCalls * kAwaitsPerCall;
+
+    fleece::Stopwatch st;
+    for ( int i = 0; i < kCalls; ++i ) {
+        auto result = oldSumSquares(kAwaitsPerCall);
+        REQUIRE(result.ready());
+    }
+    st.printReport("AsyncProvider + asyncCall", kAwaits, "await");
+
+    st.reset();
+    AllocationCounter allocs;
+    for ( int i = 0; i < kCalls; ++i ) {
+        auto result = coSumSquares(kAwaitsPerCall);
+        REQUIRE(result.ready());
+    }
+    st.printReport("Coroutine co_await", kAwaits, "await");
+    Log("    %.2f allocations per await", double(allocs.count()) / kAwaits);
+}
+
+#endif
+
+TEST_CASE("Timer ordering", "[Timer]") {
+    // Delays span several level-0 slots and a level-1 cascade:
+    vector<int>       delaysMS = {300, 0, 20, 600, 1, 257, 20};
+    mutex             mut;
+    vector<int>       fired;
+    vector<double>    lateness(delaysMS.size());
+    auto              start = Timer::clock::now();
+
+    vector<unique_ptr<Timer>> timers;
+    for ( size_t i = 0; i < delaysMS.size(); ++i ) {
+        timers.push_back(make_unique<Timer>([&, i] {
+            lateness[i] = chrono::duration<double>(Timer::clock::now() - start).count() - delaysMS[i] / 1000.0;
+            lock_guard<mutex> lock(mut);
+            fired.push_back(int(i));
+        }));
+        timers.back()->fireAt(start + chrono::milliseconds(delaysMS[i]));
+    }
+    // Reschedule one, and stop another:
+    delaysMS[3] = 400;
+    timers[3]->fireAt(start + 400ms);
+    timers[5]->stop();
+
+    auto firedCount = [&] {
+        lock_guard<mutex> lock(mut);
+        return fired.size();
+    };
+    REQUIRE_BEFORE(2s, firedCount() == delaysMS.size() - 1);
+    this_thread::sleep_for(400ms);  // make sure the stopped timer doesn't fire
+    CHECK(fired == (vector<int>{1, 4, 2, 6, 0, 3}));
+    for ( size_t i = 0; i < delaysMS.size(); ++i ) {
+        if ( i != 5 ) CHECK(lateness[i] >= 0.0);
+    }
+}
+
+TEST_CASE("Timer reschedule stress", "[Timer][Perf][.slow]") {
+    // Schedules 100k timers, reschedules each of them many times, then measures how late they fire.
+    constexpr size_t kNumTimers = 100'000, kReschedules = 10;
+    // (The targets are atomic because a timer can fire while this thread is rescheduling it.)
+    vector<atomic<Timer::time>> targets(kNumTimers);
+    vector<double>              lateness(kNumTimers);
+    atomic<size_t>              firedCount{0};
+    vector<unique_ptr<Timer>>   timers;
+    timers.reserve(kNumTimers);
+    for ( size_t i = 0; i < kNumTimers; ++i ) {
+        timers.push_back(make_unique<Timer>([&, i] {
+            lateness[i] = chrono::duration<double>(Timer::clock::now() - targets[i].load()).count();
+            ++firedCount;
+        }));
+    }
+
+    mt19937                       rng(1234);
+    uniform_int_distribution<int> delayMS(500, 2500);
+    fleece::Stopwatch             st;
+    for ( size_t round = 0; round < kReschedules; ++round ) {
+        for ( size_t i = 0; i < kNumTimers; ++i ) {
+            auto target = Timer::clock::now() + chrono::milliseconds(delayMS(rng));
+            targets[i].store(target);
+            timers[i]->fireAt(target);
+        }
+    }
+    st.printReport("Rescheduling timers", kNumTimers * kReschedules, "reschedule");
+
+    REQUIRE_BEFORE(10s, firedCount == kNumTimers);
+    sort(lateness.begin(), lateness.end());
+    double total = 0;
+    for ( double l : lateness ) total += l;
+    auto percentile = [&](double p) { return lateness[min(kNumTimers - 1, size_t(p * kNumTimers))] * 1000.0; };
+    Log("Timer lateness: mean %.3fms, p50 %.3fms, p99 %.3fms, p99.9 %.3fms, max %.3fms",
+        total / kNumTimers * 1000.0, percentile(0.5), percentile(0.99), percentile(0.999), lateness.back() * 1000.0);
+    CHECK(lateness.front() >= 0.0);
+}
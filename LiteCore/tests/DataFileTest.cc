@@ -17,6 +17,7 @@
 #include "FilePath.hh"
 #include "FleeceImpl.hh"
 #include "SecureRandomize.hh"
+#include "Stopwatch.hh"
 #ifndef _MSC_VER
 #    include <sys/stat.h>
 #endif
@@ -212,6 +213,37 @@ N_WAY_TEST_CASE_METHOD(KeyStoreTestFixture, "DataFile EnumerateDocs", "[DataFile
     }
 }
 
+N_WAY_TEST_CASE_METHOD(KeyStoreTestFixture, "DataFile EnumerateDocs Batched", "[DataFile]") {
+    createNumberedDocs(store);
+
+    for ( int metaOnly = 0; metaOnly <= 1; ++metaOnly ) {
+        INFO("Enumerate over all docs in batches, metaOnly=" << metaOnly);
+        RecordEnumerator::Options opts;
+        opts.contentOption = metaOnly ? kMetaOnly : kEntireBody;
+
+        RecordView       rows[30];
+        vector<size_t>   batchSizes;
+        int              i = 1;
+        RecordEnumerator e(*store, opts);
+        while ( size_t n = e.nextBatch(rows) ) {
+            batchSizes.push_back(n);
+            CHECK_FALSE(e.hasRecord());
+            for ( size_t r = 0; r < n; ++r, ++i ) {
+                string expectedDocID = stringWithFormat("rec-%03d", i);
+                REQUIRE(rows[r].key == slice(expectedDocID));
+                REQUIRE(rows[r].sequence == (sequence_t)i);
+                REQUIRE(rows[r].bodySize == expectedDocID.size());
+                if ( metaOnly ) CHECK(!rows[r].body);
+                else
+                    CHECK(rows[r].body == slice(expectedDocID));
+            }
+        }
+        CHECK(i == 101);
+        CHECK(batchSizes == vector<size_t>{30, 30, 30, 10});
+        CHECK(e.nextBatch(rows) == 0);
+    }
+}
+
 N_WAY_TEST_CASE_METHOD(KeyStoreTestFixture, "DataFile EnumerateDocsDescending", "[DataFile]") {
     RecordEnumerator::Options opts;
     opts.sortOption = kDescending;
@@ -277,6 +309,207 @@ N_WAY_TEST_CASE_METHOD(KeyStoreTestFixture, "DataFile EnumerateDocs Deleted", "[
     }
 }
 
+N_WAY_TEST_CASE_METHOD(KeyStoreTestFixture, "DataFile GetMany", "[DataFile]") {
+    createNumberedDocs(store);
+    {
+        ExclusiveTransaction t(db);
+        RecordUpdate         update("rec-010"_sl, ""_sl, DocumentFlags::kDeleted);
+        update.sequence = 10_seq;
+        update.version  = "2-0000";
+        CHECK(store->set(update, KeyStore::kUpdateSequence, t) == 101_seq);
+        t.commit();
+    }
+
+    vector<slice> keys    = {"rec-005"_sl, "nope"_sl, "rec-010"_sl, "rec-005"_sl, "rec-100"_sl};
+    auto          records = store->getMany(keys, kEntireBody);
+    REQUIRE(records.size() == keys.size());
+    for ( size_t i = 0; i < keys.size(); ++i ) CHECK(records[i].key() == keys[i]);
+
+    CHECK(records[0].exists());
+    CHECK(records[0].sequence() == 5_seq);
+    CHECK(records[0].body() == "rec-005"_sl);
+    CHECK(!records[1].exists());
+    CHECK(records[2].exists());
+    CHECK(records[2].sequence() == 101_seq);
+    CHECK(records[2].flags() == DocumentFlags::kDeleted);
+    CHECK(records[2].version() == "2-0000"_sl);
+    CHECK(records[3].exists());
+    CHECK(records[3].sequence() == 5_seq);
+    CHECK(records[4].body() == "rec-100"_sl);
+
+    auto meta = store->getMany(keys, kMetaOnly);
+    CHECK(meta[0].exists());
+    CHECK(meta[0].bodySize() == 7);
+    CHECK(!meta[1].exists());
+}
+
+N_WAY_TEST_CASE_METHOD(KeyStoreTestFixture, "DataFile Get Throughput", "[DataFile][Perf][.slow]") {
+    static constexpr int kNumDocs = 10000, kNumGets = 200000;
+    createNumberedDocs(store, kNumDocs, false);
+
+    vector<string> docIDs(kNumGets);
+    vector<int>    indexes(kNumGets);
+    for ( int i = 0; i < kNumGets; ++i ) {
+        indexes[i] = int(RandomNumber(kNumDocs)) + 1;
+        docIDs[i]  = stringWithFormat("rec-%03d", indexes[i]);
+    }
+
+    for ( ContentOption content : {kMetaOnly, kEntireBody} ) {
+        fleece::Stopwatch st;
+        for ( auto& docID : docIDs ) REQUIRE(store->get(docID, content).exists());
+        double byKey = st.elapsed();
+
+        st.reset();
+        for ( int i : indexes ) REQUIRE(store->get(sequence_t(i), content).exists());
+        double bySeq = st.elapsed();
+
+        Log("get (%s): by key %.0f/sec, by sequence %.0f/sec", (content == kMetaOnly ? "meta only" : "entire body"),
+            kNumGets / byKey, kNumGets / bySeq);
+    }
+}
+
+static string compressibleBody(int i) {
+    return stringWithFormat(R"({"name":"Customer %d","address":{"street":"%d Main Street","city":"Springfield",)"
+                            R"("state":"OR","zip":"97477"},"status":"active","tags":["retail","newsletter"],)"
+                            R"("notes":"Customer %d prefers to be contacted by email rather than by phone."})",
+                            i, i * 17, i);
+}
+
+static void saveCompressibleDocs(KeyStore* store, int first, int last) {
+    ExclusiveTransaction t(store->dataFile());
+    for ( int i = first; i <= last; i++ ) {
+        string       docID = stringWithFormat("rec-%03d", i), body = compressibleBody(i);
+        RecordUpdate rec(docID, body);
+        store->set(rec, KeyStore::kUpdateSequence, t);
+    }
+    t.commit();
+}
+
+N_WAY_TEST_CASE_METHOD(KeyStoreTestFixture, "DataFile Body Compression", "[DataFile]") {
+    static constexpr int kNumDocs = 100;
+
+    // Docs saved before compression is enabled are used to train the dictionary:
+    saveCompressibleDocs(store, 1, kNumDocs);
+    {
+        ExclusiveTransaction t(db);
+        store->setBodyCompression(100, t);
+        t.commit();
+    }
+    saveCompressibleDocs(store, kNumDocs + 1, 2 * kNumDocs);
+    {
+        ExclusiveTransaction t(db);
+        RecordUpdate         rec("small"_sl, "tiny body"_sl);
+        store->set(rec, KeyStore::kUpdateSequence, t);
+        t.commit();
+    }
+
+    // Reading bodies decompresses them; meta-only reads report the stored (compressed) size:
+    for ( int i = 1; i <= 2 * kNumDocs; i++ ) {
+        string docID = stringWithFormat("rec-%03d", i), body = compressibleBody(i);
+        CHECK(store->get(slice(docID)).body() == slice(body));
+        Record meta = store->get(slice(docID), kMetaOnly);
+        if ( i <= kNumDocs ) CHECK(meta.bodySize() == body.size());
+        else
+            CHECK(meta.bodySize() < body.size() / 2);
+    }
+    CHECK(store->get("small"_sl).body() == "tiny body"_sl);
+
+    int n = 0;
+    for ( RecordEnumerator e(*store); e.next(); ) {
+        if ( e->key() == "small"_sl ) continue;
+        CHECK(e->body() == slice(compressibleBody(++n)));
+    }
+    CHECK(n == 2 * kNumDocs);
+
+    auto records = store->getMany({"rec-001"_sl, "rec-150"_sl}, kEntireBody);
+    CHECK(records[0].body() == slice(compressibleBody(1)));
+    CHECK(records[1].body() == slice(compressibleBody(150)));
+
+    // Another connection, which has to load the dictionary itself, can read the bodies too:
+    {
+        unique_ptr<DataFile> db2{newDatabase(db->filePath())};
+        CHECK(db2->getKeyStore(keyStoreName).get("rec-150"_sl).body() == slice(compressibleBody(150)));
+    }
+
+    // After compression is turned off, new bodies are stored as-is but old ones are still readable:
+    {
+        ExclusiveTransaction t(db);
+        store->setBodyCompression(0, t);
+        string       body = compressibleBody(999);
+        RecordUpdate rec("rec-999"_sl, slice(body));
+        store->set(rec, KeyStore::kUpdateSequence, t);
+        t.commit();
+    }
+    CHECK(store->get("rec-999"_sl, kMetaOnly).bodySize() == compressibleBody(999).size());
+    CHECK(store->get("rec-150"_sl).body() == slice(compressibleBody(150)));
+}
+
+N_WAY_TEST_CASE_METHOD(KeyStoreTestFixture, "DataFile Body Compression From Another Connection", "[DataFile]") {
+    static constexpr int kNumDocs = 100;
+
+    // A second connection writes some docs, so it's loaded the (lack of) compression settings:
+    unique_ptr<DataFile> db2{newDatabase(db->filePath())};
+    KeyStore*            store2 = &db2->getKeyStore(keyStoreName);
+    saveCompressibleDocs(store2, 1, kNumDocs);
+
+    // Then the first connection enables compression:
+    {
+        ExclusiveTransaction t(db);
+        store->setBodyCompression(100, t);
+        t.commit();
+    }
+
+    // The second connection notices, and compresses the bodies it writes from then on:
+    saveCompressibleDocs(store2, kNumDocs + 1, 2 * kNumDocs);
+    for ( int i = kNumDocs + 1; i <= 2 * kNumDocs; i++ ) {
+        string docID = stringWithFormat("rec-%03d", i), body = compressibleBody(i);
+        CHECK(store->get(slice(docID), kMetaOnly).bodySize() < body.size() / 2);
+        CHECK(store->get(slice(docID)).body() == slice(body));
+    }
+
+    // Likewise when the first connection turns compression off again:
+    {
+        ExclusiveTransaction t(db);
+        store->setBodyCompression(0, t);
+        t.commit();
+    }
+    saveCompressibleDocs(store2, 999, 999);
+    CHECK(store->get("rec-999"_sl, kMetaOnly).bodySize() == compressibleBody(999).size());
+}
+
+N_WAY_TEST_CASE_METHOD(KeyStoreTestFixture, "DataFile Body Compression Raw Values", "[DataFile]") {
+    // Raw values are arbitrary data; a JPEG, for instance, starts with 0xFF like a compressed body:
+    static constexpr uint8_t kJPEGBytes[] = {0xFF, 0xD8, 0xFF, 0xE0, 0x00, 0x10, 'J', 'F', 'I', 'F', 0x00};
+    slice                    jpeg(kJPEGBytes, sizeof(kJPEGBytes));
+
+    saveCompressibleDocs(store, 1, 10);
+    KeyStore& rawStore = db->getKeyStore("raw_images", KeyStore::noSequences);
+    {
+        ExclusiveTransaction t(db);
+        store->setBodyCompression(100, t);
+        rawStore.setKV("photo"_sl, jpeg, t);
+        // This one is too small to be compressed:
+        RecordUpdate rec("jpeg"_sl, jpeg);
+        store->set(rec, KeyStore::kUpdateSequence, t);
+        t.commit();
+    }
+    saveCompressibleDocs(store, 11, 20);
+
+    CHECK(rawStore.get("photo"_sl).body() == jpeg);
+    CHECK(store->get("jpeg"_sl).body() == jpeg);
+    CHECK(store->get("rec-015"_sl).body() == slice(compressibleBody(15)));
+    for ( RecordEnumerator e(rawStore); e.next(); ) CHECK(e->body() == jpeg);
+
+    // A compressed record stays readable after it's moved to a KeyStore that doesn't compress:
+    KeyStore& otherStore = db->getKeyStore("other");
+    {
+        ExclusiveTransaction t(db);
+        store->moveTo("rec-015"_sl, otherStore, t);
+        t.commit();
+    }
+    CHECK(otherStore.get("rec-015"_sl).body() == slice(compressibleBody(15)));
+}
+
 N_WAY_TEST_CASE_METHOD(KeyStoreTestFixture, "DataFile AbortTransaction", "[DataFile]") {
     // Initial record:
     Record a("a");
@@ -12,11 +12,15 @@
 
 #include "LiteCoreTest.hh"
 #include "SQLite_Internal.hh"
+#include "SQLiteFleeceUtil.hh"
+#include "BodyCompressor.hh"
 #include "StringUtil.hh"
 #include "UnicodeCollator.hh"
 #include "FleeceImpl.hh"
+#include "Stopwatch.hh"
 #include "SQLiteCpp/SQLiteCpp.h"
 #include <sqlite3.h>
+#include <optional>
 
 using namespace litecore;
 using namespace fleece;
@@ -383,6 +387,153 @@ N_WAY_TEST_CASE_METHOD(SQLiteFunctionsTest, "SQLite fl_blob", "[Query]") {
           == (vector<string>{"foobar", "bazz", "MISSING", "MISSING", "MISSING"}));
 }
 
+N_WAY_TEST_CASE_METHOD(SQLiteFunctionsTest, "SQLite functions with QueryScratch", "[Query]") {
+    insert("a", "{n: 1, tags: ['x', 'y'], text: 'hi there'}");
+    insert("b", "{n: 2.5, tags: [], text: ''}");
+    insert("c", "{n: 'three', tags: {z: true}}");
+
+    // (Fleece results are converted to JSON by concatenating them with an empty string.)
+    const char* queries[] = {
+            "SELECT N1QL_concat('', array_of(key, fl_value(body, 'n'), fl_value(body, 'tags'))) FROM kv ORDER BY key",
+            "SELECT N1QL_concat('', dict_of('k', key, 'tags', fl_value(body, 'tags'))) FROM kv ORDER BY key",
+            "SELECT fl_fts_value(body, 'tags') FROM kv ORDER BY key",
+            "SELECT N1QL_concat(key, '-', fl_value(body, 'n'), fl_value(body, 'tags')) FROM kv ORDER BY key",
+            "SELECT N1QL_concat('', array_agg(fl_value(body, 'n'))) FROM kv",
+            // Several functions reading each row's body:
+            "SELECT N1QL_concat(fl_value(body, 'text'), '/', fl_count(body, 'tags'), '/', fl_exists(body, 'n')) FROM kv"
+            " WHERE fl_exists(body, 'tags') ORDER BY fl_value(body, 'n')",
+            // Two bodies per row:
+            "SELECT N1QL_concat(a.key, b.key, fl_value(a.body, 'n'), fl_value(b.body, 'n'), fl_value(a.body, 'text'))"
+            " FROM kv AS a JOIN kv AS b ON fl_value(a.body, 'n') != fl_value(b.body, 'n') ORDER BY a.key, b.key",
+    };
+    for ( const char* sql : queries ) {
+        INFO("Query: " << sql);
+        auto expected = query(sql);
+        // With a scratch, the functions' temporaries are reused from row to row:
+        QueryScratch      scratch;
+        QueryScratch::Use use(scratch);
+        vector<string>    results;
+        SQLite::Statement st(db, sql);
+        while ( st.executeStep() ) {
+            scratch.reset();
+            auto column = st.getColumn(0);
+            results.emplace_back(column.getType() == SQLITE_NULL ? "MISSING" : column.getText());
+        }
+        CHECK(results == expected);
+    }
+}
+
+N_WAY_TEST_CASE_METHOD(SQLiteFunctionsTest, "SQLite functions QueryScratch performance", "[Query][Perf][.slow]") {
+    static constexpr int kNumRows = 1'000'000;
+    db.exec("BEGIN");
+    for ( int i = 0; i < kNumRows; ++i ) {
+        char key[20], json[100];
+        snprintf(key, sizeof(key), "doc-%07d", i);
+        snprintf(json, sizeof(json), "{n: %d, name: 'Doc number %d', tags: ['a', 'b', %d]}", i, i, i % 100);
+        insert(key, json);
+    }
+    db.exec("COMMIT");
+
+    // Times `sql`, which returns `nRows` rows, reporting the time per document scanned.
+    auto run = [&](bool useScratch, const char* sql, int nRows) {
+        optional<QueryScratch>      scratch;
+        optional<QueryScratch::Use> use;
+        if ( useScratch ) use.emplace(scratch.emplace());
+        SQLite::Statement st(db, sql);
+
+        fleece::Stopwatch sw;
+        int               n = 0;
+        while ( st.executeStep() ) {
+            if ( scratch ) scratch->reset();
+            ++n;
+        }
+        double elapsed = sw.elapsed();
+        CHECK(n == nRows);
+        Log("%s scratch: %d rows in %.3f sec (%.0f ns/doc): %s", (useScratch ? "With" : "Without"), n, elapsed,
+            elapsed / kNumRows * 1e9, sql);
+    };
+
+    // A result built per row:
+    const char* rowQuery = "SELECT fl_result(dict_of('n', fl_value(body, 'n'), 'tags', fl_value(body, 'tags'))),"
+                           " N1QL_concat(key, ': ', fl_value(body, 'name')) FROM kv";
+    // Aggregates, which call the functions for many rows within a single step without a reset:
+    const char* aggregateQuery = "SELECT fl_value(body, 'tags[2]') AS g, count(*),"
+                                 " N1QL_concat('', array_agg(dict_of('n', fl_value(body, 'n'))))"
+                                 " FROM kv GROUP BY g";
+    run(false, rowQuery, kNumRows);
+    run(true, rowQuery, kNumRows);
+    run(false, aggregateQuery, 100);
+    run(true, aggregateQuery, 100);
+}
+
+N_WAY_TEST_CASE_METHOD(SQLiteFunctionsTest, "SQLite fl_value row cache performance", "[Query][Perf][.slow]") {
+    // A separate database whose SQL functions can decompress bodies:
+    alloc_slice      dictionary;
+    BodyDictionaries dictionaries([&](uint32_t id) { return id == 1 ? dictionary : nullslice; }, [] { return true; });
+    SQLite::Database cdb(":memory:", SQLite::OPEN_READWRITE | SQLite::OPEN_CREATE);
+    RegisterSQLiteFunctions(cdb.getHandle(), {this, sharedKeys, &dictionaries});
+    cdb.exec("CREATE TABLE plain (key TEXT, body BLOB); CREATE TABLE compressed (key TEXT, body BLOB)");
+
+    static constexpr int kNumRows = 200'000;
+    vector<alloc_slice>  bodies;
+    bodies.reserve(kNumRows);
+    for ( int i = 0; i < kNumRows; ++i ) {
+        char json[200];
+        snprintf(json, sizeof(json),
+                 "{a: %d, b: 'Doc number %d', c: {x: %d, y: true}, d: %d, e: 'sort %d', f: [1, 2, 3]}", i, i, i,
+                 i % 100, kNumRows - i);
+        bodies.push_back(JSONConverter::convertJSON(slice(json5(json)), sharedKeys));
+    }
+    dictionary = BodyCompressor::trainDictionary(vector<alloc_slice>(bodies.begin(), bodies.begin() + 1000));
+    BodyCompressor compressor(0, 1, dictionary);
+
+    cdb.exec("BEGIN");
+    SQLite::Statement insertPlain(cdb, "INSERT INTO plain (key, body) VALUES (?, ?)");
+    SQLite::Statement insertCompressed(cdb, "INSERT INTO compressed (key, body) VALUES (?, ?)");
+    for ( int i = 0; i < kNumRows; ++i ) {
+        char key[20];
+        snprintf(key, sizeof(key), "doc-%07d", i);
+        alloc_slice compressedBody = compressor.compress(bodies[i]);
+        if ( !compressedBody ) compressedBody = bodies[i];  // Not smaller; stored as-is
+        for ( auto [st, body] : {pair{&insertPlain, bodies[i]}, pair{&insertCompressed, compressedBody}} ) {
+            st->bind(1, key);
+            st->bind(2, body.buf, (int)body.size);
+            st->exec();
+            st->reset();
+        }
+    }
+    cdb.exec("COMMIT");
+
+    // Reads 1 or 5 properties of every row, with and without a QueryScratch. With one, a
+    // compressed body is decompressed once per row instead of once per fl_value call; plain
+    // bodies are read in place either way.
+    auto run = [&](bool useScratch, const string& sql) {
+        optional<QueryScratch>      scratch;
+        optional<QueryScratch::Use> use;
+        if ( useScratch ) use.emplace(scratch.emplace());
+        SQLite::Statement st(cdb, sql);
+
+        fleece::Stopwatch sw;
+        int               n = 0;
+        while ( st.executeStep() ) {
+            if ( scratch ) scratch->reset();
+            ++n;
+        }
+        double elapsed = sw.elapsed();
+        CHECK(n > 0);
+        Log("%s scratch: %d rows in %.3f sec (%.0f ns/row): %s", (useScratch ? "With" : "Without"), n, elapsed,
+            elapsed / n * 1e9, sql.c_str());
+    };
+    for ( const char* table : {"plain", "compressed"} ) {
+        for ( string sql : {"SELECT fl_value(body, 'a') FROM "s + table,
+                            "SELECT fl_value(body, 'a'), fl_value(body, 'b'), fl_value(body, 'c.x') FROM "s + table
+                                    + " WHERE fl_value(body, 'd') > 10 ORDER BY fl_value(body, 'e')"} ) {
+            run(false, sql);
+            run(true, sql);
+        }
+    }
+}
+
 #pragma mark - COLLATION:
 
 
@@ -17,12 +17,16 @@
 #include "fleece/InstanceCounted.hh"
 #include "catch.hpp"
 #include "DatabaseImpl.hh"
+#include "DatabasePool.hh"
 #include "Defer.hh"
 #include "Housekeeper.hh"
 #include "NumConversion.hh"
 #include "Actor.hh"
+#include "Instrumentation.hh"
 #include "URLTransformer.hh"
 #include "SQLiteDataFile.hh"
+#include "Stopwatch.hh"
+#include <atomic>
 #include <exception>
 #include <chrono>
 #include <thread>
@@ -31,6 +35,7 @@
 #    include <winerror.h>
 #endif
 #include <future>
+#include <random>
 #include <sstream>
 
 using namespace fleece;
@@ -232,6 +237,383 @@ N_WAY_TEST_CASE_METHOD(C4Test, "Database Flag FullSync", "[Database][C]") {
     CHECK(fullSyncPragma == "2");
 }
 
+N_WAY_TEST_CASE_METHOD(C4Test, "Database Flag MMapReads", "[Database][C]") {
+    auto mmapSize = [](C4Database* database) {
+        alloc_slice size = litecore::asInternal(database)->dataFile()->rawScalarQuery("PRAGMA mmap_size");
+        return std::stoll(string(size));
+    };
+
+    // By default, the platform decides:
+    CHECK(litecore::asInternal(db)->dataFile()->options().mmapReads == litecore::DataFile::MMapMode::PlatformDefault);
+    CHECK((mmapSize(db) > 0) == (litecore::SQLiteDataFile::defaultMmapSize() > 0));
+
+    C4DatabaseConfig2 config = *c4db_getConfig2(db);
+    config.flags |= kC4DB_NoMMapReads;
+    c4::ref<C4Database> noMMapConnection = c4db_openNamed(c4db_getName(db), &config, ERROR_INFO());
+    CHECK(mmapSize(noMMapConnection) == 0);
+
+    config.flags = (config.flags & ~kC4DB_NoMMapReads) | kC4DB_MMapReads;
+    c4::ref<C4Database> mmapConnection = c4db_openNamed(c4db_getName(db), &config, ERROR_INFO());
+    CHECK(mmapSize(mmapConnection) > 0);
+
+    // The flag is passed to database opened by openAgain.
+    c4::ref<C4Database> againConnection = c4db_openAgain(mmapConnection, ERROR_INFO());
+    CHECK(mmapSize(againConnection) > 0);
+}
+
+N_WAY_TEST_CASE_METHOD(C4Test, "Database Cache Size", "[Database][C]") {
+    constexpr size_t MB = 1024 * 1024;
+
+    // A cache size set in bytes is reported as a negative number of KB:
+    auto cacheSizeKB = [](C4Database* database) {
+        alloc_slice size = litecore::asInternal(database)->dataFile()->rawScalarQuery("PRAGMA cache_size");
+        return -std::stoll(string(size));
+    };
+
+    CHECK(cacheSizeKB(db) == 10 * 1024);
+    REQUIRE(c4db_setCacheSize(db, 2 * MB, ERROR_INFO()));
+    CHECK(cacheSizeKB(db) == 2 * 1024);
+
+    // Other connections are unaffected:
+    c4::ref<C4Database> otherConnection = c4db_openAgain(db, ERROR_INFO());
+    CHECK(cacheSizeKB(otherConnection) == 10 * 1024);
+
+    REQUIRE(c4db_setCacheSize(db, 0, ERROR_INFO()));
+    CHECK(cacheSizeKB(db) == 10 * 1024);
+
+    // By default a DatabasePool leaves its databases' cache sizes alone:
+    auto pool = make_retained<litecore::DatabasePool>(c4db_getName(db), *c4db_getConfig2(db));
+    CHECK(pool->cacheBudget() == 0);
+    {
+        litecore::BorrowedDatabase reader = pool->borrow();
+        CHECK(cacheSizeKB(reader) == 10 * 1024);
+    }
+
+    // A budget is divided among the pool's capacity (default 5):
+    pool->setCacheBudget(20 * MB);
+    {
+        litecore::BorrowedDatabase reader = pool->borrow();
+        CHECK(cacheSizeKB(reader) == 4 * 1024);
+
+        // A borrowed database isn't resized until it's returned:
+        pool->setCacheBudget(10 * MB);
+        CHECK(cacheSizeKB(reader) == 4 * 1024);
+    }
+    {
+        litecore::BorrowedDatabase reader = pool->borrow();
+        CHECK(cacheSizeKB(reader) == 2 * 1024);
+    }
+
+    // More connections means a smaller share each:
+    pool->setCapacity(8);
+    {
+        litecore::BorrowedDatabase reader = pool->borrow();
+        CHECK(cacheSizeKB(reader) == 10 * 1024 / 8);
+        if ( pool->writeable() ) {
+            litecore::BorrowedDatabase writer = pool->borrowWriteable();
+            CHECK(cacheSizeKB(writer) == 10 * 1024 / 8);
+        }
+    }
+
+    // Going back to no budget restores the default size:
+    pool->setCacheBudget(0);
+    {
+        litecore::BorrowedDatabase reader = pool->borrow();
+        CHECK(cacheSizeKB(reader) == 10 * 1024);
+    }
+    pool->close();
+
+    // A pool never resizes the caller's database it was created with:
+    c4::ref<C4Database> mainConnection = c4db_openAgain(db, ERROR_INFO());
+    REQUIRE(c4db_setCacheSize(mainConnection, 2 * MB, ERROR_INFO()));
+    fleece::Retained<C4Database> retainedMain = mainConnection.get();
+    pool = make_retained<litecore::DatabasePool>(std::move(retainedMain).asRef());
+    pool->setCacheBudget(100 * MB);
+    CHECK(cacheSizeKB(mainConnection) == 2 * 1024);
+    pool->close();
+}
+
+N_WAY_TEST_CASE_METHOD(C4Test, "Pooled Readers Cache Budget", "[Database][Perf][.slow]") {
+    constexpr size_t MB = 1024 * 1024;
+    // A ~100MB database, of which a "hot" 10% gets 90% of the reads:
+    constexpr size_t   kNumDocs = 200000, kNumHotDocs = kNumDocs / 10;
+    constexpr size_t   kReadsPerThread = 100000;
+    constexpr unsigned kNumReaders     = 8;
+    createPaddedNumberedDocs(kNumDocs);
+
+    auto config = *c4db_getConfig2(db);
+    config.flags |= kC4DB_ReadOnly;
+
+    auto run = [&](const char* what, size_t poolBudget, uint64_t processBudget) {
+        c4_setCacheBudget(processBudget);
+        auto pool = make_retained<litecore::DatabasePool>(c4db_getName(db), config);
+        pool->setCapacity(kNumReaders);
+        pool->setCacheBudget(poolBudget);
+
+        atomic<size_t>    failures = 0;
+        vector<thread>    readers;
+        fleece::Stopwatch st;
+        for ( unsigned r = 0; r < kNumReaders; ++r ) {
+            readers.emplace_back([&, r] {
+                litecore::BorrowedDatabase bdb = pool->borrow();
+                C4Collection*              coll = c4db_getDefaultCollection(bdb, nullptr);
+                mt19937                    rng(r);
+                for ( size_t i = 0; i < kReadsPerThread; ++i ) {
+                    size_t n = (rng() % 10) ? (rng() % kNumHotDocs) : (rng() % kNumDocs);
+                    char   docID[20];
+                    snprintf(docID, sizeof(docID), "%07zu", n + 1);
+                    if ( C4Document* doc = c4coll_getDoc(coll, c4str(docID), true, kDocGetCurrentRev, nullptr) )
+                        c4doc_release(doc);
+                    else
+                        ++failures;
+                }
+            });
+        }
+        for ( auto& reader : readers ) reader.join();
+        double   elapsed = st.elapsed();
+        uint64_t memory  = litecore::SQLiteDataFile::memoryUsed();
+        pool->close();
+        c4_setCacheBudget(0);
+
+        CHECK(failures == 0);
+        C4Log("%-32s: %9.0f docs/sec, SQLite memory %6.1f MB", what, kNumReaders * kReadsPerThread / elapsed,
+              double(memory) / MB);
+    };
+
+    run("Private 10MB cache per reader", kNumReaders * 10 * MB, 0);
+    run("Pool budget 20MB", 20 * MB, 0);
+    run("Pool budget 20MB, process 24MB", 20 * MB, 24 * MB);
+}
+
+N_WAY_TEST_CASE_METHOD(C4Test, "Pooled Readers Snapshot Group", "[Database][C]") {
+    // (Leaves one of the pool's 4 read-only databases for a regular borrow.)
+    constexpr unsigned kNumReaders = 3, kMinReadsPerReader = 20, kMinCommitsDuringReads = 10;
+    createNumberedDocs(100);
+    auto pool = make_retained<litecore::DatabasePool>(c4db_getName(db), *c4db_getConfig2(db));
+
+    // A writer keeps adding docs, one per transaction, on the test's own connection:
+    atomic<bool>     stop = false;
+    atomic<unsigned> commits = 0, writeFailures = 0;
+
+    thread writer([&] {
+        C4Collection* coll = c4db_getDefaultCollection(db, nullptr);
+        for ( unsigned i = 0; !stop; ++i ) {
+            char docID[20];
+            snprintf(docID, sizeof(docID), "new-%06u", i);
+            if ( !c4db_beginTransaction(db, nullptr) ) {
+                ++writeFailures;
+                continue;
+            }
+            C4Document* doc = c4coll_createDoc(coll, slice(docID), kFleeceBody, 0, nullptr);
+            if ( c4db_endTransaction(db, doc != nullptr, nullptr) && doc )
+                ++commits;
+            else
+                ++writeFailures;
+            c4doc_release(doc);
+        }
+    });
+    DEFER {
+        stop = true;
+        writer.join();
+    };
+    while ( commits < kMinCommitsDuringReads ) this_thread::sleep_for(1ms);
+
+    uint64_t docsInSnapshot;
+    {
+        auto group = pool->borrowSnapshotGroup(kNumReaders);
+        REQUIRE(group.size() == kNumReaders);
+        C4Collection*    firstColl   = c4db_getDefaultCollection(group[0], nullptr);
+        C4SequenceNumber snapshotSeq = c4coll_getLastSequence(firstColl);
+        docsInSnapshot               = c4coll_getDocumentCount(firstColl);
+        CHECK(docsInSnapshot >= 100 + kMinCommitsDuringReads);
+
+        // Every reader keeps seeing exactly the same docs, however many commits happen meanwhile:
+        unsigned         commitsBefore   = commits;
+        atomic<unsigned> inconsistencies = 0;
+        vector<thread>   readers;
+        for ( unsigned r = 0; r < kNumReaders; ++r ) {
+            readers.emplace_back([&, r] {
+                C4Collection* coll = c4db_getDefaultCollection(group[r], nullptr);
+                for ( unsigned i = 0; i < kMinReadsPerReader
+                                      || (commits < commitsBefore + kMinCommitsDuringReads && writeFailures == 0);
+                      ++i ) {
+                    uint64_t n = 0;
+                    if ( C4DocEnumerator* e = c4coll_enumerateAllDocs(coll, nullptr, nullptr) ) {
+                        while ( c4enum_next(e, nullptr) ) ++n;
+                        c4enum_free(e);
+                    }
+                    if ( n != docsInSnapshot || c4coll_getDocumentCount(coll) != docsInSnapshot
+                         || c4coll_getLastSequence(coll) != snapshotSeq )
+                        ++inconsistencies;
+                }
+            });
+        }
+        for ( auto& reader : readers ) reader.join();
+        CHECK(inconsistencies == 0);
+        CHECK(writeFailures == 0);
+        CHECK(commits >= commitsBefore + kMinCommitsDuringReads);
+
+        // The group's databases aren't handed out again while it holds them:
+        {
+            litecore::BorrowedDatabase other = pool->borrow();
+            for ( unsigned r = 0; r < kNumReaders; ++r ) CHECK(other.get() != group[r]);
+            CHECK(c4coll_getDocumentCount(c4db_getDefaultCollection(other, nullptr)) > docsInSnapshot);
+        }
+    }
+
+    // After the group is returned, its databases see the latest commits:
+    CHECK(pool->borrowedCount() == 0);
+    {
+        auto group = pool->borrowSnapshotGroup(kNumReaders);
+        CHECK(c4coll_getDocumentCount(c4db_getDefaultCollection(group[kNumReaders - 1], nullptr)) > docsInSnapshot);
+    }
+
+    ++gC4ExpectExceptions;
+    CHECK_THROWS_AS(pool->borrowSnapshotGroup(0), litecore::error);
+    CHECK_THROWS_AS(pool->borrowSnapshotGroup(pool->capacity()), litecore::error);
+    --gC4ExpectExceptions;
+    pool->close();
+}
+
+N_WAY_TEST_CASE_METHOD(C4Test, "Pooled Readers Snapshot Group Parallel Scan", "[Database][Perf][.slow]") {
+    constexpr size_t   kNumDocs    = 200000;
+    constexpr unsigned kNumReaders = 4;
+    createPaddedNumberedDocs(kNumDocs, 200);
+
+    auto config = *c4db_getConfig2(db);
+    config.flags |= kC4DB_ReadOnly;
+    auto pool = make_retained<litecore::DatabasePool>(c4db_getName(db), config);
+    pool->setCapacity(kNumReaders);
+
+    // Sums the "n" property of the docs whose IDs are in the range [first, end):
+    auto scan = [](C4Database* database, size_t first, size_t end) -> int64_t {
+        c4::ref<C4Query> query = c4query_new2(
+                database, kC4N1QLQuery, "SELECT sum(n) FROM _ WHERE meta().id >= $first AND meta().id < $end"_sl,
+                nullptr, nullptr);
+        char params[100];
+        snprintf(params, sizeof(params), R"({"first":"%07zu","end":"%07zu"})", first, end);
+        c4::ref<C4QueryEnumerator> e = query ? c4query_run(query, slice(params), nullptr) : nullptr;
+        if ( !e || !c4queryenum_next(e, nullptr) ) return -1;
+        return FLValue_AsInt(FLArrayIterator_GetValueAt(&e->columns, 0));
+    };
+
+    auto run = [&](unsigned numReaders) {
+        fleece::Stopwatch st;
+        auto              group = pool->borrowSnapshotGroup(numReaders);
+        vector<int64_t>   sums(numReaders);
+        vector<thread>    readers;
+        for ( unsigned r = 0; r < numReaders; ++r ) {
+            readers.emplace_back([&, r] {
+                sums[r] = scan(group[r], 1 + kNumDocs * r / numReaders, 1 + kNumDocs * (r + 1) / numReaders);
+            });
+        }
+        for ( auto& reader : readers ) reader.join();
+        double elapsed = st.elapsed();
+
+        int64_t total = 0;
+        for ( int64_t sum : sums ) {
+            CHECK(sum >= 0);
+            total += sum;
+        }
+        CHECK(total == int64_t(kNumDocs * (kNumDocs + 1) / 2));
+        C4Log("Scan with %u reader(s): %7.1f ms", numReaders, elapsed * 1000);
+        return elapsed;
+    };
+
+    run(1);  // warm up the OS file cache
+    double serial   = run(1);
+    double parallel = run(kNumReaders);
+    C4Log("Parallel scan speedup with %u readers: %.2fx", kNumReaders, serial / parallel);
+    pool->close();
+}
+
+N_WAY_TEST_CASE_METHOD(C4Test, "Database Background Checkpoint", "[Database][C]") {
+    auto autoCheckpoint = [](C4Database* database) {
+        alloc_slice pages = litecore::asInternal(database)->dataFile()->rawScalarQuery("PRAGMA wal_autocheckpoint");
+        return std::stoi(string(pages));
+    };
+
+    // Once the Housekeeper is checkpointing the WAL, the main connection's commits stop doing it.
+    // (The Housekeeper starts asynchronously, and the setting changes when a transaction begins.)
+    auto backgroundCheckpointing = [&](C4Database* database) {
+        TransactionHelper t(database);
+        return autoCheckpoint(database) == 0;
+    };
+    CHECK_BEFORE(5s, backgroundCheckpointing(db));
+
+    // A connection without housekeeping checkpoints as it commits, as usual:
+    c4::ref<C4Database> otherConnection = c4db_openAgain(db, ERROR_INFO());
+    CHECK(autoCheckpoint(otherConnection) == 1000);
+
+    // Grow the WAL past the journal size limit (5MB), with a commit that changes only raw docs:
+    litecore::DataFile* dataFile = litecore::asInternal(db)->dataFile();
+    {
+        TransactionHelper t(db);
+        alloc_slice       body(1024 * 1024);
+        memset((void*)body.buf, 'x', body.size);
+        for ( int i = 0; i < 8; ++i ) {
+            string key = "big-" + to_string(i);
+            REQUIRE(c4raw_put(db, "test"_sl, slice(key), nullslice, body, ERROR_INFO()));
+        }
+    }
+    litecore::FilePath walFile = dataFile->filePath().appendingToName("-wal");
+    CHECK(walFile.dataSize() > 5 * 1024 * 1024);
+
+    // The commit triggers the Housekeeper's checkpoint, which copies the WAL, then truncates it
+    // since it's too big:
+    CHECK_BEFORE(5s, walFile.dataSize() == 0);
+
+    // Closing and reopening restores the settings:
+    reopenDB();
+    CHECK_BEFORE(5s, backgroundCheckpointing(db));
+}
+
+N_WAY_TEST_CASE_METHOD(C4Test, "Database Incremental Vacuum", "[Database][C]") {
+    using namespace litecore;
+    // Keep the Housekeeper from vacuuming until the end of the test:
+    auto prevBudget = Housekeeper::setVacuumBudget(0ms);
+    DEFER { Housekeeper::setVacuumBudget(prevBudget); };
+
+    DataFile* dataFile = asInternal(db)->dataFile();
+
+    auto intPragma = [&](const char* pragma) {
+        return std::stoll(string(dataFile->rawScalarQuery(string("PRAGMA ") + pragma)));
+    };
+
+    // Adding and then deleting 8MB of data leaves about 2000 free pages:
+    auto addAndDelete = [&] {
+        alloc_slice body(1024 * 1024);
+        memset((void*)body.buf, 'x', body.size);
+        for ( slice value : {slice(body), nullslice} ) {
+            TransactionHelper t(db);
+            for ( int i = 0; i < 8; ++i ) {
+                string key = "big-" + to_string(i);
+                REQUIRE(c4raw_put(db, "test"_sl, slice(key), nullslice, value, ERROR_INFO()));
+            }
+        }
+    };
+    addAndDelete();
+    auto freePages = intPragma("freelist_count"), pageCount = intPragma("page_count");
+    CHECK(freePages > 1500);
+
+    // Even with no time budget, one step's worth of pages is freed:
+    CHECK(dataFile->incrementalVacuum(0ms));
+    CHECK(intPragma("freelist_count") < freePages);
+
+    // With enough time, nearly all the free pages are returned to the filesystem:
+    CHECK_FALSE(dataFile->incrementalVacuum(10s));
+    CHECK(intPragma("freelist_count") <= 64);
+    CHECK(intPragma("page_count") < pageCount - 1500);
+    CHECK(dataFile->filePath().dataSize() == intPragma("page_count") * 4096);
+
+    // The Housekeeper does the same once the database has been idle for a couple of seconds:
+    Housekeeper::setVacuumBudget(100ms);
+    addAndDelete();
+    CHECK(intPragma("freelist_count") > 1500);
+    for ( int i = 0; i < 100 && intPragma("freelist_count") > 64; ++i ) this_thread::sleep_for(100ms);
+    CHECK(intPragma("freelist_count") <= 64);
+}
+
 #pragma mark - INSTANCECOUNTED:
 
 namespace {
@@ -353,6 +735,69 @@ namespace {
         this_thread::sleep_for(2s);
     }
 
+    TEST_CASE("Actor Stats", "[C]") {
+        auto actor = retained(new TestActor());
+        for ( int i = 0; i < 5; ++i ) actor->doot();
+        actor->waitTillCaughtUp();
+
+        Doc stats(alloc_slice(c4_getActorStats()));
+        REQUIRE(stats.asDict());
+        C4Log("Actor stats: %s", stats.root().toJSONString().c_str());
+        bool found = false;
+        for ( Dict::iterator i(stats.asDict()); i; ++i ) {
+            // Other TestActors may still be alive, so look for one with the right event count:
+            Dict actorStats = i.value().asDict();
+            if ( i.keyString().hasPrefix("TestActor"_sl) && actorStats["enqueued"].asUnsigned() == 6 ) {
+                found = true;
+                CHECK(actorStats["handled"].asUnsigned() >= 5);
+                CHECK(actorStats["maxQueueDepth"].asUnsigned() >= 1);
+                CHECK(actorStats["runTime"].asDict()["count"].asUnsigned() >= 5);
+                CHECK(actorStats["waitTime"].asDict()["buckets"].asArray().count() > 0);
+            }
+        }
+        CHECK(found);
+    }
+
+    TEST_CASE("Signpost Tracing", "[C]") {
+        using litecore::Signpost;
+        c4_setSignpostTracing(true);
+        {
+            Signpost signpost(Signpost::queryRun, 1234);
+            Signpost::mark(Signpost::blipReceived, 1234, 77);
+        }
+        thread([] {
+            // Overflow this thread's ring buffer, so the first event is lost:
+            Signpost::mark(Signpost::replicatorConnect, 1234);
+            for ( size_t i = 0; i < Signpost::kTraceBufferSize; ++i ) Signpost::mark(Signpost::blipSent, 1234, i);
+        }).join();
+        c4_setSignpostTracing(false);
+        Signpost::mark(Signpost::replicatorDisconnect, 1234);  // not recorded
+
+        auto countEvents = [](Doc& trace, slice name, slice phase) {
+            unsigned n = 0;
+            for ( Array::iterator i(trace["traceEvents"].asArray()); i; ++i ) {
+                Dict event = i.value().asDict();
+                if ( event["name"].asString() == name && event["ph"].asString() == phase
+                     && event["args"].asDict()["param"].asUnsigned() == 1234 )
+                    ++n;
+            }
+            return n;
+        };
+
+        Doc trace = Doc::fromJSON(alloc_slice(c4_getSignpostTrace(true)));
+        REQUIRE(trace["traceEvents"].asArray());
+        CHECK(countEvents(trace, "queryRun"_sl, "b"_sl) == 1);
+        CHECK(countEvents(trace, "queryRun"_sl, "e"_sl) == 1);
+        CHECK(countEvents(trace, "blipReceived"_sl, "i"_sl) == 1);
+        CHECK(countEvents(trace, "blipSent"_sl, "i"_sl) == Signpost::kTraceBufferSize);
+        CHECK(countEvents(trace, "replicatorConnect"_sl, "i"_sl) == 0);
+        CHECK(countEvents(trace, "replicatorDisconnect"_sl, "i"_sl) == 0);
+
+        // The trace was cleared:
+        trace = Doc::fromJSON(alloc_slice(c4_getSignpostTrace(false)));
+        CHECK(countEvents(trace, "queryRun"_sl, "b"_sl) == 0);
+    }
+
     TEST_CASE("URL Transformation") {
         slice       withPort, unaffected;
         alloc_slice withoutPort;
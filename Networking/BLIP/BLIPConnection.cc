@@ -118,7 +118,7 @@ namespace litecore::blip {
 
       public:
         BLIPIO(Connection* connection, WebSocket* webSocket, Deflater::CompressionLevel compressionLevel)
-            : Actor(BLIPLog, string("BLIP[") + connection->name() + "]")
+            : Actor(BLIPLog, string("BLIP[") + connection->name() + "]", actor::Priority::interactive)
             , _connection(connection)
             , _webSocket(webSocket)
             , _incomingFrames(this, "incomingFrames", &BLIPIO::_onWebSocketMessages)
@@ -16,6 +16,7 @@
 #include "ReplicatedRev.hh"
 #include "ReplicatorTuning.hh"
 #include "Error.hh"
+#include "Instrumentation.hh"
 #include "Stopwatch.hh"
 #include "StringUtil.hh"
 #include "c4BlobStore.hh"
@@ -39,6 +40,11 @@ namespace litecore::repl {
                             tuning::kInsertionDelay)
         , _timer([this] { markRevsSyncedNow(); })
         , _usingVersionVectors((pool->getConfiguration().flags & kC4DB_VersionVectors) != 0) {
+        if ( tuning::kAdaptiveInsertion ) {
+            // (No capacity, since an immediate pop would call markRevsSyncedNow on the caller's thread.)
+            _revsToMarkSynced.setAdaptive({tuning::kMinInsertionDelay, tuning::kMaxInsertionDelay, 0, 0});
+        }
+
         // There are a couple of read-only operations on a C4Database that may require write access
         // the first time. Take care of those now so a read-only instance doesn't trigger them and
         // cause a write-access exception:
@@ -319,6 +325,7 @@ namespace litecore::repl {
         }
         if ( reEncode ) {
             // Re-encode with database's current sharedKeys:
+            Signpost      signpost(Signpost::fleeceReencode, uintptr_t(this));
             SharedEncoder enc(idb->sharedFleeceEncoder());
             enc.writeValue(doc.root());
             alloc_slice data = enc.finish();
@@ -431,6 +438,8 @@ namespace litecore::repl {
             }
             transaction.commit();
             double t = st.elapsed();
+            _revsToMarkSynced.processed(revs->size(),
+                                        chrono::duration_cast<actor::Timer::duration>(chrono::duration<double>(t)));
             logVerbose("Marked %zu revs as synced-to-server in %.2fms (%.0f/sec)", revs->size(), t * 1000,
                        (double)revs->size() / t);
         } catch ( const exception& x ) {
@@ -439,7 +448,7 @@ namespace litecore::repl {
         }
     }
 
-    void DBAccess::markRevsSyncedLater() { _timer.fireAfter(tuning::kInsertionDelay); }
+    void DBAccess::markRevsSyncedLater() { _timer.fireAfter(_revsToMarkSynced.latency()); }
 
     atomic<unsigned> DBAccess::gNumDeltasApplied;
 
@@ -31,10 +31,22 @@ namespace litecore::repl {
         , _revsToInsert(this, "revsToInsert", &Inserter::_insertRevisionsNow, tuning::kInsertionDelay,
                         tuning::kInsertionBatchSize) {
         setParentObjectRef(repl->getObjectRef());
+        if ( tuning::kAdaptiveInsertion ) {
+            _revsToInsert.setAdaptive({tuning::kMinInsertionDelay, tuning::kMaxInsertionDelay,
+                                       tuning::kMinInsertionBatchSize, tuning::kMaxInsertionBatchSize});
+        }
     }
 
     void Inserter::insertRevision(RevToInsert* rev) { _revsToInsert.push(rev); }
 
+    // The put requests for a batch of revisions, and the memory they point to.
+    struct Inserter::PutBatch {
+        vector<RevToInsert*>     revs;
+        vector<C4DocPutRequest>  requests;
+        vector<vector<C4String>> histories;  // Storage for the requests' `history`
+        vector<alloc_slice>      bodies;     // Storage for the requests' `allocedBody`
+    };
+
     // Inserts all the revisions queued for insertion.
     void Inserter::_insertRevisionsNow(int gen) {
         auto revs = _revsToInsert.pop(gen);
@@ -52,24 +64,20 @@ namespace litecore::repl {
             // of them apply to the docs we're updating:
             _db->markRevsSyncedNow(transaction.db());
 
+            // The revs are saved together by a single `putDocuments` call. But a purge has to stay
+            // in order with the puts, so the revs batched before it are saved first.
+            PutBatch batch;
             for ( RevToInsert* rev : *revs ) {
-                C4Error docErr;
-                bool    docSaved = insertRevisionNow(rev, collection, &docErr);
-                rev->trimBody();  // don't need body any more
-                if ( docSaved ) {
-                    rev->owner->revisionProvisionallyInserted(rev->revocationMode != RevocationMode::kNone);
-                    _db->echoCanceler.addRev(collectionIndex(), rev->docID, rev->revID);
-                } else {
-                    // Notify owner of a rev that failed:
-                    string desc = docErr.description();
-                    warn("Failed to insert '%.*s' #%.*s : %s", SPLAT(rev->docID), SPLAT(rev->revID), desc.c_str());
-                    rev->error = docErr;
-                    if ( docErr == C4Error{LiteCoreDomain, kC4ErrorDeltaBaseUnknown}
-                         || docErr == C4Error{LiteCoreDomain, kC4ErrorCorruptDelta} )
-                        rev->errorIsTransient = true;
-                    rev->owner->revisionInserted();  // Tell the IncomingRev
+                C4Error docErr = {};
+                if ( rev->flags & kRevPurged ) {
+                    insertBatchNow(batch, collection);
+                    bool docPurged = purgeRevisionNow(rev, collection, &docErr);
+                    revisionInsertedNow(rev, docPurged, docErr);
+                } else if ( !addToBatch(rev, collection, batch, &docErr) ) {
+                    revisionInsertedNow(rev, false, docErr);
                 }
             }
+            insertBatchNow(batch, collection);
 
             Stopwatch stCommit;
             transaction.commit();
@@ -79,6 +87,9 @@ namespace litecore::repl {
             warn("Transaction failed!");
         }
 
+        _revsToInsert.processed(revs->size(),
+                                chrono::duration_cast<actor::Timer::duration>(chrono::duration<double>(st.elapsed())));
+
         // Notify owners of all revs that didn't already fail:
         for ( auto& rev : *revs ) {
             if ( rev->error.code == 0 ) {
@@ -91,84 +102,131 @@ namespace litecore::repl {
             gotError(transactionErr);
         } else {
             double t = st.elapsed();
-            logInfo("Inserted %3zu revs in %6.2fms (%5.0f/sec) of which %4.1f%% was commit", revs->size(), t * 1000,
-                    (double)revs->size() / t, commitTime / t * 100);
+            logInfo("Inserted %3zu revs in %6.2fms (%5.0f/sec) of which %4.1f%% was commit; next batch size %zu, "
+                    "delay %.1fms",
+                    revs->size(), t * 1000, (double)revs->size() / t, commitTime / t * 100,
+                    _revsToInsert.capacity(), chrono::duration<double, milli>(_revsToInsert.latency()).count());
         }
     }
 
-    // Inserts one revision. Returns only C4Errors, never throws exceptions.
-    bool Inserter::insertRevisionNow(RevToInsert* rev, C4Collection* collection, C4Error* outError) {
+    // Adds a put request for a revision to the batch. Returns only C4Errors, never throws exceptions.
+    bool Inserter::addToBatch(RevToInsert* rev, C4Collection* collection, PutBatch& batch, C4Error* outError) {
         try {
-            if ( rev->flags & kRevPurged ) {
-                // Server says the document is no longer accessible, i.e. it's been
-                // removed from all channels the client has access to. Purge it.
-                if ( collection->purgeDocument(rev->docID) ) {
-                    auto collPath = _options->collectionPath(collectionIndex());
-                    logVerbose("    {'%.*s (%.*s)' removed (purged)}", SPLAT(rev->docID), SPLAT(collPath));
-                }
-                return true;
+            // Set up the "put" parameter block:
+            vector<C4String> history = rev->history();
+            C4DocPutRequest  put     = {};
+            put.docID                = rev->docID;
+            put.revFlags             = rev->flags;
+            put.existingRevision     = true;
+            put.allowConflict        = !rev->noConflicts;
+            put.history              = history.data();
+            put.historyCount         = history.size();
+            put.remoteDBID           = _db->remoteDBID();
+            put.save                 = true;
+
+            alloc_slice bodyForDB;
+            if ( rev->deltaSrc ) {
+                // If this is a delta, put the JSON delta in the put-request:
+                bodyForDB            = std::move(rev->deltaSrc);
+                put.deltaSourceRevID = rev->deltaSrcRevID;
+                put.deltaCB          = [](void* context, C4Document* doc, C4Slice delta, C4RevisionFlags* revFlags,
+                                 C4Error* outError) -> C4SliceResult {
+                    try {
+                        auto self = (Inserter*)context;
+                        return self->applyDeltaCallback(doc, delta, revFlags, outError);
+                    } catch ( ... ) {
+                        *outError = C4Error::fromCurrentException();
+                        return {};
+                    }
+                };
+                put.deltaCBContext  = this;
+                _callbackCollection = collection;
             } else {
-                // Set up the "put" parameter block:
-                vector<C4String> history = rev->history();
-                C4DocPutRequest  put     = {};
-                put.docID                = rev->docID;
-                put.revFlags             = rev->flags;
-                put.existingRevision     = true;
-                put.allowConflict        = !rev->noConflicts;
-                put.history              = history.data();
-                put.historyCount         = history.size();
-                put.remoteDBID           = _db->remoteDBID();
-                put.save                 = true;
-
-                alloc_slice bodyForDB;
-                if ( rev->deltaSrc ) {
-                    // If this is a delta, put the JSON delta in the put-request:
-                    bodyForDB            = std::move(rev->deltaSrc);
-                    put.deltaSourceRevID = rev->deltaSrcRevID;
-                    put.deltaCB          = [](void* context, C4Document* doc, C4Slice delta, C4RevisionFlags* revFlags,
-                                     C4Error* outError) -> C4SliceResult {
-                        try {
-                            auto self = (Inserter*)context;
-                            return self->applyDeltaCallback(doc, delta, revFlags, outError);
-                        } catch ( ... ) {
-                            *outError = C4Error::fromCurrentException();
-                            return {};
-                        }
-                    };
-                    put.deltaCBContext  = this;
-                    _callbackCollection = collection;
-                } else {
-                    // If not a delta, encode doc body using database's real sharedKeys:
-                    bodyForDB = _db->reEncodeForDatabase(rev->doc, collection->getDatabase());
-                    rev->doc  = nullptr;
-                }
-                put.allocedBody = {(void*)bodyForDB.buf, bodyForDB.size};
+                // If not a delta, encode doc body using database's real sharedKeys:
+                bodyForDB = _db->reEncodeForDatabase(rev->doc, collection->getDatabase());
+                rev->doc  = nullptr;
+            }
+            put.allocedBody = {(void*)bodyForDB.buf, bodyForDB.size};
 
-                // The save!!
-                size_t commonAncestorIndex;
-                auto   doc = collection->putDocument(put, &commonAncestorIndex, outError);
-                if ( !doc ) return false;
-                auto collPath = _options->collectionPath(collectionIndex());
+            // (Moving the vector and alloc_slice leaves the request's pointers into them valid.)
+            batch.revs.push_back(rev);
+            batch.requests.push_back(put);
+            batch.histories.push_back(std::move(history));
+            batch.bodies.push_back(std::move(bodyForDB));
+            return true;
+        } catch ( ... ) {
+            *outError = C4Error::fromCurrentException();
+            return false;
+        }
+    }
+
+    // Saves the batched revisions, and clears the batch.
+    void Inserter::insertBatchNow(PutBatch& batch, C4Collection* collection) {
+        size_t n = batch.revs.size();
+        if ( n == 0 ) return;
+
+        vector<size_t>  commonAncestorIndexes(n);
+        vector<C4Error> errors(n);
+
+        // The save!!
+        auto docs = collection->putDocuments(batch.requests.data(), n, commonAncestorIndexes.data(), errors.data());
+
+        auto collPath = _options->collectionPath(collectionIndex());
+        for ( size_t i = 0; i < n; ++i ) {
+            RevToInsert* rev = batch.revs[i];
+            if ( C4Document* doc = docs[i] ) {
                 logVerbose("    {'%.*s (%.*s)' #%.*s <- %.*s} seq %" PRIu64, SPLAT(rev->docID), SPLAT(collPath),
                            SPLAT(rev->revID), SPLAT(rev->historyBuf), (uint64_t)doc->selectedRev().sequence);
                 rev->sequence = doc->selectedRev().sequence;
-                if ( commonAncestorIndex == 0 ) rev->alreadyExisted = true;
+                if ( commonAncestorIndexes[i] == 0 ) rev->alreadyExisted = true;
                 if ( doc->selectedRev().flags & kRevIsConflict ) {
                     // Note that rev was inserted but caused a conflict:
                     logInfo("Created conflict with '%.*s (%.*s)' #%.*s", SPLAT(rev->docID), SPLAT(collPath),
                             SPLAT(rev->revID));
                     rev->flags |= kRevIsConflict;
                     rev->isWarning = true;
-                    DebugAssert(put.allowConflict);
+                    DebugAssert(batch.requests[i].allowConflict);
                 }
-                return true;
             }
+            revisionInsertedNow(rev, docs[i] != nullptr, errors[i]);
+        }
+        batch = {};
+    }
+
+    // Purges a revision's document. Returns only C4Errors, never throws exceptions.
+    bool Inserter::purgeRevisionNow(RevToInsert* rev, C4Collection* collection, C4Error* outError) {
+        try {
+            // Server says the document is no longer accessible, i.e. it's been
+            // removed from all channels the client has access to. Purge it.
+            if ( collection->purgeDocument(rev->docID) ) {
+                auto collPath = _options->collectionPath(collectionIndex());
+                logVerbose("    {'%.*s (%.*s)' removed (purged)}", SPLAT(rev->docID), SPLAT(collPath));
+            }
+            return true;
         } catch ( ... ) {
             *outError = C4Error::fromCurrentException();
             return false;
         }
     }
 
+    // Notifies a revision's owner that it's been saved, or failed to be.
+    void Inserter::revisionInsertedNow(RevToInsert* rev, bool saved, C4Error docErr) {
+        rev->trimBody();  // don't need body any more
+        if ( saved ) {
+            rev->owner->revisionProvisionallyInserted(rev->revocationMode != RevocationMode::kNone);
+            _db->echoCanceler.addRev(collectionIndex(), rev->docID, rev->revID);
+        } else {
+            // Notify owner of a rev that failed:
+            string desc = docErr.description();
+            warn("Failed to insert '%.*s' #%.*s : %s", SPLAT(rev->docID), SPLAT(rev->revID), desc.c_str());
+            rev->error = docErr;
+            if ( docErr == C4Error{LiteCoreDomain, kC4ErrorDeltaBaseUnknown}
+                 || docErr == C4Error{LiteCoreDomain, kC4ErrorCorruptDelta} )
+                rev->errorIsTransient = true;
+            rev->owner->revisionInserted();  // Tell the IncomingRev
+        }
+    }
+
     // Callback from c4doc_put() that applies a delta, during _insertRevisionsNow()
     C4SliceResult Inserter::applyDeltaCallback(C4Document* c4doc, C4Slice deltaJSON, C4RevisionFlags* revFlags,
                                                C4Error* outError) {
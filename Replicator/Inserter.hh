@@ -25,14 +25,23 @@ namespace litecore::repl {
 
         void insertRevision(RevToInsert* NONNULL);
 
+        /// The number of revisions that triggers an immediate insertion. This adapts to the load if
+        /// `tuning::kAdaptiveInsertion` is set. Thread-safe.
+        size_t batchSize() const { return _revsToInsert.capacity(); }
+
         bool passive() const override { return _options->pull(collectionIndex()) <= kC4Passive; }
 
       protected:
         std::string loggingClassName() const override { return "Inserter"; }
 
       private:
+        struct PutBatch;
+
         void          _insertRevisionsNow(int gen);
-        bool          insertRevisionNow(RevToInsert* NONNULL, C4Collection*, C4Error*);
+        bool          addToBatch(RevToInsert* NONNULL, C4Collection*, PutBatch&, C4Error*);
+        void          insertBatchNow(PutBatch&, C4Collection*);
+        bool          purgeRevisionNow(RevToInsert* NONNULL, C4Collection*, C4Error*);
+        void          revisionInsertedNow(RevToInsert* NONNULL, bool saved, C4Error);
         C4SliceResult applyDeltaCallback(C4Document* doc NONNULL, C4Slice deltaJSON, C4RevisionFlags* revFlags,
                                          C4Error* outError);
 
@@ -349,6 +349,8 @@ namespace litecore::repl {
 
     void Puller::insertRevision(RevToInsert* rev) { _inserter->insertRevision(rev); }
 
+    size_t Puller::insertionBatchSize() const { return _inserter->batchSize(); }
+
 #pragma mark - STATUS / PROGRESS:
 
     void Puller::_childChangedStatus(Retained<Worker> task, Status status) {
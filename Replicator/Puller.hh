@@ -52,6 +52,9 @@ namespace litecore::repl {
 
         void insertRevision(RevToInsert* rev NONNULL);
 
+        // The Inserter's current batch size. Thread-safe.
+        size_t insertionBatchSize() const;
+
         bool passive() const override { return _options->pull(collectionIndex()) <= kC4Passive; }
 
       protected:
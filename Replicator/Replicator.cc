@@ -392,11 +392,18 @@ namespace litecore::repl {
 
         setProgress(_pushStatus.progress + _pullStatus.progress);
 
+        // Report the largest insertion batch size of any collection:
+        size_t batchSize = 0;
+        for ( auto& sub : _subRepls ) {
+            if ( sub.puller ) batchSize = std::max(batchSize, sub.puller->insertionBatchSize());
+        }
+        setInsertionBatchSize(batchSize);
+
         if ( SyncBusyLog.willLog(LogLevel::Info) ) {
-            logInfo("pushStatus=%-s, pullStatus=%-s, progress=%" PRIu64 "/%" PRIu64 "/%" PRIu64 "",
+            logInfo("pushStatus=%-s, pullStatus=%-s, progress=%" PRIu64 "/%" PRIu64 "/%" PRIu64 ", insertionBatch=%zu",
                     kC4ReplicatorActivityLevelNames[_pushStatus.level],
                     kC4ReplicatorActivityLevelNames[_pullStatus.level], status().progress.unitsCompleted,
-                    status().progress.unitsTotal, status().progress.documentCount);
+                    status().progress.unitsTotal, status().progress.documentCount, batchSize);
         }
         if ( SyncBusyLog.willLog(LogLevel::Verbose) ) {
             logVerbose("Replicator status collection-wise: %s", statusVString().c_str());
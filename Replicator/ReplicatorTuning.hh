@@ -29,6 +29,19 @@ namespace litecore::repl::tuning {
            if the queue size hasn't reached kInsertionBatchSize yet. */
     constexpr auto kInsertionDelay = 20ms;
 
+    /* Whether the insertion batch size and delay adapt to the load, within the bounds below,
+           instead of being fixed at the values above. (See actor::Batcher.) This is opt-in: it's
+           off by default until benchmarks show it helps, and is only turned on by setting this.
+           The current batch size is reported in the replicator's status either way.
+           This is not declared `constexpr`, so that tests and benchmarks can change it. */
+    extern bool kAdaptiveInsertion;  // = false;
+
+    /* Bounds of the insertion delay and batch size, in adaptive mode. When revisions arrive
+           slowly, they're inserted after the minimum delay; under load, the delay approaches the
+           time a commit takes, so each commit covers more revisions. */
+    constexpr auto   kMinInsertionDelay = 2ms, kMaxInsertionDelay = 100ms;
+    constexpr size_t kMinInsertionBatchSize = 20, kMaxInsertionBatchSize = 2000;
+
     /* Minimum document body size that will be considered for delta compression.
             (This is the size of the Fleece encoding, which is usually smaller than the JSON.)
            This is not declared `constexpr`, so that the delta-sync unit tests can change it. */
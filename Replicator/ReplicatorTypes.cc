@@ -21,6 +21,7 @@ using namespace std;
 
 namespace litecore::repl::tuning {
     size_t kMinBodySizeForDelta = 200;
+    bool   kAdaptiveInsertion   = false;
 }  // namespace litecore::repl::tuning
 
 namespace litecore::repl {
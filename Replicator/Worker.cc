@@ -84,7 +84,8 @@ namespace litecore::repl {
 
     Worker::Worker(blip::Connection* connection, Worker* parent, const Options* options,
                    std::shared_ptr<DBAccess> dbAccess, const char* namePrefix, CollectionIndex coll)
-        : Actor(SyncLog, string(namePrefix) + connection->name(), (parent ? parent->mailboxForChildren() : nullptr))
+        : Actor(SyncLog, string(namePrefix) + connection->name(), (parent ? parent->mailboxForChildren() : nullptr),
+                actor::Priority::interactive)
         , _options(options)
         , _parent(parent)
         , _db(std::move(dbAccess))
@@ -235,6 +236,13 @@ namespace litecore::repl {
         }
     }
 
+    void Worker::setInsertionBatchSize(size_t size) {
+        if ( size != _status.insertionBatchSize ) {
+            _status.insertionBatchSize = size;
+            _statusChanged             = true;
+        }
+    }
+
     Worker::ActivityLevel Worker::computeActivityLevel(std::string* reason) const {
         Worker::ActivityLevel level{kC4Idle};
         if ( eventCount() > 1 || _pendingResponseCount > 0 ) level = kC4Busy;
@@ -59,6 +59,7 @@ namespace litecore::repl {
             explicit Status(ActivityLevel lvl = kC4Stopped) : C4ReplicatorStatus({lvl, {}, {}, 0}) {}
 
             C4Progress progressDelta{};
+            size_t     insertionBatchSize{0};  // Current size of pulled-revision insertion batches
         };
 
         /// The Replicator at the top of the tree.
@@ -217,6 +218,8 @@ namespace litecore::repl {
         void addProgress(C4Progress);
         /// Directly sets my status's progress counts.
         void setProgress(C4Progress);
+        /// Sets my status's `insertionBatchSize`.
+        void setInsertionBatchSize(size_t);
 
         /// Determines whether I'm stopped/idle/busy.
         /// Called after every event, to update `_status.level`.
@@ -17,6 +17,7 @@
 #include "Timer.hh"
 #include "c4Database.hh"
 #include "Base64.hh"
+#include "Defer.hh"
 #include "betterassert.hh"
 #include "fleece/Mutable.hh"
 #include "fleece/PlatformCompat.hh"
@@ -222,6 +223,31 @@ N_WAY_TEST_CASE_METHOD(ReplicatorLoopbackTest, "Push large database", "[Push]")
     validateCheckpoints(db, db2, "{\"local\":12189}");
 }
 
+N_WAY_TEST_CASE_METHOD(ReplicatorLoopbackTest, "Pull large database adaptive batching", "[Pull][Perf][.slow]") {
+    // Compares fixed-size insertion batches with adaptive ones (see actor::Batcher):
+    bool adaptive = true;
+    SECTION("Fixed batches") { adaptive = false; }
+    SECTION("Adaptive batches") {}
+    tuning::kAdaptiveInsertion = adaptive;
+    DEFER { tuning::kAdaptiveInsertion = false; };
+
+    importJSONLines(sFixturesDir + "iTunesMusicLibrary.json", _collDB1);
+    _expectedDocumentCount = 12189;
+    Stopwatch st;
+    runPullReplication();
+    double t = st.elapsed();
+    Log("%s batching: pulled %lld docs in %.3f sec (%.0f docs/sec); final batch size %zu",
+        (adaptive ? "Adaptive" : "Fixed"), (long long)_expectedDocumentCount, t, double(_expectedDocumentCount) / t,
+        _statusReceived.insertionBatchSize);
+    if ( adaptive ) {
+        CHECK(_statusReceived.insertionBatchSize >= tuning::kMinInsertionBatchSize);
+        CHECK(_statusReceived.insertionBatchSize <= tuning::kMaxInsertionBatchSize);
+    } else {
+        CHECK(_statusReceived.insertionBatchSize == tuning::kInsertionBatchSize);
+    }
+    compareDatabases();
+}
+
 N_WAY_TEST_CASE_METHOD(ReplicatorLoopbackTest, "Push large database no-conflicts", "[Push][NoConflicts]") {
     auto serverOpts = Replicator::Options::passive(_collSpec).setNoIncomingConflicts();
 
@@ -253,6 +279,24 @@ N_WAY_TEST_CASE_METHOD(ReplicatorLoopbackTest, "Pull Small Non-Empty DB", "[Pull
     runPullReplication();
     compareDatabases();
     validateCheckpoints(db2, db, "{\"remote\":100}");
+    // The status reports the size of the batches the revisions were inserted in:
+    CHECK(_statusReceived.insertionBatchSize == tuning::kInsertionBatchSize);
+}
+
+N_WAY_TEST_CASE_METHOD(ReplicatorLoopbackTest, "Pull With Adaptive Insertion", "[Pull]") {
+    // Adaptive insertion batching is opt-in; with it enabled, the batch size reported in the
+    // status is no longer the fixed one, but has adapted to the load within its bounds:
+    tuning::kAdaptiveInsertion = true;
+    DEFER { tuning::kAdaptiveInsertion = false; };
+
+    importJSONLines(sFixturesDir + "names_100.json", _collDB1);
+    _expectedDocumentCount = 100;
+    runPullReplication();
+    compareDatabases();
+    validateCheckpoints(db2, db, "{\"remote\":100}");
+    CHECK(_statusReceived.insertionBatchSize != tuning::kInsertionBatchSize);
+    CHECK(_statusReceived.insertionBatchSize >= tuning::kMinInsertionBatchSize);
+    CHECK(_statusReceived.insertionBatchSize <= tuning::kMaxInsertionBatchSize);
 }
 
 N_WAY_TEST_CASE_METHOD(ReplicatorLoopbackTest, "Incremental Pull", "[Pull]") {
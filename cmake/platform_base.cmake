@@ -58,6 +58,7 @@ function(set_litecore_source_base)
         LiteCore/Query/LazyIndex.cc
         LiteCore/Query/PredictiveModel.cc
         LiteCore/Query/Query.cc
+        LiteCore/Query/QueryCache.cc
         LiteCore/Query/Translator/QueryTranslator.cc
         LiteCore/Query/Translator/ExprNodes.cc
         LiteCore/Query/Translator/IndexedNodes.cc
@@ -87,6 +88,7 @@ function(set_litecore_source_base)
         LiteCore/RevTrees/VectorRecord.cc
         LiteCore/RevTrees/Version.cc
         LiteCore/RevTrees/VersionVector.cc
+        LiteCore/Storage/BodyCompressor.cc
         LiteCore/Storage/BothKeyStore.cc
         LiteCore/Storage/DataFile.cc
         LiteCore/Storage/KeyStore.cc
@@ -138,6 +140,7 @@ function(set_litecore_source_base)
         LiteCore/Support/EncryptedStream.cc
         LiteCore/Support/FilePath.cc
         LiteCore/Support/HybridClock.cc
+        LiteCore/Support/Instrumentation.cc
         LiteCore/Support/ObserverList.cc
         LiteCore/Support/PlatformIO.cc
         LiteCore/Support/SequenceSet.cc